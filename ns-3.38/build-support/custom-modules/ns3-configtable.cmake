@@ -158,6 +158,9 @@ macro(write_configtable)
   string(APPEND out "MPI Support                   : ")
   check_on_or_off("${NS3_MPI}" "${MPI_FOUND}")
 
+  string(APPEND out "Multithreaded parallel support: ")
+  check_on_or_off("${NS3_MTP}" "${ENABLE_MTP}")
+
   string(APPEND out "ns-3 Click Integration        : ")
   check_on_or_off("ON" "${NS3_CLICK}")
 
@@ -343,24 +343,27 @@ UdpEchoClient::Send()
         //
         p = Create<Packet>(m_size);
     }
-    Address localAddress;
-    m_socket->GetSockName(localAddress);
     // call to the trace sinks before the packet is actually sent,
     // so that tags added to the packet can be sent as well
     m_txTrace(p);
-    if (Ipv4Address::IsMatchingType(m_peerAddress))
-    {
-        m_txTraceWithAddresses(
-            p,
-            localAddress,
-            InetSocketAddress(Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
-    }
-    else if (Ipv6Address::IsMatchingType(m_peerAddress))
+    if (!m_txTraceWithAddresses.IsEmpty())
     {
-        m_txTraceWithAddresses(
-            p,
-            localAddress,
-            Inet6SocketAddress(Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+        Address localAddress;
+        m_socket->GetSockName(localAddress);
+        if (Ipv4Address::IsMatchingType(m_peerAddress))
+        {
+            m_txTraceWithAddresses(
+                p,
+                localAddress,
+                InetSocketAddress(Ipv4Address::ConvertFrom(m_peerAddress), m_peerPort));
+        }
+        else if (Ipv6Address::IsMatchingType(m_peerAddress))
+        {
+            m_txTraceWithAddresses(
+                p,
+                localAddress,
+                Inet6SocketAddress(Ipv6Address::ConvertFrom(m_peerAddress), m_peerPort));
+        }
     }
     m_socket->Send(p);
     ++m_sent;
@@ -404,7 +407,6 @@ UdpEchoClient::HandleRead(Ptr<Socket> socket)
     NS_LOG_FUNCTION(this << socket);
     Ptr<Packet> packet;
     Address from;
-    Address localAddress;
     while ((packet = socket->RecvFrom(from)))
     {
         if (InetSocketAddress::IsMatchingType(from))
@@ -421,9 +423,13 @@ UdpEchoClient::HandleRead(Ptr<Socket> socket)
                                    << Inet6SocketAddress::ConvertFrom(from).GetIpv6() << " port "
                                    << Inet6SocketAddress::ConvertFrom(from).GetPort());
         }
-        socket->GetSockName(localAddress);
         m_rxTrace(packet);
-        m_rxTraceWithAddresses(packet, from, localAddress);
+        if (!m_rxTraceWithAddresses.IsEmpty())
+        {
+            Address localAddress;
+            socket->GetSockName(localAddress);
+            m_rxTraceWithAddresses(packet, from, localAddress);
+        }
     }
 }
 
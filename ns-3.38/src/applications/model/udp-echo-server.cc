@@ -162,12 +162,15 @@ UdpEchoServer::HandleRead(Ptr<Socket> socket)
 
     Ptr<Packet> packet;
     Address from;
-    Address localAddress;
     while ((packet = socket->RecvFrom(from)))
     {
-        socket->GetSockName(localAddress);
         m_rxTrace(packet);
-        m_rxTraceWithAddresses(packet, from, localAddress);
+        if (!m_rxTraceWithAddresses.IsEmpty())
+        {
+            Address localAddress;
+            socket->GetSockName(localAddress);
+            m_rxTraceWithAddresses(packet, from, localAddress);
+        }
         if (InetSocketAddress::IsMatchingType(from))
         {
             NS_LOG_INFO("At time " << Simulator::Now().As(Time::S) << " server received "
@@ -0,0 +1,481 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-trace.h"
+
+#include "abort.h"
+#include "fatal-error.h"
+#include "log.h"
+#include "nstime.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::BinaryTrace implementation.
+ *
+ * The file starts with an 8-byte magic and the duration of a time step
+ * in seconds, as a double, followed by chunks, in host byte order.
+ * Each chunk starts with a 32-bit tag:
+ *  - EVENT: the event id, then the component and the format, each as a
+ *    32-bit length and the characters;
+ *  - RECORDS: a 32-bit count, then that many BinaryTrace::Record;
+ *  - END: the 64-bit number of dropped records.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("BinaryTrace");
+
+std::atomic<bool> BinaryTrace::m_enabled{false};
+
+namespace
+{
+
+/** File magic. */
+const char MAGIC[8] = {'N', 'S', '3', 'B', 'T', 'R', 'C', '1'};
+
+/** Chunk tags. */
+enum ChunkTag : uint32_t
+{
+    EVENT = 1,   //!< An event definition.
+    RECORDS = 2, //!< A block of records.
+    END = 3      //!< The end of the trace.
+};
+
+/**
+ * \ingroup logging
+ * Ring buffer of one thread, with a single producer, the owning
+ * thread, and a single consumer, the writer thread.
+ */
+struct Ring
+{
+    /**
+     * Constructor.
+     * \param [in] size The number of records.
+     */
+    explicit Ring(std::size_t size)
+        : records(size)
+    {
+    }
+
+    std::vector<BinaryTrace::Record> records; //!< Record storage.
+    std::atomic<uint64_t> head{0};            //!< Number of records written.
+    std::atomic<uint64_t> tail{0};            //!< Number of records read.
+    std::atomic<uint64_t> dropped{0};         //!< Number of records dropped.
+};
+
+/**
+ * \ingroup logging
+ * State shared by the tracing threads and the writer thread.
+ */
+struct TraceState
+{
+    /** Destructor, closes the trace file. */
+    ~TraceState();
+
+    std::mutex mutex;                         //!< Protects the members below.
+    std::condition_variable wakeup;           //!< Wakes the writer up.
+    std::thread writer;                       //!< The writer thread.
+    bool stop{false};                         //!< Whether the writer must stop.
+    std::ofstream file;                       //!< The trace file.
+    std::size_t ringSize{0};                  //!< Size of the rings.
+    std::vector<std::shared_ptr<Ring>> rings; //!< Rings of the current file.
+    std::vector<std::string> components;      //!< Component of each event id.
+    std::vector<std::string> formats;         //!< Format of each event id.
+    std::size_t writtenEvents{0};             //!< Event definitions written.
+    uint64_t dropped{0};                      //!< Records dropped by closed rings.
+    std::atomic<uint64_t> generation{0};      //!< Incremented for every file.
+};
+
+/**
+ * Get the trace state.
+ * \returns The trace state.
+ */
+TraceState&
+GetState()
+{
+    static TraceState state;
+    return state;
+}
+
+/** Ring of the calling thread. */
+thread_local std::shared_ptr<Ring> t_ring;
+/** Generation of the ring of the calling thread. */
+thread_local uint64_t t_generation = 0;
+
+/**
+ * Write a value.
+ * \tparam T \deduced The value type.
+ * \param [in,out] os The output stream.
+ * \param [in] value The value.
+ */
+template <typename T>
+void
+Write(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * Write a string.
+ * \param [in,out] os The output stream.
+ * \param [in] s The string.
+ */
+void
+WriteString(std::ostream& os, const std::string& s)
+{
+    Write(os, static_cast<uint32_t>(s.size()));
+    os.write(s.data(), s.size());
+}
+
+/**
+ * Read a value.
+ * \tparam T \deduced The value type.
+ * \param [in,out] is The input stream.
+ * \param [out] value The value.
+ * \returns \c false at the end of the stream.
+ */
+template <typename T>
+bool
+Read(std::istream& is, T& value)
+{
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+/**
+ * Read a string.
+ * \param [in,out] is The input stream.
+ * \param [out] s The string.
+ * \returns \c false at the end of the stream.
+ */
+bool
+ReadString(std::istream& is, std::string& s)
+{
+    uint32_t size;
+    if (!Read(is, size))
+    {
+        return false;
+    }
+    s.resize(size);
+    return static_cast<bool>(is.read(&s[0], size));
+}
+
+/**
+ * Write the new event definitions and drain the rings.
+ * \param [in,out] state The trace state, locked.
+ */
+void
+Flush(TraceState& state)
+{
+    // Events are registered under the lock, before their first record:
+    // every record drained below has its definition written first.
+    for (; state.writtenEvents < state.formats.size(); ++state.writtenEvents)
+    {
+        Write(state.file, static_cast<uint32_t>(EVENT));
+        Write(state.file, static_cast<uint32_t>(state.writtenEvents));
+        WriteString(state.file, state.components[state.writtenEvents]);
+        WriteString(state.file, state.formats[state.writtenEvents]);
+    }
+    for (auto& ring : state.rings)
+    {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        std::size_t size = ring->records.size();
+        while (tail != head)
+        {
+            // Write the contiguous part of the ring up to its end.
+            std::size_t start = tail % size;
+            std::size_t count = std::min<uint64_t>(head - tail, size - start);
+            Write(state.file, static_cast<uint32_t>(RECORDS));
+            Write(state.file, static_cast<uint32_t>(count));
+            state.file.write(reinterpret_cast<const char*>(&ring->records[start]),
+                             count * sizeof(BinaryTrace::Record));
+            tail += count;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+}
+
+/**
+ * Body of the writer thread.
+ * \param [in,out] state The trace state.
+ */
+void
+RunWriter(TraceState* state)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->stop)
+    {
+        state->wakeup.wait_for(lock, std::chrono::milliseconds(10));
+        Flush(*state);
+    }
+}
+
+/**
+ * Stop the writer thread, if running, and close the trace file.
+ * \param [in,out] state The trace state.
+ */
+void
+Close(TraceState& state)
+{
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.writer.joinable())
+        {
+            return;
+        }
+        state.stop = true;
+    }
+    state.wakeup.notify_one();
+    state.writer.join();
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    Flush(state);
+    for (const auto& ring : state.rings)
+    {
+        state.dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    Write(state.file, static_cast<uint32_t>(END));
+    Write(state.file, state.dropped);
+    state.file.close();
+    state.rings.clear();
+    if (state.dropped > 0)
+    {
+        NS_LOG_WARN(state.dropped << " binary trace records dropped");
+    }
+}
+
+TraceState::~TraceState()
+{
+    Close(*this);
+}
+
+/**
+ * Replace the \c {} placeholders of a format.
+ * \param [in,out] os The output stream.
+ * \param [in] format The event format.
+ * \param [in] args The arguments.
+ */
+void
+PrintEvent(std::ostream& os, const std::string& format, const uint64_t* args)
+{
+    std::size_t arg = 0;
+    for (std::size_t i = 0; i < format.size(); ++i)
+    {
+        if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}' &&
+            arg < BinaryTrace::MAX_ARGS)
+        {
+            os << args[arg++];
+            ++i;
+        }
+        else
+        {
+            os << format[i];
+        }
+    }
+}
+
+} // unnamed namespace
+
+void
+BinaryTrace::Enable(const std::string& filename, std::size_t ringSize)
+{
+    NS_LOG_FUNCTION(filename << ringSize);
+    NS_ABORT_MSG_IF(ringSize == 0, "Binary trace rings must not be empty");
+    Disable();
+
+    TraceState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!state.file.is_open())
+    {
+        NS_FATAL_ERROR("Cannot open binary trace file " << filename);
+    }
+    state.file.write(MAGIC, sizeof(MAGIC));
+    Write(state.file, TimeStep(1).GetSeconds());
+    state.ringSize = ringSize;
+    state.writtenEvents = 0;
+    state.dropped = 0;
+    state.stop = false;
+    state.generation.fetch_add(1, std::memory_order_release);
+    state.writer = std::thread(&RunWriter, &state);
+    m_enabled.store(true, std::memory_order_relaxed);
+}
+
+void
+BinaryTrace::Disable()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_enabled.store(false, std::memory_order_relaxed);
+    Close(GetState());
+}
+
+uint64_t
+BinaryTrace::GetDroppedCount()
+{
+    TraceState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    uint64_t dropped = state.dropped;
+    for (const auto& ring : state.rings)
+    {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+uint32_t
+BinaryTrace::RegisterEvent(const std::string& component, const std::string& format)
+{
+    TraceState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.components.push_back(component);
+    state.formats.push_back(format);
+    return static_cast<uint32_t>(state.formats.size() - 1);
+}
+
+void
+BinaryTrace::DoAppend(uint32_t event, const uint64_t (&args)[MAX_ARGS])
+{
+    TraceState& state = GetState();
+    uint64_t generation = state.generation.load(std::memory_order_acquire);
+    if (!t_ring || t_generation != generation)
+    {
+        // First record of this thread in the current file.
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.writer.joinable())
+        {
+            return;
+        }
+        t_ring = std::make_shared<Ring>(state.ringSize);
+        t_generation = generation;
+        state.rings.push_back(t_ring);
+    }
+
+    Ring& ring = *t_ring;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) == ring.records.size())
+    {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record& record = ring.records[head % ring.records.size()];
+    record.ts = Simulator::Now().GetTimeStep();
+    record.context = Simulator::GetContext();
+    record.event = event;
+    std::memcpy(record.args, args, sizeof(record.args));
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool
+BinaryTrace::Decode(std::istream& is, std::ostream& os)
+{
+    char magic[sizeof(MAGIC)];
+    double stepSeconds;
+    if (!is.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !Read(is, stepSeconds))
+    {
+        return false;
+    }
+
+    std::map<uint32_t, std::pair<std::string, std::string>> events;
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(9);
+    uint32_t tag;
+    bool valid = false;
+    while (Read(is, tag))
+    {
+        if (tag == EVENT)
+        {
+            uint32_t id;
+            std::string component;
+            std::string format;
+            if (!Read(is, id) || !ReadString(is, component) || !ReadString(is, format))
+            {
+                break;
+            }
+            events[id] = std::make_pair(component, format);
+        }
+        else if (tag == RECORDS)
+        {
+            uint32_t count;
+            if (!Read(is, count))
+            {
+                break;
+            }
+            Record record;
+            uint32_t i = 0;
+            for (; i < count && Read(is, record); ++i)
+            {
+                auto it = events.find(record.event);
+                if (it == events.end())
+                {
+                    break;
+                }
+                os << "+" << record.ts * stepSeconds << "s ";
+                if (record.context == Simulator::NO_CONTEXT)
+                {
+                    os << "-";
+                }
+                else
+                {
+                    os << record.context;
+                }
+                os << " " << it->second.first << ": ";
+                PrintEvent(os, it->second.second, record.args);
+                os << std::endl;
+            }
+            if (i < count)
+            {
+                break;
+            }
+        }
+        else if (tag == END)
+        {
+            uint64_t dropped;
+            if (Read(is, dropped))
+            {
+                if (dropped > 0)
+                {
+                    os << "# " << dropped << " records dropped" << std::endl;
+                }
+                valid = true;
+            }
+            break;
+        }
+        else
+        {
+            break;
+        }
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return valid;
+}
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <atomic>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::BinaryTrace declaration and the NS_TRACE_EVENT macro.
+ */
+
+/**
+ * \ingroup logging
+ *
+ * Append a binary trace record for the current log component.
+ *
+ * The record holds the simulation time, the context, the event and up to
+ * four integer arguments.  Each \c {} in \pname{format} is replaced by the
+ * next argument, printed as an unsigned integer, when the trace is
+ * decoded, for example
+ *
+ * \code
+ *   NS_TRACE_EVENT("rx psn={} size={}", header.GetPsn(), packet->GetSize());
+ * \endcode
+ *
+ * When tracing is disabled the cost is a single relaxed atomic load,
+ * and the arguments are not evaluated.
+ *
+ * \param [in] format The event format, a string literal.
+ * \param [in] ... The integer arguments.
+ */
+#define NS_TRACE_EVENT(format, ...)                                                                \
+    do                                                                                             \
+    {                                                                                              \
+        if (ns3::BinaryTrace::IsEnabled())                                                         \
+        {                                                                                          \
+            static const uint32_t ns3TraceEventId =                                                \
+                ns3::BinaryTrace::RegisterEvent(g_log.Name(), format);                             \
+            ns3::BinaryTrace::Append(ns3TraceEventId, ##__VA_ARGS__);                              \
+        }                                                                                          \
+    } while (false)
+
+namespace ns3
+{
+
+/**
+ * \ingroup logging
+ *
+ * \brief Low-overhead binary trace of fixed-size records.
+ *
+ * NS_LOG formats every enabled message as text on the simulation thread.
+ * A binary trace instead appends a fixed-size Record to a lock-free
+ * ring buffer owned by the calling thread; a background writer thread
+ * drains the rings into a compact file.  The formats of the events are
+ * written once, the first time each event is recorded.  The file is
+ * rendered as text offline with Decode(), or with the
+ * \c print-binary-trace utility.
+ *
+ * A full ring drops records rather than blocking the simulation; the
+ * number of dropped records is reported by GetDroppedCount() and
+ * written at the end of the file.
+ */
+class BinaryTrace
+{
+  public:
+    /** Maximum number of arguments of a record. */
+    static constexpr std::size_t MAX_ARGS = 4;
+
+    /** A trace record, as stored in the file. */
+    struct Record
+    {
+        int64_t ts;              //!< Simulation time, in time steps.
+        uint32_t context;        //!< Simulation context.
+        uint32_t event;          //!< Event id, as returned by RegisterEvent().
+        uint64_t args[MAX_ARGS]; //!< Event arguments.
+    };
+
+    /**
+     * Start tracing to a file.
+     *
+     * Tracing to a previous file, if any, is stopped first.
+     * \param [in] filename The trace file name.
+     * \param [in] ringSize The number of records of each per-thread ring.
+     */
+    static void Enable(const std::string& filename, std::size_t ringSize = 65536);
+    /** Stop tracing, writing the buffered records and closing the file. */
+    static void Disable();
+
+    /**
+     * Check whether tracing is enabled.
+     * \returns \c true if records are being traced.
+     */
+    static bool IsEnabled()
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of records dropped because a ring was full.
+     * \returns The number of records dropped since tracing was last enabled.
+     */
+    static uint64_t GetDroppedCount();
+
+    /**
+     * Register an event format.
+     * \param [in] component The log component name.
+     * \param [in] format The event format.
+     * \returns The event id.
+     */
+    static uint32_t RegisterEvent(const std::string& component, const std::string& format);
+
+    /**
+     * Append a record for the current simulation time and context.
+     * \tparam Args \deduced The argument types, integers or enums.
+     * \param [in] event The event id.
+     * \param [in] args The arguments.
+     */
+    template <typename... Args>
+    static void Append(uint32_t event, Args... args)
+    {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "Too many binary trace arguments");
+        uint64_t values[MAX_ARGS] = {ToArg(args)...};
+        DoAppend(event, values);
+    }
+
+    /**
+     * Render a trace file as text, one line per record.
+     *
+     * Each line holds the time in seconds, the context, the component
+     * and the formatted event.
+     * \param [in,out] is The trace file.
+     * \param [in,out] os The text output.
+     * \returns \c false if the file is not a valid trace.
+     */
+    static bool Decode(std::istream& is, std::ostream& os);
+
+  private:
+    /**
+     * Convert an argument to its stored value.
+     * \tparam T \deduced The argument type.
+     * \param [in] value The argument.
+     * \returns The stored value.
+     */
+    template <typename T>
+    static uint64_t ToArg(T value)
+    {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                      "Binary trace arguments must be integers");
+        return static_cast<uint64_t>(value);
+    }
+
+    /**
+     * Append a record to the ring of the calling thread.
+     * \param [in] event The event id.
+     * \param [in] args The arguments.
+     */
+    static void DoAppend(uint32_t event, const uint64_t (&args)[MAX_ARGS]);
+
+    /** Whether tracing is enabled. */
+    static std::atomic<bool> m_enabled;
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_H */
@@ -29,6 +29,8 @@
 
 #include <functional>
 #include <memory>
+#include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
 #include <vector>
@@ -130,115 +132,97 @@ class CallbackImplBase : public SimpleRefCount<CallbackImplBase>
 
 /**
  * \ingroup callbackimpl
- * Abstract base class for CallbackComponent.
- * Provides equality test.
+ * A component of a callback, i.e., the callable object or a bound
+ * argument. The purpose of this structure is to test the equality of
+ * the components of two callbacks.
  */
-class CallbackComponentBase
+struct CallbackComponent
 {
-  public:
-    /** Virtual destructor */
-    virtual ~CallbackComponentBase()
-    {
-    }
-
-    /**
-     * Equality test
-     *
-     * \param [in] other CallbackComponent Ptr
-     * \return \c true if we are equal
-     */
-    virtual bool IsEqual(std::shared_ptr<const CallbackComponentBase> other) const = 0;
+    const void* value;                       //!< The value of the component.
+    const std::type_info* type;              //!< The type of the component.
+    bool (*isEqual)(const void*, const void*); //!< Equality test, null if not comparable.
 };
 
+/// Vector of callback components
+typedef std::vector<CallbackComponent> CallbackComponentVector;
+
 /**
  * \ingroup callbackimpl
- * Stores a component of a callback, i.e., the callable object
- * or a bound argument. The purpose of this class is to test
- * the equality of the components of two callbacks.
+ * Test the equality of two callback components of the same type.
  *
- * \tparam T The type of the callback component.
+ * \tparam T \explicit The type of the callback components.
+ * \param [in] a The first component.
+ * \param [in] b The second component.
+ * \return \c true if the components are equal
+ */
+template <typename T>
+bool
+CallbackComponentIsEqual(const void* a, const void* b)
+{
+    return !(*static_cast<const T*>(a) != *static_cast<const T*>(b));
+}
+
+/**
+ * \ingroup callbackimpl
+ * Build a callback component.
+ *
+ * Callable objects such as lambdas and the objects returned by
+ * std::function and std::bind do not provide the equality operator:
+ * such components are only equal to themselves.
+ *
+ * \tparam T \deduced The type of the callback component.
  * \tparam isComparable whether this callback component can be compared to others of the same type
+ * \param [in] value The value of the callback component, which must outlive the component.
+ * \return The callback component
  */
 template <typename T, bool isComparable = true>
-class CallbackComponent : public CallbackComponentBase
+CallbackComponent
+MakeCallbackComponent(const T& value)
 {
-  public:
-    /**
-     * Constructor
-     *
-     * \param [in] t The value of the callback component
-     */
-    CallbackComponent(const T& t)
-        : m_comp(t)
+    if constexpr (isComparable)
     {
+        return {&value, &typeid(T), &CallbackComponentIsEqual<T>};
     }
-
-    /**
-     * Equality test between the values of two components
-     *
-     * \param [in] other CallbackComponentBase Ptr
-     * \return \c true if we are equal
-     */
-    bool IsEqual(std::shared_ptr<const CallbackComponentBase> other) const override
+    else
     {
-        auto p = std::dynamic_pointer_cast<const CallbackComponent<T>>(other);
-
-        // other must have the same type and value as ours
-        if (p == nullptr || p->m_comp != m_comp)
-        {
-            return false;
-        }
-
-        return true;
+        return {&value, &typeid(T), nullptr};
     }
-
-  private:
-    T m_comp; //!< the value of the callback component
-};
+}
 
 /**
  * \ingroup callbackimpl
- * Partial specialization of class CallbackComponent with isComparable equal
- * to false. This is required to handle callable objects (such as lambdas and
- * objects returned by std::function and std::bind) that do not provide the
- * equality operator. Given that these objects cannot be compared and the only
- * purpose of the class CallbackComponent is to compare values, no object is
- * stored in this specialized class.
- *
- * \tparam T The type of the callback component.
+ * Invoke a callable object, converting the result to the callback return type.
+ *
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam F \deduced The type of the callable object.
+ * \tparam Args \deduced The types of the arguments.
+ * \param [in] f The callable object.
+ * \param [in] args The arguments.
+ * \return The value returned by \pname{f}, if \pname{R} is not void.
  */
-template <typename T>
-class CallbackComponent<T, false> : public CallbackComponentBase
+template <typename R, typename F, typename... Args>
+R
+CallbackInvoke(F& f, Args&&... args)
 {
-  public:
-    /**
-     * Constructor
-     *
-     * \param [in] t The value of the callback component
-     */
-    CallbackComponent(const T& t)
+    if constexpr (std::is_void_v<R>)
     {
+        std::invoke(f, std::forward<Args>(args)...);
     }
-
-    /**
-     * Equality test between functions
-     *
-     * \param [in] other CallbackParam Ptr
-     * \return \c true if we are equal
-     */
-    bool IsEqual(std::shared_ptr<const CallbackComponentBase> other) const override
+    else
     {
-        return false;
+        return std::invoke(f, std::forward<Args>(args)...);
     }
-};
-
-/// Vector of callback components
-typedef std::vector<std::shared_ptr<CallbackComponentBase>> CallbackComponentVector;
+}
 
 /**
  * \ingroup callbackimpl
  * CallbackImpl class with varying numbers of argument types
  *
+ * This is the interface shared by all the callbacks of a signature.
+ * The callable object and the bound arguments are stored inline in the
+ * derived classes, so that building a callback costs a single
+ * allocation and invoking it a single virtual call.
+ *
  * \tparam R \explicit The return type of the Callback.
  * \tparam UArgs \explicit The types of any arguments to the Callback.
  */
@@ -247,45 +231,20 @@ class CallbackImpl : public CallbackImplBase
 {
   public:
     /**
-     * Constructor.
+     * Function call operator.
      *
-     * \param func the callable object
-     * \param components the callback components (callable object and bound arguments)
-     */
-    CallbackImpl(std::function<R(UArgs...)> func, const CallbackComponentVector& components)
-        : m_func(func),
-          m_components(components)
-    {
-    }
-
-    /**
-     * Get the stored function.
-     * \return A const reference to the stored function.
-     */
-    const std::function<R(UArgs...)>& GetFunction() const
-    {
-        return m_func;
-    }
-
-    /**
-     * Get the vector of callback components.
-     * \return A const reference to the vector of callback components.
+     * \param uargs The arguments to the Callback.
+     * \return Callback value
      */
-    const CallbackComponentVector& GetComponents() const
-    {
-        return m_components;
-    }
+    virtual R operator()(UArgs... uargs) const = 0;
 
     /**
-     * Function call operator.
+     * Append the callback components, i.e., the original callable
+     * object and the bound arguments, if any.
      *
-     * \param uargs The arguments to the Callback.
-     * \return Callback value
+     * \param [in,out] components The vector of callback components.
      */
-    R operator()(UArgs... uargs) const
-    {
-        return m_func(uargs...);
-    }
+    virtual void GetComponents(CallbackComponentVector& components) const = 0;
 
     bool IsEqual(Ptr<const CallbackImplBase> other) const override
     {
@@ -296,26 +255,37 @@ class CallbackImpl : public CallbackImplBase
         {
             return false;
         }
-
-        // if the two callback implementations are made of a distinct number of
-        // components, they are different
-        if (m_components.size() != otherDerived->GetComponents().size())
+        if (otherDerived == this)
         {
-            return false;
+            return true;
         }
 
-        // the two functions are equal if they compare equal or the shared pointers
-        // point to the same locations
-        if (!m_components.at(0)->IsEqual(otherDerived->GetComponents().at(0)) &&
-            m_components.at(0) != otherDerived->GetComponents().at(0))
+        CallbackComponentVector components;
+        CallbackComponentVector otherComponents;
+        GetComponents(components);
+        otherDerived->GetComponents(otherComponents);
+
+        // if the two callback implementations are made of a distinct number of
+        // components, they are different
+        if (components.size() != otherComponents.size())
         {
             return false;
         }
 
-        // check if the remaining components are equal one by one
-        for (std::size_t i = 1; i < m_components.size(); i++)
+        for (std::size_t i = 0; i < components.size(); i++)
         {
-            if (!m_components.at(i)->IsEqual(otherDerived->GetComponents().at(i)))
+            if (*components[i].type != *otherComponents[i].type)
+            {
+                return false;
+            }
+            // the two functions are equal if they compare equal or they are
+            // the same object, shared by callbacks bound from the same callback
+            if (i == 0 && components[i].value == otherComponents[i].value)
+            {
+                continue;
+            }
+            if (components[i].isEqual == nullptr ||
+                !components[i].isEqual(components[i].value, otherComponents[i].value))
             {
                 return false;
             }
@@ -347,13 +317,159 @@ class CallbackImpl : public CallbackImplBase
 
         return id;
     }
+};
+
+/**
+ * \ingroup callbackimpl
+ * CallbackImpl storing a callable object and the values of its first
+ * arguments, if bound.
+ *
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam UArgsList \explicit The types of the arguments to the Callback, as a std::tuple.
+ * \tparam T \explicit The type of the callable object.
+ * \tparam BArgs \explicit The types of the bound arguments.
+ */
+template <typename R, typename UArgsList, typename T, typename... BArgs>
+class CallbackFunctorImpl;
+
+/**
+ * \ingroup callbackimpl
+ * Partial specialization of CallbackFunctorImpl unpacking the argument types.
+ *
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam UArgs \explicit The types of the arguments to the Callback.
+ * \tparam T \explicit The type of the callable object.
+ * \tparam BArgs \explicit The types of the bound arguments.
+ */
+template <typename R, typename... UArgs, typename T, typename... BArgs>
+class CallbackFunctorImpl<R, std::tuple<UArgs...>, T, BArgs...> : public CallbackImpl<R, UArgs...>
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param func the callable object
+     * \param bargs the values of the bound arguments
+     */
+    CallbackFunctorImpl(T func, BArgs... bargs)
+        : m_func(std::move(func)),
+          m_bargs(std::move(bargs)...)
+    {
+    }
+
+    R operator()(UArgs... uargs) const override
+    {
+        return Invoke(std::index_sequence_for<BArgs...>{}, uargs...);
+    }
+
+    void GetComponents(CallbackComponentVector& components) const override
+    {
+        // The original function is comparable if it is a function pointer or
+        // a pointer to a member function or a pointer to a member data.
+        constexpr bool isComp =
+            std::is_function_v<std::remove_pointer_t<T>> || std::is_member_pointer_v<T>;
+
+        components.push_back(MakeCallbackComponent<T, isComp>(m_func));
+        std::apply(
+            [&components](const auto&... bargs) {
+                (components.push_back(MakeCallbackComponent(bargs)), ...);
+            },
+            m_bargs);
+    }
 
   private:
-    /// Stores the callable object associated with this callback (as a lambda)
-    std::function<R(UArgs...)> m_func;
+    /**
+     * Invoke the callable object with the bound and the unbound arguments.
+     *
+     * \param [in] seq A compile-time integer sequence, 0..N-1 for N bound arguments
+     * \param uargs The arguments to the Callback.
+     * \return Callback value
+     */
+    template <std::size_t... INDEX>
+    R Invoke(std::index_sequence<INDEX...> seq, UArgs... uargs) const
+    {
+        return CallbackInvoke<R>(m_func,
+                                 std::get<INDEX>(m_bargs)...,
+                                 std::forward<UArgs>(uargs)...);
+    }
 
-    /// Stores the original callable object and the bound arguments, if any
-    std::vector<std::shared_ptr<CallbackComponentBase>> m_components;
+    /// The callable object, mutable as callable objects may have a non-const call operator
+    mutable T m_func;
+    /// The values of the bound arguments, mutable as they may be bound to reference parameters
+    mutable std::tuple<BArgs...> m_bargs;
+};
+
+/**
+ * \ingroup callbackimpl
+ * CallbackImpl binding the first arguments of another callback.
+ *
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam UArgsList \explicit The types of the arguments to the Callback, as a std::tuple.
+ * \tparam BaseImpl \explicit The type of the implementation of the other callback.
+ * \tparam BArgs \explicit The types of the bound arguments.
+ */
+template <typename R, typename UArgsList, typename BaseImpl, typename... BArgs>
+class CallbackBoundImpl;
+
+/**
+ * \ingroup callbackimpl
+ * Partial specialization of CallbackBoundImpl unpacking the argument types.
+ *
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam UArgs \explicit The types of the arguments to the Callback.
+ * \tparam BaseImpl \explicit The type of the implementation of the other callback.
+ * \tparam BArgs \explicit The types of the bound arguments.
+ */
+template <typename R, typename... UArgs, typename BaseImpl, typename... BArgs>
+class CallbackBoundImpl<R, std::tuple<UArgs...>, BaseImpl, BArgs...>
+    : public CallbackImpl<R, UArgs...>
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param base the implementation of the other callback
+     * \param bargs the values of the bound arguments
+     */
+    CallbackBoundImpl(Ptr<BaseImpl> base, BArgs... bargs)
+        : m_base(base),
+          m_bargs(std::move(bargs)...)
+    {
+    }
+
+    R operator()(UArgs... uargs) const override
+    {
+        return Invoke(std::index_sequence_for<BArgs...>{}, uargs...);
+    }
+
+    void GetComponents(CallbackComponentVector& components) const override
+    {
+        m_base->GetComponents(components);
+        std::apply(
+            [&components](const auto&... bargs) {
+                (components.push_back(MakeCallbackComponent(bargs)), ...);
+            },
+            m_bargs);
+    }
+
+  private:
+    /**
+     * Invoke the other callback with the bound and the unbound arguments.
+     *
+     * \param [in] seq A compile-time integer sequence, 0..N-1 for N bound arguments
+     * \param uargs The arguments to the Callback.
+     * \return Callback value
+     */
+    template <std::size_t... INDEX>
+    R Invoke(std::index_sequence<INDEX...> seq, UArgs... uargs) const
+    {
+        return (*m_base)(std::get<INDEX>(m_bargs)..., std::forward<UArgs>(uargs)...);
+    }
+
+    /// The implementation of the other callback
+    Ptr<BaseImpl> m_base;
+    /// The values of the bound arguments, mutable as they may be bound to reference parameters
+    mutable std::tuple<BArgs...> m_bargs;
 };
 
 /**
@@ -469,16 +585,11 @@ class Callback : public CallbackBase
     template <typename... BArgs>
     Callback(const Callback<R, BArgs..., UArgs...>& cb, BArgs... bargs)
     {
-        auto f = cb.DoPeekImpl()->GetFunction();
+        using BaseImpl = CallbackImpl<R, BArgs..., UArgs...>;
 
-        CallbackComponentVector components(cb.DoPeekImpl()->GetComponents());
-        components.insert(components.end(), {std::make_shared<CallbackComponent<BArgs>>(bargs)...});
-
-        m_impl = Create<CallbackImpl<R, UArgs...>>(
-            [f, bargs...](auto&&... uargs) -> R {
-                return f(bargs..., std::forward<decltype(uargs)>(uargs)...);
-            },
-            components);
+        m_impl = Create<CallbackBoundImpl<R, std::tuple<UArgs...>, BaseImpl, BArgs...>>(
+            Ptr<BaseImpl>(cb.DoPeekImpl()),
+            std::move(bargs)...);
     }
 
     /**
@@ -498,22 +609,10 @@ class Callback : public CallbackBase
               typename... BArgs>
     Callback(T func, BArgs... bargs)
     {
-        // store the function in a std::function object
-        std::function<R(BArgs..., UArgs...)> f(func);
-
-        // The original function is comparable if it is a function pointer or
-        // a pointer to a member function or a pointer to a member data.
-        constexpr bool isComp =
-            std::is_function_v<std::remove_pointer_t<T>> || std::is_member_pointer_v<T>;
-
-        CallbackComponentVector components({std::make_shared<CallbackComponent<T, isComp>>(func),
-                                            std::make_shared<CallbackComponent<BArgs>>(bargs)...});
-
-        m_impl = Create<CallbackImpl<R, UArgs...>>(
-            [f, bargs...](auto&&... uargs) -> R {
-                return f(bargs..., std::forward<decltype(uargs)>(uargs)...);
-            },
-            components);
+        // the function and the bound arguments are stored in the implementation
+        m_impl = Create<CallbackFunctorImpl<R, std::tuple<UArgs...>, T, BArgs...>>(
+            std::move(func),
+            std::move(bargs)...);
     }
 
   private:
@@ -531,19 +630,16 @@ class Callback : public CallbackBase
     template <std::size_t... INDEX, typename... BoundArgs>
     auto BindImpl(std::index_sequence<INDEX...> seq, BoundArgs&&... bargs)
     {
-        Callback<R, std::tuple_element_t<sizeof...(bargs) + INDEX, std::tuple<UArgs...>>...> cb;
-
-        const auto f = DoPeekImpl()->GetFunction();
+        using BaseImpl = CallbackImpl<R, UArgs...>;
+        using UnboundArgs =
+            std::tuple<std::tuple_element_t<sizeof...(bargs) + INDEX, std::tuple<UArgs...>>...>;
 
-        CallbackComponentVector components(DoPeekImpl()->GetComponents());
-        components.insert(components.end(),
-                          {std::make_shared<CallbackComponent<BoundArgs>>(bargs)...});
+        Callback<R, std::tuple_element_t<sizeof...(bargs) + INDEX, std::tuple<UArgs...>>...> cb;
 
-        cb.m_impl = Create<std::remove_pointer_t<decltype(cb.DoPeekImpl())>>(
-            [f, bargs...](auto&&... uargs) mutable {
-                return f(bargs..., std::forward<decltype(uargs)>(uargs)...);
-            },
-            components);
+        cb.m_impl =
+            Create<CallbackBoundImpl<R, UnboundArgs, BaseImpl, std::decay_t<BoundArgs>...>>(
+                Ptr<BaseImpl>(DoPeekImpl()),
+                std::forward<BoundArgs>(bargs)...);
 
         return cb;
     }
@@ -588,7 +684,7 @@ class Callback : public CallbackBase
      */
     R operator()(UArgs... uargs) const
     {
-        return (*(DoPeekImpl()))(uargs...);
+        return (*(DoPeekImpl()))(std::forward<UArgs>(uargs)...);
     }
 
     /**
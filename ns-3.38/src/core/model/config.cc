@@ -26,6 +26,8 @@
 #include "pointer.h"
 #include "singleton.h"
 
+#include <limits>
+#include <map>
 #include <sstream>
 
 /**
@@ -197,6 +199,9 @@ MatchContainer::DisconnectWithoutContext(std::string name, const CallbackBase& c
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once into ranges of indices, since it is
+ * matched against every entry of every array found on the path.
  */
 class ArrayMatcher
 {
@@ -216,6 +221,12 @@ class ArrayMatcher
     bool Matches(std::size_t i) const;
 
   private:
+    /**
+     * Parse one alternative of the Config path specification.
+     *
+     * \param [in] alternative The alternative, without any '|'.
+     */
+    void ParseAlternative(std::string alternative);
     /**
      * Convert a string to an \c uint32_t.
      *
@@ -226,6 +237,8 @@ class ArrayMatcher
     bool StringToUint32(std::string str, uint32_t* value) const;
     /** The Config path element. */
     std::string m_element;
+    /** The ranges of matching indices, bounds included. */
+    std::vector<std::pair<std::size_t, std::size_t>> m_ranges;
 
 }; // class ArrayMatcher
 
@@ -233,65 +246,61 @@ ArrayMatcher::ArrayMatcher(std::string element)
     : m_element(element)
 {
     NS_LOG_FUNCTION(this << element);
-}
 
-bool
-ArrayMatcher::Matches(std::size_t i) const
-{
-    NS_LOG_FUNCTION(this << i);
-    if (m_element == "*")
+    // The alternatives are separated by '|'
+    std::string::size_type start = 0;
+    std::string::size_type bar;
+    while ((bar = m_element.find('|', start)) != std::string::npos)
     {
-        NS_LOG_DEBUG("Array " << i << " matches *");
-        return true;
+        ParseAlternative(m_element.substr(start, bar - start));
+        start = bar + 1;
     }
-    std::string::size_type tmp;
-    tmp = m_element.find('|');
-    if (tmp != std::string::npos)
+    ParseAlternative(m_element.substr(start));
+}
+
+void
+ArrayMatcher::ParseAlternative(std::string alternative)
+{
+    NS_LOG_FUNCTION(this << alternative);
+    if (alternative == "*")
     {
-        std::string left = m_element.substr(0, tmp - 0);
-        std::string right = m_element.substr(tmp + 1, m_element.size() - (tmp + 1));
-        ArrayMatcher matcher = ArrayMatcher(left);
-        if (matcher.Matches(i))
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << left);
-            return true;
-        }
-        matcher = ArrayMatcher(right);
-        if (matcher.Matches(i))
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << right);
-            return true;
-        }
-        NS_LOG_DEBUG("Array " << i << " does not match " << m_element);
-        return false;
+        m_ranges.emplace_back(0, std::numeric_limits<std::size_t>::max());
+        return;
     }
-    std::string::size_type leftBracket = m_element.find('[');
-    std::string::size_type rightBracket = m_element.find(']');
-    std::string::size_type dash = m_element.find('-');
-    if (leftBracket == 0 && rightBracket == m_element.size() - 1 && dash > leftBracket &&
+    std::string::size_type leftBracket = alternative.find('[');
+    std::string::size_type rightBracket = alternative.find(']');
+    std::string::size_type dash = alternative.find('-');
+    if (leftBracket == 0 && rightBracket == alternative.size() - 1 && dash > leftBracket &&
         dash < rightBracket)
     {
-        std::string lowerBound = m_element.substr(leftBracket + 1, dash - (leftBracket + 1));
-        std::string upperBound = m_element.substr(dash + 1, rightBracket - (dash + 1));
+        std::string lowerBound = alternative.substr(leftBracket + 1, dash - (leftBracket + 1));
+        std::string upperBound = alternative.substr(dash + 1, rightBracket - (dash + 1));
         uint32_t min;
         uint32_t max;
-        if (StringToUint32(lowerBound, &min) && StringToUint32(upperBound, &max) && i >= min &&
-            i <= max)
-        {
-            NS_LOG_DEBUG("Array " << i << " matches " << m_element);
-            return true;
-        }
-        else
+        if (StringToUint32(lowerBound, &min) && StringToUint32(upperBound, &max))
         {
-            NS_LOG_DEBUG("Array " << i << " does not " << m_element);
-            return false;
+            m_ranges.emplace_back(min, max);
         }
+        return;
     }
     uint32_t value;
-    if (StringToUint32(m_element, &value) && i == value)
+    if (StringToUint32(alternative, &value))
     {
-        NS_LOG_DEBUG("Array " << i << " matches " << m_element);
-        return true;
+        m_ranges.emplace_back(value, value);
+    }
+}
+
+bool
+ArrayMatcher::Matches(std::size_t i) const
+{
+    NS_LOG_FUNCTION(this << i);
+    for (const auto& range : m_ranges)
+    {
+        if (i >= range.first && i <= range.second)
+        {
+            NS_LOG_DEBUG("Array " << i << " matches " << m_element);
+            return true;
+        }
     }
     NS_LOG_DEBUG("Array " << i << " does not match " << m_element);
     return false;
@@ -310,6 +319,11 @@ ArrayMatcher::StringToUint32(std::string str, uint32_t* value) const
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
+ *
+ * The Config path is split into its elements once, and the attributes
+ * matching an element are looked up once per TypeId, so that the cost of
+ * resolving a path with wildcards over many objects is dominated by
+ * visiting the objects.
  */
 class Resolver
 {
@@ -333,23 +347,30 @@ class Resolver
     void Resolve(Ptr<Object> root);
 
   private:
+    /** An attribute of Object type matching a Config path element. */
+    struct AttributeMatch
+    {
+        std::string name; //!< The attribute name.
+        bool isContainer; //!< Whether the attribute is a container of Objects, or a pointer.
+    };
+
     /** Ensure the Config path starts and ends with a '/'. */
     void Canonicalize();
     /**
      * Parse the next element in the Config path.
      *
-     * \param [in] path The remaining portion of the Config path.
+     * \param [in] index The index of the next element of the Config path.
      * \param [in] root The object corresponding to the current position
      *                  in the Config path.
      */
-    void DoResolve(std::string path, Ptr<Object> root);
+    void DoResolve(std::size_t index, Ptr<Object> root);
     /**
      * Parse an index on the Config path.
      *
-     * \param [in] path The remaining Config path.
+     * \param [in] index The index of the next element of the Config path.
      * \param [in,out] vector The resulting list of matching objects.
      */
-    void DoArrayResolve(std::string path, const ObjectPtrContainerValue& vector);
+    void DoArrayResolve(std::size_t index, const ObjectPtrContainerValue& vector);
     /**
      * Handle one object found on the path.
      *
@@ -369,11 +390,28 @@ class Resolver
      * \param [in] path The matching Config path context.
      */
     virtual void DoOne(Ptr<Object> object, std::string path) = 0;
+    /**
+     * Get the attributes of Object type of a TypeId, or of its parents,
+     * matching a Config path element.
+     *
+     * The matches are computed the first time a TypeId and an element
+     * are seen, and cached.
+     *
+     * \param [in] tid The TypeId.
+     * \param [in] item The Config path element.
+     * \returns The matching attributes.
+     */
+    static const std::vector<AttributeMatch>& GetAttributeMatches(TypeId tid,
+                                                                  const std::string& item);
 
     /** Current list of path tokens. */
     std::vector<std::string> m_workStack;
     /** The Config path. */
     std::string m_path;
+    /** The elements of the Config path. */
+    std::vector<std::string> m_elements;
+    /** The array matchers of the elements of the Config path. */
+    std::vector<ArrayMatcher> m_matchers;
 
 }; // class Resolver
 
@@ -382,6 +420,15 @@ Resolver::Resolver(std::string path)
 {
     NS_LOG_FUNCTION(this << path);
     Canonicalize();
+
+    std::string::size_type start = 1;
+    std::string::size_type next;
+    while ((next = m_path.find('/', start)) != std::string::npos)
+    {
+        m_elements.push_back(m_path.substr(start, next - start));
+        m_matchers.emplace_back(m_elements.back());
+        start = next + 1;
+    }
 }
 
 Resolver::~Resolver()
@@ -414,7 +461,7 @@ Resolver::Resolve(Ptr<Object> root)
 {
     NS_LOG_FUNCTION(this << root);
 
-    DoResolve(m_path, root);
+    DoResolve(0, root);
 }
 
 std::string
@@ -440,14 +487,56 @@ Resolver::DoResolveOne(Ptr<Object> object)
     DoOne(object, GetResolvedPath());
 }
 
+const std::vector<Resolver::AttributeMatch>&
+Resolver::GetAttributeMatches(TypeId tid, const std::string& item)
+{
+    NS_LOG_FUNCTION(tid << item);
+
+    static std::map<std::pair<uint16_t, std::string>, std::vector<AttributeMatch>> cache;
+
+    auto [it, inserted] = cache.try_emplace({tid.GetUid(), item});
+    if (!inserted)
+    {
+        return it->second;
+    }
+
+    TypeId nextTid = tid;
+    do
+    {
+        tid = nextTid;
+
+        for (std::size_t i = 0; i < tid.GetAttributeN(); i++)
+        {
+            struct TypeId::AttributeInformation info = tid.GetAttribute(i);
+            if (info.name != item && item != "*")
+            {
+                continue;
+            }
+            if (dynamic_cast<const PointerChecker*>(PeekPointer(info.checker)) != nullptr)
+            {
+                it->second.push_back({info.name, false});
+            }
+            else if (dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker)) !=
+                     nullptr)
+            {
+                it->second.push_back({info.name, true});
+            }
+            // this could be anything else and we don't know what to do with it.
+            // So, we just ignore it.
+        }
+
+        nextTid = tid.GetParent();
+    } while (nextTid != tid);
+
+    return it->second;
+}
+
 void
-Resolver::DoResolve(std::string path, Ptr<Object> root)
+Resolver::DoResolve(std::size_t index, Ptr<Object> root)
 {
-    NS_LOG_FUNCTION(this << path << root);
-    NS_ASSERT((path.find('/')) == 0);
-    std::string::size_type next = path.find('/', 1);
+    NS_LOG_FUNCTION(this << index << root);
 
-    if (next == std::string::npos)
+    if (index == m_elements.size())
     {
         //
         // If root is zero, we're beginning to see if we can use the object name
@@ -463,8 +552,7 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
         }
         return;
     }
-    std::string item = path.substr(1, next - 1);
-    std::string pathLeft = path.substr(next, path.size() - next);
+    const std::string& item = m_elements[index];
 
     //
     // If root is zero, we're beginning to see if we can use the object name
@@ -475,11 +563,10 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     //
     if (!root)
     {
-        std::string::size_type offset = path.find("/Names");
-        if (offset == 0)
+        if (item.compare(0, 5, "Names") == 0)
         {
             m_workStack.push_back(item);
-            DoResolve(pathLeft, root);
+            DoResolve(index + 1, root);
             m_workStack.pop_back();
             return;
         }
@@ -496,7 +583,7 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
     {
         NS_LOG_DEBUG("Name system resolved item = " << item << " to " << namedObject);
         m_workStack.push_back(item);
-        DoResolve(pathLeft, namedObject);
+        DoResolve(index + 1, namedObject);
         m_workStack.pop_back();
         return;
     }
@@ -526,71 +613,48 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
             return;
         }
         m_workStack.push_back(item);
-        DoResolve(pathLeft, object);
+        DoResolve(index + 1, object);
         m_workStack.pop_back();
     }
     else
     {
         // this is a normal attribute.
-        TypeId tid;
-        TypeId nextTid = root->GetInstanceTypeId();
         bool foundMatch = false;
 
-        do
+        for (const auto& match : GetAttributeMatches(root->GetInstanceTypeId(), item))
         {
-            tid = nextTid;
-
-            for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+            if (!match.isContainer)
             {
-                struct TypeId::AttributeInformation info;
-                info = tid.GetAttribute(i);
-                if (info.name != item && item != "*")
+                NS_LOG_DEBUG("GetAttribute(ptr)=" << match.name
+                                                  << " on path=" << GetResolvedPath());
+                PointerValue pValue;
+                root->GetAttribute(match.name, pValue);
+                Ptr<Object> object = pValue.Get<Object>();
+                if (!object)
                 {
+                    NS_LOG_ERROR("Requested object name=\"" << item << "\" exists on path=\""
+                                                            << GetResolvedPath()
+                                                            << "\""
+                                                               " but is null.");
                     continue;
                 }
-                // attempt to cast to a pointer checker.
-                const PointerChecker* pChecker =
-                    dynamic_cast<const PointerChecker*>(PeekPointer(info.checker));
-                if (pChecker != nullptr)
-                {
-                    NS_LOG_DEBUG("GetAttribute(ptr)=" << info.name
-                                                      << " on path=" << GetResolvedPath());
-                    PointerValue pValue;
-                    root->GetAttribute(info.name, pValue);
-                    Ptr<Object> object = pValue.Get<Object>();
-                    if (!object)
-                    {
-                        NS_LOG_ERROR("Requested object name=\"" << item << "\" exists on path=\""
-                                                                << GetResolvedPath()
-                                                                << "\""
-                                                                   " but is null.");
-                        continue;
-                    }
-                    foundMatch = true;
-                    m_workStack.push_back(info.name);
-                    DoResolve(pathLeft, object);
-                    m_workStack.pop_back();
-                }
-                // attempt to cast to an object vector.
-                const ObjectPtrContainerChecker* vectorChecker =
-                    dynamic_cast<const ObjectPtrContainerChecker*>(PeekPointer(info.checker));
-                if (vectorChecker != nullptr)
-                {
-                    NS_LOG_DEBUG("GetAttribute(vector)=" << info.name << " on path="
-                                                         << GetResolvedPath() << pathLeft);
-                    foundMatch = true;
-                    ObjectPtrContainerValue vector;
-                    root->GetAttribute(info.name, vector);
-                    m_workStack.push_back(info.name);
-                    DoArrayResolve(pathLeft, vector);
-                    m_workStack.pop_back();
-                }
-                // this could be anything else and we don't know what to do with it.
-                // So, we just ignore it.
+                foundMatch = true;
+                m_workStack.push_back(match.name);
+                DoResolve(index + 1, object);
+                m_workStack.pop_back();
             }
-
-            nextTid = tid.GetParent();
-        } while (nextTid != tid);
+            else
+            {
+                NS_LOG_DEBUG("GetAttribute(vector)=" << match.name
+                                                     << " on path=" << GetResolvedPath());
+                foundMatch = true;
+                ObjectPtrContainerValue vector;
+                root->GetAttribute(match.name, vector);
+                m_workStack.push_back(match.name);
+                DoArrayResolve(index + 1, vector);
+                m_workStack.pop_back();
+            }
+        }
 
         if (!foundMatch)
         {
@@ -602,29 +666,22 @@ Resolver::DoResolve(std::string path, Ptr<Object> root)
 }
 
 void
-Resolver::DoArrayResolve(std::string path, const ObjectPtrContainerValue& container)
+Resolver::DoArrayResolve(std::size_t index, const ObjectPtrContainerValue& container)
 {
-    NS_LOG_FUNCTION(this << path << &container);
-    NS_ASSERT(!path.empty());
-    NS_ASSERT((path.find('/')) == 0);
-    std::string::size_type next = path.find('/', 1);
-    if (next == std::string::npos)
+    NS_LOG_FUNCTION(this << index << &container);
+    if (index == m_elements.size())
     {
         return;
     }
-    std::string item = path.substr(1, next - 1);
-    std::string pathLeft = path.substr(next, path.size() - next);
 
-    ArrayMatcher matcher = ArrayMatcher(item);
+    const ArrayMatcher& matcher = m_matchers[index];
     ObjectPtrContainerValue::Iterator it;
     for (it = container.Begin(); it != container.End(); ++it)
     {
         if (matcher.Matches((*it).first))
         {
-            std::ostringstream oss;
-            oss << (*it).first;
-            m_workStack.push_back(oss.str());
-            DoResolve(pathLeft, (*it).second);
+            m_workStack.push_back(std::to_string((*it).first));
+            DoResolve(index + 1, (*it).second);
             m_workStack.pop_back();
         }
     }
@@ -273,6 +273,20 @@ class MatchContainer
      * \sa ns3::Config::Set
      */
     void Set(std::string name, const AttributeValue& value);
+    /**
+     * \tparam Args \deduced Template type parameter pack for the sequence of name-value pairs
+     * \param [in] name Name of the first attribute to set
+     * \param [in] value Value to set to the first attribute
+     * \param [in] args A sequence of name-value pairs of additional attributes to set.
+     *
+     * Set several attribute values to all the objects stored in this
+     * container.  The args sequence can be made of any number of pairs,
+     * each consisting of a name (of std::string type) followed by a value
+     * (of const AttributeValue & type).
+     * \sa ns3::Config::SetAttributes
+     */
+    template <typename... Args>
+    void Set(const std::string& name, const AttributeValue& value, Args&&... args);
     /**
      * \param [in] name Name of attribute to set
      * \param [in] value Value to set to the attribute
@@ -361,6 +375,35 @@ class MatchContainer
  */
 MatchContainer LookupMatches(std::string path);
 
+/**
+ * \ingroup config
+ * \tparam Args \deduced Template type parameter pack for the sequence of name-value pairs
+ * \param [in] path A path to match objects.
+ * \param [in] name The name of the first attribute to set.
+ * \param [in] value The value of the first attribute.
+ * \param [in] args A sequence of name-value pairs of additional attributes to set.
+ *
+ * This function resolves the path once and sets all the attributes of
+ * each matching object, instead of resolving the path again for each
+ * attribute as Config::Set does.  On large topologies, where resolving
+ * a path with wildcards visits many objects, this is much faster, e.g.
+ *
+ * \code
+ *   Config::SetAttributes("/NodeList/[0-999]/DeviceList/0/$ns3::PointToPointNetDevice",
+ *                         "Mtu", UintegerValue(9000),
+ *                         "DataRate", DataRateValue(DataRate("10Gbps")));
+ * \endcode
+ *
+ * The errors are those of
+ * MatchContainer::Set; to connect several trace sources, use the
+ * MatchContainer returned by LookupMatches.
+ */
+template <typename... Args>
+void SetAttributes(std::string path,
+                   const std::string& name,
+                   const AttributeValue& value,
+                   Args&&... args);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -390,6 +433,29 @@ std::size_t GetRootNamespaceObjectN();
  */
 Ptr<Object> GetRootNamespaceObject(uint32_t i);
 
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+template <typename... Args>
+void
+MatchContainer::Set(const std::string& name, const AttributeValue& value, Args&&... args)
+{
+    Set(name, value);
+    Set(args...);
+}
+
+template <typename... Args>
+void
+SetAttributes(std::string path,
+              const std::string& name,
+              const AttributeValue& value,
+              Args&&... args)
+{
+    MatchContainer container = LookupMatches(path);
+    container.Set(name, value, args...);
+}
+
 } // namespace Config
 
 } // namespace ns3
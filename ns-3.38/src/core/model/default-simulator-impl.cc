@@ -20,11 +20,19 @@
 #include "default-simulator-impl.h"
 
 #include "assert.h"
+#include "boolean.h"
+#include "double.h"
+#include "enum.h"
+#include "fatal-error.h"
 #include "log.h"
-#include "scheduler.h"
 #include "simulator.h"
+#include "string.h"
+#include "uinteger.h"
 
 #include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
 
 /**
  * \file
@@ -48,7 +56,41 @@ DefaultSimulatorImpl::GetTypeId()
     static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+                            .AddConstructor<DefaultSimulatorImpl>()
+                            .AddAttribute("CancelledPurgeThreshold",
+                                          "Fraction of cancelled events in the scheduler "
+                                          "above which they are purged, 0 to disable purging",
+                                          DoubleValue(0.5),
+                                          MakeDoubleAccessor(
+                                              &DefaultSimulatorImpl::m_purgeThreshold),
+                                          MakeDoubleChecker<double>(0.0, 1.0))
+                            .AddAttribute("CancelledPurgeMinEvents",
+                                          "Minimum number of cancelled events in the scheduler "
+                                          "before they are purged",
+                                          UintegerValue(1024),
+                                          MakeUintegerAccessor(
+                                              &DefaultSimulatorImpl::m_purgeMinEvents),
+                                          MakeUintegerChecker<uint32_t>(1))
+                            .AddAttribute("EventProfiling",
+                                          "Record the wall-clock time spent running and "
+                                          "scheduling each kind of event, printed by Destroy()",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&DefaultSimulatorImpl::m_profiling),
+                                          MakeBooleanChecker())
+                            .AddAttribute("EventProfileFile",
+                                          "File to print the event profile to, "
+                                          "empty for the standard error",
+                                          StringValue(""),
+                                          MakeStringAccessor(&DefaultSimulatorImpl::m_profileFile),
+                                          MakeStringChecker())
+                            .AddAttribute("EventProfileFormat",
+                                          "Event profile output format",
+                                          EnumValue(EventProfiler::REPORT),
+                                          MakeEnumAccessor(&DefaultSimulatorImpl::m_profileFormat),
+                                          MakeEnumChecker(EventProfiler::REPORT,
+                                                          "Report",
+                                                          EventProfiler::FOLDED,
+                                                          "Folded"));
     return tid;
 }
 
@@ -61,6 +103,12 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentTs = 0;
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
+    m_purgeThreshold = 0.5;
+    m_purgeMinEvents = 1024;
+    m_purgeCount = 0;
+    m_purgedEvents = 0;
+    m_profiling = false;
+    m_profileFormat = EventProfiler::REPORT;
     m_eventCount = 0;
     m_eventsWithContextEmpty = true;
     m_mainThreadId = std::this_thread::get_id();
@@ -100,6 +148,50 @@ DefaultSimulatorImpl::Destroy()
             ev->Invoke();
         }
     }
+    PrintEventProfile();
+}
+
+void
+DefaultSimulatorImpl::PrintEventProfile()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_profiling)
+    {
+        return;
+    }
+    if (m_profileFile.empty())
+    {
+        m_profiler.Print(std::clog, m_profileFormat);
+    }
+    else
+    {
+        std::ofstream os(m_profileFile);
+        if (!os.is_open())
+        {
+            NS_FATAL_ERROR("Can't open event profile file " << m_profileFile);
+        }
+        m_profiler.Print(os, m_profileFormat);
+    }
+    m_profiler.Clear();
+}
+
+const EventProfiler&
+DefaultSimulatorImpl::GetEventProfiler() const
+{
+    return m_profiler;
+}
+
+void
+DefaultSimulatorImpl::InsertEvent(const Scheduler::Event& ev)
+{
+    if (!m_profiling)
+    {
+        m_events->Insert(ev);
+        return;
+    }
+    int64_t start = EventProfiler::GetWallClock();
+    m_events->Insert(ev);
+    m_profiler.RecordInsert(ev.impl, ev.key.m_context, EventProfiler::GetWallClock() - start);
 }
 
 void
@@ -129,19 +221,40 @@ DefaultSimulatorImpl::GetSystemId() const
 void
 DefaultSimulatorImpl::ProcessOneEvent()
 {
+    int64_t start = m_profiling ? EventProfiler::GetWallClock() : 0;
     Scheduler::Event next = m_events->RemoveNext();
+    if (m_profiling)
+    {
+        int64_t now = EventProfiler::GetWallClock();
+        m_profiler.RecordRemove(next.impl, next.key.m_context, now - start);
+    }
 
     PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
 
     NS_ASSERT(next.key.m_ts >= m_currentTs);
     m_unscheduledEvents--;
+    if (!m_cancelledEvents.empty() && next.impl->IsCancelled())
+    {
+        m_cancelledEvents.erase(next.key.m_uid);
+    }
     m_eventCount++;
 
     NS_LOG_LOGIC("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
-    next.impl->Invoke();
+    if (m_profiling)
+    {
+        start = EventProfiler::GetWallClock();
+        next.impl->Invoke();
+        m_profiler.RecordInvoke(next.impl,
+                                next.key.m_context,
+                                EventProfiler::GetWallClock() - start);
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
     next.impl->Unref();
 
     ProcessEventsWithContext();
@@ -179,7 +292,7 @@ DefaultSimulatorImpl::ProcessEventsWithContext()
         ev.key.m_uid = m_uid;
         m_uid++;
         m_unscheduledEvents++;
-        m_events->Insert(ev);
+        InsertEvent(ev);
     }
 }
 
@@ -236,7 +349,7 @@ DefaultSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
     ev.key.m_uid = m_uid;
     m_uid++;
     m_unscheduledEvents++;
-    m_events->Insert(ev);
+    InsertEvent(ev);
     return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -255,7 +368,7 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
         ev.key.m_uid = m_uid;
         m_uid++;
         m_unscheduledEvents++;
-        m_events->Insert(ev);
+        InsertEvent(ev);
     }
     else
     {
@@ -338,7 +451,18 @@ DefaultSimulatorImpl::Remove(const EventId& id)
     event.key.m_ts = id.GetTs();
     event.key.m_context = id.GetContext();
     event.key.m_uid = id.GetUid();
-    m_events->Remove(event);
+    if (m_profiling)
+    {
+        int64_t start = EventProfiler::GetWallClock();
+        m_events->Remove(event);
+        m_profiler.RecordRemove(event.impl,
+                                event.key.m_context,
+                                EventProfiler::GetWallClock() - start);
+    }
+    else
+    {
+        m_events->Remove(event);
+    }
     event.impl->Cancel();
     // whenever we remove an event from the event list, we have to unref it.
     event.impl->Unref();
@@ -352,7 +476,70 @@ DefaultSimulatorImpl::Cancel(const EventId& id)
     if (!IsExpired(id))
     {
         id.PeekEventImpl()->Cancel();
+        if (id.GetUid() != EventId::UID::DESTROY)
+        {
+            m_cancelledEvents.insert(id.GetUid());
+            uint64_t cancelled = m_cancelledEvents.size();
+            if (m_purgeThreshold > 0 && cancelled >= m_purgeMinEvents &&
+                cancelled >= m_purgeThreshold * m_unscheduledEvents)
+            {
+                PurgeCancelledEvents();
+            }
+        }
+    }
+}
+
+void
+DefaultSimulatorImpl::PurgeCancelledEvents()
+{
+    NS_LOG_FUNCTION(this << m_cancelledEvents.size() << m_unscheduledEvents);
+
+    std::vector<Scheduler::Event> live;
+    live.reserve(m_unscheduledEvents - m_cancelledEvents.size());
+    uint64_t purged = 0;
+    while (!m_events->IsEmpty())
+    {
+        Scheduler::Event next = m_events->RemoveNext();
+        if (next.impl->IsCancelled())
+        {
+            // whenever we remove an event from the event list, we have to unref it.
+            next.impl->Unref();
+            purged++;
+        }
+        else
+        {
+            live.push_back(next);
+        }
+    }
+    // Events come out in order, which is the cheapest insertion order
+    // for most schedulers.
+    for (const auto& ev : live)
+    {
+        m_events->Insert(ev);
     }
+
+    m_unscheduledEvents -= purged;
+    m_cancelledEvents.clear();
+    m_purgeCount++;
+    m_purgedEvents += purged;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCancelledEventCount() const
+{
+    return m_cancelledEvents.size();
+}
+
+uint64_t
+DefaultSimulatorImpl::GetPurgeCount() const
+{
+    return m_purgeCount;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetPurgedEventCount() const
+{
+    return m_purgedEvents;
 }
 
 bool
@@ -20,11 +20,14 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "event-profiler.h"
+#include "scheduler.h"
 #include "simulator-impl.h"
 
 #include <list>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
 /**
  * \file
@@ -35,9 +38,6 @@
 namespace ns3
 {
 
-// Forward
-class Scheduler;
-
 /**
  * \ingroup simulator
  *
@@ -78,9 +78,54 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /**
+     * Get the number of events cancelled through Cancel() still held by
+     * the scheduler.
+     *
+     * Cancelled events stay in the scheduler until they are dequeued
+     * or purged; see the \c CancelledPurgeThreshold attribute.
+     * \returns The number of cancelled events in the scheduler.
+     */
+    uint64_t GetCancelledEventCount() const;
+    /**
+     * Get the number of times cancelled events were purged from the scheduler.
+     * \returns The number of purges.
+     */
+    uint64_t GetPurgeCount() const;
+    /**
+     * Get the total number of cancelled events removed by purges.
+     * \returns The number of purged events.
+     */
+    uint64_t GetPurgedEventCount() const;
+    /**
+     * Get the event profile.
+     *
+     * The profile is only recorded when the \c EventProfiling attribute
+     * is set; it is printed and cleared by Destroy().
+     * \returns The event profiler.
+     */
+    const EventProfiler& GetEventProfiler() const;
+
   private:
     void DoDispose() override;
 
+    /**
+     * Remove all cancelled events from the scheduler.
+     *
+     * The scheduler is drained and the live events are inserted back,
+     * so the cost is linear in the number of scheduled events; purging
+     * only once cancelled events make up a fixed fraction of the
+     * scheduler keeps the amortized cost per Cancel() constant.
+     */
+    void PurgeCancelledEvents();
+
+    /**
+     * Insert an event in the scheduler, profiling the insertion if enabled.
+     * \param [in] ev The event.
+     */
+    void InsertEvent(const Scheduler::Event& ev);
+    /** Print the event profile, if enabled, and clear it. */
+    void PrintEventProfile();
     /** Process the next event. */
     void ProcessOneEvent();
     /** Move events from a different context into the main event queue. */
@@ -133,6 +178,35 @@ class DefaultSimulatorImpl : public SimulatorImpl
      */
     int m_unscheduledEvents;
 
+    /**
+     * Uids of the events cancelled through Cancel() still in the scheduler.
+     *
+     * Events cancelled directly through EventImpl::Cancel() are not
+     * counted, so only the uids recorded here are forgotten when a
+     * cancelled event leaves the scheduler.
+     */
+    std::unordered_set<uint32_t> m_cancelledEvents;
+    /**
+     * Fraction of cancelled events in the scheduler which triggers a purge,
+     * 0 to disable purging.
+     */
+    double m_purgeThreshold;
+    /** Minimum number of cancelled events before purging. */
+    uint32_t m_purgeMinEvents;
+    /** Number of purges performed. */
+    uint64_t m_purgeCount;
+    /** Total number of cancelled events removed by purges. */
+    uint64_t m_purgedEvents;
+
+    /** Whether to profile the events. */
+    bool m_profiling;
+    /** The event profile. */
+    EventProfiler m_profiler;
+    /** File to print the event profile to, empty for std::clog. */
+    std::string m_profileFile;
+    /** Event profile output format. */
+    EventProfiler::Format m_profileFormat;
+
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
 };
@@ -21,6 +21,9 @@
 
 #include "log.h"
 
+#include <atomic>
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +35,146 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+namespace
+{
+
+/** Number of EventImpl pool size classes. */
+constexpr std::size_t POOL_CLASSES = EventImpl::PoolMaxSize / EventImpl::PoolGranularity;
+
+/** A released block, linked into the free list of its size class. */
+struct PoolBlock
+{
+    PoolBlock* next; /**< Next free block of the same size class. */
+};
+
+/**
+ * Free lists of one thread.
+ *
+ * This is trivially destructible so it remains usable while other
+ * thread_local and static objects are torn down; the blocks themselves
+ * are returned to the heap by PoolReleaser.
+ */
+struct PoolState
+{
+    PoolBlock* head[POOL_CLASSES]; /**< Free list per size class. */
+    uint32_t length[POOL_CLASSES]; /**< Free list lengths. */
+    EventImpl::PoolStats stats;    /**< Allocation statistics. */
+    bool closed;                   /**< Whether this thread is exiting. */
+};
+
+/** Free lists of the calling thread. */
+thread_local PoolState g_poolState;
+
+/** Returns the cached blocks of a thread to the heap when it exits. */
+struct PoolReleaser
+{
+    ~PoolReleaser()
+    {
+        for (std::size_t i = 0; i < POOL_CLASSES; ++i)
+        {
+            while (g_poolState.head[i] != nullptr)
+            {
+                PoolBlock* block = g_poolState.head[i];
+                g_poolState.head[i] = block->next;
+                ::operator delete(block);
+            }
+            g_poolState.length[i] = 0;
+        }
+        g_poolState.stats.cached = 0;
+        g_poolState.closed = true;
+    }
+};
+
+/** Registers the PoolReleaser of the calling thread on first use. */
+thread_local PoolReleaser g_poolReleaser;
+
+/**
+ * Whether new events use the pool.  Read by every thread that allocates
+ * events, such as the workers of a multithreaded simulator.
+ */
+std::atomic<bool> g_poolEnabled{true};
+
+} // unnamed namespace
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+    PoolState& pool = g_poolState;
+    pool.stats.allocations++;
+    if (size > PoolMaxSize)
+    {
+        pool.stats.heapAllocations++;
+        return ::operator new(size);
+    }
+    // Always round up to the size class, so the block can join the free
+    // list on release even if the pool was disabled when it was allocated.
+    std::size_t index = (size - 1) / PoolGranularity;
+    PoolBlock* block = g_poolEnabled.load(std::memory_order_relaxed) ? pool.head[index] : nullptr;
+    if (block != nullptr)
+    {
+        pool.head[index] = block->next;
+        pool.length[index]--;
+        pool.stats.cached--;
+        pool.stats.poolHits++;
+        return block;
+    }
+    // Touch the releaser so the blocks of this thread are freed on exit.
+    static_cast<void>(&g_poolReleaser);
+    pool.stats.heapAllocations++;
+    return ::operator new((index + 1) * PoolGranularity);
+}
+
+void
+EventImpl::operator delete(void* ptr, std::size_t size)
+{
+    PoolState& pool = g_poolState;
+    pool.stats.releases++;
+    std::size_t index = (size - 1) / PoolGranularity;
+    if (!g_poolEnabled.load(std::memory_order_relaxed) || pool.closed || size > PoolMaxSize ||
+        pool.length[index] >= PoolMaxCached)
+    {
+        pool.stats.heapReleases++;
+        ::operator delete(ptr);
+        return;
+    }
+    // A thread may get its first blocks by releasing events allocated
+    // elsewhere: touch the releaser here too.
+    static_cast<void>(&g_poolReleaser);
+    auto block = static_cast<PoolBlock*>(ptr);
+    block->next = pool.head[index];
+    pool.head[index] = block;
+    pool.length[index]++;
+    pool.stats.cached++;
+}
+
+void
+EventImpl::SetPoolEnabled(bool enabled)
+{
+    NS_LOG_FUNCTION(enabled);
+    g_poolEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool
+EventImpl::IsPoolEnabled()
+{
+    return g_poolEnabled.load(std::memory_order_relaxed);
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats()
+{
+    return g_poolState.stats;
+}
+
+void
+EventImpl::ResetPoolStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint64_t cached = g_poolState.stats.cached;
+    g_poolState.stats = PoolStats{};
+    g_poolState.stats.cached = cached;
+}
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -21,6 +21,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -67,6 +68,73 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * \name EventImpl allocation pool
+     *
+     * Every Simulator::Schedule() call creates a new EventImpl subclass
+     * through MakeEvent(), which is released again right after Invoke().
+     * To avoid a heap round trip per event, EventImpl memory is recycled
+     * through per-thread free lists, one per size class of
+     * \c PoolGranularity bytes up to \c PoolMaxSize bytes.  Larger
+     * events, or any event while the pool is disabled, use the global heap.
+     *
+     * Since each thread owns its free lists, events created on one thread
+     * and released on another (as with the multithreaded and realtime
+     * simulator implementations) need no locking: the block simply joins
+     * the free list of the releasing thread.
+     * @{
+     */
+    /** Allocation statistics of the EventImpl pool. */
+    struct PoolStats
+    {
+        uint64_t allocations;     /**< Number of EventImpl allocations. */
+        uint64_t poolHits;        /**< Allocations served from a free list. */
+        uint64_t heapAllocations; /**< Allocations served by the global heap. */
+        uint64_t releases;        /**< Number of EventImpl releases. */
+        uint64_t heapReleases;    /**< Releases returned to the global heap. */
+        uint64_t cached;          /**< Blocks currently held in the free lists. */
+    };
+
+    /** Size class granularity in bytes. */
+    static constexpr std::size_t PoolGranularity = 16;
+    /** Largest event size served by the pool, in bytes. */
+    static constexpr std::size_t PoolMaxSize = 256;
+    /** Maximum number of blocks cached per size class and thread. */
+    static constexpr uint32_t PoolMaxCached = 4096;
+
+    /**
+     * Allocate memory for an EventImpl subclass.
+     * \param [in] size The size of the subclass.
+     * \returns The allocated memory.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Release memory of an EventImpl subclass.
+     *
+     * The destructor is virtual, so \p size is that of the dynamic type.
+     * \param [in] ptr The memory to release.
+     * \param [in] size The size of the subclass.
+     */
+    static void operator delete(void* ptr, std::size_t size);
+
+    /**
+     * Enable or disable the pool.  Blocks cached while the pool was
+     * enabled stay valid and are reused when it is enabled again.
+     * \param [in] enabled Whether new events should use the pool.
+     */
+    static void SetPoolEnabled(bool enabled);
+    /**
+     * \returns Whether the pool is enabled.
+     */
+    static bool IsPoolEnabled();
+    /**
+     * \returns The pool statistics of the calling thread.
+     */
+    static PoolStats GetPoolStats();
+    /** Reset the pool statistics of the calling thread. */
+    static void ResetPoolStats();
+    /**@}*/
+
   protected:
     /**
      * Implementation for Invoke().
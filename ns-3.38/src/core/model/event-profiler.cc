@@ -0,0 +1,341 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+
+#include "event-impl.h"
+#include "log.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <typeinfo>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+namespace
+{
+
+/**
+ * \ingroup simulator
+ * Find the end of a bracketed list, or of an item of the list.
+ * \param [in] name The string to scan.
+ * \param [in] pos The position to start from, after the opening bracket.
+ * \param [in] stopAtComma Whether to stop at the end of a list item.
+ * \returns The position of the closing bracket, or of the item separator.
+ */
+std::string::size_type
+FindListEnd(const std::string& name, std::string::size_type pos, bool stopAtComma)
+{
+    int depth = 0;
+    for (; pos < name.size(); ++pos)
+    {
+        char c = name[pos];
+        if (c == '<' || c == '(' || c == '[' || c == '{')
+        {
+            ++depth;
+        }
+        else if (c == '>' || c == ')' || c == ']' || c == '}')
+        {
+            if (depth == 0)
+            {
+                break;
+            }
+            --depth;
+        }
+        else if (c == ',' && depth == 0 && stopAtComma)
+        {
+            break;
+        }
+    }
+    return pos;
+}
+
+/**
+ * \ingroup simulator
+ * Demangle a C++ type name.
+ * \param [in] mangled The mangled name.
+ * \returns The demangled name, or \pname{mangled} if it cannot be demangled.
+ */
+std::string
+Demangle(const char* mangled)
+{
+#if (__GNUC__ >= 3)
+    int status;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0)
+    {
+        std::string ret = demangled;
+        std::free(demangled);
+        return ret;
+    }
+#endif
+    return mangled;
+}
+
+/**
+ * \ingroup simulator
+ * Sort profile lines by decreasing invocation time.
+ * \param [in,out] entries The profile lines.
+ */
+void
+SortByInvokeTime(std::vector<EventProfiler::Entry>& entries)
+{
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const EventProfiler::Entry& a, const EventProfiler::Entry& b) {
+                  if (a.second.invokeTime != b.second.invokeTime)
+                  {
+                      return a.second.invokeTime > b.second.invokeTime;
+                  }
+                  return a.first < b.first;
+              });
+}
+
+/**
+ * \ingroup simulator
+ * Print a section of the profile report.
+ * \param [in,out] os The output stream.
+ * \param [in] entries The profile lines.
+ * \param [in] total The total costs.
+ * \param [in] label The heading of the name column.
+ */
+void
+PrintSection(std::ostream& os,
+             const std::vector<EventProfiler::Entry>& entries,
+             const EventProfiler::Stats& total,
+             const std::string& label)
+{
+    os << std::setw(12) << "invoke(ms)" << std::setw(8) << "%" << std::setw(12) << "count"
+       << std::setw(10) << "mean(us)" << std::setw(12) << "insert(ms)" << std::setw(12)
+       << "remove(ms)"
+       << "  " << label << std::endl;
+    for (const auto& entry : entries)
+    {
+        const EventProfiler::Stats& stats = entry.second;
+        double share = (total.invokeTime > 0) ? 100.0 * stats.invokeTime / total.invokeTime : 0;
+        double mean = (stats.count > 0) ? stats.invokeTime / 1e3 / stats.count : 0;
+        os << std::setw(12) << stats.invokeTime / 1e6 << std::setw(8) << share << std::setw(12)
+           << stats.count << std::setw(10) << mean << std::setw(12) << stats.insertTime / 1e6
+           << std::setw(12) << stats.removeTime / 1e6 << "  " << entry.first << std::endl;
+    }
+}
+
+} // unnamed namespace
+
+EventProfiler::Stats&
+EventProfiler::Stats::operator+=(const Stats& o)
+{
+    count += o.count;
+    invokeTime += o.invokeTime;
+    inserts += o.inserts;
+    insertTime += o.insertTime;
+    removes += o.removes;
+    removeTime += o.removeTime;
+    return *this;
+}
+
+std::string
+EventProfiler::GetEventName(const EventImpl* event)
+{
+    std::string name = Demangle(typeid(*event).name());
+
+    // The events built by MakeEvent are local classes, named like
+    // "ns3::MakeEvent<MEM, OBJ>(MEM, OBJ)::EventMemberImpl0": keep the
+    // first function parameter, the function or functor type.
+    std::string::size_type pos = name.find("MakeEvent");
+    if (pos == std::string::npos)
+    {
+        return name;
+    }
+    pos += std::string("MakeEvent").size();
+    if (pos < name.size() && name[pos] == '<')
+    {
+        pos = FindListEnd(name, pos + 1, false) + 1;
+    }
+    if (pos >= name.size() || name[pos] != '(')
+    {
+        return name;
+    }
+    std::string::size_type end = FindListEnd(name, pos + 1, true);
+    return name.substr(pos + 1, end - pos - 1);
+}
+
+std::string
+EventProfiler::GetContextName(uint32_t context)
+{
+    if (context == Simulator::NO_CONTEXT)
+    {
+        return "no context";
+    }
+    std::ostringstream oss;
+    oss << "context " << context;
+    return oss.str();
+}
+
+EventProfiler::Stats&
+EventProfiler::Lookup(const EventImpl* event, uint32_t context)
+{
+    std::type_index type(typeid(*event));
+    auto it = m_types.find(type);
+    if (it == m_types.end())
+    {
+        it = m_types.emplace(type, TypeStats()).first;
+        it->second.name = GetEventName(event);
+        NS_LOG_LOGIC("new event type " << it->second.name);
+    }
+    return it->second.contexts[context];
+}
+
+void
+EventProfiler::RecordInvoke(const EventImpl* event, uint32_t context, int64_t duration)
+{
+    Stats& stats = Lookup(event, context);
+    stats.count++;
+    stats.invokeTime += duration;
+}
+
+void
+EventProfiler::RecordInsert(const EventImpl* event, uint32_t context, int64_t duration)
+{
+    Stats& stats = Lookup(event, context);
+    stats.inserts++;
+    stats.insertTime += duration;
+}
+
+void
+EventProfiler::RecordRemove(const EventImpl* event, uint32_t context, int64_t duration)
+{
+    Stats& stats = Lookup(event, context);
+    stats.removes++;
+    stats.removeTime += duration;
+}
+
+void
+EventProfiler::Clear()
+{
+    m_types.clear();
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetEventStats() const
+{
+    // Distinct types may share a name.
+    std::map<std::string, Stats> byName;
+    for (const auto& type : m_types)
+    {
+        Stats& stats = byName[type.second.name];
+        for (const auto& context : type.second.contexts)
+        {
+            stats += context.second;
+        }
+    }
+    std::vector<Entry> entries(byName.begin(), byName.end());
+    SortByInvokeTime(entries);
+    return entries;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetContextStats() const
+{
+    std::map<uint32_t, Stats> byContext;
+    for (const auto& type : m_types)
+    {
+        for (const auto& context : type.second.contexts)
+        {
+            byContext[context.first] += context.second;
+        }
+    }
+    std::vector<Entry> entries;
+    for (const auto& context : byContext)
+    {
+        entries.emplace_back(GetContextName(context.first), context.second);
+    }
+    SortByInvokeTime(entries);
+    return entries;
+}
+
+EventProfiler::Stats
+EventProfiler::GetTotal() const
+{
+    Stats total;
+    for (const auto& type : m_types)
+    {
+        for (const auto& context : type.second.contexts)
+        {
+            total += context.second;
+        }
+    }
+    return total;
+}
+
+void
+EventProfiler::Print(std::ostream& os, Format format) const
+{
+    if (format == FOLDED)
+    {
+        // One line per stack, as expected by flamegraph.pl and speedscope.
+        std::map<std::string, int64_t> stacks;
+        for (const auto& type : m_types)
+        {
+            for (const auto& context : type.second.contexts)
+            {
+                std::string suffix = type.second.name + ";" + GetContextName(context.first);
+                stacks["Simulator::Run;" + suffix] += context.second.invokeTime;
+                stacks["Simulator::Run;Scheduler::Insert;" + suffix] += context.second.insertTime;
+                stacks["Simulator::Run;Scheduler::Remove;" + suffix] += context.second.removeTime;
+            }
+        }
+        for (const auto& stack : stacks)
+        {
+            if (stack.second > 0)
+            {
+                os << stack.first << " " << stack.second << std::endl;
+            }
+        }
+        return;
+    }
+
+    Stats total = GetTotal();
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+    os << "Event profile: " << total.count << " events, " << total.invokeTime / 1e6
+       << " ms invoking, " << total.insertTime / 1e6 << " ms inserting, "
+       << total.removeTime / 1e6 << " ms removing" << std::endl;
+    PrintSection(os, GetEventStats(), total, "event");
+    os << std::endl;
+    PrintSection(os, GetContextStats(), total, "context");
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // namespace ns3
@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Wall-clock profile of the simulator main loop.
+ *
+ * The profiler accumulates, per event function and per context, the
+ * number of events run, the wall-clock time spent invoking them, and
+ * the wall-clock time spent inserting them in and removing them from
+ * the scheduler.
+ *
+ * Events are told apart by the dynamic type of their EventImpl.  The
+ * events built by MakeEvent() are local classes of a MakeEvent
+ * overload, whose first parameter, the type of the function or
+ * functor, is used as the event name, for example
+ * <tt>void (ns3::PointToPointNetDevice::*)(ns3::Ptr<ns3::Packet>)</tt>
+ * or <tt>ns3::Foo::Start()::{lambda()#1}</tt>.  Member functions
+ * with the same class and signature, and free functions with the same
+ * signature, thus share a name.
+ *
+ * The profile is printed either as a report sorted by decreasing
+ * invocation time, or as folded stacks
+ * (<tt>Simulator::Run;<event>;<context> <nanoseconds></tt>, with
+ * <tt>Scheduler::Insert</tt> and <tt>Scheduler::Remove</tt> frames
+ * for the scheduler costs) for flame graph tools.
+ *
+ * DefaultSimulatorImpl records a profile when its \c EventProfiling
+ * attribute is set.
+ */
+class EventProfiler
+{
+  public:
+    /** Output formats. */
+    enum Format
+    {
+        REPORT, //!< Human readable report, sorted by invocation time.
+        FOLDED  //!< Folded stacks, for flame graph tools.
+    };
+
+    /** Accumulated costs, wall-clock times in nanoseconds. */
+    struct Stats
+    {
+        uint64_t count{0};     //!< Number of events run.
+        int64_t invokeTime{0}; //!< Time spent in EventImpl::Invoke().
+        uint64_t inserts{0};   //!< Number of scheduler insertions.
+        int64_t insertTime{0}; //!< Time spent in Scheduler::Insert().
+        uint64_t removes{0};   //!< Number of scheduler removals.
+        int64_t removeTime{0}; //!< Time spent in Scheduler::Remove*().
+
+        /**
+         * Accumulate other costs.
+         * \param [in] o The costs to add.
+         * \returns This object.
+         */
+        Stats& operator+=(const Stats& o);
+    };
+
+    /** A profile line: name and costs. */
+    typedef std::pair<std::string, Stats> Entry;
+
+    /**
+     * Get the current wall-clock time.
+     * \returns The time in nanoseconds, from an arbitrary origin.
+     */
+    static int64_t GetWallClock()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /**
+     * Get the name under which an event is profiled.
+     * \param [in] event The event.
+     * \returns The event name.
+     */
+    static std::string GetEventName(const EventImpl* event);
+
+    /**
+     * Record an event invocation.
+     * \param [in] event The event.
+     * \param [in] context The event context.
+     * \param [in] duration The wall-clock time of the invocation.
+     */
+    void RecordInvoke(const EventImpl* event, uint32_t context, int64_t duration);
+    /**
+     * Record an event insertion in the scheduler.
+     * \param [in] event The event.
+     * \param [in] context The event context.
+     * \param [in] duration The wall-clock time of the insertion.
+     */
+    void RecordInsert(const EventImpl* event, uint32_t context, int64_t duration);
+    /**
+     * Record an event removal from the scheduler.
+     * \param [in] event The event.
+     * \param [in] context The event context.
+     * \param [in] duration The wall-clock time of the removal.
+     */
+    void RecordRemove(const EventImpl* event, uint32_t context, int64_t duration);
+
+    /** Discard the profile. */
+    void Clear();
+
+    /**
+     * Get the costs of every event function, over all contexts.
+     * \returns The costs, by decreasing invocation time.
+     */
+    std::vector<Entry> GetEventStats() const;
+    /**
+     * Get the costs of every context, over all event functions.
+     * \returns The costs, by decreasing invocation time, named by context.
+     */
+    std::vector<Entry> GetContextStats() const;
+    /**
+     * Get the total costs.
+     * \returns The costs of all events.
+     */
+    Stats GetTotal() const;
+
+    /**
+     * Print the profile.
+     * \param [in,out] os The output stream.
+     * \param [in] format The output format.
+     */
+    void Print(std::ostream& os, Format format = REPORT) const;
+
+  private:
+    /** The costs of one event type. */
+    struct TypeStats
+    {
+        std::string name;                             //!< Event name.
+        std::unordered_map<uint32_t, Stats> contexts; //!< Costs per context.
+    };
+
+    /**
+     * Get the costs of an event type in a context.
+     * \param [in] event The event.
+     * \param [in] context The context.
+     * \returns The costs, created if needed.
+     */
+    Stats& Lookup(const EventImpl* event, uint32_t context);
+    /**
+     * Get the name of a context.
+     * \param [in] context The context.
+     * \returns The context name.
+     */
+    static std::string GetContextName(uint32_t context);
+
+    /** Costs per event type. */
+    std::unordered_map<std::type_index, TypeStats> m_types;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,302 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::LadderScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<LadderScheduler>();
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topStart(0),
+      m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_rungs(MAX_RUNGS),
+      m_nRungs(0),
+      m_bottomHead(0),
+      m_size(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart(const Rung& rung)
+{
+    return rung.start + rung.current * rung.width;
+}
+
+std::size_t
+LadderScheduler::FindRung(uint64_t ts) const
+{
+    // Rungs are ordered from the coarsest to the finest; each rung
+    // covers the bucket of the rung above it that is being dequeued.
+    for (std::size_t i = 0; i < m_nRungs; ++i)
+    {
+        if (ts >= CurrentStart(m_rungs[i]))
+        {
+            return i;
+        }
+    }
+    return m_nRungs;
+}
+
+void
+LadderScheduler::SpawnRung(Events& events, uint64_t start, uint64_t end)
+{
+    NS_LOG_FUNCTION(this << events.size() << start << end);
+    NS_ASSERT(m_nRungs < MAX_RUNGS);
+    NS_ASSERT(end > start);
+
+    Rung& rung = m_rungs[m_nRungs++];
+    uint64_t span = end - start;
+    uint64_t n = events.size();
+    rung.start = start;
+    rung.width = std::max<uint64_t>((span + n - 1) / n, 1);
+    rung.nBuckets = (span + rung.width - 1) / rung.width;
+    rung.current = 0;
+    if (rung.buckets.size() < rung.nBuckets)
+    {
+        rung.buckets.resize(rung.nBuckets);
+    }
+    for (const auto& ev : events)
+    {
+        NS_ASSERT(ev.key.m_ts >= start && ev.key.m_ts < end);
+        rung.buckets[(ev.key.m_ts - start) / rung.width].push_back(ev);
+    }
+    events.clear();
+}
+
+void
+LadderScheduler::TransferTop()
+{
+    NS_LOG_FUNCTION(this << m_top.size());
+    NS_ASSERT(m_nRungs == 0);
+
+    SpawnRung(m_top, m_topMin, m_topMax + 1);
+    const Rung& rung = m_rungs[0];
+    m_topStart = rung.start + rung.nBuckets * rung.width;
+    m_topMin = std::numeric_limits<uint64_t>::max();
+    m_topMax = 0;
+}
+
+std::size_t
+LadderScheduler::BottomSize() const
+{
+    return m_bottom.size() - m_bottomHead;
+}
+
+void
+LadderScheduler::FillBottom()
+{
+    while (BottomSize() == 0)
+    {
+        m_bottom.clear();
+        m_bottomHead = 0;
+        if (m_nRungs == 0)
+        {
+            if (m_top.empty())
+            {
+                return;
+            }
+            TransferTop();
+        }
+
+        Rung& rung = m_rungs[m_nRungs - 1];
+        while (rung.current < rung.nBuckets && rung.buckets[rung.current].empty())
+        {
+            ++rung.current;
+        }
+        if (rung.current == rung.nBuckets)
+        {
+            --m_nRungs;
+            continue;
+        }
+
+        Events& bucket = rung.buckets[rung.current];
+        uint64_t start = CurrentStart(rung);
+        ++rung.current;
+        if (bucket.size() > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+            SpawnRung(bucket, start, start + rung.width);
+            continue;
+        }
+
+        // Swap so the bucket keeps the old bottom storage for reuse.
+        m_bottom.swap(bucket);
+        std::sort(m_bottom.begin(), m_bottom.end());
+    }
+}
+
+void
+LadderScheduler::InsertBottom(const Scheduler::Event& ev)
+{
+    if (BottomSize() == 0 || m_bottom.back() < ev)
+    {
+        m_bottom.push_back(ev);
+    }
+    else if (m_bottomHead > 0 && ev < m_bottom[m_bottomHead])
+    {
+        m_bottom[--m_bottomHead] = ev;
+    }
+    else
+    {
+        auto it = std::lower_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev);
+        m_bottom.insert(it, ev);
+    }
+}
+
+void
+LadderScheduler::Insert(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t ts = ev.key.m_ts;
+    ++m_size;
+
+    if (ts >= m_topStart)
+    {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+    }
+    else
+    {
+        std::size_t i = FindRung(ts);
+        if (i < m_nRungs)
+        {
+            Rung& rung = m_rungs[i];
+            rung.buckets[(ts - rung.start) / rung.width].push_back(ev);
+        }
+        else
+        {
+            InsertBottom(ev);
+            if (BottomSize() > THRESHOLD && m_nRungs < MAX_RUNGS &&
+                m_bottom.back().key.m_ts > m_bottom[m_bottomHead].key.m_ts)
+            {
+                uint64_t end = (m_nRungs > 0) ? CurrentStart(m_rungs[m_nRungs - 1]) : m_topStart;
+                m_bottom.erase(m_bottom.begin(), m_bottom.begin() + m_bottomHead);
+                m_bottomHead = 0;
+                SpawnRung(m_bottom, m_bottom.front().key.m_ts, end);
+            }
+        }
+    }
+
+    FillBottom();
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(BottomSize() > 0);
+    return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(BottomSize() > 0);
+    Scheduler::Event ev = m_bottom[m_bottomHead++];
+    --m_size;
+    FillBottom();
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    uint64_t ts = ev.key.m_ts;
+
+    // The owning tier is found with the same rule Insert() uses.
+    Events* events;
+    if (ts >= m_topStart)
+    {
+        events = &m_top;
+    }
+    else
+    {
+        std::size_t i = FindRung(ts);
+        if (i < m_nRungs)
+        {
+            Rung& rung = m_rungs[i];
+            events = &rung.buckets[(ts - rung.start) / rung.width];
+        }
+        else
+        {
+            auto head = m_bottom.begin() + m_bottomHead;
+            auto it = std::lower_bound(head, m_bottom.end(), ev);
+            NS_ASSERT(it != m_bottom.end() && *it == ev);
+            if (it == head)
+            {
+                ++m_bottomHead;
+            }
+            else
+            {
+                m_bottom.erase(it);
+            }
+            --m_size;
+            FillBottom();
+            return;
+        }
+    }
+
+    // Top and buckets are unsorted, so swap with the last event.
+    auto it = std::find(events->begin(), events->end(), ev);
+    NS_ASSERT(it != events->end());
+    *it = events->back();
+    events->pop_back();
+    --m_size;
+}
+
+} // namespace ns3
@@ -0,0 +1,171 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler is an implementation of the Ladder Queue
+ * described in:
+ * W. T. Tang, R. S. M. Goh and I. L.-J. Thng, "Ladder Queue: An O(1)
+ * Priority Queue Structure for Large-Scale Discrete Event Simulation",
+ * ACM TOMACS, vol. 15, no. 3, 2005.
+ *
+ * Events are kept in three tiers:
+ *  - the \em top, an unsorted `std::vector` of events far in the future;
+ *  - the \em ladder, up to MAX_RUNGS rungs of buckets, each rung
+ *    subdividing one bucket of the rung above it;
+ *  - the \em bottom, a small sorted `std::vector` holding the events of the
+ *    current bucket, from which events are dequeued.
+ *
+ * The bottom is kept in increasing order and dequeued by advancing a head
+ * index, so an event later than all of the bottom, such as a burst of
+ * events sharing its last timestamp, is appended, and an event earlier
+ * than all of it reuses a dequeued slot, both in constant time.
+ *
+ * When the bottom runs dry the next non-empty bucket of the lowest rung
+ * is sorted into it; a bucket holding more than THRESHOLD events is first
+ * spread over a new, finer rung instead.  When the whole ladder is empty
+ * the top is spread over a new first rung whose bucket width is derived
+ * from the top's timestamp range and population.  Unlike the
+ * CalendarScheduler there is no global resize: the bucket width adapts
+ * locally, so skewed and bimodal timestamp distributions (many near-future
+ * deliveries plus long-horizon timers) stay cheap.
+ *
+ * Buckets are `std::vector`s whose storage is kept across rung
+ * reuses, so in steady state the scheduler does not allocate.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | Constant        | Append to the top or a bucket
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom kept sorted and non-empty
+ * Remove()     | Linear          | Search in the owning bucket or tier
+ * RemoveNext() | Constant        | Each event is spread over at most MAX_RUNGS rungs
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | MAX_RUNGS rungs of `std::vector` | Rung and bucket storage is reused
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** Event container type used by all tiers. */
+    typedef std::vector<Scheduler::Event> Events;
+
+    /** One rung of the ladder. */
+    struct Rung
+    {
+        uint64_t start;              /**< Timestamp of the start of the first bucket. */
+        uint64_t width;              /**< Bucket width. */
+        std::size_t nBuckets;        /**< Number of buckets in use. */
+        std::size_t current;         /**< First bucket not yet dequeued. */
+        std::vector<Events> buckets; /**< Bucket storage, at least nBuckets long. */
+    };
+
+    /** Maximum number of rungs. */
+    static constexpr std::size_t MAX_RUNGS = 8;
+    /** Bucket size above which a bucket is spread over a new rung. */
+    static constexpr std::size_t THRESHOLD = 50;
+
+    /**
+     * Get the timestamp of the first bucket of a rung not yet dequeued.
+     * \param [in] rung The rung.
+     * \returns The start of the current bucket.
+     */
+    static uint64_t CurrentStart(const Rung& rung);
+    /**
+     * Find the rung an event with a given timestamp belongs to.
+     * \param [in] ts The timestamp, which must be below the top start.
+     * \returns The rung index, or m_nRungs if it belongs to the bottom.
+     */
+    std::size_t FindRung(uint64_t ts) const;
+    /**
+     * Spread events over a new lowest rung.
+     * \param [in,out] events The events, cleared on return.
+     * \param [in] start The lowest timestamp covered by the new rung.
+     * \param [in] end The timestamp up to which the new rung must reach.
+     */
+    void SpawnRung(Events& events, uint64_t start, uint64_t end);
+    /** Spread the top over the first rung. */
+    void TransferTop();
+    /** Refill the bottom from the ladder or the top if it is empty. */
+    void FillBottom();
+    /**
+     * Insert an event in the sorted bottom.
+     * \param [in] ev The event.
+     */
+    void InsertBottom(const Scheduler::Event& ev);
+    /**
+     * Get the number of events in the bottom.
+     * \returns The number of events not yet dequeued from the bottom.
+     */
+    std::size_t BottomSize() const;
+
+    Events m_top;              /**< Unsorted events at or after m_topStart. */
+    uint64_t m_topStart;       /**< Lowest timestamp stored in the top. */
+    uint64_t m_topMin;         /**< Lower bound of the timestamps in the top. */
+    uint64_t m_topMax;         /**< Upper bound of the timestamps in the top. */
+    std::vector<Rung> m_rungs; /**< Rung storage, MAX_RUNGS long. */
+    std::size_t m_nRungs;      /**< Number of rungs in use. */
+    Events m_bottom;           /**< Events of the current bucket, in increasing order. */
+    std::size_t m_bottomHead;  /**< Index of the next event of m_bottom. */
+    std::size_t m_size;        /**< Number of events in the scheduler. */
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
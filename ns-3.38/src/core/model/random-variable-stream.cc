@@ -109,6 +109,16 @@ RandomVariableStream::GetInteger()
     return static_cast<uint32_t>(GetValue());
 }
 
+void
+RandomVariableStream::GetValues(double* values, std::size_t n)
+{
+    NS_LOG_FUNCTION(this << values << n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        values[i] = GetValue();
+    }
+}
+
 void
 RandomVariableStream::SetStream(int64_t stream)
 {
@@ -226,6 +236,22 @@ UniformRandomVariable::GetInteger()
     return static_cast<uint32_t>(GetValue(m_min, m_max + 1));
 }
 
+void
+UniformRandomVariable::GetValues(double* values, std::size_t n)
+{
+    NS_LOG_FUNCTION(this << values << n);
+    Peek()->RandU01(values, n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        double v = m_min + values[i] * (m_max - m_min);
+        if (IsAntithetic())
+        {
+            v = m_min + (m_max - v);
+        }
+        values[i] = v;
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
 TypeId
@@ -455,6 +481,40 @@ ExponentialRandomVariable::GetValue()
     return GetValue(m_mean, m_bound);
 }
 
+void
+ExponentialRandomVariable::GetValues(double* values, std::size_t n)
+{
+    NS_LOG_FUNCTION(this << values << n);
+    Peek()->RandU01(values, n);
+
+    // A value above the bound is rejected and a new uniform value drawn, so
+    // the uniform values are read ahead of the values written in place;
+    // once the block is consumed, the next uniform values come from the stream.
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        while (true)
+        {
+            // Get a uniform random variable in [0,1].
+            double v = (next < n) ? values[next++] : Peek()->RandU01();
+            if (IsAntithetic())
+            {
+                v = (1 - v);
+            }
+
+            // Calculate the exponential random variable.
+            double r = -m_mean * std::log(v);
+
+            // Use this value if it's acceptable.
+            if (m_bound == 0 || r <= m_bound)
+            {
+                values[i] = r;
+                break;
+            }
+        }
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
 TypeId
@@ -29,6 +29,7 @@
 #include "object.h"
 #include "type-id.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -152,6 +153,20 @@ class RandomVariableStream : public Object
     // The base implementation returns `(uint32_t)GetValue()`
     virtual uint32_t GetInteger();
 
+    /**
+     * \brief Get the next random values drawn from the distribution.
+     *
+     * The values are the same as those of \pname{n} successive calls
+     * to GetValue(), so that a simulation drawing its values in blocks
+     * is reproducible.  The base implementation calls GetValue();
+     * distributions which can draw the underlying uniform values in a
+     * block, with RngStream::RandU01(double*,std::size_t), override it.
+     *
+     * \param [out] values The array to fill.
+     * \param [in] n The number of values to draw.
+     */
+    virtual void GetValues(double* values, std::size_t n);
+
   protected:
     /**
      * \brief Get the pointer to the underlying RngStream.
@@ -282,6 +297,8 @@ class UniformRandomVariable : public RandomVariableStream
      */
     uint32_t GetInteger() override;
 
+    void GetValues(double* values, std::size_t n) override;
+
   private:
     /** The lower bound on values that can be returned by this RNG stream. */
     double m_min;
@@ -591,6 +608,7 @@ class ExponentialRandomVariable : public RandomVariableStream
     // Inherited
     double GetValue() override;
     using RandomVariableStream::GetInteger;
+    void GetValues(double* values, std::size_t n) override;
 
   private:
     /** The mean value of the unbounded exponential distribution. */
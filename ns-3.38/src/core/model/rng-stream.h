@@ -18,6 +18,7 @@
 
 #ifndef RNGSTREAM_H
 #define RNGSTREAM_H
+#include <cstddef>
 #include <stdint.h>
 #include <string>
 
@@ -70,6 +71,18 @@ class RngStream
      * \returns The next random.
      */
     double RandU01();
+    /**
+     * Generate the next random numbers for this stream.
+     * Uniformly distributed between 0 and 1.
+     *
+     * The numbers are the same as those of \pname{n} successive calls
+     * to RandU01(), but the state is kept in registers across the
+     * whole block instead of being loaded and stored for each number.
+     *
+     * \param [out] values The array to fill.
+     * \param [in] n The number of random numbers to generate.
+     */
+    void RandU01(double* values, std::size_t n);
 
   private:
     /**
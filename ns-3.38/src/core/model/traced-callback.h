@@ -22,7 +22,7 @@
 
 #include "callback.h"
 
-#include <list>
+#include <vector>
 
 /**
  * \file
@@ -47,6 +47,20 @@ namespace ns3
  * calling the \c operator() form with the appropriate
  * number of arguments.
  *
+ * Trace sources are fired on every packet path, usually with no sink
+ * connected, so the chain is kept in contiguous storage and IsEmpty()
+ * is inlined.  Call sites which have to build the trace arguments,
+ * such as a packet copy or a socket address, should test IsEmpty()
+ * first:
+ *
+ * \code
+ *   if (!m_rxTraceWithAddresses.IsEmpty())
+ *   {
+ *       socket->GetSockName(localAddress);
+ *       m_rxTraceWithAddresses(packet, from, localAddress);
+ *   }
+ * \endcode
+ *
  * \tparam Ts \explicit Types of the functor arguments.
  */
 template <typename... Ts>
@@ -92,9 +106,15 @@ class TracedCallback
     void operator()(Ts... args) const;
     /**
      * \brief Checks if the Callbacks list is empty.
+     *
+     * This is the fast path of trace call sites: when no sink is
+     * connected, the trace arguments need not be built.
      * \return true if the Callbacks list is empty.
      */
-    bool IsEmpty() const;
+    bool IsEmpty() const
+    {
+        return m_callbackList.empty();
+    }
 
     /**
      *  TracedCallback signature for POD.
@@ -113,7 +133,7 @@ class TracedCallback
      *
      * \tparam Ts \deduced Types of the functor arguments.
      */
-    typedef std::list<Callback<void, Ts...>> CallbackList;
+    typedef std::vector<Callback<void, Ts...>> CallbackList;
     /** The chain of Callbacks. */
     CallbackList m_callbackList;
 };
@@ -193,21 +213,14 @@ template <typename... Ts>
 void
 TracedCallback<Ts...>::operator()(Ts... args) const
 {
-    for (typename CallbackList::const_iterator i = m_callbackList.begin();
-         i != m_callbackList.end();
-         i++)
+    // Index, rather than iterate: a sink may connect another sink to
+    // this trace source, which may reallocate the storage.
+    for (std::size_t i = 0; i < m_callbackList.size(); ++i)
     {
-        (*i)(args...);
+        m_callbackList[i](args...);
     }
 }
 
-template <typename... Ts>
-bool
-TracedCallback<Ts...>::IsEmpty() const
-{
-    return m_callbackList.empty();
-}
-
 } // namespace ns3
 
 #endif /* TRACED_CALLBACK_H */
@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/binary-trace.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup binary-trace-tests
+ * BinaryTrace test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup binary-trace-tests BinaryTrace tests
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+NS_LOG_COMPONENT_DEFINE("BinaryTraceTestSuite");
+
+/**
+ * \ingroup binary-trace-tests
+ *
+ * \brief Check that traced records are written and decoded.
+ */
+class BinaryTraceTestCase : public TestCase
+{
+  public:
+    BinaryTraceTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Trace an event.
+     * \param [in] value The first argument.
+     */
+    static void Trace(uint32_t value);
+
+    /**
+     * Decode a trace file.
+     * \param [in] filename The file name.
+     * \param [out] text The decoded text.
+     * \returns Whether the file is a valid trace.
+     */
+    static bool Decode(const std::string& filename, std::string& text);
+};
+
+BinaryTraceTestCase::BinaryTraceTestCase()
+    : TestCase("Check that binary trace records are written and decoded")
+{
+}
+
+void
+BinaryTraceTestCase::Trace(uint32_t value)
+{
+    NS_TRACE_EVENT("value={} next={}", value, value + 1);
+}
+
+bool
+BinaryTraceTestCase::Decode(const std::string& filename, std::string& text)
+{
+    std::ifstream is(filename, std::ios::in | std::ios::binary);
+    std::ostringstream os;
+    bool valid = BinaryTrace::Decode(is, os);
+    text = os.str();
+    return valid;
+}
+
+void
+BinaryTraceTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("binary-trace.bin");
+    NS_TEST_ASSERT_MSG_EQ(BinaryTrace::IsEnabled(), false, "Tracing enabled by default");
+    Trace(0);
+
+    BinaryTrace::Enable(filename);
+    NS_TEST_ASSERT_MSG_EQ(BinaryTrace::IsEnabled(), true, "Tracing not enabled");
+    Trace(1);
+    NS_TRACE_EVENT("no arguments");
+    Simulator::ScheduleWithContext(3, Seconds(2), &BinaryTraceTestCase::Trace, 7);
+    Simulator::Run();
+    // Records of another thread go to its own ring; the simulator keeps
+    // the context of its last event.
+    std::thread thread(&BinaryTraceTestCase::Trace, 9);
+    thread.join();
+    BinaryTrace::Disable();
+    NS_TEST_ASSERT_MSG_EQ(BinaryTrace::IsEnabled(), false, "Tracing not disabled");
+    Trace(10);
+
+    std::string text;
+    NS_TEST_ASSERT_MSG_EQ(Decode(filename, text), true, "Invalid trace file");
+    NS_TEST_EXPECT_MSG_EQ(text,
+                          "+0.000000000s - BinaryTraceTestSuite: value=1 next=2\n"
+                          "+0.000000000s - BinaryTraceTestSuite: no arguments\n"
+                          "+2.000000000s 3 BinaryTraceTestSuite: value=7 next=8\n"
+                          "+2.000000000s 3 BinaryTraceTestSuite: value=9 next=10\n",
+                          "Wrong decoded trace");
+
+    // A full ring drops records; each record is either written or dropped.
+    BinaryTrace::Enable(filename, 4);
+    const uint32_t records = 1000;
+    for (uint32_t i = 0; i < records; ++i)
+    {
+        Trace(i);
+    }
+    BinaryTrace::Disable();
+    uint64_t dropped = BinaryTrace::GetDroppedCount();
+    NS_TEST_ASSERT_MSG_EQ(Decode(filename, text), true, "Invalid trace file");
+    std::istringstream lines(text);
+    std::string line;
+    uint64_t written = 0;
+    uint64_t reported = 0;
+    while (std::getline(lines, line))
+    {
+        if (line[0] == '#')
+        {
+            std::istringstream(line.substr(2)) >> reported;
+        }
+        else
+        {
+            ++written;
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(written + reported, records, "Records lost");
+    NS_TEST_EXPECT_MSG_EQ(reported, dropped, "Wrong dropped record count");
+
+    Simulator::Destroy();
+
+    std::ofstream(filename) << "not a trace";
+    NS_TEST_EXPECT_MSG_EQ(Decode(filename, text), false, "Invalid trace file accepted");
+}
+
+/**
+ * \ingroup binary-trace-tests
+ *
+ * \brief The BinaryTrace test suite.
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+  public:
+    BinaryTraceTestSuite();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite()
+    : TestSuite("binary-trace", UNIT)
+{
+    AddTestCase(new BinaryTraceTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
+
+} // namespace tests
+
+} // namespace ns3
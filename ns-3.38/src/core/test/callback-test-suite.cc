@@ -931,6 +931,17 @@ CallbackEqualityTestCase::DoRun()
     //
     Callback<double> target9d = target8b.Bind(4);
     NS_TEST_ASSERT_MSG_EQ(target9d.IsEqual(target9c), false, "Equality test failed");
+
+    //
+    // Make sure that the values of the arguments bound by MakeCallback are
+    // compared, rather than the variables they were bound from.
+    //
+    double a = 1.5;
+    Callback<int, int> target10a = MakeCallback(&CallbackEqualityTestCase::TargetMember, this, a);
+    a = 2.5;
+    Callback<int, int> target10b = MakeCallback(&CallbackEqualityTestCase::TargetMember, this, a);
+    NS_TEST_ASSERT_MSG_EQ(target10a.IsEqual(target2a), true, "Equality test failed");
+    NS_TEST_ASSERT_MSG_EQ(target10a.IsEqual(target10b), false, "Equality test failed");
 }
 
 /**
@@ -30,6 +30,7 @@
 #include "ns3/traced-value.h"
 
 #include <sstream>
+#include <vector>
 
 /**
  * \file
@@ -629,6 +630,76 @@ ObjectVectorConfigTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(iv.Get(), -16, "Object Attribute \"A\" not set as expected");
 }
 
+/**
+ * \ingroup config-tests
+ * Test for the ability to set several attributes resolving the path once.
+ */
+class SetAttributesConfigTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    SetAttributesConfigTestCase();
+
+    /** Destructor. */
+    ~SetAttributesConfigTestCase() override
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+SetAttributesConfigTestCase::SetAttributesConfigTestCase()
+    : TestCase("Check ability to set several attributes of the objects matching a path")
+{
+}
+
+void
+SetAttributesConfigTestCase::DoRun()
+{
+    IntegerValue iv;
+
+    Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject>();
+    Config::RegisterRootNamespaceObject(root);
+
+    Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject>();
+    root->SetNodeA(a);
+
+    std::vector<Ptr<ConfigTestObject>> objects;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        objects.push_back(CreateObject<ConfigTestObject>());
+        a->AddNodeA(objects.back());
+    }
+
+    Config::SetAttributes("/NodeA/NodesA/0|2", "A", IntegerValue(-3), "B", IntegerValue(-4));
+    for (uint32_t i = 0; i < objects.size(); ++i)
+    {
+        int64_t expectedA = (i == 1) ? 10 : -3;
+        int64_t expectedB = (i == 1) ? 9 : -4;
+        objects[i]->GetAttribute("A", iv);
+        NS_TEST_EXPECT_MSG_EQ(iv.Get(), expectedA, "Object Attribute \"A\" of " << i);
+        objects[i]->GetAttribute("B", iv);
+        NS_TEST_EXPECT_MSG_EQ(iv.Get(), expectedB, "Object Attribute \"B\" of " << i);
+    }
+
+    //
+    // The same path resolved as a MatchContainer
+    //
+    Config::MatchContainer matches = Config::LookupMatches("/NodeA/NodesA/*");
+    NS_TEST_ASSERT_MSG_EQ(matches.GetN(), objects.size(), "Wrong number of matches");
+    matches.Set("A", IntegerValue(5), "B", IntegerValue(6));
+    for (uint32_t i = 0; i < objects.size(); ++i)
+    {
+        objects[i]->GetAttribute("A", iv);
+        NS_TEST_EXPECT_MSG_EQ(iv.Get(), 5, "Object Attribute \"A\" of " << i);
+        objects[i]->GetAttribute("B", iv);
+        NS_TEST_EXPECT_MSG_EQ(iv.Get(), 6, "Object Attribute \"B\" of " << i);
+    }
+
+    Config::UnregisterRootNamespaceObject(root);
+}
+
 /**
  * \ingroup config-tests
  * Test for the ability to trace configure with vectors of objects.
@@ -881,6 +952,7 @@ ConfigTestSuite::ConfigTestSuite()
     AddTestCase(new RootNamespaceConfigTestCase);
     AddTestCase(new UnderRootNamespaceConfigTestCase);
     AddTestCase(new ObjectVectorConfigTestCase);
+    AddTestCase(new SetAttributesConfigTestCase);
     AddTestCase(new SearchAttributesOfParentObjectsTestCase);
 }
 
@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-stream.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * Test for the block generation of random values.
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup randomvariable-tests
+ * Test that drawing values in a block gives the same values as drawing
+ * them one by one.
+ */
+class RandomVariableBlockTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    RandomVariableBlockTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check that two random variables with the same stream number give the
+     * same values, one drawing them one by one and the other in blocks.
+     *
+     * \param [in] factory The factory of the random variables.
+     * \param [in] name The name of the random variable.
+     */
+    void Check(const ObjectFactory& factory, const std::string& name);
+};
+
+RandomVariableBlockTestCase::RandomVariableBlockTestCase()
+    : TestCase("Check that random values drawn in blocks match GetValue()")
+{
+}
+
+void
+RandomVariableBlockTestCase::Check(const ObjectFactory& factory, const std::string& name)
+{
+    Ptr<RandomVariableStream> single = factory.Create<RandomVariableStream>();
+    Ptr<RandomVariableStream> block = factory.Create<RandomVariableStream>();
+    single->SetStream(42);
+    block->SetStream(42);
+
+    // blocks of different sizes, including an empty one
+    std::vector<double> values;
+    for (std::size_t n : {1, 0, 7, 1000, 3})
+    {
+        values.resize(n);
+        block->GetValues(values.data(), n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            NS_TEST_ASSERT_MSG_EQ(values[i], single->GetValue(), name << " value " << i);
+        }
+    }
+    // the stream state is the same after the blocks
+    NS_TEST_ASSERT_MSG_EQ(block->GetValue(), single->GetValue(), name << " next value");
+}
+
+void
+RandomVariableBlockTestCase::DoRun()
+{
+    RngStream single(1, 2, 3);
+    RngStream block(1, 2, 3);
+    std::vector<double> values(100);
+    block.RandU01(values.data(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(values[i], single.RandU01(), "RngStream value " << i);
+    }
+
+    for (bool antithetic : {false, true})
+    {
+        ObjectFactory uniform("ns3::UniformRandomVariable",
+                              "Min",
+                              DoubleValue(2),
+                              "Max",
+                              DoubleValue(5),
+                              "Antithetic",
+                              BooleanValue(antithetic));
+        Check(uniform, "Uniform");
+
+        // a bound rejecting about 10% of the values
+        ObjectFactory exponential("ns3::ExponentialRandomVariable",
+                                  "Mean",
+                                  DoubleValue(1),
+                                  "Bound",
+                                  DoubleValue(2.3),
+                                  "Antithetic",
+                                  BooleanValue(antithetic));
+        Check(exponential, "Exponential");
+
+        // the base implementation
+        ObjectFactory normal("ns3::NormalRandomVariable", "Antithetic", BooleanValue(antithetic));
+        Check(normal, "Normal");
+    }
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * Test suite for the block generation of random values.
+ */
+class RandomVariableBlockTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    RandomVariableBlockTestSuite();
+};
+
+RandomVariableBlockTestSuite::RandomVariableBlockTestSuite()
+    : TestSuite("random-variable-stream-block", UNIT)
+{
+    AddTestCase(new RandomVariableBlockTestCase);
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RandomVariableBlockTestSuite instance variable.
+ */
+static RandomVariableBlockTestSuite g_randomVariableBlockTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -16,13 +16,25 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/boolean.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/config.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-impl.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <set>
 
 using namespace ns3;
 
@@ -717,6 +729,414 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that EventImpl memory is recycled through the allocation pool.
+ */
+class EventImplPoolTestCase : public TestCase
+{
+  public:
+    EventImplPoolTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Event which schedules the next one until \p remaining reaches zero.
+     * \param [in] remaining The number of events still to schedule.
+     */
+    void Chain(uint32_t remaining);
+
+    /** Argument too large for the pooled size classes. */
+    struct Large
+    {
+        uint8_t data[EventImpl::PoolMaxSize]; //!< Payload
+    };
+
+    /**
+     * Event with an argument larger than the largest size class.
+     * \param [in] large The argument.
+     */
+    void LargeEvent(Large large);
+
+    uint32_t m_count; //!< Number of events executed.
+};
+
+EventImplPoolTestCase::EventImplPoolTestCase()
+    : TestCase("Check EventImpl allocation pool"),
+      m_count(0)
+{
+}
+
+void
+EventImplPoolTestCase::Chain(uint32_t remaining)
+{
+    m_count++;
+    if (remaining > 0)
+    {
+        Simulator::Schedule(NanoSeconds(1), &EventImplPoolTestCase::Chain, this, remaining - 1);
+    }
+}
+
+void
+EventImplPoolTestCase::LargeEvent(Large /* large */)
+{
+    m_count++;
+}
+
+void
+EventImplPoolTestCase::DoRun()
+{
+    const uint32_t events = 1000;
+    bool enabled = EventImpl::IsPoolEnabled();
+
+    // Each event is released right after it schedules its successor, so
+    // all but the first few allocations must be served by the free list.
+    EventImpl::SetPoolEnabled(true);
+    EventImpl::ResetPoolStats();
+    m_count = 0;
+    Simulator::Schedule(NanoSeconds(1), &EventImplPoolTestCase::Chain, this, events - 1);
+    Simulator::Run();
+    EventImpl::PoolStats stats = EventImpl::GetPoolStats();
+    NS_TEST_EXPECT_MSG_EQ(m_count, events, "Wrong number of events executed");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(stats.allocations, events, "Events not counted");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(stats.poolHits, events - 2, "Event memory not recycled");
+    NS_TEST_EXPECT_MSG_EQ(stats.releases, stats.allocations, "Events leaked");
+    NS_TEST_EXPECT_MSG_GT(stats.cached, 0, "No block returned to the free lists");
+
+    // Events larger than the largest size class always use the heap.
+    EventImpl::ResetPoolStats();
+    Simulator::Schedule(NanoSeconds(1), &EventImplPoolTestCase::LargeEvent, this, Large{});
+    Simulator::Run();
+    stats = EventImpl::GetPoolStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.poolHits, 0, "Oversized event served by the pool");
+    NS_TEST_EXPECT_MSG_EQ(stats.heapReleases, 1, "Oversized event not returned to the heap");
+
+    // With the pool disabled every event goes to the heap.
+    EventImpl::SetPoolEnabled(false);
+    EventImpl::ResetPoolStats();
+    m_count = 0;
+    Simulator::Schedule(NanoSeconds(1), &EventImplPoolTestCase::Chain, this, 9);
+    Simulator::Run();
+    stats = EventImpl::GetPoolStats();
+    NS_TEST_EXPECT_MSG_EQ(m_count, 10, "Wrong number of events executed");
+    NS_TEST_EXPECT_MSG_EQ(stats.poolHits, 0, "Disabled pool served an event");
+    NS_TEST_EXPECT_MSG_EQ(stats.heapReleases, stats.releases, "Disabled pool cached an event");
+
+    EventImpl::SetPoolEnabled(enabled);
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the LadderScheduler event order on a bimodal event population.
+ *
+ * Near-future deliveries and long-horizon timers are interleaved with
+ * dequeues and removals, and the dequeue order is checked against a
+ * `std::set` holding the same events.
+ */
+class LadderSchedulerTestCase : public TestCase
+{
+  public:
+    LadderSchedulerTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LadderSchedulerTestCase::LadderSchedulerTestCase()
+    : TestCase("Check LadderScheduler event order with bimodal timestamps")
+{
+}
+
+void
+LadderSchedulerTestCase::DoRun()
+{
+    Ptr<LadderScheduler> scheduler = CreateObject<LadderScheduler>();
+    std::set<Scheduler::EventKey> reference;
+    std::srand(1);
+
+    uint64_t now = 0;
+    uint32_t uid = 0;
+    auto insert = [&]() {
+        Scheduler::Event ev;
+        ev.impl = nullptr;
+        ev.key.m_uid = uid++;
+        ev.key.m_context = 0;
+        // Mostly near-future events, a few long timers and some simultaneous events
+        int kind = std::rand() % 10;
+        if (kind < 7)
+        {
+            ev.key.m_ts = now + 1 + std::rand() % 100;
+        }
+        else if (kind < 9)
+        {
+            ev.key.m_ts = now + 1000000 + std::rand() % 1000000;
+        }
+        else
+        {
+            ev.key.m_ts = now;
+        }
+        scheduler->Insert(ev);
+        reference.insert(ev.key);
+    };
+
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        insert();
+    }
+
+    uint32_t dequeued = 0;
+    while (!reference.empty())
+    {
+        int op = std::rand() % 10;
+        if (op < 3)
+        {
+            insert();
+        }
+        else if (op == 3)
+        {
+            // Remove a random pending event
+            auto it = reference.begin();
+            std::advance(it, std::rand() % reference.size());
+            Scheduler::Event ev;
+            ev.impl = nullptr;
+            ev.key = *it;
+            scheduler->Remove(ev);
+            reference.erase(it);
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), false, "Scheduler lost events");
+            Scheduler::Event next = scheduler->PeekNext();
+            Scheduler::Event ev = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ((next.key == ev.key), true, "PeekNext and RemoveNext differ");
+            NS_TEST_ASSERT_MSG_EQ((ev.key == *reference.begin()),
+                                  true,
+                                  "Event " << ev.key.m_uid << " at " << ev.key.m_ts
+                                           << " dequeued out of order");
+            reference.erase(reference.begin());
+            now = ev.key.m_ts;
+            ++dequeued;
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(scheduler->IsEmpty(), true, "Scheduler should be empty");
+    NS_TEST_EXPECT_MSG_GT(dequeued, 2000, "Too few events dequeued");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that DefaultSimulatorImpl purges cancelled events from the scheduler.
+ */
+class CancelledEventPurgeTestCase : public TestCase
+{
+  public:
+    CancelledEventPurgeTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Long timeout event, counts its invocations. */
+    void Timeout();
+
+    uint32_t m_timeouts; //!< Number of timeouts executed.
+};
+
+CancelledEventPurgeTestCase::CancelledEventPurgeTestCase()
+    : TestCase("Check that cancelled events are purged from the scheduler"),
+      m_timeouts(0)
+{
+}
+
+void
+CancelledEventPurgeTestCase::Timeout()
+{
+    m_timeouts++;
+}
+
+void
+CancelledEventPurgeTestCase::DoRun()
+{
+    Simulator::Destroy();
+    Config::SetDefault("ns3::DefaultSimulatorImpl::CancelledPurgeMinEvents", UintegerValue(100));
+
+    std::vector<EventId> timers;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        timers.push_back(Simulator::Schedule(Seconds(1) + MicroSeconds(i),
+                                             &CancelledEventPurgeTestCase::Timeout,
+                                             this));
+    }
+    Ptr<DefaultSimulatorImpl> impl =
+        DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Expected the default simulator implementation");
+
+    // Half of the scheduled events cancelled triggers the first purge.
+    for (uint32_t i = 0; i < 499; ++i)
+    {
+        timers[i].Cancel();
+    }
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPurgeCount(), 0, "Purged below the threshold");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 499, "Wrong cancelled event count");
+    timers[499].Cancel();
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPurgeCount(), 1, "No purge at the threshold");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPurgedEventCount(), 500, "Wrong purged event count");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 0, "Cancelled events left after purge");
+
+    // Purged events stay cancelled and expired.
+    timers[0].Cancel();
+    Simulator::Remove(timers[1]);
+    NS_TEST_EXPECT_MSG_EQ(timers[0].IsExpired(), true, "Purged event not expired");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 0, "Purged event cancelled twice");
+
+    // Below the threshold cancelled events are dropped when dequeued;
+    // events cancelled behind the simulator's back are not counted.
+    for (uint32_t i = 500; i < 550; ++i)
+    {
+        timers[i].PeekEventImpl()->Cancel();
+    }
+    for (uint32_t i = 550; i < 600; ++i)
+    {
+        timers[i].Cancel();
+    }
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPurgeCount(), 1, "Purged below the threshold");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 50, "Wrong cancelled event count");
+
+    Simulator::Stop(Seconds(1) + MicroSeconds(575));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 24, "Wrong count of dequeued events");
+
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_timeouts, 400, "Wrong number of timeouts executed");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetCancelledEventCount(), 0, "Cancelled events not dequeued");
+
+    Simulator::Destroy();
+    Config::SetDefault("ns3::DefaultSimulatorImpl::CancelledPurgeMinEvents", UintegerValue(1024));
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the event profile of DefaultSimulatorImpl.
+ */
+class EventProfilerTestCase : public TestCase
+{
+  public:
+    EventProfilerTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Member function event. */
+    void Member();
+    /**
+     * Free function event.
+     * \param [in] value Unused.
+     */
+    static void Function(uint32_t value);
+
+    uint32_t m_members; //!< Number of member events executed.
+};
+
+EventProfilerTestCase::EventProfilerTestCase()
+    : TestCase("Check the event profile"),
+      m_members(0)
+{
+}
+
+void
+EventProfilerTestCase::Member()
+{
+    m_members++;
+}
+
+void
+EventProfilerTestCase::Function(uint32_t /* value */)
+{
+}
+
+void
+EventProfilerTestCase::DoRun()
+{
+    Simulator::Destroy();
+    std::string file = CreateTempDirFilename("event-profile.txt");
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfiling", BooleanValue(true));
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfileFile", StringValue(file));
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfileFormat", StringValue("Folded"));
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        Simulator::ScheduleWithContext(3,
+                                       MicroSeconds(i),
+                                       &EventProfilerTestCase::Member,
+                                       this);
+    }
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        Simulator::Schedule(MicroSeconds(i), &EventProfilerTestCase::Function, i);
+    }
+    EventId removed = Simulator::Schedule(Seconds(1), &EventProfilerTestCase::Member, this);
+    Simulator::Remove(removed);
+    Ptr<DefaultSimulatorImpl> impl =
+        DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Expected the default simulator implementation");
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_members, 10, "Wrong number of member events executed");
+
+    const EventProfiler& profiler = impl->GetEventProfiler();
+    EventProfiler::Stats total = profiler.GetTotal();
+    NS_TEST_EXPECT_MSG_EQ(total.count, 15, "Wrong total event count");
+    NS_TEST_EXPECT_MSG_EQ(total.inserts, 16, "Wrong total insertion count");
+    NS_TEST_EXPECT_MSG_EQ(total.removes, 16, "Wrong total removal count");
+
+    std::vector<EventProfiler::Entry> events = profiler.GetEventStats();
+    NS_TEST_ASSERT_MSG_EQ(events.size(), 2, "Wrong number of event functions");
+    for (const auto& entry : events)
+    {
+        if (entry.first.find("EventProfilerTestCase::*") != std::string::npos)
+        {
+            NS_TEST_EXPECT_MSG_EQ(entry.second.count, 10, "Wrong member event count");
+            NS_TEST_EXPECT_MSG_EQ(entry.second.inserts, 11, "Wrong member insertion count");
+        }
+        else
+        {
+            NS_TEST_EXPECT_MSG_EQ(entry.first, "void (*)(unsigned int)", "Wrong function name");
+            NS_TEST_EXPECT_MSG_EQ(entry.second.count, 5, "Wrong function event count");
+        }
+    }
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(events[0].second.invokeTime,
+                                events[1].second.invokeTime,
+                                "Events not sorted by invocation time");
+
+    std::vector<EventProfiler::Entry> contexts = profiler.GetContextStats();
+    NS_TEST_ASSERT_MSG_EQ(contexts.size(), 2, "Wrong number of contexts");
+    for (const auto& entry : contexts)
+    {
+        uint64_t expected = (entry.first == "context 3") ? 10 : 5;
+        NS_TEST_EXPECT_MSG_EQ(entry.second.count, expected, "Wrong count for " << entry.first);
+    }
+
+    // Destroy() writes the profile.
+    Simulator::Destroy();
+    std::ifstream is(file);
+    NS_TEST_ASSERT_MSG_EQ(is.is_open(), true, "Event profile not written");
+    std::string line;
+    uint32_t lines = 0;
+    while (std::getline(is, line))
+    {
+        NS_TEST_EXPECT_MSG_EQ(line.rfind("Simulator::Run;", 0), 0, "Bad folded stack " << line);
+        lines++;
+    }
+    NS_TEST_EXPECT_MSG_GT(lines, 0, "Empty event profile");
+
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfiling", BooleanValue(false));
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfileFile", StringValue(""));
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfileFormat", StringValue("Report"));
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -740,6 +1160,12 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new LadderSchedulerTestCase(), TestCase::QUICK);
+        AddTestCase(new EventImplPoolTestCase(), TestCase::QUICK);
+        AddTestCase(new CancelledEventPurgeTestCase(), TestCase::QUICK);
+        AddTestCase(new EventProfilerTestCase(), TestCase::QUICK);
     }
 };
 
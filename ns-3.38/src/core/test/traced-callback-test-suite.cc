@@ -18,6 +18,8 @@
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -133,6 +135,92 @@ BasicTracedCallbackTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(m_two, true, "Callback CbTwo not called");
 }
 
+/**
+ * \ingroup tracedcallback-tests
+ *
+ * TracedCallback Test case, check the order in which the sinks are called.
+ */
+class OrderTracedCallbackTestCase : public TestCase
+{
+  public:
+    OrderTracedCallbackTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Record a sink call.
+     * \tparam ID The sink id.
+     * \param value The traced value.
+     */
+    template <int ID>
+    void Sink(int value);
+
+    /**
+     * Record a sink call and connect another sink to the trace.
+     * \param value The traced value.
+     */
+    void ConnectingSink(int value);
+
+    TracedCallback<int> m_trace; //!< The trace source.
+    std::vector<int> m_calls;    //!< The ids of the sinks called.
+};
+
+OrderTracedCallbackTestCase::OrderTracedCallbackTestCase()
+    : TestCase("Check the order of the TracedCallback sinks")
+{
+}
+
+template <int ID>
+void
+OrderTracedCallbackTestCase::Sink(int /* value */)
+{
+    m_calls.push_back(ID);
+}
+
+void
+OrderTracedCallbackTestCase::ConnectingSink(int /* value */)
+{
+    m_calls.push_back(0);
+    m_trace.ConnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::Sink<4>, this));
+}
+
+void
+OrderTracedCallbackTestCase::DoRun()
+{
+    NS_TEST_ASSERT_MSG_EQ(m_trace.IsEmpty(), true, "Trace source not empty");
+
+    m_trace.ConnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::Sink<1>, this));
+    m_trace.ConnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::Sink<2>, this));
+    m_trace.ConnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::Sink<3>, this));
+    NS_TEST_ASSERT_MSG_EQ(m_trace.IsEmpty(), false, "Trace source empty");
+    m_trace(0);
+    NS_TEST_EXPECT_MSG_EQ((m_calls == std::vector<int>{1, 2, 3}), true, "Wrong sink order");
+
+    //
+    // Disconnecting a sink keeps the order of the others.
+    //
+    m_trace.DisconnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::Sink<2>, this));
+    m_calls.clear();
+    m_trace(0);
+    NS_TEST_EXPECT_MSG_EQ((m_calls == std::vector<int>{1, 3}), true, "Wrong sink order");
+
+    //
+    // A sink connected while the trace is fired is called last.
+    //
+    m_trace.ConnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::ConnectingSink, this));
+    m_calls.clear();
+    m_trace(0);
+    NS_TEST_EXPECT_MSG_EQ((m_calls == std::vector<int>{1, 3, 0, 4}), true, "Wrong sink order");
+
+    m_trace.DisconnectWithoutContext(
+        MakeCallback(&OrderTracedCallbackTestCase::ConnectingSink, this));
+    m_trace.DisconnectWithoutContext(MakeCallback(&OrderTracedCallbackTestCase::Sink<4>, this));
+    m_calls.clear();
+    m_trace(0);
+    NS_TEST_EXPECT_MSG_EQ((m_calls == std::vector<int>{1, 3}), true, "Wrong sink order");
+}
+
 /**
  * \ingroup tracedcallback-tests
  *
@@ -148,6 +236,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite()
     : TestSuite("traced-callback", UNIT)
 {
     AddTestCase(new BasicTracedCallbackTestCase, TestCase::QUICK);
+    AddTestCase(new OrderTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite
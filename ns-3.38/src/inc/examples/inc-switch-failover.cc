@@ -0,0 +1,173 @@
+/*
+ * 在网计算协议 - 模拟测试：交换机故障检测与Ring AllReduce回退
+ * 拓扑结构: 一个交换机连接N个主机（星型），交换机上的网计算引擎在指定时间停止，
+ * 交换机节点仍然按IP转发报文。主机通过重传次数阈值检测故障，控制器通知组内所有主机，
+ * 由主机之间的Ring AllReduce完成剩余PSN范围，输出各主机的作业完成时间。
+ *
+ *             Switch0
+ *          /   |   |   \
+ *        H0   H1  ...  H(N-1)
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/error-model.h"
+#include "../model/inc-stack.h"
+#include "../model/inc-switch.h"
+#include "../model/inc-fallback-controller.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("IncSwitchFailover");
+
+// AllReduce开始时间
+static const double g_allReduceStartTime = 2.0;
+
+// 回调函数，用于在AllReduce完成时通知
+void AllReduceCompletionCallback(std::string id)
+{
+  NS_LOG_UNCOND("时间 " << Simulator::Now().GetSeconds() << "s: 主机 " << id << " 完成 AllReduce 操作，JCT="
+                << (Simulator::Now().GetSeconds() - g_allReduceStartTime) << "s");
+}
+
+// 回调函数，用于在启动回退时通知
+void FallbackStartedCallback(uint32_t startPsn, uint32_t packets)
+{
+  NS_LOG_UNCOND("时间 " << Simulator::Now().GetSeconds() << "s: 启动Ring回退，起始PSN=" << startPsn
+                << " 报文数=" << packets);
+}
+
+int
+main(int argc, char* argv[])
+{
+  // 命令行参数处理
+  uint32_t nHosts = 4;              // 主机数量
+  uint32_t totalPackets = 1024;     // 每个主机的数据包数
+  uint32_t windowSize = 64;         // 滑动窗口大小
+  uint32_t arraySize = 1024;        // 交换机数组大小
+  uint32_t maxRetransmissions = 3;  // 判定故障的重传次数阈值
+  double failTime = 2.005;          // 交换机网计算引擎停止时间(秒)，小于0表示不注入故障
+  std::string dataRate = "1Gbps";   // 链路带宽
+  std::string delay = "10us";       // 链路时延
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("hosts", "主机数量", nHosts);
+  cmd.AddValue("packets", "每个主机的数据包数", totalPackets);
+  cmd.AddValue("window", "滑动窗口大小", windowSize);
+  cmd.AddValue("array", "交换机数组大小", arraySize);
+  cmd.AddValue("maxRetx", "判定交换机故障的重传次数阈值", maxRetransmissions);
+  cmd.AddValue("failTime", "交换机故障时间(秒)，小于0表示不注入故障", failTime);
+  cmd.AddValue("datarate", "链路带宽", dataRate);
+  cmd.AddValue("delay", "链路时延", delay);
+  cmd.Parse(argc, argv);
+
+  LogComponentEnable("IncSwitchFailover", LOG_LEVEL_INFO);
+  LogComponentEnable("IncFallbackController", LOG_LEVEL_WARN);
+
+  NodeContainer switchNode;
+  switchNode.Create(1);
+  NodeContainer hosts;
+  hosts.Create(nHosts);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute("DataRate", StringValue(dataRate));
+  p2p.SetChannelAttribute("Delay", StringValue(delay));
+
+  std::vector<NetDeviceContainer> devices(nHosts);
+  for (uint32_t i = 0; i < nHosts; i++) {
+    devices[i] = p2p.Install(switchNode.Get(0), hosts.Get(i));
+  }
+
+  InternetStackHelper internet;
+  internet.Install(switchNode);
+  internet.Install(hosts);
+
+  Ipv4AddressHelper ipv4;
+  std::vector<Ipv4InterfaceContainer> interfaces(nHosts);
+  for (uint32_t i = 0; i < nHosts; i++) {
+    std::ostringstream subnet;
+    subnet << "10.1." << (i + 1) << ".0";
+    ipv4.SetBase(subnet.str().c_str(), "255.255.255.0");
+    interfaces[i] = ipv4.Assign(devices[i]);
+  }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+  // 交换机QP为1..N，主机QP为N+1..2N
+  uint16_t groupId = 1;
+  Ptr<IncSwitch> incSwitch = CreateObject<IncSwitch>();
+  switchNode.Get(0)->AddApplication(incSwitch);
+  incSwitch->SetSwitchId("Switch0");
+  incSwitch->SetStartTime(Seconds(0.5));
+  if (failTime >= 0) {
+    incSwitch->SetStopTime(Seconds(failTime));
+  }
+
+  std::vector<std::tuple<Ipv4Address, uint16_t, Ipv4Address, uint16_t, bool>> linkState;
+  for (uint32_t i = 0; i < nHosts; i++) {
+    linkState.push_back(std::make_tuple(interfaces[i].GetAddress(0), i + 1,
+                                        interfaces[i].GetAddress(1), nHosts + i + 1, true));
+  }
+  incSwitch->InitializeEngine(linkState, groupId, nHosts, arraySize);
+
+  // 故障回退控制器
+  Ptr<IncFallbackController> controller = CreateObject<IncFallbackController>();
+  controller->TraceConnectWithoutContext("FallbackStarted", MakeCallback(&FallbackStartedCallback));
+
+  std::vector<Ptr<IncStack>> incStacks(nHosts);
+  for (uint32_t i = 0; i < nHosts; i++) {
+    incStacks[i] = CreateObject<IncStack>();
+    hosts.Get(i)->AddApplication(incStacks[i]);
+    incStacks[i]->SetStartTime(Seconds(1.0));
+    incStacks[i]->SetStopTime(Seconds(10000.0));
+
+    std::ostringstream hostId;
+    hostId << "Host" << i;
+    incStacks[i]->SetServerId(hostId.str());
+    incStacks[i]->SetAttribute("MaxRetransmissions", UintegerValue(maxRetransmissions));
+    incStacks[i]->SetRemote(interfaces[i].GetAddress(0), i + 1);
+    incStacks[i]->SetLocal(interfaces[i].GetAddress(1), nHosts + i + 1);
+    incStacks[i]->SetCompleteCallback(MakeBoundCallback(&AllReduceCompletionCallback, hostId.str()));
+    incStacks[i]->SetWindowSize(windowSize);
+    incStacks[i]->SetOperation(IncHeader::SUM);
+    incStacks[i]->SetDataType(IncHeader::INT32);
+    incStacks[i]->SetTotalPackets(totalPackets);
+    incStacks[i]->SetFillValue(1);
+    incStacks[i]->SetGroupId(groupId);
+
+    controller->AddHost(incStacks[i], interfaces[i].GetAddress(1));
+  }
+
+  for (uint32_t i = 0; i < nHosts; i++) {
+    Simulator::Schedule(Seconds(g_allReduceStartTime), &IncStack::AllReduce, incStacks[i]);
+  }
+
+  NS_LOG_INFO("开始运行仿真...");
+  Simulator::Stop(Seconds(1000.0));
+  Simulator::Run();
+
+  // 校验结果
+  bool allCorrect = true;
+  for (uint32_t i = 0; i < nHosts; i++) {
+    const std::vector<int32_t>& result = incStacks[i]->GetResultBuffer();
+    bool correct = incStacks[i]->IsCompleted();
+    for (uint32_t psn = 0; correct && psn < result.size(); psn++) {
+      correct = (result[psn] == static_cast<int32_t>(nHosts));
+    }
+    if (!correct) {
+      allCorrect = false;
+      NS_LOG_INFO("主机" << i << " 结果校验失败");
+    }
+  }
+  NS_LOG_UNCOND("回退" << (controller->IsFallbackStarted() ? "已启动" : "未启动")
+                << "，结果校验" << (allCorrect ? "成功" : "失败"));
+
+  Simulator::Destroy();
+  NS_LOG_INFO("仿真结束");
+
+  return 0;
+}
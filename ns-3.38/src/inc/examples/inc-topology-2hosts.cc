@@ -54,10 +54,12 @@ main(int argc, char* argv[])
   Ptr<RateErrorModel> em1 = CreateObject<RateErrorModel>();
   em1->SetAttribute("ErrorRate", DoubleValue(errorRate));
   em1->SetAttribute("ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
+  em1->SetAttribute("SkipAhead", BooleanValue(true));
   
   Ptr<RateErrorModel> em2 = CreateObject<RateErrorModel>();
   em2->SetAttribute("ErrorRate", DoubleValue(errorRate));
   em2->SetAttribute("ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
+  em2->SetAttribute("SkipAhead", BooleanValue(true));
 
   // 连接Host0和Switch
   NetDeviceContainer devicesH0S;
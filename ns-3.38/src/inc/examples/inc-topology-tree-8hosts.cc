@@ -123,6 +123,7 @@ main(int argc, char* argv[])
   Ptr<RateErrorModel> em = CreateObject<RateErrorModel>();
   em->SetAttribute("ErrorRate", DoubleValue(errorRate));
   em->SetAttribute("ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
+  em->SetAttribute("SkipAhead", BooleanValue(true));
   
   for (int i = 0; i < 14; i++) {
     devices[i].Get(0)->SetAttribute("ReceiveErrorModel", PointerValue(em));
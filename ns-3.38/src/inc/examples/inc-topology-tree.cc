@@ -80,6 +80,7 @@ main(int argc, char* argv[])
   Ptr<RateErrorModel> em = CreateObject<RateErrorModel>();
   em->SetAttribute("ErrorRate", DoubleValue(errorRate));
   em->SetAttribute("ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
+  em->SetAttribute("SkipAhead", BooleanValue(true));
   
   devAB.Get(0)->SetAttribute("ReceiveErrorModel", PointerValue(em));
   devAB.Get(1)->SetAttribute("ReceiveErrorModel", PointerValue(em));
@@ -0,0 +1,158 @@
+/*
+ * 在网计算协议 - 分布式训练负载：对比在网聚合与Ring AllReduce的单轮迭代时间
+ *
+ * 由IncTreeHelper构建满K叉聚合树，IncTrainingWorkload按层模拟前向/反向计算，
+ * 梯度按桶在反向传播中逐个就绪并与剩余计算重叠通信，输出每轮迭代时间、
+ * 反向计算结束后暴露的通信时间，以及在网聚合相对Ring AllReduce的端到端加速比。
+ * 结果直接输出到标准输出。
+ *
+ * 运行方式:
+ *   ./ns3 run "inc-training-workload --layers=16 --layerBytes=262144 --bucket=1048576"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/inc-tree-helper.h"
+#include "ns3/inc-training-workload.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("IncTrainingWorkloadExample");
+
+// 回调函数，输出每轮迭代的耗时
+void IterationCallback(std::string backend, uint32_t iteration, Time duration)
+{
+  std::cout << backend << " 第" << iteration << "轮迭代耗时=" << duration.As(Time::MS) << std::endl;
+}
+
+/**
+ * \brief 构建聚合树并用指定后端运行训练负载
+ * \param backend 集合通信后端
+ * \param fanOut 每个交换机的子节点数
+ * \param depth 交换机层数
+ * \param layers 模型层数
+ * \param layerBytes 每层梯度大小(字节)
+ * \param bucketSize 梯度桶大小(字节)
+ * \param forwardUs 每层前向计算时间(微秒)
+ * \param backwardUs 每层反向计算时间(微秒)
+ * \param iterations 迭代轮数
+ * \param overlap 通信是否与反向计算重叠
+ * \param stackDelay 在网聚合协议栈发送每个报文的处理时延
+ * \return 平均迭代时间(秒)，未完成时返回0
+ */
+double
+RunTraining(IncTrainingWorkload::Backend backend, uint32_t fanOut, uint32_t depth, uint32_t layers,
+            uint32_t layerBytes, uint32_t bucketSize, double forwardUs, double backwardUs,
+            uint32_t iterations, bool overlap, Time stackDelay)
+{
+  std::string name = (backend == IncTrainingWorkload::INC) ? "INC" : "Ring";
+
+  IncTreeHelper tree;
+  tree.SetTreeShape(fanOut, depth);
+  tree.SetLinkAttributes("100Gbps", "1us");
+  tree.SetGroupParameters(1, 1024);
+  tree.SetStackAttribute("WindowSize", UintegerValue(256));
+  tree.SetStackAttribute("ProcessingDelay", TimeValue(stackDelay));
+  tree.Create();
+  tree.InstallApplications(Seconds(1.0), Seconds(1000.0));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+  Ptr<IncTrainingWorkload> workload = CreateObject<IncTrainingWorkload>();
+  workload->SetAttribute("Backend", EnumValue(backend));
+  workload->SetAttribute("Iterations", UintegerValue(iterations));
+  workload->SetAttribute("BucketSize", UintegerValue(bucketSize));
+  workload->SetAttribute("Overlap", BooleanValue(overlap));
+  for (uint32_t i = 0; i < layers; i++)
+  {
+    workload->AddLayer(MicroSeconds(forwardUs), MicroSeconds(backwardUs), layerBytes);
+  }
+
+  std::vector<Ptr<IncStack>> stacks = tree.GetLocalStacks();
+  for (uint32_t h = 0; h < stacks.size(); h++)
+  {
+    if (backend == IncTrainingWorkload::INC)
+    {
+      workload->AddHost(stacks[h]);
+    }
+    else
+    {
+      workload->AddHost(tree.GetHostNodes().Get(h), tree.GetHostAddress(h));
+    }
+  }
+  workload->TraceConnectWithoutContext("IterationComplete", MakeBoundCallback(&IterationCallback, name));
+  Simulator::Schedule(Seconds(2.0), &IncTrainingWorkload::Start, workload);
+
+  Simulator::Stop(Seconds(1000.0));
+  Simulator::Run();
+
+  double average = 0.0;
+  const std::vector<Time>& times = workload->GetIterationTimes();
+  const std::vector<Time>& exposed = workload->GetExposedCommTimes();
+  if (workload->IsFinished())
+  {
+    double exposedAverage = 0.0;
+    for (uint32_t i = 0; i < times.size(); i++)
+    {
+      average += times[i].GetSeconds() / times.size();
+      exposedAverage += exposed[i].GetSeconds() / times.size();
+    }
+    std::cout << name << ": 梯度桶数=" << workload->GetBucketCount() << " 平均迭代时间=" << average * 1e3
+              << "ms 平均暴露通信时间=" << exposedAverage * 1e3 << "ms" << std::endl;
+  }
+  else
+  {
+    std::cout << name << ": 仅完成 " << times.size() << "/" << iterations << " 轮迭代" << std::endl;
+  }
+
+  Simulator::Destroy();
+  return average;
+}
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t fanOut = 4;              // 每个交换机的子节点数
+  uint32_t depth = 1;               // 交换机层数
+  uint32_t layers = 16;             // 模型层数
+  uint32_t layerBytes = 256 * 1024; // 每层梯度大小(字节)
+  uint32_t bucketSize = 1024 * 1024; // 梯度桶大小(字节)
+  double forwardUs = 100;           // 每层前向计算时间(微秒)
+  double backwardUs = 200;          // 每层反向计算时间(微秒)
+  uint32_t iterations = 3;          // 迭代轮数
+  bool overlap = true;              // 通信是否与反向计算重叠
+  bool ring = true;                 // 是否同时运行Ring AllReduce作为对比
+  uint32_t stackDelayNs = 100;      // 协议栈每个报文的处理时延(纳秒)，默认值10us会把发送速率限制在1Gbps以下
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("fanout", "每个交换机的子节点数", fanOut);
+  cmd.AddValue("depth", "交换机层数，主机数为fanout^depth", depth);
+  cmd.AddValue("layers", "模型层数", layers);
+  cmd.AddValue("layerBytes", "每层梯度大小(字节)", layerBytes);
+  cmd.AddValue("bucket", "梯度桶大小(字节)", bucketSize);
+  cmd.AddValue("forwardUs", "每层前向计算时间(微秒)", forwardUs);
+  cmd.AddValue("backwardUs", "每层反向计算时间(微秒)", backwardUs);
+  cmd.AddValue("iterations", "迭代轮数", iterations);
+  cmd.AddValue("overlap", "通信是否与反向计算重叠", overlap);
+  cmd.AddValue("ring", "是否同时运行Ring AllReduce作为对比", ring);
+  cmd.AddValue("stackDelayNs", "在网聚合协议栈每个报文的处理时延(纳秒)", stackDelayNs);
+  cmd.Parse(argc, argv);
+
+  double incTime = RunTraining(IncTrainingWorkload::INC, fanOut, depth, layers, layerBytes, bucketSize,
+                               forwardUs, backwardUs, iterations, overlap, NanoSeconds(stackDelayNs));
+  if (ring)
+  {
+    double ringTime = RunTraining(IncTrainingWorkload::RING, fanOut, depth, layers, layerBytes, bucketSize,
+                                  forwardUs, backwardUs, iterations, overlap, NanoSeconds(stackDelayNs));
+    if (incTime > 0.0 && ringTime > 0.0)
+    {
+      std::cout << "在网聚合端到端加速比=" << ringTime / incTime << std::endl;
+    }
+  }
+
+  return 0;
+}
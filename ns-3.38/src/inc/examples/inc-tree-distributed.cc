@@ -0,0 +1,156 @@
+/*
+ * 在网计算协议 - 分布式模拟：由IncTreeHelper构建的满K叉聚合树，按子树划分到多个MPI rank
+ *
+ * 每个rank都创建完整的拓扑，但只在本rank的节点上安装IncSwitch/IncStack，
+ * 只有子树之间的树链路跨越rank（PointToPointRemoteChannel）。
+ *
+ * 结果直接输出到标准输出，优化构建下同样可用于扩展性测试（见inc-tree-scaling.sh）。
+ *
+ * 运行方式:
+ *   ./ns3 run inc-tree-distributed --command-template="mpirun -np 4 %s --fanout=4 --depth=5"
+ *   ./ns3 run "inc-tree-distributed --distributed=0"   (单进程顺序模拟，作为基准)
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/inc-tree-helper.h"
+
+#include <iostream>
+#include <mpi.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("IncTreeDistributed");
+
+// AllReduce开始时间
+static const double g_allReduceStartTime = 2.0;
+
+// 回调函数，记录本rank最晚的AllReduce完成时间
+void AllReduceCompletionCallback(double* lastCompletion)
+{
+  *lastCompletion = std::max(*lastCompletion, Simulator::Now().GetSeconds());
+}
+
+int
+main(int argc, char* argv[])
+{
+  bool distributed = true;          // 是否使用MPI分布式模拟
+  bool nullmsg = false;             // 是否使用空消息同步算法
+  uint32_t fanOut = 4;              // 每个交换机的子节点数
+  uint32_t depth = 3;               // 交换机层数
+  uint32_t totalPackets = 1024;     // 每个主机的数据包数
+  uint32_t windowSize = 256;        // 滑动窗口大小
+  uint32_t arraySize = 1024;        // 交换机数组大小
+  uint32_t payloadSize = 1024;      // 数据报文载荷大小(字节)，最大9000
+  std::string dataRate = "100Gbps"; // 链路带宽
+  std::string delay = "1us";        // 链路时延，即跨rank链路的lookahead
+  double simTime = 3.0;             // 仿真结束时间(秒)，空消息算法的开销与simTime/delay成正比
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("distributed", "使用MPI分布式模拟，否则为单进程顺序模拟", distributed);
+  cmd.AddValue("nullmsg", "使用空消息同步算法，否则为授时窗口算法", nullmsg);
+  cmd.AddValue("fanout", "每个交换机的子节点数", fanOut);
+  cmd.AddValue("depth", "交换机层数，主机数为fanout^depth", depth);
+  cmd.AddValue("packets", "每个主机的数据包数", totalPackets);
+  cmd.AddValue("window", "滑动窗口大小", windowSize);
+  cmd.AddValue("array", "交换机数组大小", arraySize);
+  cmd.AddValue("payload", "数据报文载荷大小(字节)，最大9000", payloadSize);
+  cmd.AddValue("datarate", "链路带宽", dataRate);
+  cmd.AddValue("delay", "链路时延", delay);
+  cmd.AddValue("simTime", "仿真结束时间(秒)", simTime);
+  cmd.Parse(argc, argv);
+
+  uint32_t systemId = 0;
+  uint32_t systemCount = 1;
+  if (distributed)
+  {
+    if (nullmsg)
+    {
+      GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::NullMessageSimulatorImpl"));
+    }
+    else
+    {
+      GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    }
+    MpiInterface::Enable(&argc, &argv);
+    systemId = MpiInterface::GetSystemId();
+    systemCount = MpiInterface::GetSize();
+  }
+
+  SystemWallClockMs setupClock;
+  setupClock.Start();
+
+  IncTreeHelper tree;
+  tree.SetTreeShape(fanOut, depth);
+  tree.SetPartitionCount(systemCount);
+  tree.SetLinkAttributes(dataRate, delay);
+  tree.SetGroupParameters(1, arraySize, payloadSize);
+  tree.SetStackAttribute("TotalPackets", UintegerValue(totalPackets));
+  tree.SetStackAttribute("WindowSize", UintegerValue(windowSize));
+  tree.Create();
+  tree.InstallApplications(Seconds(1.0), Seconds(simTime));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+  std::vector<Ptr<IncStack>> stacks = tree.GetLocalStacks();
+  for (auto& stack : stacks)
+  {
+    Simulator::Schedule(Seconds(g_allReduceStartTime), &IncStack::AllReduce, stack);
+  }
+
+  int64_t setupMs = setupClock.End();
+  if (systemId == 0)
+  {
+    std::cout << "主机数=" << tree.GetHostNodes().GetN() << " 交换机数=" << tree.GetSwitchNodes().GetN()
+              << " rank数=" << systemCount << " 跨rank链路数=" << tree.GetCrossPartitionLinkCount()
+              << " 拓扑构建耗时=" << setupMs << "ms" << std::endl;
+  }
+
+  double lastCompletion = 0.0;
+  for (auto& stack : stacks)
+  {
+    stack->SetCompleteCallback(MakeBoundCallback(&AllReduceCompletionCallback, &lastCompletion));
+  }
+
+  SystemWallClockMs runClock;
+  runClock.Start();
+  Simulator::Stop(Seconds(simTime));
+  Simulator::Run();
+  int64_t runMs = runClock.End();
+
+  uint32_t completed = 0;
+  for (auto& stack : stacks)
+  {
+    completed += stack->IsCompleted();
+  }
+
+  // 汇总各rank的完成数、最晚完成时间和墙钟时间
+  uint32_t totalCompleted = completed;
+  double maxCompletion = lastCompletion;
+  int64_t maxRunMs = runMs;
+  if (distributed)
+  {
+    MPI_Reduce(&completed, &totalCompleted, 1, MPI_UNSIGNED, MPI_SUM, 0, MpiInterface::GetCommunicator());
+    MPI_Reduce(&lastCompletion, &maxCompletion, 1, MPI_DOUBLE, MPI_MAX, 0, MpiInterface::GetCommunicator());
+    MPI_Reduce(&runMs, &maxRunMs, 1, MPI_INT64_T, MPI_MAX, 0, MpiInterface::GetCommunicator());
+  }
+
+  if (systemId == 0)
+  {
+    std::cout << "完成AllReduce的主机数=" << totalCompleted << "/" << tree.GetHostNodes().GetN()
+              << " JCT=" << (maxCompletion - g_allReduceStartTime) << "s"
+              << " 仿真墙钟时间=" << maxRunMs << "ms" << std::endl;
+  }
+
+  Simulator::Destroy();
+  if (distributed)
+  {
+    MpiInterface::Disable();
+  }
+
+  return 0;
+}
@@ -0,0 +1,47 @@
+#!/bin/bash
+#
+# 在网计算协议 - 分布式模拟扩展性测试
+# 使用inc-tree-distributed在单机上以1~16个MPI rank运行同一棵聚合树，
+# 输出各rank数下的仿真墙钟时间和相对单进程顺序模拟的加速比。
+#
+# 用法（在ns-3根目录下运行，需要以 --enable-mpi 配置并构建examples）:
+#   src/inc/examples/inc-tree-scaling.sh [fanout] [depth] [packets] [额外参数...]
+#
+
+FANOUT=${1:-4}
+DEPTH=${2:-5}
+PACKETS=${3:-256}
+shift 3 2>/dev/null
+EXTRA_ARGS="$@"
+
+RANKS="1 2 4 8 16"
+ARGS="--fanout=${FANOUT} --depth=${DEPTH} --packets=${PACKETS} ${EXTRA_ARGS}"
+
+# 从程序输出中提取仿真墙钟时间(ms)
+extract_wallclock()
+{
+    sed -n 's/.*仿真墙钟时间=\([0-9]*\)ms.*/\1/p' | tail -n 1
+}
+
+echo "扩展性测试: fanout=${FANOUT} depth=${DEPTH} packets=${PACKETS}"
+
+./ns3 build inc-tree-distributed || exit 1
+
+BASE=$(./ns3 run --no-build "inc-tree-distributed --distributed=0 ${ARGS}" 2>&1 | extract_wallclock)
+if [ -z "${BASE}" ]; then
+    echo "顺序模拟运行失败"
+    exit 1
+fi
+printf "%-12s %12s %10s\n" "ranks" "wallclock(ms)" "speedup"
+printf "%-12s %12s %10s\n" "sequential" "${BASE}" "1.00"
+
+for NP in ${RANKS}; do
+    TIME=$(./ns3 run --no-build inc-tree-distributed \
+        --command-template="mpirun --oversubscribe -np ${NP} %s ${ARGS}" 2>&1 | extract_wallclock)
+    if [ -z "${TIME}" ]; then
+        printf "%-12s %12s %10s\n" "${NP}" "failed" "-"
+        continue
+    fi
+    SPEEDUP=$(awk -v b="${BASE}" -v t="${TIME}" 'BEGIN { if (t > 0) printf "%.2f", b / t; else print "-" }')
+    printf "%-12s %12s %10s\n" "${NP}" "${TIME}" "${SPEEDUP}"
+done
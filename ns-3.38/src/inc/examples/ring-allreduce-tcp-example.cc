@@ -90,6 +90,7 @@ main (int argc, char *argv[])
   Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
   em->SetAttribute ("ErrorRate", DoubleValue (errorRate));
   em->SetAttribute ("ErrorUnit", EnumValue (RateErrorModel::ERROR_UNIT_PACKET));
+  em->SetAttribute ("SkipAhead", BooleanValue (true));
   
   // 创建网络设备并应用错误模型
   NetDeviceContainer devices[nNodes];
@@ -0,0 +1,349 @@
+#include "inc-tree-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include <limits>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("IncTreeHelper");
+
+IncTreeHelper::IncTreeHelper()
+  : m_fanOut(2),
+    m_depth(3),
+    m_partitions(1),
+    m_groupId(1),
+    m_arraySize(1024),
+    m_payloadSize(IncHeader::DEFAULT_PAYLOAD_SIZE),
+    m_sparseCells(0)
+{
+  m_p2p.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+  m_p2p.SetChannelAttribute("Delay", StringValue("1ms"));
+  m_stackFactory.SetTypeId("ns3::IncStack");
+  m_switchFactory.SetTypeId("ns3::IncSwitch");
+}
+
+void
+IncTreeHelper::SetTreeShape(uint32_t fanOut, uint32_t depth)
+{
+  NS_LOG_FUNCTION(this << fanOut << depth);
+  NS_ABORT_MSG_IF(fanOut < 2, "扇入度至少为2");
+  NS_ABORT_MSG_IF(depth < 1, "至少需要一层交换机");
+  m_fanOut = fanOut;
+  m_depth = depth;
+}
+
+void
+IncTreeHelper::SetPartitionCount(uint32_t partitions)
+{
+  NS_LOG_FUNCTION(this << partitions);
+  NS_ABORT_MSG_IF(partitions < 1, "分区数至少为1");
+  m_partitions = partitions;
+}
+
+void
+IncTreeHelper::SetLinkAttributes(std::string dataRate, std::string delay)
+{
+  NS_LOG_FUNCTION(this << dataRate << delay);
+  m_p2p.SetDeviceAttribute("DataRate", StringValue(dataRate));
+  m_p2p.SetChannelAttribute("Delay", StringValue(delay));
+}
+
+void
+IncTreeHelper::SetGroupParameters(uint16_t groupId, uint16_t arraySize, uint16_t payloadSize)
+{
+  NS_LOG_FUNCTION(this << groupId << arraySize << payloadSize);
+  NS_ABORT_MSG_IF(payloadSize == 0 || payloadSize > IncHeader::MAX_PAYLOAD_SIZE,
+                  "载荷大小 " << payloadSize << " 超出范围(1~" << IncHeader::MAX_PAYLOAD_SIZE << ")");
+  m_groupId = groupId;
+  m_arraySize = arraySize;
+  m_payloadSize = payloadSize;
+  m_stackFactory.Set("PayloadSize", UintegerValue(payloadSize));
+}
+
+void
+IncTreeHelper::SetSparseMode(uint16_t cellsPerSlot)
+{
+  NS_LOG_FUNCTION(this << cellsPerSlot);
+  m_sparseCells = cellsPerSlot;
+}
+
+void
+IncTreeHelper::SetStackAttribute(std::string name, const AttributeValue& value)
+{
+  m_stackFactory.Set(name, value);
+}
+
+void
+IncTreeHelper::SetSwitchAttribute(std::string name, const AttributeValue& value)
+{
+  m_switchFactory.Set(name, value);
+}
+
+uint32_t
+IncTreeHelper::GetLevelSize(uint32_t level) const
+{
+  uint32_t size = 1;
+  for (uint32_t l = 0; l < level; ++l)
+  {
+    size *= m_fanOut;
+  }
+  return size;
+}
+
+uint32_t
+IncTreeHelper::GetPartitionLevel() const
+{
+  // 子树数量不少于分区数的最浅一层，第depth层即按主机划分
+  for (uint32_t level = 0; level < m_depth; ++level)
+  {
+    if (GetLevelSize(level) >= m_partitions)
+    {
+      return level;
+    }
+  }
+  return m_depth;
+}
+
+uint32_t
+IncTreeHelper::GetSubtreePartition(uint32_t subtree) const
+{
+  // 相邻的子树划分到同一个分区，各分区的子树数量最多相差1
+  uint64_t subtrees = GetLevelSize(GetPartitionLevel());
+  return static_cast<uint32_t>(static_cast<uint64_t>(subtree) * m_partitions / subtrees);
+}
+
+uint32_t
+IncTreeHelper::GetSwitchPartition(uint32_t level, uint32_t index) const
+{
+  uint32_t partitionLevel = GetPartitionLevel();
+  if (level >= partitionLevel)
+  {
+    // 位于划分层之下，归属其所在的子树
+    return GetSubtreePartition(index / GetLevelSize(level - partitionLevel));
+  }
+  // 位于划分层之上，归属其最左侧的子树
+  return GetSubtreePartition(index * GetLevelSize(partitionLevel - level));
+}
+
+uint32_t
+IncTreeHelper::GetHostPartition(uint32_t index) const
+{
+  return GetSwitchPartition(m_depth, index);
+}
+
+void
+IncTreeHelper::Create()
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t numHosts = GetLevelSize(m_depth);
+  NS_ABORT_MSG_IF(m_partitions > numHosts, "分区数 " << m_partitions << " 超过主机数 " << numHosts);
+
+  // 按层序创建交换机，节点的系统ID即其所在分区
+  for (uint32_t level = 0; level < m_depth; ++level)
+  {
+    for (uint32_t i = 0; i < GetLevelSize(level); ++i)
+    {
+      m_switchNodes.Add(CreateObject<Node>(GetSwitchPartition(level, i)));
+    }
+  }
+  for (uint32_t i = 0; i < numHosts; ++i)
+  {
+    m_hostNodes.Add(CreateObject<Node>(GetHostPartition(i)));
+  }
+
+  uint32_t numSwitches = m_switchNodes.GetN();
+  uint32_t numLinks = numSwitches - 1 + numHosts;
+  NS_ABORT_MSG_IF(2 * numLinks > std::numeric_limits<uint16_t>::max() - 1024,
+                  "链路数 " << numLinks << " 超出QP号范围");
+
+  NS_LOG_INFO("创建聚合树: 扇入度=" << m_fanOut << " 交换机层数=" << m_depth
+              << " 交换机数=" << numSwitches << " 主机数=" << numHosts
+              << " 分区数=" << m_partitions << " 划分层=" << GetPartitionLevel());
+
+  // 链路MTU至少容纳IPv4头部(20B)、UDP头部(8B)、INC头部和载荷，避免IP分片
+  IncHeader header;
+  uint32_t mtu = 20 + 8 + header.GetSerializedSize() + m_payloadSize;
+  if (mtu > 1500)
+  {
+    m_p2p.SetDeviceAttribute("Mtu", UintegerValue(mtu));
+  }
+
+  InternetStackHelper internet;
+  internet.Install(m_switchNodes);
+  internet.Install(m_hostNodes);
+
+  // 每条链路使用一个/30网段，每端一个QP
+  Ipv4AddressHelper ipv4("10.0.0.0", "255.255.255.252");
+  uint16_t qp = 1;
+
+  // 交换机之间的链路：交换机s的父节点为(s-1)/K
+  for (uint32_t s = 1; s < numSwitches; ++s)
+  {
+    TreeLink link;
+    link.parent = (s - 1) / m_fanOut;
+    link.child = m_switchNodes.Get(s);
+    link.parentQP = qp++;
+    link.childQP = qp++;
+    NetDeviceContainer devices = m_p2p.Install(m_switchNodes.Get(link.parent), link.child);
+    link.interfaces = ipv4.Assign(devices);
+    ipv4.NewNetwork();
+    m_switchLinks.push_back(link);
+  }
+
+  // 交换机到主机的链路：主机h连接到第h/K个最底层交换机
+  uint32_t firstLeaf = numSwitches - GetLevelSize(m_depth - 1);
+  for (uint32_t h = 0; h < numHosts; ++h)
+  {
+    TreeLink link;
+    link.parent = firstLeaf + h / m_fanOut;
+    link.child = m_hostNodes.Get(h);
+    link.parentQP = qp++;
+    link.childQP = qp++;
+    NetDeviceContainer devices = m_p2p.Install(m_switchNodes.Get(link.parent), link.child);
+    link.interfaces = ipv4.Assign(devices);
+    ipv4.NewNetwork();
+    m_hostLinks.push_back(link);
+  }
+
+  NS_LOG_INFO("跨分区链路数=" << GetCrossPartitionLinkCount());
+}
+
+void
+IncTreeHelper::InstallApplications(Time start, Time stop)
+{
+  NS_LOG_FUNCTION(this << start << stop);
+
+  uint32_t systemId = Simulator::GetSystemId();
+  uint32_t numSwitches = m_switchNodes.GetN();
+  uint32_t firstLeaf = numSwitches - GetLevelSize(m_depth - 1);
+
+  // 只在本分区的交换机上安装网计算引擎
+  for (uint32_t s = 0; s < numSwitches; ++s)
+  {
+    Ptr<Node> node = m_switchNodes.Get(s);
+    if (node->GetSystemId() != systemId)
+    {
+      continue;
+    }
+
+    Ptr<IncSwitch> incSwitch = m_switchFactory.Create<IncSwitch>();
+    node->AddApplication(incSwitch);
+    incSwitch->SetStartTime(start);
+    incSwitch->SetStopTime(stop);
+
+    std::ostringstream switchId;
+    switchId << "Switch" << s;
+    incSwitch->SetSwitchId(switchId.str());
+
+    std::vector<std::tuple<Ipv4Address, uint16_t, Ipv4Address, uint16_t, bool>> linkState;
+
+    // 到父节点的链路（根节点除外）
+    if (s > 0)
+    {
+      const TreeLink& link = m_switchLinks[s - 1];
+      linkState.push_back(std::make_tuple(link.interfaces.GetAddress(1), link.childQP,
+                                          link.interfaces.GetAddress(0), link.parentQP, false));
+    }
+
+    // 到子节点的链路
+    for (uint32_t j = 0; j < m_fanOut; ++j)
+    {
+      const TreeLink& link = (s < firstLeaf) ? m_switchLinks[s * m_fanOut + j]
+                                             : m_hostLinks[(s - firstLeaf) * m_fanOut + j];
+      linkState.push_back(std::make_tuple(link.interfaces.GetAddress(0), link.parentQP,
+                                          link.interfaces.GetAddress(1), link.childQP, true));
+    }
+
+    incSwitch->InitializeEngine(linkState, m_groupId, m_fanOut, m_arraySize, m_payloadSize);
+    if (m_sparseCells > 0)
+    {
+      incSwitch->EnableSparseMode(m_groupId, m_sparseCells);
+    }
+    m_localSwitches.push_back(incSwitch);
+  }
+
+  // 只在本分区的主机上安装协议栈
+  for (uint32_t h = 0; h < m_hostNodes.GetN(); ++h)
+  {
+    Ptr<Node> node = m_hostNodes.Get(h);
+    if (node->GetSystemId() != systemId)
+    {
+      continue;
+    }
+
+    Ptr<IncStack> stack = m_stackFactory.Create<IncStack>();
+    node->AddApplication(stack);
+    stack->SetStartTime(start);
+    stack->SetStopTime(stop);
+
+    std::ostringstream hostId;
+    hostId << "Host" << h;
+    stack->SetServerId(hostId.str());
+    stack->SetGroupId(m_groupId);
+
+    const TreeLink& link = m_hostLinks[h];
+    stack->SetRemote(link.interfaces.GetAddress(0), link.parentQP);
+    stack->SetLocal(link.interfaces.GetAddress(1), link.childQP);
+    m_localStacks.push_back(stack);
+  }
+
+  NS_LOG_INFO("分区 " << systemId << " 安装交换机 " << m_localSwitches.size()
+              << " 个，主机协议栈 " << m_localStacks.size() << " 个");
+}
+
+NodeContainer
+IncTreeHelper::GetSwitchNodes() const
+{
+  return m_switchNodes;
+}
+
+NodeContainer
+IncTreeHelper::GetHostNodes() const
+{
+  return m_hostNodes;
+}
+
+Ipv4Address
+IncTreeHelper::GetHostAddress(uint32_t index) const
+{
+  NS_ABORT_MSG_IF(index >= m_hostLinks.size(), "主机序号 " << index << " 超出范围");
+  return m_hostLinks[index].interfaces.GetAddress(1);
+}
+
+std::vector<Ptr<IncStack>>
+IncTreeHelper::GetLocalStacks() const
+{
+  return m_localStacks;
+}
+
+std::vector<Ptr<IncSwitch>>
+IncTreeHelper::GetLocalSwitches() const
+{
+  return m_localSwitches;
+}
+
+uint32_t
+IncTreeHelper::GetCrossPartitionLinkCount() const
+{
+  uint32_t count = 0;
+  for (const auto& link : m_switchLinks)
+  {
+    count += (m_switchNodes.Get(link.parent)->GetSystemId() != link.child->GetSystemId());
+  }
+  for (const auto& link : m_hostLinks)
+  {
+    count += (m_switchNodes.Get(link.parent)->GetSystemId() != link.child->GetSystemId());
+  }
+  return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,206 @@
+#ifndef INC_TREE_HELPER_H
+#define INC_TREE_HELPER_H
+
+#include "ns3/inc-stack.h"
+#include "ns3/inc-switch.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/nstime.h"
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup inc
+ * \brief 在网计算聚合树拓扑的帮助类
+ *
+ * 构建一棵满K叉聚合树：depth层交换机（第0层为根），最底层交换机各连接K个主机，
+ * 自动分配链路地址和QP号，初始化各交换机的网计算引擎并在主机上安装协议栈。
+ *
+ * 支持按子树划分到多个逻辑进程（MPI rank）：选择子树数量不少于分区数的最浅一层，
+ * 每棵子树整体分配给一个rank，子树之上的交换机归属其最左侧子树所在的rank，
+ * 因此只有子树之间的树链路跨越rank，IncSwitch/IncStack的状态都留在本rank内。
+ * 应用只安装在系统ID等于当前Simulator::GetSystemId()的节点上。
+ */
+class IncTreeHelper
+{
+public:
+  /**
+   * \brief 创建一个IncTreeHelper实例
+   */
+  IncTreeHelper();
+
+  /**
+   * \brief 设置树的形状
+   * \param fanOut 每个交换机的子节点数（即扇入度）
+   * \param depth 交换机层数
+   */
+  void SetTreeShape(uint32_t fanOut, uint32_t depth);
+
+  /**
+   * \brief 设置分区数（MPI rank数）
+   * \param partitions 分区数，1表示不划分
+   */
+  void SetPartitionCount(uint32_t partitions);
+
+  /**
+   * \brief 设置链路属性
+   * \param dataRate 链路带宽
+   * \param delay 链路时延
+   */
+  void SetLinkAttributes(std::string dataRate, std::string delay);
+
+  /**
+   * \brief 设置通信组参数
+   * \param groupId 通信组ID
+   * \param arraySize 交换机数组大小
+   * \param payloadSize 数据报文载荷大小，同时用于主机协议栈和交换机，链路MTU随之增大
+   */
+  void SetGroupParameters(uint16_t groupId, uint16_t arraySize,
+                          uint16_t payloadSize = IncHeader::DEFAULT_PAYLOAD_SIZE);
+
+  /**
+   * \brief 为通信组开启交换机上的稀疏聚合模式，主机需通过IncStack::SetSparseData提供输入
+   * \param cellsPerSlot 每个槽位的哈希聚合单元数，0表示稠密模式
+   */
+  void SetSparseMode(uint16_t cellsPerSlot);
+
+  /**
+   * \brief 设置主机协议栈属性
+   * \param name 属性名称
+   * \param value 属性值
+   */
+  void SetStackAttribute(std::string name, const AttributeValue& value);
+
+  /**
+   * \brief 设置交换机属性
+   * \param name 属性名称
+   * \param value 属性值
+   */
+  void SetSwitchAttribute(std::string name, const AttributeValue& value);
+
+  /**
+   * \brief 创建节点、链路、协议栈并分配地址
+   *
+   * 所有rank都需要创建完整的拓扑，节点的系统ID由子树划分决定
+   */
+  void Create();
+
+  /**
+   * \brief 在本rank的节点上安装并初始化交换机和主机协议栈
+   * \param start 应用启动时间
+   * \param stop 应用停止时间
+   */
+  void InstallApplications(Time start, Time stop);
+
+  /**
+   * \brief 获取交换机节点（按层序排列，第0个为根）
+   * \return 交换机节点容器
+   */
+  NodeContainer GetSwitchNodes() const;
+
+  /**
+   * \brief 获取主机节点
+   * \return 主机节点容器
+   */
+  NodeContainer GetHostNodes() const;
+
+  /**
+   * \brief 获取主机的IP地址
+   * \param index 主机序号
+   * \return 主机到叶交换机链路上的地址
+   */
+  Ipv4Address GetHostAddress(uint32_t index) const;
+
+  /**
+   * \brief 获取本rank上安装的主机协议栈
+   * \return 协议栈列表
+   */
+  std::vector<Ptr<IncStack>> GetLocalStacks() const;
+
+  /**
+   * \brief 获取本rank上安装的交换机
+   * \return 交换机列表
+   */
+  std::vector<Ptr<IncSwitch>> GetLocalSwitches() const;
+
+  /**
+   * \brief 获取跨越分区的链路数
+   * \return 链路数
+   */
+  uint32_t GetCrossPartitionLinkCount() const;
+
+  /**
+   * \brief 计算交换机所属的分区
+   * \param level 交换机所在层
+   * \param index 交换机在该层中的序号
+   * \return 分区号（系统ID）
+   */
+  uint32_t GetSwitchPartition(uint32_t level, uint32_t index) const;
+
+  /**
+   * \brief 计算主机所属的分区
+   * \param index 主机序号
+   * \return 分区号（系统ID）
+   */
+  uint32_t GetHostPartition(uint32_t index) const;
+
+private:
+  // 树中的一条链路，父节点为设备0，子节点为设备1
+  struct TreeLink {
+    uint32_t parent;        // 父交换机序号
+    Ptr<Node> child;        // 子节点（交换机或主机）
+    uint16_t parentQP;      // 父节点端的QP
+    uint16_t childQP;       // 子节点端的QP
+    Ipv4InterfaceContainer interfaces;  // 链路两端的地址
+  };
+
+  /**
+   * \brief 计算第level层的节点数
+   * \param level 层号
+   * \return 节点数
+   */
+  uint32_t GetLevelSize(uint32_t level) const;
+
+  /**
+   * \brief 计算子树划分所在的层
+   * \return 层号（depth表示按主机划分）
+   */
+  uint32_t GetPartitionLevel() const;
+
+  /**
+   * \brief 计算划分层上的子树所属的分区
+   * \param subtree 子树序号
+   * \return 分区号
+   */
+  uint32_t GetSubtreePartition(uint32_t subtree) const;
+
+  uint32_t m_fanOut;              //!< 每个交换机的子节点数
+  uint32_t m_depth;               //!< 交换机层数
+  uint32_t m_partitions;          //!< 分区数
+  uint16_t m_groupId;             //!< 通信组ID
+  uint16_t m_arraySize;           //!< 交换机数组大小
+  uint16_t m_payloadSize;         //!< 数据报文载荷大小
+  uint16_t m_sparseCells;         //!< 稀疏聚合单元数，0表示稠密模式
+
+  PointToPointHelper m_p2p;       //!< 链路帮助类
+  ObjectFactory m_stackFactory;   //!< 主机协议栈工厂
+  ObjectFactory m_switchFactory;  //!< 交换机工厂
+
+  NodeContainer m_switchNodes;    //!< 交换机节点，按层序排列
+  NodeContainer m_hostNodes;      //!< 主机节点
+  std::vector<TreeLink> m_switchLinks;  //!< 交换机之间的链路，第i条的子节点为交换机i+1
+  std::vector<TreeLink> m_hostLinks;    //!< 交换机到主机的链路，第i条的子节点为主机i
+
+  std::vector<Ptr<IncStack>> m_localStacks;     //!< 本rank上的主机协议栈
+  std::vector<Ptr<IncSwitch>> m_localSwitches;  //!< 本rank上的交换机
+};
+
+} // namespace ns3
+
+#endif /* INC_TREE_HELPER_H */
@@ -0,0 +1,278 @@
+/*
+ * 在网计算协议 - 交换机故障回退控制器实现
+ */
+
+#include "inc-fallback-controller.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/trace-source-accessor.h"
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("IncFallbackController");
+
+NS_OBJECT_ENSURE_REGISTERED(IncFallbackController);
+
+TypeId
+IncFallbackController::GetTypeId()
+{
+  static TypeId tid =
+      TypeId("ns3::IncFallbackController")
+          .SetParent<Object>()
+          .SetGroupName("Applications")
+          .AddConstructor<IncFallbackController>()
+          .AddAttribute("NotifyDelay",
+                        "控制器收到故障上报后向组内主机下发通知的时延",
+                        TimeValue(MilliSeconds(1)),
+                        MakeTimeAccessor(&IncFallbackController::m_notifyDelay),
+                        MakeTimeChecker())
+          .AddAttribute("SetupTime",
+                        "Ring回退建立连接后开始传输前的等待时间",
+                        TimeValue(MilliSeconds(100)),
+                        MakeTimeAccessor(&IncFallbackController::m_setupTime),
+                        MakeTimeChecker())
+          .AddAttribute("RingPort",
+                        "Ring回退监听端口",
+                        UintegerValue(9000),
+                        MakeUintegerAccessor(&IncFallbackController::m_ringPort),
+                        MakeUintegerChecker<uint16_t>())
+          .AddAttribute("PayloadSize",
+                        "Ring回退报文净荷大小",
+                        UintegerValue(1024),
+                        MakeUintegerAccessor(&IncFallbackController::m_payloadSize),
+                        MakeUintegerChecker<uint32_t>())
+          .AddAttribute("RcwndSize",
+                        "Ring回退TCP接收窗口大小",
+                        UintegerValue(2 * 1024 * 1024),
+                        MakeUintegerAccessor(&IncFallbackController::m_rcwndSize),
+                        MakeUintegerChecker<uint32_t>())
+          .AddAttribute("PacketInterval",
+                        "Ring回退发包时间间隔(毫秒)",
+                        DoubleValue(0.01),
+                        MakeDoubleAccessor(&IncFallbackController::m_packetInterval),
+                        MakeDoubleChecker<double>(0.0))
+          .AddTraceSource("FallbackStarted",
+                        "启动Ring回退，参数为起始PSN和报文数",
+                        MakeTraceSourceAccessor(&IncFallbackController::m_fallbackTrace),
+                        "ns3::IncFallbackController::FallbackTracedCallback");
+  return tid;
+}
+
+IncFallbackController::IncFallbackController()
+    : m_notifyDelay(MilliSeconds(1)),
+      m_setupTime(MilliSeconds(100)),
+      m_ringPort(9000),
+      m_payloadSize(1024),
+      m_rcwndSize(2 * 1024 * 1024),
+      m_packetInterval(0.01),
+      m_failureReported(false),
+      m_fallbackStarted(false),
+      m_startPsn(0),
+      m_remainingPackets(0),
+      m_pendingHosts(0),
+      m_fallbackCount(0)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+IncFallbackController::~IncFallbackController()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+IncFallbackController::DoDispose()
+{
+  NS_LOG_FUNCTION(this);
+  m_hosts.clear();
+  Object::DoDispose();
+}
+
+void
+IncFallbackController::AddHost(Ptr<IncStack> stack, Ipv4Address ringAddress)
+{
+  NS_LOG_FUNCTION(this << stack << ringAddress);
+
+  HostEntry entry;
+  entry.stack = stack;
+  entry.ringAddress = ringAddress;
+  entry.ring = nullptr;
+  m_hosts.push_back(entry);
+
+  // 任一主机检测到故障即上报控制器
+  stack->SetFailureCallback(MakeCallback(&IncFallbackController::HandleStackFailure, this));
+}
+
+bool
+IncFallbackController::IsFallbackStarted() const
+{
+  return m_fallbackStarted || m_fallbackCount > 0;
+}
+
+uint32_t
+IncFallbackController::GetFallbackCount() const
+{
+  return m_fallbackCount;
+}
+
+uint32_t
+IncFallbackController::GetFallbackStartPsn() const
+{
+  return m_startPsn;
+}
+
+Ptr<RingApplication>
+IncFallbackController::GetRingApplication(uint32_t index) const
+{
+  NS_ASSERT(index < m_hosts.size());
+  return m_hosts[index].ring;
+}
+
+void
+IncFallbackController::HandleStackFailure(uint32_t firstPsn)
+{
+  NS_LOG_FUNCTION(this << firstPsn);
+
+  if (m_failureReported)
+  {
+    return;
+  }
+  m_failureReported = true;
+
+  NS_LOG_WARN("控制器收到交换机故障上报，第一个未完成PSN=" << firstPsn
+              << "，" << m_notifyDelay.As(Time::MS) << " 后通知组内所有主机");
+  Simulator::Schedule(m_notifyDelay, &IncFallbackController::StartRingFallback, this);
+}
+
+void
+IncFallbackController::StartRingFallback()
+{
+  NS_LOG_FUNCTION(this);
+
+  if (m_fallbackStarted || m_hosts.empty())
+  {
+    return;
+  }
+  m_fallbackStarted = true;
+
+  // 下发故障通知，并取所有主机中最小的未完成PSN作为回退起点
+  uint32_t numHosts = m_hosts.size();
+  uint32_t totalPackets = m_hosts[0].stack->GetTotalPackets();
+  IncHeader::Operation op = m_hosts[0].stack->GetOperation();
+  m_startPsn = totalPackets;
+  for (auto& host : m_hosts)
+  {
+    // Ring只能携带稠密数据，稀疏或自定义操作的AllReduce无法给出正确结果
+    NS_ABORT_MSG_IF(host.stack->IsSparse(),
+                    host.stack->GetServerId() << ": 稀疏AllReduce不支持Ring回退");
+    NS_ABORT_MSG_IF(host.stack->GetOperation() != op || op == IncHeader::CUSTOM,
+                    host.stack->GetServerId() << ": 操作类型 " << static_cast<uint32_t>(op)
+                    << " 不支持Ring回退或组内不一致");
+    NS_ABORT_MSG_IF(host.stack->GetTotalPackets() != totalPackets,
+                    host.stack->GetServerId() << ": 组内主机的报文数不一致");
+    host.stack->NotifySwitchFailure();
+    m_startPsn = std::min(m_startPsn, host.stack->GetFirstIncompletePsn());
+  }
+  m_remainingPackets = totalPackets - m_startPsn;
+  m_pendingHosts = numHosts;
+
+  m_fallbackTrace(m_startPsn, m_remainingPackets);
+
+  if (m_remainingPackets == 0 || numHosts < 2)
+  {
+    NS_LOG_WARN("无需Ring回退，剩余报文数=" << m_remainingPackets << " 主机数=" << numHosts);
+    for (auto& host : m_hosts)
+    {
+      std::vector<int32_t> result;
+      if (m_remainingPackets > 0)
+      {
+        // 单主机的归约结果即本地数据（AVERAGE除以1不变）
+        const std::vector<int32_t>& data = host.stack->GetSendBuffer();
+        result.assign(data.begin() + m_startPsn, data.end());
+      }
+      host.stack->CompleteWithFallback(m_startPsn, result);
+    }
+    FinishFallback();
+    return;
+  }
+
+  NS_LOG_WARN("启动Ring回退: 起始PSN=" << m_startPsn << " 剩余报文数=" << m_remainingPackets
+              << " 主机数=" << numHosts);
+
+  // Ring连接在第一次回退时建立，之后复用
+  bool connected = (m_hosts[0].ring != nullptr);
+  double transferStartTime = (Simulator::Now() + m_setupTime).GetSeconds();
+  for (uint32_t i = 0; i < numHosts; ++i)
+  {
+    HostEntry& host = m_hosts[i];
+    if (!connected)
+    {
+      // RingApplication要求报文数能被节点数整除，SetInputData会按实际数据重新计算
+      Ptr<RingApplication> ring = CreateObject<RingApplication>();
+      ring->SetListenConfig(host.ringAddress, m_ringPort);
+      ring->SetPeer(m_hosts[(i + 1) % numHosts].ringAddress, m_ringPort);
+      ring->Setup(i, numHosts, numHosts, m_payloadSize, m_rcwndSize, 10, 1,
+                  0.0, transferStartTime, m_packetInterval);
+      ring->SetKeepConnection(true);
+      ring->SetCompleteCallback(MakeCallback(&IncFallbackController::HandleRingComplete, this, i));
+      host.ring = ring;
+    }
+
+    // 以发送缓冲区中剩余PSN的真实数据作为Ring的输入
+    const std::vector<int32_t>& data = host.stack->GetSendBuffer();
+    host.ring->SetInputData(std::vector<int32_t>(data.begin() + m_startPsn, data.end()), op);
+
+    if (!connected)
+    {
+      // 应用在加入节点后立即启动
+      host.stack->GetNode()->AddApplication(host.ring);
+      host.ring->SetStartTime(Seconds(0));
+    }
+  }
+  if (connected)
+  {
+    // 复用已建立的连接，所有主机同时开始
+    for (auto& host : m_hosts)
+    {
+      host.ring->StartTransfer();
+    }
+  }
+}
+
+void
+IncFallbackController::HandleRingComplete(uint32_t index)
+{
+  NS_LOG_FUNCTION(this << index);
+
+  HostEntry& host = m_hosts[index];
+  const std::vector<int32_t>& ringResult = host.ring->GetResultBuffer();
+  std::vector<int32_t> result(ringResult.begin(), ringResult.begin() + m_remainingPackets);
+
+  NS_LOG_INFO("主机 " << host.stack->GetServerId() << " Ring回退完成");
+  host.stack->CompleteWithFallback(m_startPsn, result);
+
+  if (m_pendingHosts > 0 && --m_pendingHosts == 0)
+  {
+    FinishFallback();
+  }
+}
+
+void
+IncFallbackController::FinishFallback()
+{
+  NS_LOG_FUNCTION(this);
+
+  // 重置本次AllReduce的状态，同一组后续的AllReduce再次故障时可以重新回退
+  m_failureReported = false;
+  m_fallbackStarted = false;
+  m_pendingHosts = 0;
+  m_fallbackCount++;
+}
+
+} // namespace ns3
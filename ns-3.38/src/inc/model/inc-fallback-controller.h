@@ -0,0 +1,134 @@
+/*
+ * 在网计算协议 - 交换机故障回退控制器
+ */
+
+#ifndef INC_FALLBACK_CONTROLLER_H
+#define INC_FALLBACK_CONTROLLER_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-callback.h"
+#include <vector>
+#include "inc-stack.h"
+#include "ring-application.h"
+
+namespace ns3
+{
+
+/**
+ * \brief 交换机故障回退控制器
+ *
+ * 汇总各主机协议栈的交换机故障检测结果（重传次数超过阈值），
+ * 将故障通知下发给组内所有主机，并在主机之间建立基于TCP的Ring AllReduce，
+ * 由RingApplication完成剩余PSN范围的聚合，最后把结果写回各协议栈的接收缓冲区。
+ *
+ * Ring回退以各协议栈发送缓冲区中剩余PSN的数据作为输入，按协议栈的操作类型归约，
+ * 因此结果与在网聚合一致。稀疏AllReduce和自定义操作无法回退，检测到故障时直接终止仿真。
+ * Ring连接在第一次回退时建立并保持，同一组后续AllReduce再次故障时复用这些连接。
+ */
+class IncFallbackController : public Object
+{
+public:
+  /**
+   * \brief 获取类型ID
+   * \return 对象TypeId
+   */
+  static TypeId GetTypeId();
+  IncFallbackController();
+  ~IncFallbackController() override;
+
+  /**
+   * \brief 添加组内主机，添加顺序即Ring中的节点顺序
+   * \param stack 主机上的协议栈
+   * \param ringAddress 主机用于Ring回退的IP地址
+   */
+  void AddHost(Ptr<IncStack> stack, Ipv4Address ringAddress);
+
+  /**
+   * \brief 检查是否已启动过回退
+   * \return 如果当前或之前的AllReduce启动过回退返回true
+   */
+  bool IsFallbackStarted() const;
+
+  /**
+   * \brief 获取已完成的回退次数
+   * \return 所有主机都已补全结果的回退次数
+   */
+  uint32_t GetFallbackCount() const;
+
+  /**
+   * \brief 获取回退覆盖的起始PSN
+   * \return 起始PSN
+   */
+  uint32_t GetFallbackStartPsn() const;
+
+  /**
+   * \brief 获取主机上创建的Ring回退应用
+   * \param index 主机序号
+   * \return Ring应用指针，未启动回退时为空
+   */
+  Ptr<RingApplication> GetRingApplication(uint32_t index) const;
+
+  /**
+   * \brief 启动回退的跟踪回调签名
+   * \param startPsn 回退覆盖的起始PSN
+   * \param packets 回退覆盖的报文数
+   */
+  typedef void (*FallbackTracedCallback)(uint32_t startPsn, uint32_t packets);
+
+protected:
+  void DoDispose() override;
+
+private:
+  /**
+   * \brief 处理某个主机上报的交换机故障
+   * \param firstPsn 该主机第一个未完成的PSN
+   */
+  void HandleStackFailure(uint32_t firstPsn);
+
+  /**
+   * \brief 通知所有主机交换机故障并启动Ring回退
+   */
+  void StartRingFallback();
+
+  /**
+   * \brief 处理某个主机上的Ring回退完成
+   * \param index 主机序号
+   */
+  void HandleRingComplete(uint32_t index);
+
+  /**
+   * \brief 所有主机都已补全结果，允许同一组后续AllReduce再次回退
+   */
+  void FinishFallback();
+
+  // 组内主机信息
+  struct HostEntry {
+    Ptr<IncStack> stack;            // 主机协议栈
+    Ipv4Address ringAddress;        // Ring回退使用的地址
+    Ptr<RingApplication> ring;      // Ring回退应用
+  };
+
+  std::vector<HostEntry> m_hosts;   //!< 组内主机，按Ring顺序排列
+  Time m_notifyDelay;               //!< 控制器下发故障通知的时延
+  Time m_setupTime;                 //!< Ring连接建立到开始传输的间隔
+  uint16_t m_ringPort;              //!< Ring回退监听端口
+  uint32_t m_payloadSize;           //!< Ring回退报文净荷大小
+  uint32_t m_rcwndSize;             //!< Ring回退TCP接收窗口大小
+  double m_packetInterval;          //!< Ring回退发包间隔(毫秒)
+
+  bool m_failureReported;           //!< 本次AllReduce是否已有主机上报故障
+  bool m_fallbackStarted;           //!< 本次AllReduce是否已启动回退
+  uint32_t m_startPsn;              //!< 回退覆盖的起始PSN
+  uint32_t m_remainingPackets;      //!< 回退覆盖的报文数
+  uint32_t m_pendingHosts;          //!< 尚未完成回退的主机数
+  uint32_t m_fallbackCount;         //!< 已完成的回退次数
+
+  TracedCallback<uint32_t, uint32_t> m_fallbackTrace; //!< 启动回退跟踪，参数为起始PSN和报文数
+};
+
+} // namespace ns3
+
+#endif /* INC_FALLBACK_CONTROLLER_H */
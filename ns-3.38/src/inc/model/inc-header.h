@@ -35,6 +35,10 @@ public:
     CTRL = 0x08        // 控制器下发配置
   };
 
+  // 数据报文载荷大小（字节），由通信组协商，主机协议栈和交换机保持一致
+  static constexpr uint16_t DEFAULT_PAYLOAD_SIZE = 1024;  // 默认载荷大小
+  static constexpr uint16_t MAX_PAYLOAD_SIZE = 9000;      // 最大载荷大小（巨型帧）
+
   IncHeader();
   virtual ~IncHeader();
 
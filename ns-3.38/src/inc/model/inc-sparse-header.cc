@@ -0,0 +1,112 @@
+#include "inc-sparse-header.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("IncSparseHeader");
+NS_OBJECT_ENSURE_REGISTERED(IncSparseHeader);
+
+IncSparseHeader::IncSparseHeader()
+{
+}
+
+IncSparseHeader::~IncSparseHeader()
+{
+}
+
+TypeId
+IncSparseHeader::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::IncSparseHeader")
+        .SetParent<Header>()
+        .SetGroupName("Applications")
+        .AddConstructor<IncSparseHeader>();
+    return tid;
+}
+
+TypeId
+IncSparseHeader::GetInstanceTypeId() const
+{
+    return GetTypeId();
+}
+
+void
+IncSparseHeader::Print(std::ostream &os) const
+{
+    os << "entries=" << m_entries.size();
+    for (const auto& entry : m_entries)
+    {
+        os << " (" << entry.index << "," << entry.value << ")";
+    }
+}
+
+uint32_t
+IncSparseHeader::GetSerializedSize() const
+{
+    // 条目数(2 bytes) + 每个条目的索引(4 bytes)和值(4 bytes)
+    return 2 + 8 * m_entries.size();
+}
+
+void
+IncSparseHeader::Serialize(Buffer::Iterator start) const
+{
+    // 写入条目数
+    start.WriteHtonU16(static_cast<uint16_t>(m_entries.size()));
+
+    // 写入各个键值对
+    for (const auto& entry : m_entries)
+    {
+        start.WriteHtonU32(entry.index);
+        start.WriteHtonU32(static_cast<uint32_t>(entry.value));
+    }
+}
+
+uint32_t
+IncSparseHeader::Deserialize(Buffer::Iterator start)
+{
+    // 读取条目数
+    uint16_t count = start.ReadNtohU16();
+
+    // 读取各个键值对
+    m_entries.resize(count);
+    for (auto& entry : m_entries)
+    {
+        entry.index = start.ReadNtohU32();
+        entry.value = static_cast<int32_t>(start.ReadNtohU32());
+    }
+
+    return GetSerializedSize();
+}
+
+void
+IncSparseHeader::AddEntry(uint32_t index, int32_t value)
+{
+    NS_ASSERT_MSG(m_entries.size() < 0xFFFF, "键值对数目超出范围");
+    m_entries.push_back({index, value});
+}
+
+const std::vector<IncSparseHeader::Entry>&
+IncSparseHeader::GetEntries() const
+{
+    return m_entries;
+}
+
+uint32_t
+IncSparseHeader::GetNEntries() const
+{
+    return m_entries.size();
+}
+
+void
+IncSparseHeader::Clear()
+{
+    m_entries.clear();
+}
+
+uint32_t
+IncSparseHeader::GetMaxEntries(uint32_t payloadSize)
+{
+    return payloadSize > 2 ? (payloadSize - 2) / 8 : 0;
+}
+
+} // namespace ns3
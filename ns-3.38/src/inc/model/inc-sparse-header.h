@@ -0,0 +1,53 @@
+#ifndef INC_SPARSE_HEADER_H
+#define INC_SPARSE_HEADER_H
+
+#include "ns3/header.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief 稀疏聚合模式的键值对头部，紧跟在IncHeader之后
+ *
+ * 报文格式：条目数(2 bytes) + 条目数 × (索引(4 bytes) + 值(4 bytes))
+ */
+class IncSparseHeader : public Header
+{
+public:
+  // 稀疏梯度中的一个键值对
+  struct Entry {
+    uint32_t index;    // 在稠密张量中的下标
+    int32_t value;     // 值
+  };
+
+  IncSparseHeader();
+  virtual ~IncSparseHeader();
+
+  // 必须实现的Header类虚函数
+  static TypeId GetTypeId();
+  virtual TypeId GetInstanceTypeId() const;
+  virtual void Print(std::ostream &os) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize() const;
+
+  // 键值对操作
+  void AddEntry(uint32_t index, int32_t value);
+  const std::vector<Entry>& GetEntries() const;
+  uint32_t GetNEntries() const;
+  void Clear();
+
+  /**
+   * \brief 计算载荷大小可容纳的键值对数目
+   * \param payloadSize 载荷大小(字节)
+   * \return 键值对数目
+   */
+  static uint32_t GetMaxEntries(uint32_t payloadSize);
+
+private:
+  std::vector<Entry> m_entries;  // 键值对列表
+};
+
+} // namespace ns3
+
+#endif /* INC_SPARSE_HEADER_H */
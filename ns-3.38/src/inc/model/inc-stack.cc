@@ -4,6 +4,7 @@
 
 #include "inc-stack.h"
 #include "ns3/log.h"
+#include "ns3/binary-trace.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/inet-socket-address.h"
@@ -13,6 +14,9 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
 #include "inc-header.h"
 #include <string>
 
@@ -71,11 +75,21 @@ IncStack::GetTypeId()
                         UintegerValue(1024),
                         MakeUintegerAccessor(&IncStack::m_dataSize),
                         MakeUintegerChecker<uint32_t>())
+          .AddAttribute("PayloadSize",
+                        "数据报文载荷大小(字节)，需与交换机上的通信组配置一致",
+                        UintegerValue(IncHeader::DEFAULT_PAYLOAD_SIZE),
+                        MakeUintegerAccessor(&IncStack::m_payloadSize),
+                        MakeUintegerChecker<uint16_t>(1, IncHeader::MAX_PAYLOAD_SIZE))
           .AddAttribute("TotalPackets",
                         "发送数据包数目",
                         UintegerValue(3),
                         MakeUintegerAccessor(&IncStack::m_totalPackets),
                         MakeUintegerChecker<uint32_t>())    
+          .AddAttribute("MaxRetransmissions",
+                        "同一报文连续重传超过该次数即判定上游交换机故障，0表示不检测",
+                        UintegerValue(0),
+                        MakeUintegerAccessor(&IncStack::m_maxRetransmissions),
+                        MakeUintegerChecker<uint32_t>())
           .AddAttribute("WindowSize",
                         "滑动窗口大小",
                         UintegerValue(16),
@@ -92,7 +106,11 @@ IncStack::GetTypeId()
           .AddTraceSource("RxWithAddresses",
                         "接收数据包，包含地址信息",
                         MakeTraceSourceAccessor(&IncStack::m_rxTraceWithAddresses),
-                        "ns3::Packet::AddressTracedCallback");
+                        "ns3::Packet::AddressTracedCallback")
+          .AddTraceSource("SwitchFailure",
+                        "判定上游交换机故障，参数为第一个未完成的PSN",
+                        MakeTraceSourceAccessor(&IncStack::m_switchFailureTrace),
+                        "ns3::IncStack::SwitchFailureTracedCallback");
   return tid;
 }
 
@@ -101,21 +119,28 @@ IncStack::IncStack()
       m_operation(IncHeader::SUM),
       m_dataType(IncHeader::INT32),
       m_dataSize(1024),
+      m_payloadSize(IncHeader::DEFAULT_PAYLOAD_SIZE),
       m_fillValue(1),
       m_windowSize(16),
       m_localQP(1),
       m_remoteQP(1),
       m_port(9),
+      m_sparse(false),
+      m_sparseTensorSize(0),
       m_totalPackets(3),
+      m_psnBase(0),
+      m_nextPsnBase(0),
       m_nextPsn(0),
       m_windowBase(0),
       m_windowEnd(0),
       m_recvSocket(nullptr),
       m_sendSocket(nullptr),
+      m_maxRetransmissions(0),
       m_running(false),
       m_allReduceStarted(false),
       m_allReduceCompleted(false),
-      m_lastDataReceived(false)
+      m_lastDataReceived(false),
+      m_switchFailed(false)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -152,6 +177,12 @@ IncStack::SetOperation(IncHeader::Operation op)
   m_operation = op;
 }
 
+IncHeader::Operation
+IncStack::GetOperation() const
+{
+  return m_operation;
+}
+
 void
 IncStack::SetDataType(IncHeader::DataType dataType)
 {
@@ -166,6 +197,46 @@ IncStack::SetDataSize(uint32_t dataSize)
   m_dataSize = dataSize;
 }
 
+void
+IncStack::SetPayloadSize(uint16_t payloadSize)
+{
+  NS_LOG_FUNCTION(this << payloadSize);
+  NS_ABORT_MSG_IF(payloadSize == 0 || payloadSize > IncHeader::MAX_PAYLOAD_SIZE,
+                  "载荷大小 " << payloadSize << " 超出范围(1~" << IncHeader::MAX_PAYLOAD_SIZE << ")");
+  m_payloadSize = payloadSize;
+}
+
+uint16_t
+IncStack::GetPayloadSize() const
+{
+  return m_payloadSize;
+}
+
+uint16_t
+IncStack::GetMaxPayloadSize() const
+{
+  Ptr<Ipv4> ipv4 = GetNode() ? GetNode()->GetObject<Ipv4>() : nullptr;
+  if (!ipv4)
+  {
+    return IncHeader::MAX_PAYLOAD_SIZE;
+  }
+  int32_t interface = ipv4->GetInterfaceForAddress(m_localAddr);
+  if (interface < 0)
+  {
+    return IncHeader::MAX_PAYLOAD_SIZE;
+  }
+
+  // MTU减去IPv4头部(20B)、UDP头部(8B)和INC头部
+  IncHeader header;
+  uint32_t overhead = 20 + 8 + header.GetSerializedSize();
+  uint32_t mtu = ipv4->GetMtu(interface);
+  if (mtu <= overhead)
+  {
+    return 0;
+  }
+  return static_cast<uint16_t>(std::min<uint32_t>(mtu - overhead, IncHeader::MAX_PAYLOAD_SIZE));
+}
+
 void
 IncStack::SetFillValue(uint32_t value)
 {
@@ -202,6 +273,34 @@ IncStack::GetResultBuffer() const
   return m_recvBuffer;
 }
 
+const std::vector<int32_t>&
+IncStack::GetSendBuffer() const
+{
+  return m_sendBuffer;
+}
+
+bool
+IncStack::IsSparse() const
+{
+  return m_sparse;
+}
+
+void
+IncStack::SetSparseData(uint32_t tensorSize, const std::vector<IncSparseHeader::Entry>& entries)
+{
+  NS_LOG_FUNCTION(this << tensorSize << entries.size());
+  NS_ABORT_MSG_IF(tensorSize == 0, m_serverId << ": 稀疏张量大小不能为0");
+  m_sparse = true;
+  m_sparseTensorSize = tensorSize;
+  m_sparseInput = entries;
+}
+
+const std::vector<int32_t>&
+IncStack::GetSparseResult() const
+{
+  return m_sparseResult;
+}
+
 void
 IncStack::DoDispose()
 {
@@ -210,26 +309,7 @@ IncStack::DoDispose()
   m_sendSocket = nullptr;
   
   // 取消所有事件
-  if (m_sendEvent.IsRunning())
-  {
-    m_sendEvent.Cancel();
-  }
-  
-  // 取消循环发送事件
-  if (m_circleSendEvent.IsRunning())
-  {
-    m_circleSendEvent.Cancel();
-  }
-  
-  // 取消所有报文重传事件
-  for (auto it = m_retransmitEvents.begin(); it != m_retransmitEvents.end(); ++it)
-  {
-    if (it->second.IsRunning())
-    {
-      it->second.Cancel();
-    }
-  }
-  m_retransmitEvents.clear();
+  CancelAllEvents();
   
   Application::DoDispose();
 }
@@ -300,26 +380,7 @@ IncStack::StopApplication()
   }
   
   // 取消所有事件
-  if (m_sendEvent.IsRunning())
-  {
-    m_sendEvent.Cancel();
-  }
-  
-  // 取消循环发送事件
-  if (m_circleSendEvent.IsRunning())
-  {
-    m_circleSendEvent.Cancel();
-  }
-  
-  // 取消所有报文重传事件
-  for (auto it = m_retransmitEvents.begin(); it != m_retransmitEvents.end(); ++it)
-  {
-    if (it->second.IsRunning())
-    {
-      it->second.Cancel();
-    }
-  }
-  m_retransmitEvents.clear();
+  CancelAllEvents();
 }
 
 void
@@ -329,6 +390,12 @@ IncStack::SetTotalPackets(uint32_t totalPackets)
   m_totalPackets = totalPackets;
 }
 
+uint32_t
+IncStack::GetTotalPackets() const
+{
+  return m_totalPackets;
+}
+
 void
 IncStack::SetCompleteCallback(CompleteCallback callback)
 {
@@ -342,12 +409,125 @@ IncStack::IsCompleted() const
   return m_allReduceCompleted;
 }
 
+void
+IncStack::SetFailureCallback(FailureCallback callback)
+{
+  NS_LOG_FUNCTION(this);
+  m_failureCallback = callback;
+}
+
+bool
+IncStack::IsSwitchFailed() const
+{
+  return m_switchFailed;
+}
+
+uint32_t
+IncStack::GetFirstIncompletePsn() const
+{
+  for (uint32_t psn = 0; psn < m_dataReceived.size(); ++psn)
+  {
+    if (!m_dataReceived[psn])
+    {
+      return psn;
+    }
+  }
+  return m_dataReceived.size();
+}
+
+void
+IncStack::NotifySwitchFailure()
+{
+  NS_LOG_FUNCTION(this);
+  
+  if (m_switchFailed || m_allReduceCompleted)
+  {
+    return;
+  }
+  
+  m_switchFailed = true;
+  uint32_t firstPsn = GetFirstIncompletePsn();
+  NS_LOG_WARN(m_serverId << ": 判定上游交换机故障，停止在网聚合，第一个未完成PSN=" << firstPsn);
+  
+  // 停止在网聚合的发送和重传，已收到的聚合结果保留在接收缓冲区中
+  CancelAllEvents();
+  
+  m_switchFailureTrace(firstPsn);
+  if (!m_failureCallback.IsNull())
+  {
+    m_failureCallback(firstPsn);
+  }
+}
+
+void
+IncStack::CompleteWithFallback(uint32_t startPsn, const std::vector<int32_t>& result)
+{
+  NS_LOG_FUNCTION(this << startPsn << result.size());
+  
+  if (m_allReduceCompleted)
+  {
+    return;
+  }
+  
+  for (uint32_t i = 0; i < result.size() && startPsn + i < m_totalPackets; ++i)
+  {
+    m_recvBuffer[startPsn + i] = result[i];
+    m_dataReceived[startPsn + i] = true;
+  }
+  
+  NS_LOG_INFO(m_serverId << ": 回退路径补全PSN " << startPsn << " 之后的结果");
+  FinishAllReduce();
+}
+
+void
+IncStack::FinishAllReduce()
+{
+  NS_LOG_FUNCTION(this);
+  
+  NS_LOG_INFO(m_serverId << ": AllReduce操作完成");
+  m_allReduceCompleted = true;
+  
+  // 调用完成回调
+  if (!m_completeCallback.IsNull())
+  {
+    NS_LOG_INFO(m_serverId << ": 触发完成回调");
+    m_completeCallback();
+  }
+}
+
+void
+IncStack::CancelAllEvents()
+{
+  NS_LOG_FUNCTION(this);
+  
+  if (m_sendEvent.IsRunning())
+  {
+    m_sendEvent.Cancel();
+  }
+  
+  // 取消循环发送事件
+  if (m_circleSendEvent.IsRunning())
+  {
+    m_circleSendEvent.Cancel();
+  }
+  
+  // 取消所有报文重传事件
+  for (auto it = m_retransmitEvents.begin(); it != m_retransmitEvents.end(); ++it)
+  {
+    if (it->second.IsRunning())
+    {
+      it->second.Cancel();
+    }
+  }
+  m_retransmitEvents.clear();
+}
+
 void
 IncStack::AllReduce()
 {
   NS_LOG_FUNCTION(this);
   
-  if (!m_running || m_allReduceStarted)
+  if (!m_running || (m_allReduceStarted && !m_allReduceCompleted))
   {
     NS_LOG_WARN(m_serverId << ": 无法启动AllReduce，协议栈未运行或已有运行中的AllReduce");
     return;
@@ -357,28 +537,55 @@ IncStack::AllReduce()
   m_allReduceStarted = true;
   m_allReduceCompleted = false;
   m_lastDataReceived = false;
+  m_switchFailed = false;
   
+  // 载荷超过MTU会导致IP分片，报文丢失时整组重传，直接视为配置错误
+  NS_ABORT_MSG_IF(m_payloadSize > GetMaxPayloadSize(),
+                  m_serverId << ": 载荷大小 " << m_payloadSize << " 超过本地接口MTU允许的 "
+                  << GetMaxPayloadSize() << " 字节，请增大设备的Mtu属性");
+
+  if (m_sparse)
+  {
+    // 稀疏模式：按块划分张量，块大小为一个报文可容纳的键值对数，交换机合并后的结果也不会超过载荷
+    NS_ABORT_MSG_IF(m_operation != IncHeader::SUM, m_serverId << ": 稀疏AllReduce只支持SUM操作");
+    uint32_t blockSize = IncSparseHeader::GetMaxEntries(m_payloadSize);
+    NS_ABORT_MSG_IF(blockSize == 0, m_serverId << ": 载荷大小 " << m_payloadSize << " 无法容纳键值对");
+    m_totalPackets = (m_sparseTensorSize + blockSize - 1) / blockSize;
+    m_sparseSendBuffer.assign(m_totalPackets, IncSparseHeader());
+    for (const auto& entry : m_sparseInput)
+    {
+      NS_ABORT_MSG_IF(entry.index >= m_sparseTensorSize,
+                      m_serverId << ": 稀疏索引 " << entry.index << " 超出张量大小 " << m_sparseTensorSize);
+      m_sparseSendBuffer[entry.index / blockSize].AddEntry(entry.index, entry.value);
+    }
+    m_sparseResult.assign(m_sparseTensorSize, 0);
+  }
   // -只有在未设置总报文数时才计算
-  if (m_totalPackets == 0)
+  else if (m_totalPackets == 0)
   {
-    // 计算总报文数量，每个报文载荷固定为1024B
-    m_totalPackets = m_dataSize / 1024;
-    if (m_dataSize % 1024 != 0)
+    // 计算总报文数量，每个报文载荷为m_payloadSize
+    m_totalPackets = m_dataSize / m_payloadSize;
+    if (m_dataSize % m_payloadSize != 0)
     {
       m_totalPackets++;
     }
   }
   
+  // 本次AllReduce占用线路上连续的一段PSN，交换机槽位的聚合号随之推进
+  m_psnBase = m_nextPsnBase;
+  m_nextPsnBase = m_psnBase + m_totalPackets;
+  
   // 初始化发送缓冲区
-  m_sendBuffer.resize(m_totalPackets, m_fillValue);
+  m_sendBuffer.assign(m_totalPackets, m_fillValue);
   
   // 初始化接收缓冲区
-  m_recvBuffer.resize(m_totalPackets, 0);
+  m_recvBuffer.assign(m_totalPackets, 0);
   
   // 初始化状态数组
-  m_ackReceived.resize(m_totalPackets, false);
-  m_dataReceived.resize(m_totalPackets, false);
-  m_inFlight.resize(m_totalPackets, false);
+  m_ackReceived.assign(m_totalPackets, false);
+  m_dataReceived.assign(m_totalPackets, false);
+  m_inFlight.assign(m_totalPackets, false);
+  m_retransmitCount.assign(m_totalPackets, 0);
   
   // 清空重传事件映射
   for (auto it = m_retransmitEvents.begin(); it != m_retransmitEvents.end(); ++it)
@@ -409,13 +616,14 @@ IncStack::HandleRead(Ptr<Socket> socket)
   
   while ((packet = socket->RecvFrom(from)))
   {
-    //NS_LOG_INFO(m_serverId << ": 接收到数据包，包体大小=" << packet->GetSize());
     m_rxTrace(packet);
     m_rxTraceWithAddresses(packet, from);
     
     // 获取并移除头部
     IncHeader header;
     packet->RemoveHeader(header);
+    NS_TRACE_EVENT("接收报文 PSN={} 标志={} 大小={}",
+                   header.GetPsn(), header.GetFlags(), packet->GetSize());
     
     if (header.HasFlag(IncHeader::ACK))
     {
@@ -435,17 +643,9 @@ IncStack::HandleRead(Ptr<Socket> socket)
     }
     
     // 检查AllReduce是否完成
-    if (m_allReduceStarted && !m_allReduceCompleted && IsAllReduceComplete())
+    if (m_allReduceStarted && !m_allReduceCompleted && !m_switchFailed && IsAllReduceComplete())
     {
-      NS_LOG_INFO(m_serverId << ": AllReduce操作完成");
-      m_allReduceCompleted = true;
-      
-      // 调用完成回调
-      if (!m_completeCallback.IsNull())
-      {
-        NS_LOG_INFO(m_serverId << ": 触发完成回调");
-        m_completeCallback();
-      }
+      FinishAllReduce();
     }
   }
 }
@@ -462,7 +662,14 @@ IncStack::SendData(uint32_t psn)
   }
   
   // 创建要发送的数据报文，使用ns3 packet的默认构造，仅用来填充数据包至预期大小
-  Ptr<Packet> packet = Create<Packet>(1024); // 默认包大小1024B
+  // 稀疏模式下载荷为本块内的键值对
+  Ptr<Packet> packet = Create<Packet>(m_sparse ? 0 : m_payloadSize);
+  uint32_t payloadSize = m_payloadSize;
+  if (m_sparse)
+  {
+    packet->AddHeader(m_sparseSendBuffer[psn]);
+    payloadSize = m_sparseSendBuffer[psn].GetSerializedSize();
+  }
   
   // 创建头部
   IncHeader header;
@@ -470,11 +677,11 @@ IncStack::SendData(uint32_t psn)
   header.SetDstAddr(m_remoteAddr);
   header.SetSrcQP(m_localQP);
   header.SetDstQP(m_remoteQP);
-  header.SetPsn(psn);
+  header.SetPsn(m_psnBase + psn);
   header.SetOperation(m_operation);
   header.SetDataType(m_dataType);
   header.SetGroupId(m_groupId);
-  header.SetLength(header.GetSerializedSize() + 1024); // 头部大小 + 载荷大小
+  header.SetLength(header.GetSerializedSize() + payloadSize); // 头部大小 + 载荷大小
   
   // 设置agg_data_test字段，用m_sendBuffer中的值
   header.SetAggDataTest(m_sendBuffer[psn]);
@@ -511,7 +718,7 @@ IncStack::CircleSend()
 {
   NS_LOG_FUNCTION(this);
   
-  if (!m_running) {
+  if (!m_running || m_switchFailed) {
     return;
   }
   
@@ -569,7 +776,7 @@ IncStack::ScheduleSendPacket(uint32_t psn)
     return;
   }
   
-  if (!m_running || m_ackReceived[psn])
+  if (!m_running || m_switchFailed || m_ackReceived[psn])
   {
     return;
   }
@@ -608,8 +815,16 @@ IncStack::RetransmitPacket(uint32_t psn)
 {
   NS_LOG_FUNCTION(this << psn);
   
-  if (psn >= m_totalPackets || !m_running || m_ackReceived[psn])
+  if (psn >= m_totalPackets || !m_running || m_switchFailed || m_ackReceived[psn])
+  {
+    return;
+  }
+  
+  // 连续重传次数超过阈值，判定上游交换机故障
+  if (m_maxRetransmissions > 0 && ++m_retransmitCount[psn] > m_maxRetransmissions)
   {
+    NS_LOG_WARN(m_serverId << ": 报文 PSN=" << psn << " 重传次数超过 " << m_maxRetransmissions);
+    NotifySwitchFailure();
     return;
   }
   
@@ -641,11 +856,19 @@ IncStack::ProcessDataPacket(Ptr<Packet> packet, const IncHeader& header)
 {
   NS_LOG_FUNCTION(this);
   
+  // 之前AllReduce的重传结果，说明交换机未收到ACK，回复ACK使其释放槽位
+  if (header.GetPsn() < m_psnBase)
+  {
+    NS_LOG_INFO(m_serverId << ": 接收到之前AllReduce的数据报文 PSN=" << header.GetPsn());
+    SendAck(header, header.GetAggDataTest());
+    return;
+  }
+  
   // 检查是否在报文范围内
-  uint32_t psn = header.GetPsn();
+  uint32_t psn = header.GetPsn() - m_psnBase;
   if (psn >= m_totalPackets)
   {
-    NS_LOG_WARN(m_serverId << ": 接收到超出范围的数据报文 PSN=" << psn);
+    NS_LOG_WARN(m_serverId << ": 接收到超出范围的数据报文 PSN=" << header.GetPsn());
     return;
   }
   
@@ -664,6 +887,20 @@ IncStack::ProcessDataPacket(Ptr<Packet> packet, const IncHeader& header)
   m_recvBuffer[psn] = aggDataTest;
   m_dataReceived[psn] = true;
   
+  // 稀疏模式：将聚合后的键值对写回稠密结果
+  if (m_sparse)
+  {
+    IncSparseHeader sparse;
+    packet->RemoveHeader(sparse);
+    for (const auto& entry : sparse.GetEntries())
+    {
+      if (entry.index < m_sparseTensorSize)
+      {
+        m_sparseResult[entry.index] += entry.value;
+      }
+    }
+  }
+  
   // 检查是否是最后一个数据包
   if (psn == m_totalPackets - 1)
   {
@@ -681,12 +918,13 @@ IncStack::ProcessAckPacket(Ptr<Packet> packet, const IncHeader& header)
 {
   NS_LOG_FUNCTION(this);
   
-  uint32_t psn = header.GetPsn();
+  // 线路上的PSN减去本次AllReduce的起始PSN，之前AllReduce的报文回绕后超出范围
+  uint32_t psn = header.GetPsn() - m_psnBase;
   
   // 检查是否是有效PSN
   if (psn >= m_totalPackets)
   {
-    NS_LOG_WARN(m_serverId << ": 接收到超出范围的ACK报文 PSN=" << psn);
+    NS_LOG_WARN(m_serverId << ": 接收到超出范围的ACK报文 PSN=" << header.GetPsn());
     return;
   }
   
@@ -708,7 +946,7 @@ IncStack::ProcessAckPacket(Ptr<Packet> packet, const IncHeader& header)
   }
   
   // 检查是否可以移动窗口
-  while (m_ackReceived[m_windowBase] && m_windowBase < m_totalPackets)
+  while (m_windowBase < m_totalPackets && m_ackReceived[m_windowBase])
   {
     m_windowBase++;
     
@@ -731,12 +969,12 @@ IncStack::ProcessNakPacket(Ptr<Packet> packet, const IncHeader& header)
 {
   NS_LOG_FUNCTION(this);
   
-  uint32_t psn = header.GetPsn();
+  uint32_t psn = header.GetPsn() - m_psnBase;
   
   // 检查是否是有效PSN
   if (psn >= m_totalPackets)
   {
-    NS_LOG_WARN(m_serverId << ": 接收到超出范围的NAK报文 PSN=" << psn);
+    NS_LOG_WARN(m_serverId << ": 接收到超出范围的NAK报文 PSN=" << header.GetPsn());
     return;
   }
   
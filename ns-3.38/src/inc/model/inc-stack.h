@@ -17,6 +17,7 @@
 #include <vector>
 #include <map>
 #include "inc-header.h"
+#include "inc-sparse-header.h"
 #include "ns3/callback.h"
 
 namespace ns3
@@ -62,6 +63,12 @@ public:
    */
   void SetOperation(IncHeader::Operation op);
 
+  /**
+   * \brief 获取操作类型
+   * \return 操作类型
+   */
+  IncHeader::Operation GetOperation() const;
+
   /**
    * \brief 设置数据类型
    * \param dataType 数据类型
@@ -74,6 +81,24 @@ public:
    */
   void SetDataSize(uint32_t dataSize);
 
+  /**
+   * \brief 设置数据报文的载荷大小
+   * \param payloadSize 载荷大小(字节)，不超过IncHeader::MAX_PAYLOAD_SIZE，需与交换机上的通信组配置一致
+   */
+  void SetPayloadSize(uint16_t payloadSize);
+
+  /**
+   * \brief 获取数据报文的载荷大小
+   * \return 载荷大小(字节)
+   */
+  uint16_t GetPayloadSize() const;
+
+  /**
+   * \brief 获取本地接口MTU允许的最大载荷大小
+   * \return 最大载荷大小(字节)，尚未配置本地地址时返回IncHeader::MAX_PAYLOAD_SIZE
+   */
+  uint16_t GetMaxPayloadSize() const;
+
   /**
    * \brief 设置填充数据的值(int32_t)
    * \param value 要填充的值
@@ -106,8 +131,39 @@ public:
    */
   const std::vector<int32_t>& GetResultBuffer() const;
 
+  /**
+   * \brief 获取本次AllReduce的发送缓冲区
+   * \return 发送缓冲区的引用，sendBuffer[i]为PSN i携带的本地数据
+   */
+  const std::vector<int32_t>& GetSendBuffer() const;
+
+  /**
+   * \brief 检查是否为稀疏AllReduce
+   * \return 如果已通过SetSparseData开启稀疏模式返回true
+   */
+  bool IsSparse() const;
+
+  /**
+   * \brief 设置稀疏输入，开启稀疏（键值对）AllReduce，需在AllReduce之前调用
+   *
+   * 张量按GetMaxEntries(载荷大小)个元素划分为块，每个PSN携带一块内的非零元素，
+   * 因此总报文数由张量大小决定，TotalPackets属性不再生效。只支持SUM操作。
+   * \param tensorSize 稠密张量的元素数
+   * \param entries 非零元素的键值对，索引需小于tensorSize
+   */
+  void SetSparseData(uint32_t tensorSize, const std::vector<IncSparseHeader::Entry>& entries);
+
+  /**
+   * \brief 获取稀疏AllReduce的结果
+   * \return 稠密张量形式的聚合结果，大小为tensorSize
+   */
+  const std::vector<int32_t>& GetSparseResult() const;
+
   /**
    * \brief 执行AllReduce操作
+   *
+   * 上一次AllReduce完成后可再次调用，每次AllReduce的报文数由TotalPackets（为0时由DataSize）决定，
+   * 报文序列号在多次AllReduce之间连续递增，与交换机上的聚合号保持一致
    */
   void AllReduce();
 
@@ -117,6 +173,12 @@ public:
    */
   void SetTotalPackets(uint32_t totalPackets);
 
+  /**
+   * \brief 获取总数据包数
+   * \return 总数据包数
+   */
+  uint32_t GetTotalPackets() const;
+
   /**
    * \brief 回调函数类型定义，用于AllReduce操作完成通知
    */
@@ -134,6 +196,49 @@ public:
    */
   bool IsCompleted() const;
 
+  /**
+   * \brief 交换机故障的跟踪回调签名
+   * \param firstPsn 第一个尚未收到聚合结果的PSN
+   */
+  typedef void (*SwitchFailureTracedCallback)(uint32_t firstPsn);
+
+  /**
+   * \brief 交换机故障回调函数类型定义，参数为第一个尚未收到聚合结果的PSN
+   */
+  typedef Callback<void, uint32_t> FailureCallback;
+
+  /**
+   * \brief 设置交换机故障回调函数
+   * \param callback 检测到交换机故障时调用的回调函数
+   */
+  void SetFailureCallback(FailureCallback callback);
+
+  /**
+   * \brief 通知协议栈上游交换机已失效（来自重传计数检测或控制器下发）
+   *
+   * 停止在网聚合的发送与重传，保留已收到的聚合结果，等待回退路径补全剩余PSN
+   */
+  void NotifySwitchFailure();
+
+  /**
+   * \brief 检查是否已判定交换机故障
+   * \return 如果已判定故障返回true
+   */
+  bool IsSwitchFailed() const;
+
+  /**
+   * \brief 获取第一个尚未收到聚合结果的PSN
+   * \return PSN，全部收到时返回总报文数
+   */
+  uint32_t GetFirstIncompletePsn() const;
+
+  /**
+   * \brief 用回退路径（如Ring AllReduce）的结果补全剩余PSN并完成AllReduce
+   * \param startPsn 回退结果对应的起始PSN
+   * \param result 回退路径得到的聚合结果，result[i]对应PSN startPsn+i
+   */
+  void CompleteWithFallback(uint32_t startPsn, const std::vector<int32_t>& result);
+
 protected:
   void DoDispose() override;
 
@@ -210,11 +315,22 @@ private:
    */
   void RetransmitPacket(uint32_t psn);
 
+  /**
+   * \brief 取消所有发送和重传事件
+   */
+  void CancelAllEvents();
+
+  /**
+   * \brief 标记AllReduce完成并触发完成回调
+   */
+  void FinishAllReduce();
+
   std::string m_serverId;             //!< 服务器标识符
   uint16_t m_groupId;                 //!< 通信组ID
   IncHeader::Operation m_operation;   //!< 操作类型
   IncHeader::DataType m_dataType;     //!< 数据类型
   uint32_t m_dataSize;                //!< 数据大小(字节)
+  uint16_t m_payloadSize;             //!< 数据报文载荷大小(字节)
   uint32_t m_fillValue;               //!< 填充值
   uint16_t m_windowSize;              //!< 滑动窗口大小
 
@@ -230,7 +346,15 @@ private:
   std::vector<bool> m_dataReceived;   //!< 数据接收状态
   std::vector<bool> m_inFlight;       //!< 标记报文是否在传输中
 
+  bool m_sparse;                      //!< 是否为稀疏AllReduce
+  uint32_t m_sparseTensorSize;        //!< 稀疏模式下稠密张量的元素数
+  std::vector<IncSparseHeader::Entry> m_sparseInput; //!< 稀疏模式的输入键值对
+  std::vector<IncSparseHeader> m_sparseSendBuffer;   //!< 稀疏模式的发送缓冲区，每个PSN一块
+  std::vector<int32_t> m_sparseResult; //!< 稀疏模式的聚合结果（稠密形式）
+
   uint32_t m_totalPackets;            //!< 总报文数
+  uint32_t m_psnBase;                 //!< 本次AllReduce第一个报文在线路上的PSN
+  uint32_t m_nextPsnBase;             //!< 下一次AllReduce第一个报文在线路上的PSN
   uint32_t m_nextPsn;                 //!< 下一个发送的序列号
   uint32_t m_windowBase;              //!< 当前窗口的基础位置
   uint32_t m_windowEnd;               //!< 当前窗口的结束位置
@@ -244,18 +368,23 @@ private:
   Time m_interval;                    //!< 重传间隔
   Time m_processingDelay;             //!< 处理时延
   std::map<uint32_t, EventId> m_retransmitEvents; //!< 报文重传事件映射
+  std::vector<uint32_t> m_retransmitCount; //!< 每个报文的连续重传次数
+  uint32_t m_maxRetransmissions;      //!< 判定交换机故障的重传次数阈值，0表示不检测
 
   bool m_running;                     //!< 是否正在运行
   bool m_allReduceStarted;            //!< AllReduce是否已启动
   bool m_allReduceCompleted;          //!< AllReduce是否已完成
   bool m_lastDataReceived;            //!< 是否接收到最后一个数据包
+  bool m_switchFailed;                //!< 是否已判定上游交换机故障
 
   // 跟踪回调
   TracedCallback<Ptr<const Packet>> m_txTrace;
   TracedCallback<Ptr<const Packet>> m_rxTrace;
   TracedCallback<Ptr<const Packet>, const Address&> m_rxTraceWithAddresses;
+  TracedCallback<uint32_t> m_switchFailureTrace; //!< 交换机故障跟踪，参数为第一个未完成的PSN
 
   CompleteCallback m_completeCallback;  //!< AllReduce完成回调
+  FailureCallback m_failureCallback;    //!< 交换机故障回调
 };
 
 } // namespace ns3
@@ -4,6 +4,7 @@
 
 #include "inc-switch.h"
 #include "ns3/log.h"
+#include "ns3/binary-trace.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/inet-socket-address.h"
@@ -12,7 +13,9 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/abort.h"
 #include "inc-header.h"
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 
@@ -46,6 +49,11 @@ IncSwitch::GetTypeId()
                       TimeValue(MilliSeconds(20)),
                       MakeTimeAccessor(&IncSwitch::m_retransmitTimeout),
                       MakeTimeChecker())
+          .AddAttribute("MaxRetransmissions",
+                      "单个报文最大重传次数，超过后认为下一跳失效并放弃重传，0表示不限制",
+                      UintegerValue(0),
+                      MakeUintegerAccessor(&IncSwitch::m_maxRetransmissions),
+                      MakeUintegerChecker<uint32_t>())
           .AddTraceSource("Rx",
                         "接收数据包",
                         MakeTraceSourceAccessor(&IncSwitch::m_rxTrace),
@@ -61,7 +69,9 @@ IncSwitch::IncSwitch()
     : m_port(9),
       m_socket(nullptr),
       m_switchId(""),
-      m_retransmitTimeout(MilliSeconds(10))
+      m_retransmitTimeout(MilliSeconds(10)),
+      m_maxRetransmissions(0),
+      m_sparseSpillCount(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -144,14 +154,17 @@ IncSwitch::DoDispose()
 // 引擎初始化方法
 void
 IncSwitch::InitializeEngine(std::vector<std::tuple<Ipv4Address, uint16_t, Ipv4Address, uint16_t, bool>> linkState,
-                           uint16_t groupId, uint16_t fanIn, uint16_t arraySize)
+                           uint16_t groupId, uint16_t fanIn, uint16_t arraySize, uint16_t payloadSize)
 {
-  NS_LOG_FUNCTION(this << groupId << fanIn << arraySize);
+  NS_LOG_FUNCTION(this << groupId << fanIn << arraySize << payloadSize);
+  NS_ABORT_MSG_IF(payloadSize == 0 || payloadSize > IncHeader::MAX_PAYLOAD_SIZE,
+                  m_switchId << " 载荷大小 " << payloadSize << " 超出范围(1~" << IncHeader::MAX_PAYLOAD_SIZE << ")");
   
-  NS_LOG_INFO(m_switchId << " 初始化引擎: 组ID=" << groupId << " 扇入度=" << fanIn << " 数组大小=" << arraySize);
+  NS_LOG_INFO(m_switchId << " 初始化引擎: 组ID=" << groupId << " 扇入度=" << fanIn << " 数组大小=" << arraySize
+              << " 载荷大小=" << payloadSize);
   
   // 创建组状态
-  CreateGroupState(groupId, fanIn, arraySize);
+  CreateGroupState(groupId, fanIn, arraySize, payloadSize);
   
   // 检查是否有到父节点的链路
   bool hasLinkToFather = false;
@@ -259,33 +272,26 @@ IncSwitch::HandleRead(Ptr<Socket> socket)
   
   Ptr<Packet> packet;
   Address from;
-  Address localAddress;
 
   while ((packet = socket->RecvFrom(from)))
   {
-    socket->GetSockName(localAddress);
-    
-    // 记录跟踪信息
+    // 记录跟踪信息，本地地址仅在有接收者时获取
     m_rxTrace(packet);
-    m_rxTraceWithAddresses(packet, from, localAddress);
-
-    /*if (InetSocketAddress::IsMatchingType(from))
+    if (!m_rxTraceWithAddresses.IsEmpty())
     {
-      NS_LOG_INFO(m_switchId << " 接收到数据包 大小=" << packet->GetSize() 
-                  << " 字节 来自=" << InetSocketAddress::ConvertFrom(from).GetIpv4() 
-                  << ":" << InetSocketAddress::ConvertFrom(from).GetPort());
-    }*/
-    
+      Address localAddress;
+      socket->GetSockName(localAddress);
+      m_rxTraceWithAddresses(packet, from, localAddress);
+    }
+
     // 解析INC头部
     IncHeader header;
     Ptr<Packet> packetCopy = packet->Copy(); // 创建副本以保持原始报文
     packetCopy->RemoveHeader(header);
     
-    // 显示头部信息
-    /*NS_LOG_INFO(m_switchId << " 报文头部: src=" << header.GetSrcAddr() 
-                << ":" << header.GetSrcQP() << " dst=" << header.GetDstAddr() 
-                << ":" << header.GetDstQP() << " PSN=" << header.GetPsn() 
-                << " ACK=" << header.HasFlag(IncHeader::ACK));*/
+    // 二进制跟踪报文头部，文本日志开销过大
+    NS_TRACE_EVENT("接收报文 大小={} srcQP={} dstQP={} PSN={}",
+                   packet->GetSize(), header.GetSrcQP(), header.GetDstQP(), header.GetPsn());
     
     // 流分类
     uint8_t flowType = ClassifyFlow(packet, header);
@@ -294,22 +300,22 @@ IncSwitch::HandleRead(Ptr<Socket> socket)
     switch (flowType)
     {
       case UPSTREAM_DATA:
-        /*NS_LOG_INFO(m_switchId << " 处理上行数据流 PSN=" << header.GetPsn());*/
+        NS_TRACE_EVENT("处理上行数据流 PSN={}", header.GetPsn());
         ProcessUpstreamData(packetCopy, header);
         break;
       
       case DOWNSTREAM_DATA:
-        //NS_LOG_INFO(m_switchId << " 处理下行数据流 PSN=" << header.GetPsn());
+        NS_TRACE_EVENT("处理下行数据流 PSN={}", header.GetPsn());
         ProcessDownstreamData(packetCopy, header);
         break;
       
       case UPSTREAM_ACK:
-        //NS_LOG_INFO(m_switchId << " 处理上行ACK PSN=" << header.GetPsn());
+        NS_TRACE_EVENT("处理上行ACK PSN={}", header.GetPsn());
         ProcessUpstreamAck(packetCopy, header);
         break;
       
       case DOWNSTREAM_ACK:
-        //NS_LOG_INFO(m_switchId << " 处理下行ACK PSN=" << header.GetPsn());
+        NS_TRACE_EVENT("处理下行ACK PSN={}", header.GetPsn());
         ProcessDownstreamAck(packetCopy, header);
         break;
       
@@ -547,9 +553,9 @@ IncSwitch::AddMulticastForwardingRule(Ipv4Address srcAddr, uint16_t srcQP, Ipv4A
 
 // 创建组状态
 struct IncSwitch::GroupState&
-IncSwitch::CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize)
+IncSwitch::CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize, uint16_t payloadSize)
 {
-  NS_LOG_FUNCTION(this << groupId << fanIn << arraySize);
+  NS_LOG_FUNCTION(this << groupId << fanIn << arraySize << payloadSize);
   
   // 检查组ID是否已存在
   auto it = m_groupStateTable.find(groupId);
@@ -565,7 +571,9 @@ IncSwitch::CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize
   newGroup.arraySize = arraySize;
   newGroup.inc_op = IncHeader::SUM; // 默认聚合操作为SUM
   newGroup.inc_data_type = IncHeader::INT32; // 默认数据类型为INT32
-  newGroup.packet_length = 1024; // 默认发送报文长度为1KB
+  newGroup.packet_length = payloadSize; // 组内协商的载荷长度
+  newGroup.sparse = false;              // 默认为稠密聚合模式
+  newGroup.sparseCells = 0;
     
     // 初始化各个数组
   newGroup.aggBuffer.resize(arraySize, 0);
@@ -573,6 +581,8 @@ IncSwitch::CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize
   newGroup.bcastBuffer.resize(arraySize, 0);
   newGroup.bcastArrState.resize(arraySize, false);
   newGroup.rDegree.resize(arraySize, 0);
+  newGroup.sparseAggResult.resize(arraySize);
+  newGroup.sparseBcastBuffer.resize(arraySize);
   
   // 正确初始化aggPSN数组，每个元素值为其索引
   newGroup.aggPSN.resize(arraySize);
@@ -584,7 +594,7 @@ IncSwitch::CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize
     m_groupStateTable[groupId] = newGroup;
     
   NS_LOG_INFO(m_switchId << " 创建组: " << groupId 
-              << " 扇入度=" << fanIn << " 数组大小=" << arraySize);
+              << " 扇入度=" << fanIn << " 数组大小=" << arraySize << " 载荷大小=" << payloadSize);
   
   return m_groupStateTable[groupId];
 }
@@ -603,6 +613,30 @@ IncSwitch::GetGroupState(uint16_t groupId)
   return it->second;
 }
 
+// 开启稀疏聚合模式
+void
+IncSwitch::EnableSparseMode(uint16_t groupId, uint16_t cellsPerSlot)
+{
+  NS_LOG_FUNCTION(this << groupId << cellsPerSlot);
+  NS_ABORT_MSG_IF(cellsPerSlot == 0, m_switchId << " 稀疏聚合单元数不能为0");
+
+  GroupState& group = GetGroupState(groupId);
+  NS_ABORT_MSG_IF(group.inc_op != IncHeader::SUM, m_switchId << " 稀疏聚合模式只支持SUM操作");
+
+  group.sparse = true;
+  group.sparseCells = cellsPerSlot;
+  group.sparseStore.assign(group.arraySize, std::vector<SparseCell>(cellsPerSlot, SparseCell{0, 0, false}));
+  group.sparseSpill.assign(group.arraySize, std::vector<IncSparseHeader::Entry>());
+
+  NS_LOG_INFO(m_switchId << " 组 " << groupId << " 开启稀疏聚合模式，每槽位聚合单元数=" << cellsPerSlot);
+}
+
+uint64_t
+IncSwitch::GetSparseSpillCount() const
+{
+  return m_sparseSpillCount;
+}
+
 // 更新聚合号数组
 void
 IncSwitch::UpdateAggPSN(uint16_t groupId, uint16_t idx, uint16_t size)
@@ -653,7 +687,14 @@ IncSwitch::ClearGroupState(uint16_t groupId, uint16_t idx)
   group.bcastArrState[idx] = false;
   group.rDegree[idx] = 0;
   group.bcastBuffer[idx] = 0;
-  
+  if (group.sparse) {
+    for (auto& cell : group.sparseStore[idx]) {
+      cell.valid = false;
+    }
+    group.sparseSpill[idx].clear();
+    group.sparseAggResult[idx].Clear();
+    group.sparseBcastBuffer[idx].Clear();
+  }
   
   // 查找并清理所有使用该组状态的流上下文中的对应标志
   for (auto& flowPair : m_inboundFlowContextTable) {
@@ -778,6 +819,16 @@ IncSwitch::ProcessUpstreamData(Ptr<Packet> packet, const IncHeader& header)
     return;
   }
   
+  // 载荷长度与组内协商的不一致，说明主机配置错误，丢弃且不确认
+  // 稀疏模式下载荷为变长的键值对，只要求不超过协商的载荷长度
+  uint32_t maxLength = header.GetSerializedSize() + groupState->packet_length;
+  if (groupState->sparse ? header.GetLength() > maxLength : header.GetLength() != maxLength) {
+    NS_LOG_WARN(m_switchId << " 上行数据载荷长度 " << (header.GetLength() - header.GetSerializedSize())
+                << " 与组 " << groupState->groupId << " 的载荷长度 " << groupState->packet_length
+                << " 不一致，丢弃: src=" << srcAddr << " PSN=" << psn);
+    return;
+  }
+  
   // 计算索引
   uint16_t idx = psn % groupState->arraySize;
   
@@ -886,6 +937,9 @@ IncSwitch::ProcessDownstreamData(Ptr<Packet> packet, const IncHeader& header)
   
   // 缓存聚合值到广播缓冲区
   groupState->bcastBuffer[idx] = aggDataTest;
+  if (groupState->sparse) {
+    packet->PeekHeader(groupState->sparseBcastBuffer[idx]);
+  }
   
   NS_LOG_INFO(m_switchId << " 缓存下行数据到广播缓冲区: PSN=" << psn 
               << " 值=" << aggDataTest);
@@ -966,6 +1020,11 @@ IncSwitch::AggregateData(Ptr<Packet> packet, const IncHeader& header)
       break;
   }
   
+  // 稀疏模式：聚合报文携带的键值对
+  if (groupState->sparse) {
+    AggregateSparse(*groupState, idx, packet);
+  }
+  
   // 更新聚合度
   groupState->degree[idx]++;
   
@@ -985,6 +1044,20 @@ IncSwitch::AggregateData(Ptr<Packet> packet, const IncHeader& header)
     NS_LOG_INFO(m_switchId << " 聚合完成，准备转发: PSN=" << psn 
                 << " 聚合结果=" << groupState->aggBuffer[idx]);
     
+    // 稀疏模式：收集已占用的聚合单元和溢出的键值对作为本节点的聚合结果
+    if (groupState->sparse) {
+      IncSparseHeader& result = groupState->sparseAggResult[idx];
+      result.Clear();
+      for (const auto& cell : groupState->sparseStore[idx]) {
+        if (cell.valid) {
+          result.AddEntry(cell.index, cell.value);
+        }
+      }
+      for (const auto& entry : groupState->sparseSpill[idx]) {
+        result.AddEntry(entry.index, entry.value);
+      }
+    }
+    
     // 查找转发规则
     key_with_ack forwardKey;
     forwardKey.srcAddr = srcAddr;
@@ -1011,13 +1084,11 @@ IncSwitch::AggregateData(Ptr<Packet> packet, const IncHeader& header)
       
       // 缓存聚合值到广播缓冲区
       groupState->bcastBuffer[idx] = groupState->aggBuffer[idx];
+      groupState->sparseBcastBuffer[idx] = groupState->sparseAggResult[idx];
     }
     
     // 转发到所有下一跳
     for (const auto& nextHop : forwardValue.nextHops) {
-      // 创建新的数据包
-      Ptr<Packet> forwardPacket = Create<Packet>(groupState->packet_length);
-      
       // 创建新的头部
       IncHeader forwardHeader = header;
       forwardHeader.SetSrcAddr(nextHop.srcAddr);
@@ -1028,10 +1099,9 @@ IncSwitch::AggregateData(Ptr<Packet> packet, const IncHeader& header)
       forwardHeader.SetOperation(op);
       forwardHeader.SetDataType(groupState->inc_data_type);
       forwardHeader.SetAggDataTest(groupState->aggBuffer[idx]); // 设置聚合结果
-      forwardHeader.SetLength(forwardHeader.GetSerializedSize() + groupState->packet_length);
       
-      // 添加头部
-      forwardPacket->AddHeader(forwardHeader);
+      // 创建新的数据包
+      Ptr<Packet> forwardPacket = CreateDataPacket(*groupState, forwardHeader, groupState->sparseAggResult[idx]);
       
       // 发送数据包
       if (nextHop.socket->Send(forwardPacket) >= 0) {
@@ -1042,7 +1112,7 @@ IncSwitch::AggregateData(Ptr<Packet> packet, const IncHeader& header)
                     << " 聚合值=" << groupState->aggBuffer[idx]);*/
                     
         // 设置重传事件
-        ScheduleRetransmission(forwardHeader, groupState->aggBuffer[idx]);
+        ScheduleRetransmission(forwardHeader, groupState->aggBuffer[idx], groupState->sparseAggResult[idx]);
       } else {
         NS_LOG_ERROR(m_switchId << " 发送数据包失败");
       }
@@ -1095,12 +1165,10 @@ IncSwitch::BroadcastResult(Ptr<Packet> packet, const IncHeader& header)
   
   InboundFlowContext& context = contextIt->second;
   GroupState* groupState = context.groupStatePtr;
+  uint16_t idx = psn % groupState->arraySize;
   
   // 转发到所有下一跳
   for (const auto& nextHop : forwardValue.nextHops) {
-    // 创建新的数据包
-    Ptr<Packet> broadcastPacket = Create<Packet>(groupState->packet_length);
-    
     // 创建新的头部
     IncHeader broadcastHeader = header;
     broadcastHeader.SetSrcAddr(nextHop.srcAddr);
@@ -1109,10 +1177,9 @@ IncSwitch::BroadcastResult(Ptr<Packet> packet, const IncHeader& header)
     broadcastHeader.SetDstQP(nextHop.dstQP);
     broadcastHeader.SetPsn(psn); // 保持相同的PSN
     broadcastHeader.SetAggDataTest(aggDataTest); // 保持聚合结果
-    broadcastHeader.SetLength(broadcastHeader.GetSerializedSize() + groupState->packet_length);
     
-    // 添加头部
-    broadcastPacket->AddHeader(broadcastHeader);
+    // 创建新的数据包
+    Ptr<Packet> broadcastPacket = CreateDataPacket(*groupState, broadcastHeader, groupState->sparseBcastBuffer[idx]);
     
     // 发送数据包
     if (nextHop.socket->Send(broadcastPacket) >= 0) {
@@ -1123,13 +1190,67 @@ IncSwitch::BroadcastResult(Ptr<Packet> packet, const IncHeader& header)
                   << " 聚合值=" << aggDataTest);
                   
       // 设置重传事件
-      ScheduleRetransmission(broadcastHeader, aggDataTest);
+      ScheduleRetransmission(broadcastHeader, aggDataTest, groupState->sparseBcastBuffer[idx]);
     } else {
       NS_LOG_ERROR(m_switchId << " 发送数据包失败");
     }
   }
 }
 
+// 稀疏聚合：按索引哈希到聚合单元
+void
+IncSwitch::AggregateSparse(GroupState& groupState, uint16_t idx, Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION(this << idx);
+  
+  IncSparseHeader sparse;
+  packet->PeekHeader(sparse);
+  
+  std::vector<SparseCell>& cells = groupState.sparseStore[idx];
+  std::vector<IncSparseHeader::Entry>& spill = groupState.sparseSpill[idx];
+  
+  for (const auto& entry : sparse.GetEntries()) {
+    SparseCell& cell = cells[entry.index % groupState.sparseCells];
+    if (!cell.valid) {
+      cell.index = entry.index;
+      cell.value = entry.value;
+      cell.valid = true;
+    } else if (cell.index == entry.index) {
+      cell.value += entry.value;
+    } else {
+      // 哈希冲突：同一索引的溢出键值对合并，保证转发的键值对数目不超过块内元素数
+      auto it = std::find_if(spill.begin(), spill.end(),
+                             [&entry](const IncSparseHeader::Entry& e) { return e.index == entry.index; });
+      if (it != spill.end()) {
+        it->value += entry.value;
+      } else {
+        spill.push_back(entry);
+      }
+      m_sparseSpillCount++;
+    }
+  }
+  
+  NS_LOG_INFO(m_switchId << " 稀疏聚合: 槽位=" << idx << " 键值对数=" << sparse.GetNEntries()
+              << " 溢出数=" << spill.size());
+}
+
+// 创建数据报文
+Ptr<Packet>
+IncSwitch::CreateDataPacket(const GroupState& groupState, IncHeader& header, const IncSparseHeader& sparse) const
+{
+  Ptr<Packet> packet;
+  if (groupState.sparse) {
+    packet = Create<Packet>(0);
+    packet->AddHeader(sparse);
+    header.SetLength(header.GetSerializedSize() + sparse.GetSerializedSize());
+  } else {
+    packet = Create<Packet>(groupState.packet_length);
+    header.SetLength(header.GetSerializedSize() + groupState.packet_length);
+  }
+  packet->AddHeader(header);
+  return packet;
+}
+
 // 处理上行ACK流
 void
 IncSwitch::ProcessUpstreamAck(Ptr<Packet> packet, const IncHeader& header)
@@ -1208,6 +1329,7 @@ IncSwitch::ProcessUpstreamAck(Ptr<Packet> packet, const IncHeader& header)
       }
       outCtx.retransmitEvents.erase(eventIt);
     }
+    outCtx.retransmitCounts.erase(psn);
   }
   
   // 检查PSN与AggPSN的关系和广播确认报文抵达状态
@@ -1320,6 +1442,7 @@ IncSwitch::ProcessDownstreamAck(Ptr<Packet> packet, const IncHeader& header)
       }
       outCtx.retransmitEvents.erase(eventIt);
     }
+    outCtx.retransmitCounts.erase(psn);
   }
   
   // 检查PSN与AggPSN的关系
@@ -1506,9 +1629,6 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
                 << " AggPSN=" << aggPSN
                 << " 值=" << groupState->bcastBuffer[idx]);
     
-    // 创建新的数据包
-    Ptr<Packet> retransPacket = Create<Packet>(groupState->packet_length);
-    
     // 创建新的头部，反转源目地址和QP
     IncHeader retransHeader;
     retransHeader.SetSrcAddr(dstAddr);  // 反转地址
@@ -1520,10 +1640,9 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
     retransHeader.SetDataType(header.GetDataType());
     retransHeader.SetGroupId(header.GetGroupId());
     retransHeader.SetAggDataTest(groupState->bcastBuffer[idx]);
-    retransHeader.SetLength(retransHeader.GetSerializedSize() + groupState->packet_length);
     
-    // 添加头部
-    retransPacket->AddHeader(retransHeader);
+    // 创建新的数据包
+    Ptr<Packet> retransPacket = CreateDataPacket(*groupState, retransHeader, groupState->sparseBcastBuffer[idx]);
     
     // 使用Socket发送
     if (context.send_Socket->Send(retransPacket) >= 0) {
@@ -1532,7 +1651,7 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
                   << " 值=" << groupState->bcastBuffer[idx]);
                   
       // 设置重传事件
-      ScheduleRetransmission(retransHeader, groupState->bcastBuffer[idx]);
+      ScheduleRetransmission(retransHeader, groupState->bcastBuffer[idx], groupState->sparseBcastBuffer[idx]);
     } else {
       NS_LOG_ERROR(m_switchId << " 发送重传的聚合结果失败");
     }
@@ -1556,9 +1675,6 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
       
       // 转发到所有下一跳
       for (const auto& nextHop : forwardValue.nextHops) {
-        // 创建新的数据包
-        Ptr<Packet> forwardPacket = Create<Packet>(groupState->packet_length);
-        
         // 创建新的头部
         IncHeader forwardHeader = header;
         forwardHeader.SetSrcAddr(nextHop.srcAddr);
@@ -1569,10 +1685,9 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
         forwardHeader.SetOperation(groupState->inc_op);
         forwardHeader.SetDataType(groupState->inc_data_type);
         forwardHeader.SetAggDataTest(groupState->aggBuffer[idx]);
-        forwardHeader.SetLength(forwardHeader.GetSerializedSize() + groupState->packet_length);
         
-        // 添加头部
-        forwardPacket->AddHeader(forwardHeader);
+        // 创建新的数据包
+        Ptr<Packet> forwardPacket = CreateDataPacket(*groupState, forwardHeader, groupState->sparseAggResult[idx]);
         
         // 发送数据包
         if (nextHop.socket->Send(forwardPacket) >= 0) {
@@ -1583,7 +1698,7 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
                       << " 值=" << groupState->aggBuffer[idx]);
                       
           // 设置重传事件
-          ScheduleRetransmission(forwardHeader, groupState->aggBuffer[idx]);
+          ScheduleRetransmission(forwardHeader, groupState->aggBuffer[idx], groupState->sparseAggResult[idx]);
         } else {
           NS_LOG_ERROR(m_switchId << " 发送重传的聚合结果失败");
         }
@@ -1603,7 +1718,7 @@ IncSwitch::ProcessRetransmission(Ptr<Packet> packet, const IncHeader& header)
 
 // 调度重传事件
 void
-IncSwitch::ScheduleRetransmission(const IncHeader& header, int32_t aggDataValue)
+IncSwitch::ScheduleRetransmission(const IncHeader& header, int32_t aggDataValue, const IncSparseHeader& sparse)
 {
   NS_LOG_FUNCTION(this);
   
@@ -1644,7 +1759,7 @@ IncSwitch::ScheduleRetransmission(const IncHeader& header, int32_t aggDataValue)
     m_retransmitTimeout,
     &IncSwitch::RetransmitPacket,
     this,
-    header, aggDataValue);
+    header, aggDataValue, sparse);
   
   // 保存事件ID
   outCtx.retransmitEvents[psn] = retransEvent;
@@ -1654,7 +1769,7 @@ IncSwitch::ScheduleRetransmission(const IncHeader& header, int32_t aggDataValue)
 
 // 执行重传
 void
-IncSwitch::RetransmitPacket(const IncHeader& header, int32_t aggDataValue)
+IncSwitch::RetransmitPacket(const IncHeader& header, int32_t aggDataValue, const IncSparseHeader& sparse)
 {
   NS_LOG_FUNCTION(this);
   
@@ -1685,6 +1800,14 @@ IncSwitch::RetransmitPacket(const IncHeader& header, int32_t aggDataValue)
   // 从重传事件映射中移除该事件
   outCtx.retransmitEvents.erase(psn);
   
+  // 超过最大重传次数，认为下一跳已失效，放弃该报文的重传
+  if (m_maxRetransmissions > 0 && ++outCtx.retransmitCounts[psn] > m_maxRetransmissions) {
+    NS_LOG_WARN(m_switchId << " 报文重传次数超过 " << m_maxRetransmissions
+                << "，放弃重传: PSN=" << psn << " 目的地址=" << dstAddr);
+    outCtx.retransmitCounts.erase(psn);
+    return;
+  }
+  
   // 查找组状态
   auto groupIt = m_groupStateTable.find(groupId);
   if (groupIt == m_groupStateTable.end()) {
@@ -1692,17 +1815,13 @@ IncSwitch::RetransmitPacket(const IncHeader& header, int32_t aggDataValue)
     return;
   }
   
-  // 创建重传数据包
-  Ptr<Packet> retransPacket = Create<Packet>(1024); // 默认大小1KB
-  
   // 创建新的头部，拷贝原始头部的关键信息
   IncHeader retransHeader = header;
-  // 下面两行似乎是多余的
+  // 下面一行似乎是多余的
   retransHeader.SetAggDataTest(aggDataValue);
-  retransHeader.SetLength(retransHeader.GetSerializedSize() + 1024);
   
-  // 添加头部到数据包
-  retransPacket->AddHeader(retransHeader);
+  // 创建重传数据包
+  Ptr<Packet> retransPacket = CreateDataPacket(groupIt->second, retransHeader, sparse);
   
   bool packetSent = false;
   
@@ -1741,8 +1860,7 @@ IncSwitch::RetransmitPacket(const IncHeader& header, int32_t aggDataValue)
     Ptr<Socket> socket = GetOrCreateSocket(srcAddr, srcPort, dstAddr, 9);
     
     // 需要创建新数据包，因为前面已经添加了头部
-    Ptr<Packet> newPacket = Create<Packet>(1024);
-    newPacket->AddHeader(retransHeader);
+    Ptr<Packet> newPacket = CreateDataPacket(groupIt->second, retransHeader, sparse);
     
     if (socket->Send(newPacket) >= 0) {
       NS_LOG_INFO(m_switchId << " 使用临时socket重传数据包成功: PSN=" << psn);
@@ -1767,7 +1885,7 @@ IncSwitch::RetransmitPacket(const IncHeader& header, int32_t aggDataValue)
         nextTimeout,
         &IncSwitch::RetransmitPacket,
         this,
-        header, aggDataValue);
+        header, aggDataValue, sparse);
       
       // 保存事件ID
       outCtx.retransmitEvents[psn] = nextRetransmit;
@@ -19,6 +19,7 @@
 #include <vector>
 #include <string>
 #include "inc-header.h"
+#include "inc-sparse-header.h"
 
 namespace ns3
 {
@@ -31,6 +32,13 @@ namespace ns3
 class IncSwitch : public Application
 {
 public:
+  // 稀疏聚合模式下的哈希聚合单元
+  struct SparseCell {
+    uint32_t index;            // 键，即稠密张量中的下标
+    int32_t value;             // 聚合值
+    bool valid;                // 是否已被占用
+  };
+
   // 组状态结构体 - 组内流共享
   struct GroupState {
     uint16_t groupId;          // 组ID
@@ -38,7 +46,7 @@ public:
     uint16_t arraySize;        // 数组长度N
     IncHeader::Operation inc_op;    // 聚合操作类型（默认SUM）
     IncHeader::DataType inc_data_type; // 数据类型（默认INT32）
-    uint32_t packet_length;    // 发送报文长度（默认1024字节）
+    uint32_t packet_length;    // 数据报文载荷长度，由通信组协商（默认1024字节，最大9000字节）
     
     // 缓冲区和状态数组 - 组内共享
     std::vector<int32_t> aggBuffer;      // 聚合缓冲区
@@ -47,6 +55,14 @@ public:
     std::vector<bool> bcastArrState;     // 广播报文抵达数组（每组一个，即下行数据流的报文抵达数组）
     std::vector<uint16_t> rDegree;       // 聚合结果广播度数组
     std::vector<uint32_t> aggPSN;        // 聚合号数组
+
+    // 稀疏聚合模式（键值对），由EnableSparseMode开启，槽位的推进与可靠性机制与稠密模式相同
+    bool sparse;                         // 是否为稀疏聚合模式
+    uint16_t sparseCells;                // 每个槽位的哈希聚合单元数
+    std::vector<std::vector<SparseCell>> sparseStore;  // 哈希索引的聚合单元，按槽位划分
+    std::vector<std::vector<IncSparseHeader::Entry>> sparseSpill; // 哈希冲突的键值对，不聚合直接随结果转发
+    std::vector<IncSparseHeader> sparseAggResult;   // 本节点聚合完成的键值对
+    std::vector<IncSparseHeader> sparseBcastBuffer; // 广播缓冲区中的键值对
   };
 
   /**
@@ -87,9 +103,27 @@ public:
    * \param groupId 组ID
    * \param fanIn 扇入度
    * \param arraySize 数组大小
+   * \param payloadSize 数据报文载荷大小，需与组内主机协议栈的PayloadSize一致
    */
   void InitializeEngine(std::vector<std::tuple<Ipv4Address, uint16_t, Ipv4Address, uint16_t, bool>> linkState, 
-                        uint16_t groupId, uint16_t fanIn, uint16_t arraySize);
+                        uint16_t groupId, uint16_t fanIn, uint16_t arraySize,
+                        uint16_t payloadSize = IncHeader::DEFAULT_PAYLOAD_SIZE);
+
+  /**
+   * \brief 为通信组开启稀疏（键值对）聚合模式，需在InitializeEngine之后调用
+   *
+   * 报文在IncHeader之后携带IncSparseHeader，交换机将键值对按索引哈希到槽位内的聚合单元，
+   * 与已占用单元的键冲突时溢出，溢出的键值对不聚合，随聚合结果一起转发，由上层交换机或主机合并
+   * \param groupId 组ID
+   * \param cellsPerSlot 每个槽位的哈希聚合单元数
+   */
+  void EnableSparseMode(uint16_t groupId, uint16_t cellsPerSlot);
+
+  /**
+   * \brief 获取稀疏聚合时因哈希冲突溢出的键值对数目
+   * \return 溢出的键值对数目
+   */
+  uint64_t GetSparseSpillCount() const;
 
   /**
    * \brief 添加流分类规则，用于流分类表
@@ -153,9 +187,11 @@ public:
    * \param groupId 组ID
    * \param fanIn 扇入度
    * \param arraySize 数组大小
+   * \param payloadSize 数据报文载荷大小
    * \return 组状态引用
    */
-  struct GroupState& CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize);
+  struct GroupState& CreateGroupState(uint16_t groupId, uint16_t fanIn, uint16_t arraySize,
+                                      uint16_t payloadSize = IncHeader::DEFAULT_PAYLOAD_SIZE);
 
   /**
    * \brief 获取组状态
@@ -183,15 +219,18 @@ public:
    * \brief 调度重传事件
    * \param header 原始报文的header
    * \param aggDataValue 聚合数据值
+   * \param sparse 稀疏模式下报文携带的键值对
    */
-  void ScheduleRetransmission(const IncHeader& header, int32_t aggDataValue);
+  void ScheduleRetransmission(const IncHeader& header, int32_t aggDataValue,
+                              const IncSparseHeader& sparse = IncSparseHeader());
 
   /**
    * \brief 执行报文重传
    * \param header 原始报文的header
    * \param aggDataValue 聚合数据值
+   * \param sparse 稀疏模式下报文携带的键值对
    */
-  void RetransmitPacket(const IncHeader& header, int32_t aggDataValue);
+  void RetransmitPacket(const IncHeader& header, int32_t aggDataValue, const IncSparseHeader& sparse);
 
   /**
    * \brief 清理组状态
@@ -266,6 +305,23 @@ private:
    */
   void BroadcastResult(Ptr<Packet> packet, const IncHeader& header);
 
+  /**
+   * \brief 将报文携带的键值对聚合到槽位的哈希聚合单元中，冲突的键值对进入溢出列表
+   * \param groupState 组状态
+   * \param idx 槽位索引
+   * \param packet 去掉IncHeader后的数据包
+   */
+  void AggregateSparse(GroupState& groupState, uint16_t idx, Ptr<Packet> packet);
+
+  /**
+   * \brief 创建数据报文：稠密模式填充组内协商的载荷，稀疏模式携带键值对，并设置头部长度
+   * \param groupState 组状态
+   * \param header 报文头部，会更新其长度字段
+   * \param sparse 稀疏模式下携带的键值对
+   * \return 数据报文
+   */
+  Ptr<Packet> CreateDataPacket(const GroupState& groupState, IncHeader& header, const IncSparseHeader& sparse) const;
+
   /**
    * \brief 发送ACK确认
    * \param header 原始数据包的头部信息
@@ -294,6 +350,8 @@ private:
   Address m_local;       //!< 本地绑定地址
   std::string m_switchId; //!< 交换机ID，用于标识交换机
   Time m_retransmitTimeout; //!< 重传超时间隔
+  uint32_t m_maxRetransmissions; //!< 单个报文最大重传次数，超过后认为下一跳失效并放弃，0表示不限制
+  uint64_t m_sparseSpillCount; //!< 稀疏聚合时因哈希冲突溢出的键值对数目
 
   // Socket缓存：保存已创建的发送Socket，避免重复绑定
   std::map<std::pair<Ipv4Address, uint16_t>, Ptr<Socket>> m_socketCache;
@@ -389,6 +447,7 @@ private:
     int32_t* bufferPtr;  // 指向发送缓冲区的指针(aggBuffer或bcastBuffer)
     std::map<uint32_t, EventId> retransmitEvents;  // PSN -> 重传事件ID
     std::map<uint32_t, int32_t> retransmitValues;  // PSN -> agg_data_test值
+    std::map<uint32_t, uint32_t> retransmitCounts; // PSN -> 已重传次数
   };
 
   // 跟踪回调
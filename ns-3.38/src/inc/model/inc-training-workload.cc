@@ -0,0 +1,424 @@
+/*
+ * 在网计算协议 - 分布式训练负载驱动实现
+ */
+
+#include "inc-training-workload.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/abort.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("IncTrainingWorkload");
+
+NS_OBJECT_ENSURE_REGISTERED(IncTrainingWorkload);
+
+TypeId
+IncTrainingWorkload::GetTypeId()
+{
+  static TypeId tid =
+      TypeId("ns3::IncTrainingWorkload")
+          .SetParent<Object>()
+          .SetGroupName("Applications")
+          .AddConstructor<IncTrainingWorkload>()
+          .AddAttribute("Backend",
+                        "集合通信后端",
+                        EnumValue(IncTrainingWorkload::INC),
+                        MakeEnumAccessor(&IncTrainingWorkload::m_backend),
+                        MakeEnumChecker(IncTrainingWorkload::INC, "Inc",
+                                        IncTrainingWorkload::RING, "Ring"))
+          .AddAttribute("Iterations",
+                        "训练迭代轮数",
+                        UintegerValue(3),
+                        MakeUintegerAccessor(&IncTrainingWorkload::m_iterations),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("BucketSize",
+                        "梯度桶大小(字节)，与PyTorch DDP的bucket_cap_mb含义相同",
+                        UintegerValue(25 * 1024 * 1024),
+                        MakeUintegerAccessor(&IncTrainingWorkload::m_bucketSize),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("Overlap",
+                        "是否让梯度通信与剩余层的反向计算重叠，否则在反向计算全部完成后才开始通信",
+                        BooleanValue(true),
+                        MakeBooleanAccessor(&IncTrainingWorkload::m_overlap),
+                        MakeBooleanChecker())
+          .AddAttribute("OptimizerTime",
+                        "所有梯度聚合完成后优化器更新参数的时间",
+                        TimeValue(Seconds(0)),
+                        MakeTimeAccessor(&IncTrainingWorkload::m_optimizerTime),
+                        MakeTimeChecker())
+          .AddAttribute("RingPort",
+                        "Ring后端第一个桶使用的监听端口，后续桶依次递增",
+                        UintegerValue(10000),
+                        MakeUintegerAccessor(&IncTrainingWorkload::m_ringPort),
+                        MakeUintegerChecker<uint16_t>())
+          .AddAttribute("RingPayloadSize",
+                        "Ring后端报文净荷大小",
+                        UintegerValue(1024),
+                        MakeUintegerAccessor(&IncTrainingWorkload::m_ringPayloadSize),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("RcwndSize",
+                        "Ring后端TCP接收窗口大小",
+                        UintegerValue(2 * 1024 * 1024),
+                        MakeUintegerAccessor(&IncTrainingWorkload::m_rcwndSize),
+                        MakeUintegerChecker<uint32_t>())
+          .AddAttribute("PacketInterval",
+                        "Ring后端发包时间间隔(毫秒)",
+                        DoubleValue(0.01),
+                        MakeDoubleAccessor(&IncTrainingWorkload::m_packetInterval),
+                        MakeDoubleChecker<double>(0.0))
+          .AddTraceSource("IterationComplete",
+                        "一轮迭代完成，参数为迭代序号和耗时",
+                        MakeTraceSourceAccessor(&IncTrainingWorkload::m_iterationTrace),
+                        "ns3::IncTrainingWorkload::IterationTracedCallback");
+  return tid;
+}
+
+IncTrainingWorkload::IncTrainingWorkload()
+    : m_backend(INC),
+      m_iterations(3),
+      m_bucketSize(25 * 1024 * 1024),
+      m_overlap(true),
+      m_optimizerTime(Seconds(0)),
+      m_ringPort(10000),
+      m_ringPayloadSize(1024),
+      m_rcwndSize(2 * 1024 * 1024),
+      m_packetInterval(0.01),
+      m_iteration(0),
+      m_backwardDone(false),
+      m_commBusy(false),
+      m_activeBucket(0),
+      m_pendingHosts(0),
+      m_bucketsDone(0),
+      m_finished(false)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+IncTrainingWorkload::~IncTrainingWorkload()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+IncTrainingWorkload::DoDispose()
+{
+  NS_LOG_FUNCTION(this);
+  m_hosts.clear();
+  Object::DoDispose();
+}
+
+void
+IncTrainingWorkload::AddHost(Ptr<IncStack> stack)
+{
+  NS_LOG_FUNCTION(this << stack);
+
+  HostEntry entry;
+  entry.stack = stack;
+  entry.node = stack->GetNode();
+  m_hosts.push_back(entry);
+
+  // 每个桶的AllReduce完成时通知驱动
+  stack->SetCompleteCallback(MakeCallback(&IncTrainingWorkload::HostCollectiveDone, this));
+}
+
+void
+IncTrainingWorkload::AddHost(Ptr<Node> node, Ipv4Address ringAddress)
+{
+  NS_LOG_FUNCTION(this << node << ringAddress);
+
+  HostEntry entry;
+  entry.stack = nullptr;
+  entry.node = node;
+  entry.ringAddress = ringAddress;
+  m_hosts.push_back(entry);
+}
+
+void
+IncTrainingWorkload::AddLayer(Time forwardTime, Time backwardTime, uint32_t gradientBytes)
+{
+  NS_LOG_FUNCTION(this << forwardTime << backwardTime << gradientBytes);
+  m_forwardTimes.push_back(forwardTime);
+  m_backwardTimes.push_back(backwardTime);
+  m_gradientBytes.push_back(gradientBytes);
+}
+
+bool
+IncTrainingWorkload::IsFinished() const
+{
+  return m_finished;
+}
+
+uint32_t
+IncTrainingWorkload::GetBucketCount() const
+{
+  return m_buckets.size();
+}
+
+const std::vector<Time>&
+IncTrainingWorkload::GetIterationTimes() const
+{
+  return m_iterationTimes;
+}
+
+const std::vector<Time>&
+IncTrainingWorkload::GetExposedCommTimes() const
+{
+  return m_exposedCommTimes;
+}
+
+void
+IncTrainingWorkload::BuildBuckets()
+{
+  NS_LOG_FUNCTION(this);
+
+  // 从最后一层开始按反向顺序装桶，桶内梯度达到BucketSize即封桶
+  m_buckets.clear();
+  Time backwardOffset = Seconds(0);
+  uint32_t bytes = 0;
+  for (uint32_t i = m_gradientBytes.size(); i-- > 0;)
+  {
+    backwardOffset += m_backwardTimes[i];
+    bytes += m_gradientBytes[i];
+    if (bytes >= m_bucketSize || i == 0)
+    {
+      if (bytes > 0)
+      {
+        m_buckets.push_back({bytes, backwardOffset});
+      }
+      bytes = 0;
+    }
+  }
+
+  NS_LOG_INFO("模型层数=" << m_gradientBytes.size() << " 梯度桶数=" << m_buckets.size());
+}
+
+void
+IncTrainingWorkload::Start()
+{
+  NS_LOG_FUNCTION(this);
+  NS_ABORT_MSG_IF(m_hosts.empty(), "训练负载未添加主机");
+  NS_ABORT_MSG_IF(m_gradientBytes.empty(), "训练负载未添加模型层");
+  for (const auto& host : m_hosts)
+  {
+    NS_ABORT_MSG_IF(m_backend == INC && !host.stack, "在网聚合后端的主机需要通过AddHost(Ptr<IncStack>)添加");
+  }
+
+  BuildBuckets();
+  m_iteration = 0;
+  m_finished = false;
+  m_iterationTimes.clear();
+  m_exposedCommTimes.clear();
+
+  // Ring连接在第一轮前向计算期间建立，之后各轮迭代复用
+  if (m_backend == RING)
+  {
+    SetupRings();
+  }
+  StartIteration();
+}
+
+void
+IncTrainingWorkload::StartIteration()
+{
+  NS_LOG_FUNCTION(this << m_iteration);
+
+  m_iterationStart = Simulator::Now();
+  m_backwardDone = false;
+  m_commBusy = false;
+  m_bucketsDone = 0;
+  m_readyBuckets.clear();
+
+  Time forwardTotal = Seconds(0);
+  for (const auto& t : m_forwardTimes)
+  {
+    forwardTotal += t;
+  }
+
+  // 反向传播按层逆序推进，桶内最后一层完成时桶就绪
+  for (uint32_t b = 0; b < m_buckets.size(); ++b)
+  {
+    Simulator::Schedule(forwardTotal + m_buckets[b].readyOffset, &IncTrainingWorkload::BucketReady, this, b);
+  }
+  Simulator::Schedule(forwardTotal + m_buckets.back().readyOffset, &IncTrainingWorkload::BackwardDone, this);
+
+  NS_LOG_INFO("开始第 " << m_iteration << " 轮迭代，前向计算时间=" << forwardTotal.As(Time::MS));
+}
+
+void
+IncTrainingWorkload::SetupRings()
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t numHosts = m_hosts.size();
+  if (numHosts < 2)
+  {
+    return;
+  }
+  if (!m_hosts[0].rings.empty())
+  {
+    // 再次调用Start时沿用已建立的连接
+    NS_ABORT_MSG_IF(m_hosts[0].rings.size() != m_buckets.size(),
+                    "Ring连接已按 " << m_hosts[0].rings.size() << " 个桶建立，不能改变桶数");
+    return;
+  }
+  NS_ABORT_MSG_IF(m_ringPort + m_buckets.size() - 1 > 65535,
+                  "Ring端口号不足，请减小RingPort或增大BucketSize");
+
+  for (uint32_t b = 0; b < m_buckets.size(); ++b)
+  {
+    uint16_t port = m_ringPort + b;
+
+    // RingApplication要求报文数能被节点数整除
+    uint32_t packets = (m_buckets[b].bytes + m_ringPayloadSize - 1) / m_ringPayloadSize;
+    packets = (packets + numHosts - 1) / numHosts * numHosts;
+
+    for (uint32_t i = 0; i < numHosts; ++i)
+    {
+      HostEntry& host = m_hosts[i];
+      Ptr<RingApplication> ring = CreateObject<RingApplication>();
+      ring->SetListenConfig(host.ringAddress, port);
+      ring->SetPeer(m_hosts[(i + 1) % numHosts].ringAddress, port);
+      // transferStartTime为负值：连接建立后等待StartTransfer，完成后保持连接供下一轮迭代使用
+      ring->Setup(i, numHosts, packets, m_ringPayloadSize, m_rcwndSize, 10, 1, 0.0, -1.0, m_packetInterval);
+      ring->SetKeepConnection(true);
+      ring->SetCompleteCallback(MakeCallback(&IncTrainingWorkload::HostCollectiveDone, this));
+
+      // 应用在加入节点后立即启动
+      host.node->AddApplication(ring);
+      ring->SetStartTime(Seconds(0));
+      host.rings.push_back(ring);
+    }
+  }
+}
+
+void
+IncTrainingWorkload::BucketReady(uint32_t bucket)
+{
+  NS_LOG_FUNCTION(this << bucket);
+  NS_LOG_INFO("第 " << m_iteration << " 轮迭代桶 " << bucket << " 就绪，梯度大小=" << m_buckets[bucket].bytes);
+
+  m_readyBuckets.push_back(bucket);
+  if (m_overlap)
+  {
+    TryStartCollective();
+  }
+}
+
+void
+IncTrainingWorkload::BackwardDone()
+{
+  NS_LOG_FUNCTION(this);
+
+  m_backwardDone = true;
+  m_backwardEnd = Simulator::Now();
+  TryStartCollective();
+  CheckIterationDone();
+}
+
+void
+IncTrainingWorkload::TryStartCollective()
+{
+  NS_LOG_FUNCTION(this);
+
+  if (m_commBusy || m_readyBuckets.empty() || (!m_overlap && !m_backwardDone))
+  {
+    return;
+  }
+
+  m_activeBucket = m_readyBuckets.front();
+  m_readyBuckets.pop_front();
+
+  // 单主机无需通信
+  if (m_hosts.size() < 2)
+  {
+    m_bucketsDone++;
+    TryStartCollective();
+    return;
+  }
+
+  m_commBusy = true;
+  m_pendingHosts = m_hosts.size();
+
+  NS_LOG_INFO("启动桶 " << m_activeBucket << " 的AllReduce");
+
+  for (auto& host : m_hosts)
+  {
+    if (m_backend == INC)
+    {
+      uint32_t payloadSize = host.stack->GetPayloadSize();
+      uint32_t packets = (m_buckets[m_activeBucket].bytes + payloadSize - 1) / payloadSize;
+      host.stack->SetTotalPackets(packets);
+      host.stack->AllReduce();
+    }
+    else
+    {
+      host.rings[m_activeBucket]->StartTransfer();
+    }
+  }
+}
+
+void
+IncTrainingWorkload::HostCollectiveDone()
+{
+  NS_LOG_FUNCTION(this);
+
+  if (!m_commBusy || m_pendingHosts == 0)
+  {
+    return;
+  }
+  if (--m_pendingHosts > 0)
+  {
+    return;
+  }
+
+  NS_LOG_INFO("桶 " << m_activeBucket << " 的AllReduce完成");
+  m_commBusy = false;
+  m_bucketsDone++;
+
+  // 在回调之外启动下一个桶，避免在协议栈的完成回调中重入AllReduce
+  Simulator::ScheduleNow(&IncTrainingWorkload::TryStartCollective, this);
+  CheckIterationDone();
+}
+
+void
+IncTrainingWorkload::CheckIterationDone()
+{
+  NS_LOG_FUNCTION(this);
+
+  if (!m_backwardDone || m_bucketsDone < m_buckets.size())
+  {
+    return;
+  }
+
+  m_exposedCommTimes.push_back(Simulator::Now() - m_backwardEnd);
+  Simulator::Schedule(m_optimizerTime, &IncTrainingWorkload::FinishIteration, this);
+}
+
+void
+IncTrainingWorkload::FinishIteration()
+{
+  NS_LOG_FUNCTION(this);
+
+  Time duration = Simulator::Now() - m_iterationStart;
+  m_iterationTimes.push_back(duration);
+  m_iterationTrace(m_iteration, duration);
+
+  NS_LOG_INFO("第 " << m_iteration << " 轮迭代完成，耗时=" << duration.As(Time::MS));
+
+  if (++m_iteration < m_iterations)
+  {
+    StartIteration();
+  }
+  else
+  {
+    m_finished = true;
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,211 @@
+/*
+ * 在网计算协议 - 分布式训练负载驱动
+ */
+
+#ifndef INC_TRAINING_WORKLOAD_H
+#define INC_TRAINING_WORKLOAD_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/traced-callback.h"
+#include <deque>
+#include <vector>
+#include "inc-stack.h"
+#include "ring-application.h"
+
+namespace ns3
+{
+
+/**
+ * \brief 数据并行训练负载驱动
+ *
+ * 按层描述模型的前向/反向计算时间和梯度大小，模拟多轮同步数据并行训练：
+ * 反向传播按层逆序产生梯度，梯度按BucketSize划分为桶（与PyTorch DDP相同，从最后一层开始装桶），
+ * 桶内所有层的反向计算完成后即可发起AllReduce，与剩余层的反向计算重叠。
+ * 同一时刻组内只有一个集合通信在进行，就绪的桶按产生顺序排队。
+ * 所有桶完成AllReduce并执行优化器更新后进入下一轮迭代。
+ *
+ * 集合通信可以使用在网聚合（IncStack，每个桶一次AllReduce，PSN在桶之间连续）
+ * 或基于TCP的Ring AllReduce（训练开始时为每个桶建立一次RingApplication连接，
+ * 各轮迭代复用这些连接，桶就绪时启动传输）。
+ * 组内各主机的计算时间相同，因此由一个驱动统一推进所有主机的训练时间线。
+ */
+class IncTrainingWorkload : public Object
+{
+public:
+  /**
+   * \brief 集合通信后端
+   */
+  enum Backend {
+    INC = 0,           // 在网聚合
+    RING = 1           // Ring AllReduce
+  };
+
+  /**
+   * \brief 获取类型ID
+   * \return 对象TypeId
+   */
+  static TypeId GetTypeId();
+  IncTrainingWorkload();
+  ~IncTrainingWorkload() override;
+
+  /**
+   * \brief 添加使用在网聚合的主机
+   * \param stack 主机上已安装的协议栈
+   */
+  void AddHost(Ptr<IncStack> stack);
+
+  /**
+   * \brief 添加使用Ring AllReduce的主机，添加顺序即Ring中的节点顺序
+   * \param node 主机节点
+   * \param ringAddress 主机用于Ring通信的IP地址
+   */
+  void AddHost(Ptr<Node> node, Ipv4Address ringAddress);
+
+  /**
+   * \brief 按前向顺序添加模型的一层
+   * \param forwardTime 前向计算时间
+   * \param backwardTime 反向计算时间
+   * \param gradientBytes 该层的梯度大小(字节)
+   */
+  void AddLayer(Time forwardTime, Time backwardTime, uint32_t gradientBytes);
+
+  /**
+   * \brief 开始训练，按Iterations属性执行多轮迭代
+   */
+  void Start();
+
+  /**
+   * \brief 检查所有迭代是否已完成
+   * \return 如果完成返回true
+   */
+  bool IsFinished() const;
+
+  /**
+   * \brief 获取梯度桶数
+   * \return 每轮迭代的梯度桶数
+   */
+  uint32_t GetBucketCount() const;
+
+  /**
+   * \brief 获取每轮迭代的耗时
+   * \return 已完成迭代的耗时
+   */
+  const std::vector<Time>& GetIterationTimes() const;
+
+  /**
+   * \brief 获取每轮迭代中反向计算结束后仍在等待通信的时间
+   * \return 已完成迭代的通信暴露时间
+   */
+  const std::vector<Time>& GetExposedCommTimes() const;
+
+  /**
+   * \brief 迭代完成的跟踪回调签名
+   * \param iteration 迭代序号
+   * \param duration 迭代耗时
+   */
+  typedef void (*IterationTracedCallback)(uint32_t iteration, Time duration);
+
+protected:
+  void DoDispose() override;
+
+private:
+  // 梯度桶：反向顺序上连续的若干层
+  struct Bucket {
+    uint32_t bytes;                 // 梯度大小(字节)
+    Time readyOffset;               // 相对反向传播开始的就绪时间
+  };
+
+  // 组内主机信息
+  struct HostEntry {
+    Ptr<IncStack> stack;            // 在网聚合协议栈
+    Ptr<Node> node;                 // Ring后端使用的节点
+    Ipv4Address ringAddress;        // Ring后端使用的地址
+    std::vector<Ptr<RingApplication>> rings; // 每个桶的Ring应用，各轮迭代复用
+  };
+
+  /**
+   * \brief 按反向顺序将各层梯度划分为桶
+   */
+  void BuildBuckets();
+
+  /**
+   * \brief 开始一轮迭代：前向计算，随后逐层反向计算
+   */
+  void StartIteration();
+
+  /**
+   * \brief 训练开始时为每个桶建立Ring连接
+   */
+  void SetupRings();
+
+  /**
+   * \brief 桶内所有层的反向计算完成
+   * \param bucket 桶序号
+   */
+  void BucketReady(uint32_t bucket);
+
+  /**
+   * \brief 反向计算全部完成
+   */
+  void BackwardDone();
+
+  /**
+   * \brief 通信空闲时启动下一个就绪桶的AllReduce
+   */
+  void TryStartCollective();
+
+  /**
+   * \brief 某个主机完成了当前桶的AllReduce
+   */
+  void HostCollectiveDone();
+
+  /**
+   * \brief 检查本轮迭代的计算和通信是否全部完成
+   */
+  void CheckIterationDone();
+
+  /**
+   * \brief 优化器更新完成，结束本轮迭代
+   */
+  void FinishIteration();
+
+  Backend m_backend;                //!< 集合通信后端
+  uint32_t m_iterations;            //!< 迭代轮数
+  uint32_t m_bucketSize;            //!< 梯度桶大小(字节)
+  bool m_overlap;                   //!< 是否让通信与反向计算重叠
+  Time m_optimizerTime;             //!< 优化器更新时间
+  uint16_t m_ringPort;              //!< Ring后端第一个桶使用的端口，后续桶依次递增
+  uint32_t m_ringPayloadSize;       //!< Ring后端报文净荷大小
+  uint32_t m_rcwndSize;             //!< Ring后端TCP接收窗口大小
+  double m_packetInterval;          //!< Ring后端发包间隔(毫秒)
+
+  std::vector<HostEntry> m_hosts;   //!< 组内主机
+  std::vector<Time> m_forwardTimes; //!< 各层前向计算时间，按前向顺序
+  std::vector<Time> m_backwardTimes; //!< 各层反向计算时间，按前向顺序
+  std::vector<uint32_t> m_gradientBytes; //!< 各层梯度大小，按前向顺序
+  std::vector<Bucket> m_buckets;    //!< 梯度桶，按反向顺序
+
+  uint32_t m_iteration;             //!< 当前迭代序号
+  Time m_iterationStart;            //!< 当前迭代开始时间
+  Time m_backwardEnd;               //!< 当前迭代反向计算结束时间
+  bool m_backwardDone;              //!< 当前迭代反向计算是否完成
+  std::deque<uint32_t> m_readyBuckets; //!< 已就绪等待通信的桶
+  bool m_commBusy;                  //!< 是否有集合通信在进行
+  uint32_t m_activeBucket;          //!< 正在通信的桶
+  uint32_t m_pendingHosts;          //!< 当前桶尚未完成AllReduce的主机数
+  uint32_t m_bucketsDone;           //!< 本轮迭代已完成AllReduce的桶数
+  bool m_finished;                  //!< 所有迭代是否已完成
+
+  std::vector<Time> m_iterationTimes;   //!< 每轮迭代耗时
+  std::vector<Time> m_exposedCommTimes; //!< 每轮迭代未被计算掩盖的通信时间
+
+  TracedCallback<uint32_t, Time> m_iterationTrace; //!< 迭代完成跟踪，参数为迭代序号和耗时
+};
+
+} // namespace ns3
+
+#endif /* INC_TRAINING_WORKLOAD_H */
@@ -2,6 +2,7 @@
 
 #include "ring-application.h"
 #include "ring-header.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
@@ -12,6 +13,8 @@
 #include "ns3/boolean.h"
 #include "ns3/double.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("RingApplication");
@@ -91,7 +94,12 @@ RingApplication::RingApplication ()
     m_isInitialRound (true),
     m_canSend (false),
     m_receiveReady (false),
-    m_sendReady (false)
+    m_sendReady (false),
+    m_connected (false),
+    m_transferRequested (false),
+    m_keepConnection (false),
+    m_userData (false),
+    m_operation (IncHeader::SUM)
 {
   NS_LOG_FUNCTION (this);
   // 初始化后节点状态
@@ -185,6 +193,10 @@ RingApplication::GetNumNodes () const
 bool
 RingApplication::VerifyResults () const
 {
+  if (m_userData)
+    {
+      return m_currentPhase == DONE;
+    }
   for (uint32_t i = 0; i < m_totalPackets; ++i)
     {
       if (m_allGatherBuffer[i] != static_cast<int32_t>(m_numNodes))
@@ -346,11 +358,70 @@ RingApplication::InitializeBuffers (void)
 {
   NS_LOG_FUNCTION (this);
   
-  // 初始化Scatter-Reduce缓冲区，所有值都设为1
-  m_scatterReduceBuffer.resize (m_totalPackets, 1);
+  if (m_userData)
+    {
+      // 真实数据模式：Scatter-Reduce缓冲区从本地数据开始，补齐的报文填0
+      m_scatterReduceBuffer.assign (m_totalPackets, 0);
+      std::copy (m_inputData.begin (), m_inputData.end (), m_scatterReduceBuffer.begin ());
+    }
+  else
+    {
+      // 初始化Scatter-Reduce缓冲区，所有值都设为1
+      m_scatterReduceBuffer.assign (m_totalPackets, 1);
+    }
   
   // 初始化All-Gather缓冲区，所有值都设为0
-  m_allGatherBuffer.resize (m_totalPackets, 0);
+  m_allGatherBuffer.assign (m_totalPackets, 0);
+}
+
+void
+RingApplication::SetKeepConnection (bool keep)
+{
+  NS_LOG_FUNCTION (this << keep);
+  m_keepConnection = keep;
+}
+
+void
+RingApplication::SetInputData (const std::vector<int32_t>& data, IncHeader::Operation op)
+{
+  NS_LOG_FUNCTION (this << data.size () << static_cast<uint32_t>(op));
+  
+  NS_ABORT_MSG_IF (m_numNodes == 0, "节点 " << m_nodeId << " 需先调用Setup再设置输入数据");
+  NS_ABORT_MSG_IF (m_currentPhase == SCATTER_REDUCE || m_currentPhase == ALL_GATHER,
+                   "节点 " << m_nodeId << " 归约进行中，不能修改输入数据");
+  NS_ABORT_MSG_IF (data.empty (), "节点 " << m_nodeId << " 输入数据为空");
+  NS_ABORT_MSG_IF (op == IncHeader::CUSTOM, "Ring AllReduce不支持自定义归约操作");
+  
+  m_userData = true;
+  m_inputData = data;
+  m_operation = op;
+  
+  // RingApplication要求报文数能被节点数整除，多出的补齐报文结果被丢弃
+  m_totalPackets = (data.size () + m_numNodes - 1) / m_numNodes * m_numNodes;
+  m_packetsPerChunk = m_totalPackets / m_numNodes;
+  InitializeBuffers ();
+}
+
+void
+RingApplication::ReduceValue (uint32_t opi, int32_t value)
+{
+  int32_t& acc = m_scatterReduceBuffer[opi];
+  switch (m_operation)
+    {
+    case IncHeader::MIN:
+      acc = std::min (acc, value);
+      break;
+    case IncHeader::MAX:
+      acc = std::max (acc, value);
+      break;
+    case IncHeader::PRODUCT:
+      acc *= value;
+      break;
+    default:
+      // SUM，AVERAGE在完成时再除以节点数
+      acc += value;
+      break;
+    }
 }
 
 void
@@ -362,7 +433,16 @@ RingApplication::ConnectionSucceededCallback (Ptr<Socket> socket)
   // 连接建立，但不立即开始Ring Allreduce操作
   if (m_currentPhase == CONNECTING)
     {
-      if (m_transferStartTime > 0.0)
+      if (m_transferStartTime < 0.0)
+        {
+          // 手动启动模式，等待StartTransfer
+          m_connected = true;
+          if (m_transferRequested)
+            {
+              StartDataTransfer ();
+            }
+        }
+      else if (m_transferStartTime > 0.0)
         {
           // 在指定时间点开始传输数据
           Time now = Simulator::Now ();
@@ -389,6 +469,30 @@ RingApplication::ConnectionSucceededCallback (Ptr<Socket> socket)
     }
 }
 
+void
+RingApplication::StartTransfer (void)
+{
+  NS_LOG_FUNCTION (this);
+  
+  m_transferRequested = true;
+  if (m_connected && m_currentPhase == CONNECTING)
+    {
+      StartDataTransfer ();
+    }
+  else if (m_keepConnection && m_currentPhase == DONE)
+    {
+      // 在已有连接上开始新一次归约，清除上一次的同步状态
+      NS_LOG_INFO ("节点 " << m_nodeId << " 复用连接开始新一次归约");
+      m_waitingForNextNode = false;
+      m_hasNotifiedPreviousNode = false;
+      m_nextNodeState.currentPass = 0;
+      m_nextNodeState.currentPhase = IDLE;
+      m_nextNodeState.readyForNextPass = false;
+      InitializeBuffers ();
+      StartDataTransfer ();
+    }
+}
+
 void
 RingApplication::StartDataTransfer (void)
 {
@@ -556,9 +660,9 @@ RingApplication::ProcessReceivedData (Ptr<Socket> socket, uint8_t* recvBuffer, u
         }
       else if (m_currentPhase == SCATTER_REDUCE && header.GetMessageType () == SCATTER_REDUCE_DATA)
         {
-          // 验证聚合数据
+          // 验证聚合数据（仅合成数据模式）
           uint32_t expectedAggData = header.GetPassNumber () + 1;
-          if (header.GetAggDataTest () != static_cast<int32_t>(expectedAggData))
+          if (!m_userData && header.GetAggDataTest () != static_cast<int32_t>(expectedAggData))
             {
               NS_LOG_WARN ("节点 " << m_nodeId << " 接收到无效的聚合数据: "
                           << header.GetAggDataTest () << ", 期望值: " << expectedAggData);
@@ -566,7 +670,7 @@ RingApplication::ProcessReceivedData (Ptr<Socket> socket, uint8_t* recvBuffer, u
           
           // 更新Scatter-Reduce缓冲区
           uint32_t opi = header.GetOriginalPacketIndex ();
-          m_scatterReduceBuffer[opi] += header.GetAggDataTest ();
+          ReduceValue (opi, header.GetAggDataTest ());
           
           // 记录数据块接收进度
           uint32_t logicalChunkId = header.GetLogicalChunkIdentity ();
@@ -586,8 +690,8 @@ RingApplication::ProcessReceivedData (Ptr<Socket> socket, uint8_t* recvBuffer, u
         }
       else if (m_currentPhase == ALL_GATHER && header.GetMessageType () == ALL_GATHER_DATA)
         {
-          // 验证聚合数据
-          if (header.GetAggDataTest () != static_cast<int32_t>(m_numNodes))
+          // 验证聚合数据（仅合成数据模式）
+          if (!m_userData && header.GetAggDataTest () != static_cast<int32_t>(m_numNodes))
             {
               NS_LOG_WARN ("节点 " << m_nodeId << " 在All-Gather阶段接收到无效的聚合数据: "
                           << header.GetAggDataTest () << ", 期望值: " << m_numNodes);
@@ -677,6 +781,13 @@ RingApplication::HandleRoundCompleteNotification (Ptr<Socket> socket, const Ring
                << " 的轮次完成通知: 轮次=" << senderPass 
                << ", 阶段=" << senderPhase);
   
+  // All-Gather最后一轮之后不再有发送，其完成通知无需处理；
+  // 保持连接时忽略它，以免被当作下一次归约的就绪通知
+  if (senderPhase == ALL_GATHER && senderPass == m_numNodes - 2)
+    {
+      return;
+    }
+  
   // 更新后节点状态
   if (senderNodeId == (m_nodeId + 1) % m_numNodes)
     {
@@ -854,7 +965,8 @@ RingApplication::AdvanceToNextPhase (void)
       for (uint32_t i = 0; i < m_packetsPerChunk; i++)
         {
           uint32_t opi = myChunk * m_packetsPerChunk + i;
-          if (opi < m_totalPackets && m_scatterReduceBuffer[opi] == static_cast<int32_t>(m_numNodes))
+          if (opi < m_totalPackets
+              && (m_userData || m_scatterReduceBuffer[opi] == static_cast<int32_t>(m_numNodes)))
             {
               m_allGatherBuffer[opi] = m_scatterReduceBuffer[opi];
             }
@@ -1091,26 +1203,58 @@ RingApplication::AdvanceReceivingToNextRound (void)
       else
         {
           // 完成All-Gather阶段，Ring Allreduce完成
-          m_endTime = Simulator::Now ();
-          m_currentPhase = DONE;
-          
-          // 在结束前，确保所有缓冲区都包含最终值
-          for (uint32_t i = 0; i < m_totalPackets; ++i)
+          FinishTransfer ();
+        }
+    }
+}
+
+void
+RingApplication::FinishTransfer (void)
+{
+  NS_LOG_FUNCTION (this);
+  
+  m_endTime = Simulator::Now ();
+  m_currentPhase = DONE;
+  
+  // 在结束前，确保所有缓冲区都包含最终值
+  for (uint32_t i = 0; i < m_totalPackets; ++i)
+    {
+      if (m_userData)
+        {
+          m_allGatherBuffer[i] = m_scatterReduceBuffer[i];
+          if (m_operation == IncHeader::AVERAGE)
             {
-              if (m_scatterReduceBuffer[i] == static_cast<int32_t>(m_numNodes))
-                {
-                  m_allGatherBuffer[i] = m_scatterReduceBuffer[i];
-                }
+              m_allGatherBuffer[i] /= static_cast<int32_t>(m_numNodes);
             }
-          
-          NS_LOG_UNCOND ("节点 " << m_nodeId << " 完成Ring Allreduce，耗时 " 
-                      << (m_endTime - m_startTime).GetSeconds () << " 秒");
-          NS_LOG_UNCOND ("验证结果: " << (VerifyResults () ? "成功" : "失败"));
-          
-          // 停止应用
-          StopApplication ();
+        }
+      else if (m_scatterReduceBuffer[i] == static_cast<int32_t>(m_numNodes))
+        {
+          m_allGatherBuffer[i] = m_scatterReduceBuffer[i];
         }
     }
+  
+  NS_LOG_UNCOND ("节点 " << m_nodeId << " 完成Ring Allreduce，耗时 " 
+              << (m_endTime - m_startTime).GetSeconds () << " 秒");
+  NS_LOG_UNCOND ("验证结果: " << (VerifyResults () ? "成功" : "失败"));
+  
+  if (m_keepConnection)
+    {
+      // 保持连接，等待下一次StartTransfer
+      if (m_sendEvent.IsRunning ())
+        {
+          m_sendEvent.Cancel ();
+        }
+    }
+  else
+    {
+      // 停止应用
+      StopApplication ();
+    }
+
+  if (!m_completeCallback.IsNull ())
+    {
+      m_completeCallback ();
+    }
 }
 
 void
@@ -1136,4 +1280,17 @@ RingApplication::SetTimingParams (double connectionStartTime, double transferSta
   m_transferStartTime = transferStartTime;
 }
 
-} // namespace ns3 
\ No newline at end of file
+void
+RingApplication::SetCompleteCallback (CompleteCallback callback)
+{
+  NS_LOG_FUNCTION (this);
+  m_completeCallback = callback;
+}
+
+const std::vector<int32_t>&
+RingApplication::GetResultBuffer () const
+{
+  return m_allGatherBuffer;
+}
+
+} // namespace ns3
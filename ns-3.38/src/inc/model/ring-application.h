@@ -11,6 +11,7 @@
 #include "ns3/traced-callback.h"
 #include "ns3/tcp-socket-factory.h"
 #include "ring-header.h"
+#include "inc-header.h"
 
 #include <vector>
 #include <map>
@@ -74,7 +75,7 @@ public:
    * \param checkInterval 状态检查间隔(毫秒)
    * \param retryInterval 重试发送间隔(毫秒)
    * \param connectionStartTime 连接建立开始时间(秒)
-   * \param transferStartTime 数据传输开始时间(秒)
+   * \param transferStartTime 数据传输开始时间(秒)，为负值时等待StartTransfer手动启动
    * \param packetInterval 发包间隔(毫秒)
    */
   void Setup (uint32_t nodeId, uint32_t numNodes, uint32_t totalPackets, 
@@ -117,7 +118,8 @@ public:
 
   /**
    * \brief 获取All-Gather结果缓冲区的验证结果
-   * \return 如果所有值都等于节点数则返回true
+   * \return 合成数据模式下如果所有值都等于节点数则返回true，
+   *         真实数据模式下如果归约已完成则返回true
    */
   bool VerifyResults () const;
 
@@ -140,6 +142,53 @@ public:
    */
   void SetTimingParams (double connectionStartTime, double transferStartTime);
 
+  /**
+   * \brief 手动启动数据传输，用于transferStartTime为负值的情况
+   *
+   * 连接已建立时立即开始传输，否则在连接建立后开始，
+   * 便于提前建立连接，在集合通信真正就绪时再启动。
+   * 开启保持连接时，上一次归约完成后可再次调用，在已有连接上开始新一次归约，
+   * Ring中所有节点需在同一时刻调用
+   */
+  void StartTransfer (void);
+
+  /**
+   * \brief 设置归约完成后是否保持连接
+   *
+   * 默认完成后停止应用并关闭连接；保持连接时可通过StartTransfer复用连接进行多次归约，
+   * 避免每次归约重新建立连接和占用新的端口
+   * \param keep 是否保持连接
+   */
+  void SetKeepConnection (bool keep);
+
+  /**
+   * \brief 设置参与归约的本地数据，切换为真实数据模式，需在开始传输前调用
+   *
+   * 默认的合成数据模式下每个节点的每个报文贡献1；真实数据模式下每个报文携带
+   * data中对应的一个值，按op归约（AVERAGE为求和后除以节点数）。
+   * 报文数为data的大小向上取整到节点数的整数倍，补齐的报文结果被丢弃
+   * \param data 本地数据，每个报文一个值
+   * \param op 归约操作，不支持CUSTOM
+   */
+  void SetInputData (const std::vector<int32_t>& data, IncHeader::Operation op);
+
+  /**
+   * \brief 回调函数类型定义，用于Ring Allreduce完成通知
+   */
+  typedef Callback<void> CompleteCallback;
+
+  /**
+   * \brief 设置Ring Allreduce完成回调函数
+   * \param callback 完成时调用的回调函数
+   */
+  void SetCompleteCallback (CompleteCallback callback);
+
+  /**
+   * \brief 获取All-Gather结果缓冲区
+   * \return 结果缓冲区的引用
+   */
+  const std::vector<int32_t>& GetResultBuffer () const;
+
 protected:
   /**
    * \brief 启动应用
@@ -161,6 +210,18 @@ private:
    */
   void InitializeBuffers (void);
 
+  /**
+   * \brief 按当前归约操作合并一个值
+   * \param opi 原始包索引
+   * \param value 收到的部分归约结果
+   */
+  void ReduceValue (uint32_t opi, int32_t value);
+
+  /**
+   * \brief 完成归约，写入结果缓冲区并通知完成
+   */
+  void FinishTransfer (void);
+
   /**
    * \brief 开始建立连接
    */
@@ -333,6 +394,14 @@ private:
   bool m_canSend;                   //!< 是否可以发送
   bool m_receiveReady;              //!< 是否可以开始下一轮接收
   bool m_sendReady;                 //!< 是否可以开始下一轮发送
+  bool m_connected;                 //!< 手动启动模式下连接是否已建立
+  bool m_transferRequested;         //!< 手动启动模式下是否已请求开始传输
+  bool m_keepConnection;            //!< 归约完成后是否保持连接
+  
+  // 真实数据模式
+  bool m_userData;                  //!< 是否使用SetInputData设置的数据
+  std::vector<int32_t> m_inputData; //!< 本地输入数据
+  IncHeader::Operation m_operation; //!< 归约操作
   
   // 后节点状态
   NodeState m_nextNodeState;        //!< 后节点状态
@@ -348,6 +417,8 @@ private:
   // 跟踪回调
   TracedCallback<Ptr<const Packet>> m_txTrace;   //!< 发送跟踪
   TracedCallback<Ptr<const Packet>> m_rxTrace;   //!< 接收跟踪
+
+  CompleteCallback m_completeCallback;           //!< 完成回调
 };
 
 } // namespace ns3
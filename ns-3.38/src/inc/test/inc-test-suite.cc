@@ -1,12 +1,27 @@
 // Include a header file from your module to test.
 #include "ns3/inc.h"
 #include "ns3/inc-header.h"
+#include "ns3/inc-sparse-header.h"
+#include "ns3/inc-stack.h"
+#include "ns3/inc-switch.h"
+#include "ns3/inc-fallback-controller.h"
+#include "ns3/inc-tree-helper.h"
+#include "ns3/inc-training-workload.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 #include "ns3/packet.h"
 #include "ns3/buffer.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/node-container.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/point-to-point-helper.h"
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -123,6 +138,503 @@ IncHeaderTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(receivedHeader.GetLength(), 1024, "Wrong Length");
 }
 
+/**
+ * \ingroup inc-tests
+ * Test case for switch failure detection and ring fallback
+ */
+class IncSwitchFailoverTestCase : public TestCase
+{
+  public:
+    IncSwitchFailoverTestCase();
+    virtual ~IncSwitchFailoverTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+IncSwitchFailoverTestCase::IncSwitchFailoverTestCase()
+    : TestCase("IncSwitch failure falls back to ring AllReduce")
+{
+}
+
+IncSwitchFailoverTestCase::~IncSwitchFailoverTestCase()
+{
+}
+
+void
+IncSwitchFailoverTestCase::DoRun()
+{
+    // 一个交换机连接两个主机，交换机的网计算引擎在AllReduce开始后停止，
+    // 之后每次AllReduce都要回退到Ring
+    const uint32_t nHosts = 2;
+    const uint32_t totalPackets = 64;
+
+    NodeContainer switchNode;
+    switchNode.Create(1);
+    NodeContainer hosts;
+    hosts.Create(nHosts);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("1Gbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("10us"));
+
+    InternetStackHelper internet;
+    internet.Install(switchNode);
+    internet.Install(hosts);
+
+    Ipv4AddressHelper ipv4;
+    std::vector<Ipv4InterfaceContainer> interfaces;
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        std::ostringstream subnet;
+        subnet << "10.1." << (i + 1) << ".0";
+        ipv4.SetBase(subnet.str().c_str(), "255.255.255.0");
+        interfaces.push_back(ipv4.Assign(p2p.Install(switchNode.Get(0), hosts.Get(i))));
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Ptr<IncSwitch> incSwitch = CreateObject<IncSwitch>();
+    switchNode.Get(0)->AddApplication(incSwitch);
+    incSwitch->SetStartTime(Seconds(0.5));
+    incSwitch->SetStopTime(Seconds(2.0002));
+
+    std::vector<std::tuple<Ipv4Address, uint16_t, Ipv4Address, uint16_t, bool>> linkState;
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        linkState.push_back(std::make_tuple(interfaces[i].GetAddress(0), i + 1,
+                                            interfaces[i].GetAddress(1), nHosts + i + 1, true));
+    }
+    incSwitch->InitializeEngine(linkState, 1, nHosts, totalPackets);
+
+    Ptr<IncFallbackController> controller = CreateObject<IncFallbackController>();
+    std::vector<Ptr<IncStack>> stacks;
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        Ptr<IncStack> stack = CreateObject<IncStack>();
+        hosts.Get(i)->AddApplication(stack);
+        stack->SetStartTime(Seconds(1.0));
+        stack->SetStopTime(Seconds(100.0));
+        stack->SetAttribute("MaxRetransmissions", UintegerValue(2));
+        stack->SetRemote(interfaces[i].GetAddress(0), i + 1);
+        stack->SetLocal(interfaces[i].GetAddress(1), nHosts + i + 1);
+        stack->SetWindowSize(8);
+        stack->SetTotalPackets(totalPackets);
+        // 各主机的填充值不同，回退结果必须是真实数据的归约
+        stack->SetFillValue(3 + 4 * i);
+        controller->AddHost(stack, interfaces[i].GetAddress(1));
+        Simulator::Schedule(Seconds(2.0), &IncStack::AllReduce, stack);
+        stacks.push_back(stack);
+    }
+    const int32_t expected = 3 + 7;
+
+    Simulator::Stop(Seconds(20.0));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(controller->IsFallbackStarted(), true, "Fallback was not started");
+    NS_TEST_ASSERT_MSG_EQ(controller->GetFallbackCount(), 1, "Fallback did not finish");
+    NS_TEST_ASSERT_MSG_LT(controller->GetFallbackStartPsn(), totalPackets, "Fallback covers no PSN");
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(stacks[i]->IsSwitchFailed(), true, "Switch failure not detected");
+        NS_TEST_ASSERT_MSG_EQ(stacks[i]->IsCompleted(), true, "AllReduce did not complete");
+        const std::vector<int32_t>& result = stacks[i]->GetResultBuffer();
+        for (uint32_t psn = 0; psn < totalPackets; psn++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(result[psn], expected, "Wrong result at PSN " << psn);
+        }
+    }
+
+    // 同一组的下一次AllReduce再次故障，复用Ring连接完成全部PSN
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        stacks[i]->SetFillValue(5 + i);
+        stacks[i]->AllReduce();
+    }
+    Simulator::Stop(Seconds(40.0));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(controller->GetFallbackCount(), 2, "Second failure was ignored");
+    NS_TEST_ASSERT_MSG_EQ(controller->GetFallbackStartPsn(), 0, "Second fallback not from PSN 0");
+    for (uint32_t i = 0; i < nHosts; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(stacks[i]->IsCompleted(), true, "Second AllReduce did not complete");
+        const std::vector<int32_t>& result = stacks[i]->GetResultBuffer();
+        for (uint32_t psn = 0; psn < totalPackets; psn++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(result[psn], 5 + 6, "Wrong second result at PSN " << psn);
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup inc-tests
+ * Test case for IncTreeHelper subtree partitioning and tree construction
+ */
+class IncTreeHelperTestCase : public TestCase
+{
+  public:
+    IncTreeHelperTestCase();
+    virtual ~IncTreeHelperTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+IncTreeHelperTestCase::IncTreeHelperTestCase()
+    : TestCase("IncTreeHelper partitions by subtree and builds a working tree")
+{
+}
+
+IncTreeHelperTestCase::~IncTreeHelperTestCase()
+{
+}
+
+void
+IncTreeHelperTestCase::DoRun()
+{
+    // 4叉3层树，4个分区：第1层的每棵子树一个分区，根归属分区0
+    IncTreeHelper partitioned;
+    partitioned.SetTreeShape(4, 3);
+    partitioned.SetPartitionCount(4);
+    NS_TEST_ASSERT_MSG_EQ(partitioned.GetSwitchPartition(0, 0), 0, "Root not in partition 0");
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(partitioned.GetSwitchPartition(1, i), i, "Wrong level-1 partition");
+    }
+    for (uint32_t h = 0; h < 64; h++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(partitioned.GetHostPartition(h), h / 16, "Host not in its subtree's partition");
+        NS_TEST_ASSERT_MSG_EQ(partitioned.GetSwitchPartition(2, h / 4), h / 16, "Leaf switch split from its hosts");
+    }
+
+    // 3个分区：4棵子树按0,0,1,2分配
+    partitioned.SetPartitionCount(3);
+    NS_TEST_ASSERT_MSG_EQ(partitioned.GetSwitchPartition(1, 1), 0, "Wrong partition for subtree 1");
+    NS_TEST_ASSERT_MSG_EQ(partitioned.GetSwitchPartition(1, 3), 2, "Wrong partition for subtree 3");
+
+    // 8个分区：在第2层划分，相邻的两棵子树共享一个分区
+    partitioned.SetPartitionCount(8);
+    NS_TEST_ASSERT_MSG_EQ(partitioned.GetSwitchPartition(1, 1), 2, "Wrong partition above the cut");
+    NS_TEST_ASSERT_MSG_EQ(partitioned.GetHostPartition(63), 7, "Wrong partition for last host");
+
+    // 单分区下构建2叉2层树并完成一次AllReduce
+    uint32_t totalPackets = 32;
+    IncTreeHelper tree;
+    tree.SetTreeShape(2, 2);
+    tree.SetLinkAttributes("1Gbps", "10us");
+    tree.SetGroupParameters(1, 64);
+    tree.SetStackAttribute("TotalPackets", UintegerValue(totalPackets));
+    tree.SetStackAttribute("WindowSize", UintegerValue(8));
+    tree.Create();
+    tree.InstallApplications(Seconds(0.5), Seconds(10.0));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    NS_TEST_ASSERT_MSG_EQ(tree.GetSwitchNodes().GetN(), 3, "Wrong switch count");
+    NS_TEST_ASSERT_MSG_EQ(tree.GetHostNodes().GetN(), 4, "Wrong host count");
+    NS_TEST_ASSERT_MSG_EQ(tree.GetCrossPartitionLinkCount(), 0, "Unexpected cross-partition link");
+
+    std::vector<Ptr<IncStack>> stacks = tree.GetLocalStacks();
+    NS_TEST_ASSERT_MSG_EQ(stacks.size(), 4, "Stacks not installed on all hosts");
+    for (auto& stack : stacks)
+    {
+        Simulator::Schedule(Seconds(1.0), &IncStack::AllReduce, stack);
+    }
+
+    Simulator::Stop(Seconds(10.0));
+    Simulator::Run();
+
+    for (auto& stack : stacks)
+    {
+        NS_TEST_ASSERT_MSG_EQ(stack->IsCompleted(), true, "AllReduce did not complete");
+        const std::vector<int32_t>& result = stack->GetResultBuffer();
+        for (uint32_t psn = 0; psn < totalPackets; psn++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(result[psn], 4, "Wrong result at PSN " << psn);
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup inc-tests
+ * Test case for MTU-aware payload sizing shared by stack, switch and helper
+ */
+class IncPayloadSizeTestCase : public TestCase
+{
+  public:
+    IncPayloadSizeTestCase();
+    virtual ~IncPayloadSizeTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * 记录发送的数据报文大小
+     * \param packet 发送的报文
+     */
+    void TxCallback(Ptr<const Packet> packet);
+
+    uint32_t m_maxTxSize; //!< 发送的最大报文大小
+};
+
+IncPayloadSizeTestCase::IncPayloadSizeTestCase()
+    : TestCase("IncStack and IncSwitch use the group's jumbo payload size"),
+      m_maxTxSize(0)
+{
+}
+
+IncPayloadSizeTestCase::~IncPayloadSizeTestCase()
+{
+}
+
+void
+IncPayloadSizeTestCase::TxCallback(Ptr<const Packet> packet)
+{
+    m_maxTxSize = std::max(m_maxTxSize, packet->GetSize());
+}
+
+void
+IncPayloadSizeTestCase::DoRun()
+{
+    uint16_t payloadSize = IncHeader::MAX_PAYLOAD_SIZE;
+    uint32_t expectedPackets = 16;
+
+    IncTreeHelper tree;
+    tree.SetTreeShape(2, 1);
+    tree.SetLinkAttributes("10Gbps", "10us");
+    tree.SetGroupParameters(1, 64, payloadSize);
+    tree.SetStackAttribute("TotalPackets", UintegerValue(0));
+    tree.SetStackAttribute("DataSize", UintegerValue(payloadSize * (expectedPackets - 1) + 1));
+    tree.SetStackAttribute("WindowSize", UintegerValue(4));
+    tree.Create();
+    tree.InstallApplications(Seconds(0.5), Seconds(10.0));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    std::vector<Ptr<IncStack>> stacks = tree.GetLocalStacks();
+    for (auto& stack : stacks)
+    {
+        NS_TEST_ASSERT_MSG_EQ(stack->GetPayloadSize(), payloadSize, "Helper did not set the payload size");
+        NS_TEST_ASSERT_MSG_EQ(stack->GetMaxPayloadSize(), payloadSize, "Helper did not raise the link MTU");
+        stack->TraceConnectWithoutContext("Tx", MakeCallback(&IncPayloadSizeTestCase::TxCallback, this));
+        Simulator::Schedule(Seconds(1.0), &IncStack::AllReduce, stack);
+    }
+
+    Simulator::Stop(Seconds(10.0));
+    Simulator::Run();
+
+    IncHeader header;
+    NS_TEST_ASSERT_MSG_EQ(m_maxTxSize, header.GetSerializedSize() + payloadSize, "Wrong data packet size");
+    for (auto& stack : stacks)
+    {
+        NS_TEST_ASSERT_MSG_EQ(stack->GetTotalPackets(), expectedPackets, "Packet count not derived from payload size");
+        NS_TEST_ASSERT_MSG_EQ(stack->IsCompleted(), true, "AllReduce did not complete");
+        const std::vector<int32_t>& result = stack->GetResultBuffer();
+        for (uint32_t psn = 0; psn < expectedPackets; psn++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(result[psn], 2, "Wrong result at PSN " << psn);
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup inc-tests
+ * Test case for sparse key-value aggregation with hash collisions on the switches
+ */
+class IncSparseAggregationTestCase : public TestCase
+{
+  public:
+    IncSparseAggregationTestCase();
+    virtual ~IncSparseAggregationTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+IncSparseAggregationTestCase::IncSparseAggregationTestCase()
+    : TestCase("IncSwitch aggregates sparse key-value payloads and forwards spilled pairs")
+{
+}
+
+IncSparseAggregationTestCase::~IncSparseAggregationTestCase()
+{
+}
+
+void
+IncSparseAggregationTestCase::DoRun()
+{
+    uint32_t tensorSize = 1000;
+
+    // 2叉2层树，每个槽位只有4个聚合单元，保证出现哈希冲突
+    IncTreeHelper tree;
+    tree.SetTreeShape(2, 2);
+    tree.SetLinkAttributes("1Gbps", "10us");
+    tree.SetGroupParameters(1, 64);
+    tree.SetSparseMode(4);
+    tree.SetStackAttribute("WindowSize", UintegerValue(4));
+    tree.Create();
+    tree.InstallApplications(Seconds(0.5), Seconds(10.0));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    // 主机h的非零元素位于索引 h*3 + 11k，各主机的非零元素部分重叠
+    std::vector<Ptr<IncStack>> stacks = tree.GetLocalStacks();
+    std::vector<int32_t> expected(tensorSize, 0);
+    for (uint32_t h = 0; h < stacks.size(); h++)
+    {
+        std::vector<IncSparseHeader::Entry> entries;
+        for (uint32_t index = h * 3; index < tensorSize; index += 11)
+        {
+            int32_t value = static_cast<int32_t>(h + 1);
+            entries.push_back({index, value});
+            expected[index] += value;
+        }
+        stacks[h]->SetSparseData(tensorSize, entries);
+        Simulator::Schedule(Seconds(1.0), &IncStack::AllReduce, stacks[h]);
+    }
+
+    Simulator::Stop(Seconds(10.0));
+    Simulator::Run();
+
+    uint64_t spilled = 0;
+    for (auto& incSwitch : tree.GetLocalSwitches())
+    {
+        spilled += incSwitch->GetSparseSpillCount();
+    }
+    NS_TEST_ASSERT_MSG_GT(spilled, 0, "Expected hash collisions with 4 cells per slot");
+
+    uint32_t expectedPackets = (tensorSize + IncSparseHeader::GetMaxEntries(IncHeader::DEFAULT_PAYLOAD_SIZE) - 1) /
+                               IncSparseHeader::GetMaxEntries(IncHeader::DEFAULT_PAYLOAD_SIZE);
+    for (auto& stack : stacks)
+    {
+        NS_TEST_ASSERT_MSG_EQ(stack->IsCompleted(), true, "Sparse AllReduce did not complete");
+        NS_TEST_ASSERT_MSG_EQ(stack->GetTotalPackets(), expectedPackets, "Packet count not derived from block size");
+        const std::vector<int32_t>& result = stack->GetSparseResult();
+        NS_TEST_ASSERT_MSG_EQ(result.size(), tensorSize, "Wrong sparse result size");
+        for (uint32_t index = 0; index < tensorSize; index++)
+        {
+            NS_TEST_ASSERT_MSG_EQ(result[index], expected[index], "Wrong sparse result at index " << index);
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup inc-tests
+ * Test case for the training workload driver running multiple iterations on both backends
+ */
+class IncTrainingWorkloadTestCase : public TestCase
+{
+  public:
+    IncTrainingWorkloadTestCase();
+    virtual ~IncTrainingWorkloadTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * 构建2叉1层树并运行训练负载
+     * \param backend 集合通信后端
+     * \return 每轮迭代耗时
+     */
+    std::vector<Time> RunWorkload(IncTrainingWorkload::Backend backend);
+};
+
+IncTrainingWorkloadTestCase::IncTrainingWorkloadTestCase()
+    : TestCase("IncTrainingWorkload runs bucketed iterations over INC and ring")
+{
+}
+
+IncTrainingWorkloadTestCase::~IncTrainingWorkloadTestCase()
+{
+}
+
+std::vector<Time>
+IncTrainingWorkloadTestCase::RunWorkload(IncTrainingWorkload::Backend backend)
+{
+    IncTreeHelper tree;
+    tree.SetTreeShape(2, 1);
+    tree.SetLinkAttributes("1Gbps", "10us");
+    tree.SetGroupParameters(1, 64);
+    tree.SetStackAttribute("WindowSize", UintegerValue(8));
+    tree.Create();
+    tree.InstallApplications(Seconds(0.5), Seconds(10.0));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    // 4层，每层16KB梯度，32KB一个桶
+    Ptr<IncTrainingWorkload> workload = CreateObject<IncTrainingWorkload>();
+    workload->SetAttribute("Backend", EnumValue(backend));
+    workload->SetAttribute("Iterations", UintegerValue(3));
+    workload->SetAttribute("BucketSize", UintegerValue(32 * 1024));
+    workload->SetAttribute("OptimizerTime", TimeValue(MilliSeconds(1)));
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        workload->AddLayer(MilliSeconds(1), MilliSeconds(2), 16 * 1024);
+    }
+    std::vector<Ptr<IncStack>> stacks = tree.GetLocalStacks();
+    for (uint32_t h = 0; h < stacks.size(); h++)
+    {
+        if (backend == IncTrainingWorkload::INC)
+        {
+            workload->AddHost(stacks[h]);
+        }
+        else
+        {
+            workload->AddHost(tree.GetHostNodes().Get(h), tree.GetHostAddress(h));
+        }
+    }
+    Ptr<Node> host = tree.GetHostNodes().Get(0);
+    uint32_t applications = host->GetNApplications();
+    Simulator::Schedule(Seconds(1.0), &IncTrainingWorkload::Start, workload);
+
+    Simulator::Stop(Seconds(10.0));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(workload->GetBucketCount(), 2, "Wrong bucket count");
+    if (backend == IncTrainingWorkload::RING)
+    {
+        // 每个桶一个Ring应用，各轮迭代复用
+        NS_TEST_EXPECT_MSG_EQ(host->GetNApplications(), applications + 2, "Ring applications leaked");
+    }
+    NS_TEST_EXPECT_MSG_EQ(workload->IsFinished(), true, "Workload did not finish all iterations");
+    if (backend == IncTrainingWorkload::INC)
+    {
+        // 最后一个桶的AllReduce结果正确，说明多次AllReduce之间PSN保持连续
+        for (auto& stack : stacks)
+        {
+            NS_TEST_EXPECT_MSG_EQ(stack->GetTotalPackets(), 32, "Wrong packet count for the last bucket");
+            for (int32_t value : stack->GetResultBuffer())
+            {
+                NS_TEST_EXPECT_MSG_EQ(value, 2, "Wrong result in the last bucket");
+            }
+        }
+    }
+    std::vector<Time> times = workload->GetIterationTimes();
+
+    Simulator::Destroy();
+    return times;
+}
+
+void
+IncTrainingWorkloadTestCase::DoRun()
+{
+    // 单轮计算时间：前向4ms + 反向8ms + 优化器1ms，最后一个桶的通信无法被掩盖
+    Time compute = MilliSeconds(13);
+    for (auto backend : {IncTrainingWorkload::INC, IncTrainingWorkload::RING})
+    {
+        std::vector<Time> times = RunWorkload(backend);
+        NS_TEST_ASSERT_MSG_EQ(times.size(), 3, "Wrong number of iterations for backend " << backend);
+        for (const auto& t : times)
+        {
+            NS_TEST_ASSERT_MSG_GT(t, compute, "Iteration shorter than its compute time");
+        }
+    }
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -143,6 +655,11 @@ IncTestSuite::IncTestSuite()
     // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
     AddTestCase(new IncTestCase1, TestCase::QUICK);
     AddTestCase(new IncHeaderTestCase, TestCase::QUICK);
+    AddTestCase(new IncSwitchFailoverTestCase, TestCase::QUICK);
+    AddTestCase(new IncTreeHelperTestCase, TestCase::QUICK);
+    AddTestCase(new IncPayloadSizeTestCase, TestCase::QUICK);
+    AddTestCase(new IncSparseAggregationTestCase, TestCase::QUICK);
+    AddTestCase(new IncTrainingWorkloadTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
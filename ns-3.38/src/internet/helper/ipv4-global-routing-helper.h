@@ -86,6 +86,11 @@ class Ipv4GlobalRoutingHelper : public Ipv4RoutingHelper
      * Users must first call PopulateRoutingTables() and then may subsequently
      * call RecomputeRoutingTables() at any later time in the simulation.
      *
+     * When the GlobalRoutingIncremental global value is set, the routers
+     * whose shortest path tree did not change keep it, and only their
+     * routes are added again.  The GlobalRoutingThreads global value sets
+     * the number of threads running the SPF calculations.
+     *
      */
     static void RecomputeRoutingTables();
 };
@@ -28,16 +28,21 @@
 #include "ipv4-global-routing.h"
 
 #include "ns3/assert.h"
+#include "ns3/boolean.h"
 #include "ns3/fatal-error.h"
+#include "ns3/global-value.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4.h"
 #include "ns3/log.h"
 #include "ns3/node-list.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <queue>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -46,6 +51,158 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("GlobalRouteManagerImpl");
 
+/**
+ * \relates GlobalRouteManager
+ * \anchor GlobalValueGlobalRoutingThreads
+ * \brief The number of threads computing the global routes.
+ */
+static GlobalValue g_globalRoutingThreads =
+    GlobalValue("GlobalRoutingThreads",
+                "The number of threads computing the global routes, "
+                "or 0 for one thread per hardware thread",
+                UintegerValue(1),
+                MakeUintegerChecker<uint32_t>());
+
+/**
+ * \relates GlobalRouteManager
+ * \anchor GlobalValueGlobalRoutingIncremental
+ * \brief A global switch to recompute the global routes incrementally.
+ */
+static GlobalValue g_globalRoutingIncremental =
+    GlobalValue("GlobalRoutingIncremental",
+                "Whether a recomputation of the global routes only runs the SPF "
+                "calculations of the routers that the topology changes can affect",
+                BooleanValue(false),
+                MakeBooleanChecker());
+
+/**
+ * \brief Get the number of threads computing the global routes.
+ * \returns the number of threads
+ */
+static uint32_t
+GetThreads()
+{
+    UintegerValue value;
+    g_globalRoutingThreads.GetValue(value);
+    uint32_t nThreads = value.Get();
+    if (nThreads == 0)
+    {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    return nThreads;
+}
+
+/**
+ * \brief Get whether the global routes are recomputed incrementally.
+ * \returns true if they are
+ */
+static bool
+IsIncremental()
+{
+    BooleanValue value;
+    g_globalRoutingIncremental.GetValue(value);
+    return value.Get();
+}
+
+/**
+ * \brief Compare two Link State Advertisements, except for their SPF status.
+ * \param a the first LSA
+ * \param b the second LSA
+ * \returns true if the LSAs advertise the same links
+ */
+static bool
+IsSameLSA(const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+    if (a->GetLSType() != b->GetLSType() || a->GetLinkStateId() != b->GetLinkStateId() ||
+        a->GetAdvertisingRouter() != b->GetAdvertisingRouter() ||
+        a->GetNetworkLSANetworkMask() != b->GetNetworkLSANetworkMask() ||
+        a->GetNLinkRecords() != b->GetNLinkRecords() ||
+        a->GetNAttachedRouters() != b->GetNAttachedRouters())
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->GetNLinkRecords(); i++)
+    {
+        GlobalRoutingLinkRecord* la = a->GetLinkRecord(i);
+        GlobalRoutingLinkRecord* lb = b->GetLinkRecord(i);
+        if (la->GetLinkType() != lb->GetLinkType() || la->GetLinkId() != lb->GetLinkId() ||
+            la->GetLinkData() != lb->GetLinkData() || la->GetMetric() != lb->GetMetric())
+        {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < a->GetNAttachedRouters(); i++)
+    {
+        if (a->GetAttachedRouter(i) != b->GetAttachedRouter(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// The cost of the edges of the SPF graph, by their source and destination Link State IDs
+typedef std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t> SPFEdges;
+
+/**
+ * \brief Get the edges that the SPF calculation follows in an LSDB.
+ *
+ * The edges are the point-to-point and transit network links of the router
+ * LSAs and, at no cost, the links from the network LSAs to their attached
+ * routers.  Only the lowest cost of parallel links is kept.
+ *
+ * \param lsdb the LSDB
+ * \returns the edges
+ */
+static SPFEdges
+GetEdges(const GlobalRouteManagerLSDB* lsdb)
+{
+    SPFEdges edges;
+    auto addEdge = [&edges](GlobalRoutingLSA* v, GlobalRoutingLSA* w, uint32_t cost) {
+        auto key = std::make_pair(v->GetLinkStateId(), w->GetLinkStateId());
+        auto it = edges.find(key);
+        if (it == edges.end())
+        {
+            edges.emplace(key, cost);
+        }
+        else
+        {
+            it->second = std::min(it->second, cost);
+        }
+    };
+    for (uint32_t i = 0; i < lsdb->GetNumLSAs(); i++)
+    {
+        GlobalRoutingLSA* v = lsdb->GetLSAByIndex(i);
+        if (v->GetLSType() == GlobalRoutingLSA::NetworkLSA)
+        {
+            for (uint32_t j = 0; j < v->GetNAttachedRouters(); j++)
+            {
+                GlobalRoutingLSA* w = lsdb->GetLSAByLinkData(v->GetAttachedRouter(j));
+                if (w)
+                {
+                    addEdge(v, w, 0);
+                }
+            }
+            continue;
+        }
+        for (uint32_t j = 0; j < v->GetNLinkRecords(); j++)
+        {
+            GlobalRoutingLinkRecord* l = v->GetLinkRecord(j);
+            if (l->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint &&
+                l->GetLinkType() != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+                continue;
+            }
+            GlobalRoutingLSA* w = lsdb->GetLSA(l->GetLinkId());
+            if (w)
+            {
+                addEdge(v, w, l->GetMetric());
+            }
+        }
+    }
+    return edges;
+}
+
 /**
  * \brief Stream insertion operator.
  *
@@ -429,7 +586,10 @@ SPFVertex::ClearVertexProcessed()
 
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB()
     : m_database(),
-      m_extdatabase()
+      m_extdatabase(),
+      m_lsas(),
+      m_lsaIndexes(),
+      m_linkDataIndex()
 {
     NS_LOG_FUNCTION(this);
 }
@@ -474,9 +634,24 @@ GlobalRouteManagerLSDB::Insert(Ipv4Address addr, GlobalRoutingLSA* lsa)
     {
         m_extdatabase.push_back(lsa);
     }
-    else
+    else if (m_database.insert(LSDBPair_t(addr, lsa)).second)
     {
-        m_database.insert(LSDBPair_t(addr, lsa));
+        m_lsaIndexes[lsa] = m_lsas.size();
+        m_lsas.push_back(lsa);
+        for (uint32_t j = 0; j < lsa->GetNLinkRecords(); j++)
+        {
+            GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
+            if (lr->GetLinkType() != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+                continue;
+            }
+            // GetLSAByLinkData () returns the first match in database order.
+            auto it = m_linkDataIndex.find(lr->GetLinkData());
+            if (it == m_linkDataIndex.end() || addr < it->second.first)
+            {
+                m_linkDataIndex[lr->GetLinkData()] = LSDBPair_t(addr, lsa);
+            }
+        }
     }
 }
 
@@ -501,13 +676,10 @@ GlobalRouteManagerLSDB::GetLSA(Ipv4Address addr) const
     //
     // Look up an LSA by its address.
     //
-    LSDBMap_t::const_iterator i;
-    for (i = m_database.begin(); i != m_database.end(); i++)
+    LSDBMap_t::const_iterator i = m_database.find(addr);
+    if (i != m_database.end())
     {
-        if (i->first == addr)
-        {
-            return i->second;
-        }
+        return i->second;
     }
     return nullptr;
 }
@@ -517,26 +689,39 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
 {
     NS_LOG_FUNCTION(this << addr);
     //
-    // Look up an LSA by its address.
+    // Look up an LSA by the link data of its TransitNetwork link records.
     //
-    LSDBMap_t::const_iterator i;
-    for (i = m_database.begin(); i != m_database.end(); i++)
+    auto i = m_linkDataIndex.find(addr);
+    if (i != m_linkDataIndex.end())
     {
-        GlobalRoutingLSA* temp = i->second;
-        // Iterate among temp's Link Records
-        for (uint32_t j = 0; j < temp->GetNLinkRecords(); j++)
-        {
-            GlobalRoutingLinkRecord* lr = temp->GetLinkRecord(j);
-            if (lr->GetLinkType() == GlobalRoutingLinkRecord::TransitNetwork &&
-                lr->GetLinkData() == addr)
-            {
-                return temp;
-            }
-        }
+        return i->second.second;
     }
     return nullptr;
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_lsas.size();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex(uint32_t index) const
+{
+    NS_LOG_FUNCTION(this << index);
+    return m_lsas.at(index);
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetLSAIndex(const GlobalRoutingLSA* lsa) const
+{
+    NS_LOG_FUNCTION(this << lsa);
+    auto i = m_lsaIndexes.find(lsa);
+    NS_ASSERT_MSG(i != m_lsaIndexes.end(), "LSA not in the database");
+    return i->second;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -544,16 +729,29 @@ GlobalRouteManagerLSDB::GetLSAByLinkData(Ipv4Address addr) const
 // ---------------------------------------------------------------------------
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl()
-    : m_spfroot(nullptr)
+    : m_spfroot(nullptr),
+      m_ownLsdb(true),
+      m_keepTrees(false),
+      m_root(nullptr)
 {
     NS_LOG_FUNCTION(this);
     m_lsdb = new GlobalRouteManagerLSDB();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb, bool keepTrees)
+    : m_spfroot(nullptr),
+      m_lsdb(lsdb),
+      m_ownLsdb(false),
+      m_keepTrees(keepTrees),
+      m_root(nullptr)
+{
+    NS_LOG_FUNCTION(this << lsdb << keepTrees);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl()
 {
     NS_LOG_FUNCTION(this);
-    if (m_lsdb)
+    if (m_lsdb && m_ownLsdb)
     {
         delete m_lsdb;
     }
@@ -572,6 +770,20 @@ GlobalRouteManagerImpl::DebugUseLsdb(GlobalRouteManagerLSDB* lsdb)
 
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    DeleteRoutes();
+    if (m_lsdb)
+    {
+        NS_LOG_LOGIC("Deleting LSDB, creating new one");
+        delete m_lsdb;
+        m_lsdb = new GlobalRouteManagerLSDB();
+    }
+    m_roots.clear();
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes()
 {
     NS_LOG_FUNCTION(this);
     NodeList::Iterator listEnd = NodeList::End();
@@ -597,12 +809,6 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes()
         }
         NS_LOG_LOGIC("Deleted " << j << " global routes from node " << node->GetId());
     }
-    if (m_lsdb)
-    {
-        NS_LOG_LOGIC("Deleting LSDB, creating new one");
-        delete m_lsdb;
-        m_lsdb = new GlobalRouteManagerLSDB();
-    }
 }
 
 //
@@ -701,10 +907,224 @@ void
 GlobalRouteManagerImpl::InitializeRoutes()
 {
     NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("About to start SPF calculation");
+    m_keepTrees = IsIncremental();
+    std::vector<SPFRoot> roots = GetRoots();
+    ComputeRoutes(roots);
+    for (auto& root : roots)
+    {
+        InstallRoutes(root);
+    }
+    if (m_keepTrees)
+    {
+        m_roots.swap(roots);
+    }
+    NS_LOG_INFO("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes()
+{
+    NS_LOG_FUNCTION(this);
+    if (!IsIncremental() || m_roots.empty())
+    {
+        DeleteGlobalRoutes();
+        BuildGlobalRoutingDatabase();
+        InitializeRoutes();
+        return;
+    }
+    //
+    // Keep the LSDB and the trees of the last calculation to find which
+    // routers the changes of the LSDB can affect.
+    //
+    NS_LOG_INFO("About to start incremental SPF calculation");
+    GlobalRouteManagerLSDB* oldLsdb = m_lsdb;
+    std::vector<SPFRoot> oldRoots;
+    oldRoots.swap(m_roots);
+    m_lsdb = new GlobalRouteManagerLSDB();
+    DeleteRoutes();
+    BuildGlobalRoutingDatabase();
+    std::vector<SPFRoot> roots = GetRoots();
+    FindChangedRoots(roots, oldRoots, oldLsdb);
+    oldRoots.clear();
+    delete oldLsdb;
+    ComputeRoutes(roots);
+    for (auto& root : roots)
+    {
+        InstallRoutes(root);
+    }
+    m_roots.swap(roots);
+    NS_LOG_INFO("Finished incremental SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::FindChangedRoots(std::vector<SPFRoot>& roots,
+                                         std::vector<SPFRoot>& oldRoots,
+                                         const GlobalRouteManagerLSDB* oldLsdb) const
+{
+    NS_LOG_FUNCTION(this << roots.size() << oldRoots.size() << oldLsdb);
+    //
+    // The trees only carry over between LSDBs with the same LSAs, by Link State
+    // ID, and the same External LSAs.
+    //
+    uint32_t nLSAs = m_lsdb->GetNumLSAs();
+    if (oldLsdb->GetNumLSAs() != nLSAs || oldLsdb->GetNumExtLSAs() != m_lsdb->GetNumExtLSAs())
+    {
+        NS_LOG_LOGIC("LSAs added or removed, recomputing all the routers");
+        return;
+    }
+    for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs(); i++)
+    {
+        if (!IsSameLSA(oldLsdb->GetExtLSA(i), m_lsdb->GetExtLSA(i)))
+        {
+            NS_LOG_LOGIC("External LSAs changed, recomputing all the routers");
+            return;
+        }
+    }
+    //
+    // Map the indexes of the old LSDB to the new one, and find the changed LSAs.
+    //
+    std::vector<uint32_t> indexes(nLSAs);
+    std::vector<bool> changed(nLSAs);
+    for (uint32_t i = 0; i < nLSAs; i++)
+    {
+        GlobalRoutingLSA* lsa = m_lsdb->GetLSAByIndex(i);
+        GlobalRoutingLSA* oldLsa = oldLsdb->GetLSA(lsa->GetLinkStateId());
+        if (!oldLsa)
+        {
+            NS_LOG_LOGIC("LSAs added or removed, recomputing all the routers");
+            return;
+        }
+        indexes[oldLsdb->GetLSAIndex(oldLsa)] = i;
+        changed[i] = !IsSameLSA(oldLsa, lsa);
+    }
+    //
+    // Find the edges whose cost changed, SPF_INFINITY standing for no edge,
+    // and the neighbors of each vertex in either LSDB.
+    //
+    struct ChangedEdge
+    {
+        uint32_t v;       //!< the source vertex
+        uint32_t w;       //!< the destination vertex
+        uint32_t oldCost; //!< the cost in the old LSDB
+        uint32_t newCost; //!< the cost in the new LSDB
+    };
+
+    std::vector<ChangedEdge> changedEdges;
+    std::vector<std::vector<uint32_t>> neighbors(nLSAs);
+    SPFEdges oldEdges = GetEdges(oldLsdb);
+    SPFEdges newEdges = GetEdges(m_lsdb);
+    auto o = oldEdges.begin();
+    auto n = newEdges.begin();
+    while (o != oldEdges.end() || n != newEdges.end())
+    {
+        std::pair<Ipv4Address, Ipv4Address> key;
+        uint32_t oldCost = SPF_INFINITY;
+        uint32_t newCost = SPF_INFINITY;
+        if (n == newEdges.end() || (o != oldEdges.end() && o->first < n->first))
+        {
+            key = o->first;
+            oldCost = (o++)->second;
+        }
+        else if (o == oldEdges.end() || n->first < o->first)
+        {
+            key = n->first;
+            newCost = (n++)->second;
+        }
+        else
+        {
+            key = o->first;
+            oldCost = (o++)->second;
+            newCost = (n++)->second;
+        }
+        uint32_t v = m_lsdb->GetLSAIndex(m_lsdb->GetLSA(key.first));
+        uint32_t w = m_lsdb->GetLSAIndex(m_lsdb->GetLSA(key.second));
+        neighbors[v].push_back(w);
+        neighbors[w].push_back(v);
+        if (oldCost != newCost)
+        {
+            changedEdges.push_back({v, w, oldCost, newCost});
+        }
+    }
+
+    std::map<Ipv4Address, SPFRoot*> oldRootsById;
+    for (auto& oldRoot : oldRoots)
+    {
+        oldRootsById[oldRoot.routerId] = &oldRoot;
+    }
+    for (auto& root : roots)
+    {
+        auto it = oldRootsById.find(root.routerId);
+        GlobalRoutingLSA* lsa = m_lsdb->GetLSA(root.routerId);
+        if (it == oldRootsById.end() || !lsa || it->second->tree.distances.empty() ||
+            it->second->addresses != root.addresses)
+        {
+            continue;
+        }
+        SPFTree& oldTree = it->second->tree;
+        //
+        // The root exit directions come from the LSAs of the router, of its
+        // neighbors and of the routers on its transit networks.
+        //
+        uint32_t rootIndex = m_lsdb->GetLSAIndex(lsa);
+        bool affected = changed[rootIndex];
+        for (uint32_t neighbor : neighbors[rootIndex])
+        {
+            affected = affected || changed[neighbor];
+            if (m_lsdb->GetLSAByIndex(neighbor)->GetLSType() == GlobalRoutingLSA::NetworkLSA)
+            {
+                for (uint32_t router : neighbors[neighbor])
+                {
+                    affected = affected || changed[router];
+                }
+            }
+        }
+        //
+        // The tree changes if an edge on one of its shortest paths changes, or
+        // if a changed edge gives a path as short as or shorter than the tree.
+        //
+        std::vector<uint32_t> distances(nLSAs);
+        for (uint32_t i = 0; i < nLSAs; i++)
+        {
+            distances[indexes[i]] = oldTree.distances[i];
+        }
+        for (auto e = changedEdges.begin(); !affected && e != changedEdges.end(); e++)
+        {
+            uint64_t dv = distances[e->v];
+            uint64_t dw = distances[e->w];
+            if (dv == SPF_INFINITY)
+            {
+                continue;
+            }
+            affected = (e->oldCost != SPF_INFINITY && dv + e->oldCost == dw) ||
+                       (e->newCost != SPF_INFINITY && dv + e->newCost <= dw);
+        }
+        NS_LOG_LOGIC("Router " << root.routerId
+                               << (affected ? " needs a new SPF calculation" : " keeps its tree"));
+        if (affected)
+        {
+            continue;
+        }
+        root.recompute = false;
+        root.tree.distances.swap(distances);
+        root.tree.vertices.swap(oldTree.vertices);
+        for (auto& vertex : root.tree.vertices)
+        {
+            vertex = indexes[vertex];
+        }
+        root.tree.exitOffsets.swap(oldTree.exitOffsets);
+        root.tree.exits.swap(oldTree.exits);
+    }
+}
+
+std::vector<GlobalRouteManagerImpl::SPFRoot>
+GlobalRouteManagerImpl::GetRoots() const
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<SPFRoot> roots;
     //
     // Walk the list of nodes in the system.
     //
-    NS_LOG_INFO("About to start SPF calculation");
     NodeList::Iterator listEnd = NodeList::End();
     for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
     {
@@ -728,10 +1148,154 @@ GlobalRouteManagerImpl::InitializeRoutes()
         //
         if (rtr && rtr->GetNumLSAs())
         {
-            SPFCalculate(rtr->GetRouterId());
+            roots.push_back(GetRoot(node));
         }
     }
-    NS_LOG_INFO("Finished SPF calculation");
+    return roots;
+}
+
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::GetRoot(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(node);
+    Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+    NS_ASSERT(rtr);
+    SPFRoot root;
+    root.routerId = rtr->GetRouterId();
+    root.routing = rtr->GetRoutingProtocol();
+    NS_ASSERT(root.routing);
+    root.recompute = true;
+    //
+    // Record the addresses of the interfaces, which the SPF calculation looks
+    // up instead of the Ipv4 object since it may run on other threads.
+    //
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    NS_ASSERT_MSG(ipv4,
+                  "GlobalRouteManagerImpl::GetRoot (): "
+                  "GetObject for <Ipv4> interface failed");
+    for (uint32_t i = 0; i < ipv4->GetNInterfaces(); i++)
+    {
+        for (uint32_t j = 0; j < ipv4->GetNAddresses(i); j++)
+        {
+            root.addresses.emplace_back(i, ipv4->GetAddress(i, j).GetLocal());
+        }
+    }
+    return root;
+}
+
+void
+GlobalRouteManagerImpl::ComputeRoutes(std::vector<SPFRoot>& roots)
+{
+    NS_LOG_FUNCTION(this << roots.size());
+    uint32_t nThreads = GetThreads();
+    // Interleaved log messages of several threads would be unreadable.
+    if (!g_log.IsNoneEnabled())
+    {
+        nThreads = 1;
+    }
+    nThreads = std::min<std::size_t>(nThreads, roots.size());
+    if (nThreads <= 1)
+    {
+        for (auto& root : roots)
+        {
+            ComputeRoutes(root);
+        }
+        return;
+    }
+    //
+    // The SPF calculations only read the LSDB, and each thread has its own
+    // SPF state.  The routes are installed afterwards, on this thread.
+    //
+    NS_LOG_LOGIC("Computing the routes of " << roots.size() << " routers on " << nThreads
+                                            << " threads");
+    std::atomic<std::size_t> next(0);
+    auto work = [this, &roots, &next]() {
+        GlobalRouteManagerImpl worker(m_lsdb, m_keepTrees);
+        for (std::size_t i = next++; i < roots.size(); i = next++)
+        {
+            worker.ComputeRoutes(roots[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < nThreads; i++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void
+GlobalRouteManagerImpl::ComputeRoutes(SPFRoot& root)
+{
+    NS_LOG_FUNCTION(this << root.routerId);
+    m_root = &root;
+    root.routes.clear();
+    if (root.recompute)
+    {
+        root.tree = SPFTree();
+        SPFCalculate(root.routerId);
+    }
+    else
+    {
+        SPFReuseTree(root.routerId);
+    }
+    m_root = nullptr;
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes(SPFRoot& root)
+{
+    NS_LOG_FUNCTION(root.routerId);
+    if (!root.routing)
+    {
+        NS_LOG_LOGIC("Can't find root node " << root.routerId);
+        root.routes.clear();
+        return;
+    }
+    for (const auto& route : root.routes)
+    {
+        switch (route.kind)
+        {
+        case SPFRoute::HOST:
+            root.routing->AddHostRouteTo(route.dest, route.nextHop, route.outIf);
+            break;
+        case SPFRoute::NETWORK:
+            root.routing->AddNetworkRouteTo(route.dest, route.mask, route.nextHop, route.outIf);
+            break;
+        case SPFRoute::EXTERNAL:
+            root.routing->AddASExternalRouteTo(route.dest, route.mask, route.nextHop, route.outIf);
+            break;
+        }
+    }
+    std::vector<SPFRoute>().swap(root.routes);
+}
+
+void
+GlobalRouteManagerImpl::AddRoute(SPFRoute::Kind kind,
+                                 Ipv4Address dest,
+                                 Ipv4Mask mask,
+                                 Ipv4Address nextHop,
+                                 uint32_t outIf)
+{
+    NS_LOG_FUNCTION(this << kind << dest << mask << nextHop << outIf);
+    NS_ASSERT_MSG(m_root, "GlobalRouteManagerImpl::AddRoute (): Root router not set");
+    m_root->routes.push_back({kind, dest, mask, nextHop, outIf});
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetStatus(const GlobalRoutingLSA* lsa) const
+{
+    return m_status[m_lsdb->GetLSAIndex(lsa)];
+}
+
+void
+GlobalRouteManagerImpl::SetStatus(const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+    m_status[m_lsdb->GetLSAIndex(lsa)] = status;
 }
 
 //
@@ -837,7 +1401,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
         // If the link is to a router that is already in the shortest path first tree
         // then we have it covered -- ignore it.
         //
-        if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
+        if (GetStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE)
         {
             NS_LOG_LOGIC("Skipping ->  LSA " << w_lsa->GetLinkStateId() << " already in SPF tree");
             continue;
@@ -861,7 +1425,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
         NS_LOG_LOGIC("Considering w_lsa " << w_lsa->GetLinkStateId());
 
         // Is there already vertex w in candidate list?
-        if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+        if (GetStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
             // Calculate nexthop to w
             // We need to figure out how to actually get to the new router represented
@@ -873,7 +1437,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
             w = new SPFVertex(w_lsa);
             if (SPFNexthopCalculation(v, w, l, distance))
             {
-                w_lsa->SetStatus(GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+                SetStatus(w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
                 //
                 // Push this new vertex onto the priority queue (ordered by distance from the
                 // root node).
@@ -890,7 +1454,7 @@ GlobalRouteManagerImpl::SPFNext(SPFVertex* v, CandidateQueue& candidate)
                                   << "return false, but it does now!");
             }
         }
-        else if (w_lsa->GetStatus() == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+        else if (GetStatus(w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
             //
             // We have already considered the link represented by <w>.  What wse have to
@@ -1244,7 +1808,22 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate(Ipv4Address root)
 {
     NS_LOG_FUNCTION(this << root);
-    SPFCalculate(root);
+    SPFRoot spfRoot;
+    spfRoot.routerId = root;
+    spfRoot.recompute = true;
+    NodeList::Iterator listEnd = NodeList::End();
+    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    {
+        Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter>();
+        if (rtr && rtr->GetRouterId() == root)
+        {
+            spfRoot = GetRoot(*i);
+            break;
+        }
+    }
+    m_keepTrees = false;
+    ComputeRoutes(spfRoot);
+    InstallRoutes(spfRoot);
 }
 
 //
@@ -1317,14 +1896,11 @@ GlobalRouteManagerImpl::CheckForStubNode(Ipv4Address root)
                 if (lr->GetLinkId() == myRouterId)
                 {
                     // Next hop is stored in the LinkID field of lr
-                    Ptr<GlobalRouter> router = rlsa->GetNode()->GetObject<GlobalRouter>();
-                    NS_ASSERT(router);
-                    Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-                    NS_ASSERT(gr);
-                    gr->AddNetworkRouteTo(Ipv4Address("0.0.0.0"),
-                                          Ipv4Mask("0.0.0.0"),
-                                          lr->GetLinkData(),
-                                          FindOutgoingInterfaceId(transitLink->GetLinkData()));
+                    AddRoute(SPFRoute::NETWORK,
+                             Ipv4Address("0.0.0.0"),
+                             Ipv4Mask("0.0.0.0"),
+                             lr->GetLinkData(),
+                             FindOutgoingInterfaceId(transitLink->GetLinkData()));
                     NS_LOG_LOGIC("Inserting default route for node "
                                  << myRouterId << " to next hop " << lr->GetLinkData()
                                  << " via interface "
@@ -1345,9 +1921,11 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
 
     SPFVertex* v;
     //
-    // Initialize the Link State Database.
+    // Initialize the status of the Link State Advertisements.  The status is
+    // kept here rather than in the LSAs, so that the LSDB is not modified by
+    // the calculation.
     //
-    m_lsdb->Initialize();
+    m_status.assign(m_lsdb->GetNumLSAs(), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
     //
     // The candidate queue is a priority queue of SPFVertex objects, with the top
     // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +1945,7 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     //
     m_spfroot = v;
     v->SetDistanceFromRoot(0);
-    v->GetLSA()->SetStatus(GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+    SetStatus(v->GetLSA(), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
     NS_LOG_LOGIC("Starting SPFCalculate for node " << root);
 
     //
@@ -1377,12 +1955,25 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     // reached.  Instead, short-circuit this computation and just install
     // a default route in the CheckForStubNode() method.
     //
-    if (NodeList::GetNNodes() > 0 && CheckForStubNode(root))
+    if (m_root->routing && CheckForStubNode(root))
     {
         NS_LOG_LOGIC("SPFCalculate truncated for stub node " << root);
         delete m_spfroot;
+        m_spfroot = nullptr;
         return;
     }
+    //
+    // Keep the tree for the incremental recomputation: the distance of each
+    // vertex and, in the order they join the tree, the vertices and their
+    // root exit directions.
+    //
+    SPFTree* tree = m_keepTrees ? &m_root->tree : nullptr;
+    if (tree)
+    {
+        tree->distances.assign(m_lsdb->GetNumLSAs(), SPF_INFINITY);
+        tree->distances[m_lsdb->GetLSAIndex(v->GetLSA())] = 0;
+        tree->exitOffsets.push_back(0);
+    }
 
     for (;;)
     {
@@ -1428,7 +2019,18 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
         // Update the status field of the vertex to indicate that it is in the SPF
         // tree.
         //
-        v->GetLSA()->SetStatus(GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+        SetStatus(v->GetLSA(), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+        if (tree)
+        {
+            uint32_t index = m_lsdb->GetLSAIndex(v->GetLSA());
+            tree->distances[index] = v->GetDistanceFromRoot();
+            tree->vertices.push_back(index);
+            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
+            {
+                tree->exits.push_back(v->GetRootExitDirection(i));
+            }
+            tree->exitOffsets.push_back(tree->exits.size());
+        }
         //
         // The current vertex has a parent pointer.  By calling this rather oddly
         // named method (blame quagga) we add the current vertex to the list of
@@ -1444,12 +2046,11 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
         //
         // RFC2328 16.1. (4).
         //
-        // This is the method that actually adds the routes.  It'll walk the list
-        // of nodes in the system, looking for the node corresponding to the router
-        // ID of the root of the tree -- that is the router we're building the routes
-        // for.  It looks for the Ipv4 interface of that node and remembers it.  So
-        // we are only actually adding routes to that one node at the root of the SPF
-        // tree.
+        // This is the method that actually adds the routes.  They are routes for
+        // the router at the root of the tree -- that is the router we're building
+        // the routes for -- and are installed in its routing table once the
+        // calculation is done.  So we are only actually adding routes to that one
+        // node at the root of the SPF tree.
         //
         // We're going to pop of a pointer to every vertex in the tree except the
         // root in order of distance from the root.  For each of the vertices, we call
@@ -1504,6 +2105,78 @@ GlobalRouteManagerImpl::SPFCalculate(Ipv4Address root)
     m_spfroot = nullptr;
 }
 
+void
+GlobalRouteManagerImpl::SPFReuseTree(Ipv4Address root)
+{
+    NS_LOG_FUNCTION(this << root);
+    const SPFTree& tree = m_root->tree;
+    m_spfroot = new SPFVertex(m_lsdb->GetLSA(root));
+    m_spfroot->SetDistanceFromRoot(0);
+    //
+    // Rebuild the vertices of the tree with their root exit directions, and add
+    // their routes from the current LSAs as SPFCalculate () does: the host and
+    // transit network routes first, then the stub network routes, then the
+    // external routes.
+    //
+    std::vector<SPFVertex*> vertices;
+    vertices.reserve(tree.vertices.size());
+    for (uint32_t i = 0; i < tree.vertices.size(); i++)
+    {
+        SPFVertex* v = new SPFVertex(m_lsdb->GetLSAByIndex(tree.vertices[i]));
+        v->SetDistanceFromRoot(tree.distances[tree.vertices[i]]);
+        for (uint32_t j = tree.exitOffsets[i]; j < tree.exitOffsets[i + 1]; j++)
+        {
+            SPFVertex exit;
+            exit.SetRootExitDirection(tree.exits[j]);
+            v->MergeRootExitDirections(&exit);
+        }
+        vertices.push_back(v);
+        if (v->GetVertexType() == SPFVertex::VertexRouter)
+        {
+            SPFIntraAddRouter(v);
+        }
+        else
+        {
+            SPFIntraAddTransit(v);
+        }
+    }
+    for (SPFVertex* v : vertices)
+    {
+        if (v->GetVertexType() != SPFVertex::VertexRouter)
+        {
+            continue;
+        }
+        GlobalRoutingLSA* rlsa = v->GetLSA();
+        for (uint32_t i = 0; i < rlsa->GetNLinkRecords(); i++)
+        {
+            GlobalRoutingLinkRecord* l = rlsa->GetLinkRecord(i);
+            if (l->GetLinkType() == GlobalRoutingLinkRecord::StubNetwork)
+            {
+                SPFIntraAddStub(l, v);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs(); i++)
+    {
+        GlobalRoutingLSA* extlsa = m_lsdb->GetExtLSA(i);
+        for (SPFVertex* v : vertices)
+        {
+            if (v->GetVertexType() == SPFVertex::VertexRouter &&
+                v->GetVertexId() == extlsa->GetAdvertisingRouter())
+            {
+                SPFAddASExternal(extlsa, v);
+                break;
+            }
+        }
+    }
+    for (SPFVertex* v : vertices)
+    {
+        delete v;
+    }
+    delete m_spfroot;
+    m_spfroot = nullptr;
+}
+
 void
 GlobalRouteManagerImpl::ProcessASExternals(SPFVertex* v, GlobalRoutingLSA* extlsa)
 {
@@ -1554,109 +2227,43 @@ GlobalRouteManagerImpl::SPFAddASExternal(GlobalRoutingLSA* extlsa, SPFVertex* v)
     NS_LOG_LOGIC("External is on remote host: " << extlsa->GetAdvertisingRouter()
                                                 << "; installing");
 
+    //
+    // The routes are for the router at the root of the SPF tree, whose router ID
+    // is the vertex ID of the root vertex.
+    //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
-    //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
-    //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = extlsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            AddRoute(SPFRoute::EXTERNAL, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " add external network route to " << tempip
+                                   << " using next hop " << nextHop << " via interface "
+                                   << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = extlsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddASExternalRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add external network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
@@ -1716,113 +2323,44 @@ GlobalRouteManagerImpl::SPFIntraAddStub(GlobalRoutingLinkRecord* l, SPFVertex* v
     //
     // The root of the Shortest Path First tree is the router to which we are
     // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // to this router has a vertex ID which is the router ID of that node.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
+    NS_ASSERT_MSG(v->GetLSA(),
+                  "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask(l->GetLinkData().Get());
+    Ipv4Address tempip = l->GetLinkId();
+    tempip = tempip.CombineMask(tempmask);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // The vertex <v> (corresponding to the node that has the stub network) has
+    // the next hop addresses and outbound interfaces that the root node uses
+    // to forward packets to it, and so to the stub network.
     //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    // walk through all next-hop-IPs and out-going-interfaces for reaching
+    // the stub network gateway 'v' from the root node
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to QI for that interface.  If there's no GlobalRouter interface, the node
-        // in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            AddRoute(SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " add network route to "
+                                   << tempip << " using next hop " << nextHop
+                                   << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to QI
-            // for that interface.  If the node is acting as an IP version 4 router, it
-            // should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "QI for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            NS_ASSERT_MSG(v->GetLSA(),
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask(l->GetLinkData().Get());
-            Ipv4Address tempip = l->GetLinkId();
-            tempip = tempip.CombineMask(tempmask);
-            //
-            // Here's why we did all of that work.  We're going to add a host route to the
-            // host address found in the m_linkData field of the point-to-point link
-            // record.  In the case of a point-to-point link, this is the local IP address
-            // of the node connected to the link.  Each of these point-to-point links
-            // will correspond to a local interface that has an IP address to which
-            // the node at the root of the SPF tree can send packets.  The vertex <v>
-            // (corresponding to the node that has these links and interfaces) has
-            // an m_nextHop address precalculated for us that is the address to which the
-            // root node should send packets to be forwarded to these IP addresses.
-            // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-            // which the packets should be send for forwarding.
-            //
-
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all next-hop-IPs and out-going-interfaces for reaching
-            // the stub network gateway 'v' from the root node
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative");
-                }
-            }
-            return;
-        } // if
-    }     // for
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1839,66 +2377,23 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId(Ipv4Address a, Ipv4Mask amask)
     //
     // We have an IP address <a> and a vertex ID of the root of the SPF tree.
     // The question is what interface index does this address correspond to.
-    // The answer is a little complicated since we have to find a pointer to
-    // the node corresponding to the vertex ID, find the Ipv4 interface on that
-    // node in order to iterate the interfaces and find the one corresponding to
-    // the address in question.
-    //
-    Ipv4Address routerId = m_spfroot->GetVertexId();
+    // We look through the addresses of the interfaces of the root node, which
+    // were recorded before the calculation, for the first one in the prefix,
+    // as Ipv4::GetInterfaceForPrefix () does.
     //
-    // Walk the list of nodes in the system looking for the one corresponding to
-    // the node at the root of the SPF tree.  This is the node for which we are
-    // building the routing table.
-    //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    NS_ASSERT_MSG(m_root, "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): Root not set");
+    for (const auto& address : m_root->addresses)
     {
-        Ptr<Node> node = *i;
-
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-        //
-        // If the node doesn't have a GlobalRouter interface it can't be the one
-        // we're interested in.
-        //
-        if (!rtr)
+        if (address.second.CombineMask(amask) == a.CombineMask(amask))
         {
-            continue;
-        }
-
-        if (rtr->GetRouterId() == routerId)
-        {
-            //
-            // This is the node we're building the routing table for.  We're going to need
-            // the Ipv4 interface to look for the ipv4 interface index.  Since this node
-            // is participating in routing IP version 4 packets, it certainly must have
-            // an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Look through the interfaces on this node for one that has the IP address
-            // we're looking for.  If we find one, return the corresponding interface
-            // index, or -1 if not found.
-            //
-            int32_t interface = ipv4->GetInterfaceForPrefix(a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif
-            return interface;
+            return address.first;
         }
     }
     //
     // Couldn't find it.
     //
-    NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find root node " << routerId);
+    NS_LOG_LOGIC("FindOutgoingInterfaceId():Can't find interface of root node "
+                 << m_root->routerId << " for " << a);
     return -1;
 }
 
@@ -1927,138 +2422,81 @@ GlobalRouteManagerImpl::SPFIntraAddRouter(SPFVertex* v)
     //
     // The root of the Shortest Path First tree is the router to which we are
     // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // to this router has a vertex ID which is the router ID of that node.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  The LSA will have a number of attached Global Router
+    // Link Records corresponding to links off of that vertex / node.  We're going
+    // to be interested in the records corresponding to point-to-point links.
     //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                  "Expected valid LSA in SPFVertex* v");
+
+    uint32_t nLinkRecords = lsa->GetNLinkRecords();
+    //
+    // Iterate through the link records on the vertex to which we're going to add
+    // routes.  To make sure we're being clear, we're going to add routing table
+    // entries to the tables on the node corresping to the root of the SPF tree.
+    // These entries will have routes to the IP addresses we find from looking at
+    // the local side of the point-to-point links found on the node described by
+    // the vertex <v>.
+    //
+    NS_LOG_LOGIC(" Router " << routerId << " found " << nLinkRecords
+                            << " link records in LSA " << lsa << "with LinkStateId "
+                            << lsa->GetLinkStateId());
+    for (uint32_t j = 0; j < nLinkRecords; ++j)
     {
-        Ptr<Node> node = *i;
         //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
+        // We are only concerned about point-to-point links
         //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
-
-        if (!rtr)
+        GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
+        if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
             continue;
         }
         //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
+        // Here's why we did all of that work.  We're going to add a host route to the
+        // host address found in the m_linkData field of the point-to-point link
+        // record.  In the case of a point-to-point link, this is the local IP address
+        // of the node connected to the link.  Each of these point-to-point links
+        // will correspond to a local interface that has an IP address to which
+        // the node at the root of the SPF tree can send packets.  The vertex <v>
+        // (corresponding to the node that has these links and interfaces) has
+        // an m_nextHop address precalculated for us that is the address to which the
+        // root node should send packets to be forwarded to these IP addresses.
+        // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
+        // which the packets should be send for forwarding.
         //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        // walk through all available exit directions due to ECMP,
+        // and add host route for each of the exit direction toward
+        // the vertex 'v'
+        for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
         {
-            NS_LOG_LOGIC("Setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                          "Expected valid LSA in SPFVertex* v");
-
-            uint32_t nLinkRecords = lsa->GetNLinkRecords();
-            //
-            // Iterate through the link records on the vertex to which we're going to add
-            // routes.  To make sure we're being clear, we're going to add routing table
-            // entries to the tables on the node corresping to the root of the SPF tree.
-            // These entries will have routes to the IP addresses we find from looking at
-            // the local side of the point-to-point links found on the node described by
-            // the vertex <v>.
-            //
-            NS_LOG_LOGIC(" Node " << node->GetId() << " found " << nLinkRecords
-                                  << " link records in LSA " << lsa << "with LinkStateId "
-                                  << lsa->GetLinkStateId());
-            for (uint32_t j = 0; j < nLinkRecords; ++j)
+            SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+            Ipv4Address nextHop = exit.first;
+            int32_t outIf = exit.second;
+            if (outIf >= 0)
             {
-                //
-                // We are only concerned about point-to-point links
-                //
-                GlobalRoutingLinkRecord* lr = lsa->GetLinkRecord(j);
-                if (lr->GetLinkType() != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                    continue;
-                }
-                //
-                // Here's why we did all of that work.  We're going to add a host route to the
-                // host address found in the m_linkData field of the point-to-point link
-                // record.  In the case of a point-to-point link, this is the local IP address
-                // of the node connected to the link.  Each of these point-to-point links
-                // will correspond to a local interface that has an IP address to which
-                // the node at the root of the SPF tree can send packets.  The vertex <v>
-                // (corresponding to the node that has these links and interfaces) has
-                // an m_nextHop address precalculated for us that is the address to which the
-                // root node should send packets to be forwarded to these IP addresses.
-                // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-                // which the packets should be send for forwarding.
-                //
-                Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-                if (!router)
-                {
-                    continue;
-                }
-                Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-                NS_ASSERT(gr);
-                // walk through all available exit directions due to ECMP,
-                // and add host route for each of the exit direction toward
-                // the vertex 'v'
-                for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-                {
-                    SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                    Ipv4Address nextHop = exit.first;
-                    int32_t outIf = exit.second;
-                    if (outIf >= 0)
-                    {
-                        gr->AddHostRouteTo(lr->GetLinkData(), nextHop, outIf);
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " adding host route to " << lr->GetLinkData()
-                                               << " using next hop " << nextHop
-                                               << " and outgoing interface " << outIf);
-                    }
-                    else
-                    {
-                        NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                               << " NOT able to add host route to "
-                                               << lr->GetLinkData() << " using next hop " << nextHop
-                                               << " since outgoing interface id is negative "
-                                               << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+                AddRoute(SPFRoute::HOST, lr->GetLinkData(), Ipv4Mask::GetOnes(), nextHop, outIf);
+                NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                       << " adding host route to " << lr->GetLinkData()
+                                       << " using next hop " << nextHop
+                                       << " and outgoing interface " << outIf);
             }
-            //
-            // Done adding the routes for the selected node.
-            //
-            return;
-        }
+            else
+            {
+                NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                       << " NOT able to add host route to " << lr->GetLinkData()
+                                       << " using next hop " << nextHop
+                                       << " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 
@@ -2071,99 +2509,44 @@ GlobalRouteManagerImpl::SPFIntraAddTransit(SPFVertex* v)
     //
     // The root of the Shortest Path First tree is the router to which we are
     // going to write the actual routing table entries.  The vertex corresponding
-    // to this router has a vertex ID which is the router ID of that node.  We're
-    // going to use this ID to discover which node it is that we're actually going
-    // to update.
+    // to this router has a vertex ID which is the router ID of that node.
     //
     Ipv4Address routerId = m_spfroot->GetVertexId();
 
     NS_LOG_LOGIC("Vertex ID = " << routerId);
     //
-    // We need to walk the list of nodes looking for the one that has the router
-    // ID corresponding to the root vertex.  This is the one we're going to write
-    // the routing information to.
+    // Get the Global Router Link State Advertisement from the vertex we're
+    // adding the routes to.  This is the network LSA of the transit network.
     //
-    NodeList::Iterator i = NodeList::Begin();
-    NodeList::Iterator listEnd = NodeList::End();
-    for (; i != listEnd; i++)
+    GlobalRoutingLSA* lsa = v->GetLSA();
+    NS_ASSERT_MSG(lsa,
+                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                  "Expected valid LSA in SPFVertex* v");
+    Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
+    Ipv4Address tempip = lsa->GetLinkStateId();
+    tempip = tempip.CombineMask(tempmask);
+    // walk through all available exit directions due to ECMP,
+    // and add host route for each of the exit direction toward
+    // the vertex 'v'
+    for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
     {
-        Ptr<Node> node = *i;
-        //
-        // The router ID is accessible through the GlobalRouter interface, so we need
-        // to GetObject for that interface.  If there's no GlobalRouter interface,
-        // the node in question cannot be the router we want, so we continue.
-        //
-        Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter>();
+        SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
+        Ipv4Address nextHop = exit.first;
+        int32_t outIf = exit.second;
 
-        if (!rtr)
+        if (outIf >= 0)
         {
-            NS_LOG_LOGIC("No GlobalRouter interface on node " << node->GetId());
-            continue;
+            AddRoute(SPFRoute::NETWORK, tempip, tempmask, nextHop, outIf);
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId << " add network route to "
+                                   << tempip << " using next hop " << nextHop
+                                   << " via interface " << outIf);
         }
-        //
-        // If the router ID of the current node is equal to the router ID of the
-        // root of the SPF tree, then this node is the one for which we need to
-        // write the routing tables.
-        //
-        NS_LOG_LOGIC("Considering router " << rtr->GetRouterId());
-
-        if (rtr->GetRouterId() == routerId)
+        else
         {
-            NS_LOG_LOGIC("setting routes for node " << node->GetId());
-            //
-            // Routing information is updated using the Ipv4 interface.  We need to
-            // GetObject for that interface.  If the node is acting as an IP version 4
-            // router, it should absolutely have an Ipv4 interface.
-            //
-            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
-            NS_ASSERT_MSG(ipv4,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "GetObject for <Ipv4> interface failed");
-            //
-            // Get the Global Router Link State Advertisement from the vertex we're
-            // adding the routes to.  The LSA will have a number of attached Global Router
-            // Link Records corresponding to links off of that vertex / node.  We're going
-            // to be interested in the records corresponding to point-to-point links.
-            //
-            GlobalRoutingLSA* lsa = v->GetLSA();
-            NS_ASSERT_MSG(lsa,
-                          "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                          "Expected valid LSA in SPFVertex* v");
-            Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask();
-            Ipv4Address tempip = lsa->GetLinkStateId();
-            tempip = tempip.CombineMask(tempmask);
-            Ptr<GlobalRouter> router = node->GetObject<GlobalRouter>();
-            if (!router)
-            {
-                continue;
-            }
-            Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol();
-            NS_ASSERT(gr);
-            // walk through all available exit directions due to ECMP,
-            // and add host route for each of the exit direction toward
-            // the vertex 'v'
-            for (uint32_t i = 0; i < v->GetNRootExitDirections(); i++)
-            {
-                SPFVertex::NodeExit_t exit = v->GetRootExitDirection(i);
-                Ipv4Address nextHop = exit.first;
-                int32_t outIf = exit.second;
-
-                if (outIf >= 0)
-                {
-                    gr->AddNetworkRouteTo(tempip, tempmask, nextHop, outIf);
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " add network route to " << tempip
-                                           << " using next hop " << nextHop << " via interface "
-                                           << outIf);
-                }
-                else
-                {
-                    NS_LOG_LOGIC("(Route " << i << ") Node " << node->GetId()
-                                           << " NOT able to add network route to " << tempip
-                                           << " using next hop " << nextHop
-                                           << " since outgoing interface id is negative " << outIf);
-                }
-            }
+            NS_LOG_LOGIC("(Route " << i << ") Router " << routerId
+                                   << " NOT able to add network route to " << tempip
+                                   << " using next hop " << nextHop
+                                   << " since outgoing interface id is negative " << outIf);
         }
     }
 }
@@ -31,6 +31,8 @@
 #include <map>
 #include <queue>
 #include <stdint.h>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -40,6 +42,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -672,6 +675,36 @@ class GlobalRouteManagerLSDB
      */
     uint32_t GetNumExtLSAs() const;
 
+    /**
+     * @brief Get the number of Link State Advertisements, not counting the
+     * External ones.
+     *
+     * @returns the number of Link State Advertisements.
+     */
+    uint32_t GetNumLSAs() const;
+
+    /**
+     * @brief Look up a Link State Advertisement, other than the External ones,
+     * by its index.
+     *
+     * The LSAs are indexed in the order of their insertion.
+     *
+     * @see GlobalRoutingLSA
+     * @param index the index of the LSA.
+     * @returns A pointer to the Link State Advertisement.
+     */
+    GlobalRoutingLSA* GetLSAByIndex(uint32_t index) const;
+
+    /**
+     * @brief Get the index of a Link State Advertisement of the database.
+     *
+     * @see GetLSAByIndex
+     * @param lsa A pointer to a Link State Advertisement of the database,
+     * other than an External one.
+     * @returns the index of the LSA.
+     */
+    uint32_t GetLSAIndex(const GlobalRoutingLSA* lsa) const;
+
   private:
     typedef std::map<Ipv4Address, GlobalRoutingLSA*>
         LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +714,11 @@ class GlobalRouteManagerLSDB
     LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
     std::vector<GlobalRoutingLSA*>
         m_extdatabase; //!< database of External Link State Advertisements
+    std::vector<GlobalRoutingLSA*> m_lsas; //!< LSAs of the database map, in insertion order
+    std::unordered_map<const GlobalRoutingLSA*, uint32_t>
+        m_lsaIndexes; //!< index of each LSA of the database map in m_lsas
+    std::unordered_map<Ipv4Address, LSDBPair_t, Ipv4AddressHash>
+        m_linkDataIndex; //!< first LSA, in database order, per TransitNetwork link data
 };
 
 /**
@@ -725,6 +763,18 @@ class GlobalRouteManagerImpl
      */
     virtual void InitializeRoutes();
 
+    /**
+     * @brief Delete the routes, rebuild the routing database and compute the
+     * routes again, after a change of the topology.
+     *
+     * With the incremental recomputation enabled, only the routers whose
+     * shortest path trees the changes of the database can affect run a new
+     * SPF calculation.  The other routers rebuild their routes from their
+     * previous trees and the new LSAs, which yields the same routes, possibly
+     * in a different order.
+     */
+    virtual void RecomputeRoutes();
+
     /**
      * @brief Debugging routine; allow client code to supply a pre-built LSDB
      * @param lsdb the pre-built LSDB
@@ -738,8 +788,149 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /**
+     * @brief A route computed for the root of the SPF tree, to be installed
+     * in its routing table.
+     */
+    struct SPFRoute
+    {
+        /// The kind of route
+        enum Kind
+        {
+            HOST,     //!< host route
+            NETWORK,  //!< network route
+            EXTERNAL, //!< AS external route
+        };
+
+        Kind kind;           //!< the kind of route
+        Ipv4Address dest;    //!< the destination
+        Ipv4Mask mask;       //!< the destination mask, unused by host routes
+        Ipv4Address nextHop; //!< the next hop
+        uint32_t outIf;      //!< the outgoing interface
+    };
+
+    /**
+     * @brief The shortest path tree of a router, kept for the incremental
+     * recomputation.
+     */
+    struct SPFTree
+    {
+        std::vector<uint32_t> distances; //!< distance of each LSA, by index, from the root
+        std::vector<uint32_t> vertices;  //!< LSA indexes of the vertices, in the order they joined
+        std::vector<uint32_t> exitOffsets; //!< offset of the exits of each vertex, then the end
+        std::vector<SPFVertex::NodeExit_t> exits; //!< root exit directions of the vertices
+    };
+
+    /**
+     * @brief A router at the root of an SPF calculation.
+     */
+    struct SPFRoot
+    {
+        Ipv4Address routerId;            //!< the router ID
+        Ptr<Ipv4GlobalRouting> routing;  //!< the routing protocol receiving the routes
+        std::vector<std::pair<int32_t, Ipv4Address>> addresses; //!< interfaces and local addresses
+        bool recompute;                  //!< whether the routes need a new SPF calculation
+        std::vector<SPFRoute> routes;    //!< the routes computed for the router
+        SPFTree tree;                    //!< the tree of the last calculation, when kept
+    };
+
+    /**
+     * @brief Construct a worker computing routes on the LSDB of another
+     * route manager.
+     * @param lsdb the LSDB, which the worker does not own
+     * @param keepTrees whether to keep the SPF trees of the routers
+     */
+    GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb, bool keepTrees);
+
     SPFVertex* m_spfroot;           //!< the root node
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    bool m_ownLsdb;                 //!< whether the LSDB is deleted with the route manager
+    bool m_keepTrees;               //!< whether to keep the SPF trees of the routers
+    SPFRoot* m_root;                //!< the router whose routes are being computed
+    std::vector<GlobalRoutingLSA::SPFStatus> m_status; //!< SPF status of the LSAs, by index
+    std::vector<SPFRoot> m_roots; //!< routers of the last calculation, when keeping their trees
+
+    /**
+     * \brief Delete the routes of all the nodes that have a GlobalRouter interface.
+     */
+    void DeleteRoutes();
+
+    /**
+     * \brief Get the routers of this system that have Link State Advertisements.
+     * \returns the routers
+     */
+    std::vector<SPFRoot> GetRoots() const;
+
+    /**
+     * \brief Get a router at the root of an SPF calculation.
+     * \param node the node of the router
+     * \returns the router
+     */
+    static SPFRoot GetRoot(Ptr<Node> node);
+
+    /**
+     * \brief Compute the routes of routers, on a pool of threads.
+     * \param roots the routers
+     */
+    void ComputeRoutes(std::vector<SPFRoot>& roots);
+
+    /**
+     * \brief Compute the routes of a router, with a new SPF calculation or
+     * from its kept tree.
+     * \param root the router
+     */
+    void ComputeRoutes(SPFRoot& root);
+
+    /**
+     * \brief Install the routes computed for a router in its routing table.
+     * \param root the router
+     */
+    static void InstallRoutes(SPFRoot& root);
+
+    /**
+     * \brief Find the routers whose shortest path trees the changes of the
+     * LSDB can affect, and take the trees of the other routers over.
+     *
+     * A router needs a new SPF calculation when its LSA or one of its
+     * neighbors' changes, when its addresses change, or when an edge whose
+     * cost changes gives a path to a vertex shorter than or as short as the
+     * shortest one in its tree, or was on a shortest path of the tree.
+     *
+     * \param roots the routers, with the new LSDB
+     * \param oldRoots the routers of the last calculation, with their trees
+     * \param oldLsdb the LSDB of the last calculation
+     */
+    void FindChangedRoots(std::vector<SPFRoot>& roots,
+                          std::vector<SPFRoot>& oldRoots,
+                          const GlobalRouteManagerLSDB* oldLsdb) const;
+
+    /**
+     * \brief Add a route for the root of the SPF tree.
+     * \param kind the kind of route
+     * \param dest the destination
+     * \param mask the destination mask
+     * \param nextHop the next hop
+     * \param outIf the outgoing interface
+     */
+    void AddRoute(SPFRoute::Kind kind,
+                  Ipv4Address dest,
+                  Ipv4Mask mask,
+                  Ipv4Address nextHop,
+                  uint32_t outIf);
+
+    /**
+     * \brief Get the status of an LSA in the current SPF calculation.
+     * \param lsa the LSA
+     * \returns the status
+     */
+    GlobalRoutingLSA::SPFStatus GetStatus(const GlobalRoutingLSA* lsa) const;
+
+    /**
+     * \brief Set the status of an LSA in the current SPF calculation.
+     * \param lsa the LSA
+     * \param status the status
+     */
+    void SetStatus(const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -761,6 +952,14 @@ class GlobalRouteManagerImpl
      */
     void SPFCalculate(Ipv4Address root);
 
+    /**
+     * \brief Add the routes of the kept shortest path tree of the current
+     * router, from the current LSAs.
+     *
+     * \param root the root node
+     */
+    void SPFReuseTree(Ipv4Address root);
+
     /**
      * \brief Process Stub nodes
      *
@@ -910,8 +1109,8 @@ class GlobalRouteManagerImpl
     /**
      * \brief Return the interface number corresponding to a given IP address and mask
      *
-     * This is a wrapper around GetInterfaceForPrefix(), but we first
-     * have to find the right node pointer to pass to that function.
+     * This looks the prefix up in the addresses of the root router, as
+     * GetInterfaceForPrefix() does on its Ipv4 object.
      * If no such interface is found, return -1 (note:  unit test framework
      * for routing assumes -1 to be a legal return value)
      *
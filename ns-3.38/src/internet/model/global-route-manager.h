@@ -70,6 +70,13 @@ class GlobalRouteManager
      * per-node forwarding tables
      */
     static void InitializeRoutes();
+
+    /**
+     * @brief Delete the routes, rebuild the routing database and compute the
+     * routes again, reusing the shortest path trees that did not change when
+     * the GlobalRoutingIncremental global value is set.
+     */
+    static void RecomputeRoutes();
 };
 
 } // namespace ns3
@@ -24,11 +24,52 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("Ipv4EndPointDemux");
 
+namespace
+{
+
+/**
+ * \brief Remove an endpoint from its bucket in a table, and the bucket if it
+ * becomes empty.
+ * \param table the table
+ * \param key the key of the bucket
+ * \param endPoint the endpoint
+ */
+template <typename Table, typename Key>
+void
+RemoveFromBucket(Table& table, const Key& key, Ipv4EndPoint* endPoint)
+{
+    auto bucket = table.find(key);
+    NS_ASSERT(bucket != table.end());
+    bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), endPoint));
+    if (bucket->second.empty())
+    {
+        table.erase(bucket);
+    }
+}
+
+} // namespace
+
+std::size_t
+Ipv4EndPointDemux::KeyHash::operator()(const LocalKey& key) const
+{
+    return std::hash<uint64_t>()(uint64_t(key.address.Get()) << 16 | key.port);
+}
+
+std::size_t
+Ipv4EndPointDemux::KeyHash::operator()(const TupleKey& key) const
+{
+    uint64_t peer = uint64_t(key.peerAddress.Get()) << 16 | key.peerPort;
+    return (*this)(key.local) * 0x9e3779b97f4a7c15ULL ^ std::hash<uint64_t>()(peer);
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux()
     : m_ephemeral(49152),
       m_portLast(65535),
@@ -52,24 +93,21 @@ bool
 Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
 {
     NS_LOG_FUNCTION(this << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        if ((*i)->GetLocalPort() == port)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_locals.find(LocalKey{addr, port});
+    if (bucket == m_locals.end())
+    {
+        return false;
+    }
+    for (Ipv4EndPoint* endPoint : bucket->second)
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        if (endPoint->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -88,7 +126,7 @@ Ipv4EndPointDemux::Allocate()
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -104,7 +142,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -127,7 +165,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -140,19 +178,21 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_tuples.find(TupleKey{{localAddress, localPort}, peerAddress, peerPort});
+    if (bucket != m_tuples.end())
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (Ipv4EndPoint* endPoint : bucket->second)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if (endPoint->GetBoundNetDevice() == boundNetDevice || !endPoint->GetBoundNetDevice())
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -163,17 +203,47 @@ void
 Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this << endPoint);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    EndPointsI i = std::find(m_endPoints.begin(), m_endPoints.end(), endPoint);
+    if (i != m_endPoints.end())
     {
-        if (*i == endPoint)
-        {
-            delete endPoint;
-            m_endPoints.erase(i);
-            break;
-        }
+        Unindex(endPoint);
+        RemoveFromBucket(m_ports, endPoint->GetLocalPort(), endPoint);
+        m_endPoints.erase(i);
+        delete endPoint;
     }
 }
 
+void
+Ipv4EndPointDemux::Insert(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    m_endPoints.push_back(endPoint);
+    m_ports[endPoint->GetLocalPort()].push_back(endPoint);
+    Index(endPoint);
+    endPoint->m_demux = this;
+}
+
+void
+Ipv4EndPointDemux::Index(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    LocalKey local{endPoint->GetLocalAddress(), endPoint->GetLocalPort()};
+    m_locals[local].push_back(endPoint);
+    m_tuples[TupleKey{local, endPoint->GetPeerAddress(), endPoint->GetPeerPort()}].push_back(
+        endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unindex(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    LocalKey local{endPoint->GetLocalAddress(), endPoint->GetLocalPort()};
+    RemoveFromBucket(m_locals, local, endPoint);
+    RemoveFromBucket(m_tuples,
+                     TupleKey{local, endPoint->GetPeerAddress(), endPoint->GetPeerPort()},
+                     endPoint);
+}
+
 /*
  * return list of all available Endpoints
  */
@@ -211,131 +281,127 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval4; // Exact match on all 4
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        Ipv4EndPoint* endP = *i;
 
-        NS_LOG_DEBUG("Looking at endpoint dport="
-                     << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
-                     << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
-
-        if (!endP->IsRxEnabled())
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP
-                                              << " because endpoint can not receive packets");
-            continue;
-        }
+    // We have 3 cases for the local address of a matching endpoint:
+    // 1) Exact local / destination address match
+    // 2) Local endpoint bound to Any -> matches anything
+    // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g.,
+    // x.y.z.255 in a /24 net) and direct destination match.
+    // Its peer address and port must match exactly or be wildcards, so the
+    // endpoints which can match are found in a few buckets of the four-tuple table.
+    std::vector<Ipv4Address> localAddresses{daddr};
+    if (daddr != Ipv4Address::GetAny())
+    {
+        localAddresses.push_back(Ipv4Address::GetAny());
+    }
+    for (uint32_t i = 0; incomingInterface && i < incomingInterface->GetNAddresses(); i++)
+    {
+        Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
 
-        if (endP->GetLocalPort() != dport)
+        Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
+        if (daddr.CombineMask(addr.GetMask()) == addrNetpart &&
+            std::find(localAddresses.begin(), localAddresses.end(), addrNetpart) ==
+                localAddresses.end())
         {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
-                                              << endP->GetLocalPort()
-                                              << " does not match packet dport " << dport);
-            continue;
+            localAddresses.push_back(addrNetpart);
         }
-        if (endP->GetBoundNetDevice())
+    }
+    std::vector<std::pair<Ipv4Address, uint16_t>> peers;
+    for (Ipv4Address peerAddress : {saddr, Ipv4Address::GetAny()})
+    {
+        for (uint16_t peerPort : {sport, uint16_t(0)})
         {
-            if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
+            if (std::find(peers.begin(), peers.end(), std::make_pair(peerAddress, peerPort)) ==
+                peers.end())
             {
-                NS_LOG_LOGIC("Skipping endpoint "
-                             << &endP << " because endpoint is bound to specific device and"
-                             << endP->GetBoundNetDevice() << " does not match packet device "
-                             << incomingInterface->GetDevice());
-                continue;
+                peers.emplace_back(peerAddress, peerPort);
             }
         }
+    }
 
-        bool localAddressMatchesExact = false;
-        bool localAddressIsAny = false;
-        bool localAddressIsSubnetAny = false;
-
-        // We have 3 cases:
-        // 1) Exact local / destination address match
-        // 2) Local endpoint bound to Any -> matches anything
-        // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g.,
-        // x.y.z.255 in a /24 net) and direct destination match.
-
-        if (endP->GetLocalAddress() == daddr)
-        {
-            // Case 1:
-            localAddressMatchesExact = true;
-        }
-        else if (endP->GetLocalAddress() == Ipv4Address::GetAny())
-        {
-            // Case 2:
-            localAddressIsAny = true;
-        }
-        else
+    for (Ipv4Address localAddress : localAddresses)
+    {
+        for (const auto& [peerAddress, peerPort] : peers)
         {
-            // Case 3:
-            for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
+            auto bucket = m_tuples.find(TupleKey{{localAddress, dport}, peerAddress, peerPort});
+            if (bucket == m_tuples.end())
+            {
+                continue;
+            }
+            for (Ipv4EndPoint* endP : bucket->second)
             {
-                Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
+                NS_LOG_DEBUG("Looking at endpoint dport="
+                             << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
+                             << " sport=" << endP->GetPeerPort()
+                             << " saddr=" << endP->GetPeerAddress());
 
-                Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
-                if (endP->GetLocalAddress() == addrNetpart)
+                if (!endP->IsRxEnabled())
                 {
-                    NS_LOG_LOGIC("Endpoint is SubnetDirectedAny "
-                                 << endP->GetLocalAddress() << "/"
-                                 << addr.GetMask().GetPrefixLength());
+                    NS_LOG_LOGIC("Skipping endpoint "
+                                 << &endP << " because endpoint can not receive packets");
+                    continue;
+                }
 
-                    Ipv4Address daddrNetPart = daddr.CombineMask(addr.GetMask());
-                    if (addrNetpart == daddrNetPart)
+                if (endP->GetBoundNetDevice())
+                {
+                    if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
                     {
-                        localAddressIsSubnetAny = true;
+                        NS_LOG_LOGIC("Skipping endpoint "
+                                     << &endP
+                                     << " because endpoint is bound to specific device and"
+                                     << endP->GetBoundNetDevice()
+                                     << " does not match packet device "
+                                     << incomingInterface->GetDevice());
+                        continue;
                     }
                 }
-            }
 
-            // if no match here, keep looking
-            if (!localAddressIsSubnetAny)
-            {
-                continue;
-            }
-        }
-
-        bool remotePortMatchesExact = endP->GetPeerPort() == sport;
-        bool remotePortMatchesWildCard = endP->GetPeerPort() == 0;
-        bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
-        bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv4Address::GetAny();
+                bool localAddressMatchesExact = localAddress == daddr;
+                bool localAddressIsAny =
+                    !localAddressMatchesExact && localAddress == Ipv4Address::GetAny();
+                bool localAddressIsSubnetAny = !localAddressMatchesExact && !localAddressIsAny;
+                if (localAddressIsSubnetAny)
+                {
+                    NS_LOG_LOGIC("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress());
+                }
 
-        // If remote does not match either with exact or wildcard,
-        // skip this one
-        if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        {
-            continue;
-        }
-        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-            continue;
-        }
+                bool remotePortMatchesExact = endP->GetPeerPort() == sport;
+                bool remotePortMatchesWildCard = endP->GetPeerPort() == 0;
+                bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
+                bool remoteAddressMatchesWildCard =
+                    endP->GetPeerAddress() == Ipv4Address::GetAny();
 
-        bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
+                bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
 
-        if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-            NS_LOG_LOGIC("Found an endpoint for case 4, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval4.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-            NS_LOG_LOGIC("Found an endpoint for case 3, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval3.push_back(endP);
-        }
-        if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-            NS_LOG_LOGIC("Found an endpoint for case 2, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval2.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remoteAddressMatchesWildCard &&
-            remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-            NS_LOG_LOGIC("Found an endpoint for case 1, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval1.push_back(endP);
+                if (localAddressMatchesExact && remoteAddressMatchesExact &&
+                    remotePortMatchesExact)
+                { // All 4 match - this is the case of an open TCP connection, for example.
+                    NS_LOG_LOGIC("Found an endpoint for case 4, adding "
+                                 << endP->GetLocalAddress() << ":" << endP->GetLocalPort());
+                    retval4.push_back(endP);
+                }
+                if (localAddressMatchesWildCard && remoteAddressMatchesExact &&
+                    remotePortMatchesExact)
+                { // All but local address - no idea what this case could be.
+                    NS_LOG_LOGIC("Found an endpoint for case 3, adding "
+                                 << endP->GetLocalAddress() << ":" << endP->GetLocalPort());
+                    retval3.push_back(endP);
+                }
+                if (localAddressMatchesExact && remoteAddressMatchesWildCard &&
+                    remotePortMatchesWildCard)
+                { // Only local port and local address match - Not yet opened connection
+                    NS_LOG_LOGIC("Found an endpoint for case 2, adding "
+                                 << endP->GetLocalAddress() << ":" << endP->GetLocalPort());
+                    retval2.push_back(endP);
+                }
+                if (localAddressMatchesWildCard && remoteAddressMatchesWildCard &&
+                    remotePortMatchesWildCard)
+                { // Only local port matches exactly - Endpoint open to "any" connection
+                    NS_LOG_LOGIC("Found an endpoint for case 1, adding "
+                                 << endP->GetLocalAddress() << ":" << endP->GetLocalPort());
+                    retval1.push_back(endP);
+                }
+            }
         }
     }
 
@@ -376,12 +442,13 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
     // function.
     uint32_t genericity = 3;
     Ipv4EndPoint* generic = nullptr;
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_ports.find(dport);
+    if (bucket == m_ports.end())
+    {
+        return nullptr;
+    }
+    for (auto i = bucket->second.begin(); i != bucket->second.end(); i++)
     {
-        if ((*i)->GetLocalPort() != dport)
-        {
-            continue;
-        }
         if ((*i)->GetLocalAddress() == daddr && (*i)->GetPeerPort() == sport &&
             (*i)->GetPeerAddress() == saddr)
         {
@@ -26,6 +26,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -42,6 +44,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are also indexed in hash tables keyed on their local port,
+ * their local address and port, and their four-tuple, so that a lookup only
+ * visits the endpoints which can match, however many are allocated.  The
+ * endpoints update the tables when their addresses change.
  */
 
 class Ipv4EndPointDemux
@@ -171,6 +178,86 @@ class Ipv4EndPointDemux
     void DeAllocate(Ipv4EndPoint* endPoint);
 
   private:
+    friend class Ipv4EndPoint;
+
+    /**
+     * \brief Key of the endpoints bound to a local address and port.
+     */
+    struct LocalKey
+    {
+        Ipv4Address address; //!< local address
+        uint16_t port;       //!< local port
+
+        /**
+         * \param other the key to compare with
+         * \return true if the keys are equal
+         */
+        bool operator==(const LocalKey& other) const
+        {
+            return address == other.address && port == other.port;
+        }
+    };
+
+    /**
+     * \brief Key of the endpoints with a given four-tuple.
+     */
+    struct TupleKey
+    {
+        LocalKey local;          //!< local address and port
+        Ipv4Address peerAddress; //!< peer address
+        uint16_t peerPort;       //!< peer port
+
+        /**
+         * \param other the key to compare with
+         * \return true if the keys are equal
+         */
+        bool operator==(const TupleKey& other) const
+        {
+            return local == other.local && peerAddress == other.peerAddress &&
+                   peerPort == other.peerPort;
+        }
+    };
+
+    /**
+     * \brief Hash function of the endpoint keys.
+     */
+    struct KeyHash
+    {
+        /**
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const LocalKey& key) const;
+        /**
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const TupleKey& key) const;
+    };
+
+    /**
+     * \brief Endpoints sharing a key, in the order they were indexed.
+     */
+    typedef std::vector<Ipv4EndPoint*> Bucket;
+
+    /**
+     * \brief Add an endpoint to the list and to the tables.
+     * \param endPoint the endpoint
+     */
+    void Insert(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Add an endpoint to the tables keyed on its addresses.
+     * \param endPoint the endpoint
+     */
+    void Index(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Remove an endpoint from the tables keyed on its addresses.
+     * \param endPoint the endpoint
+     */
+    void Unindex(Ipv4EndPoint* endPoint);
+
     /**
      * \brief Allocate an ephemeral port.
      * \returns the ephemeral port
@@ -196,6 +283,21 @@ class Ipv4EndPointDemux
      * \brief A list of IPv4 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The end points, by local port.
+     */
+    std::unordered_map<uint16_t, Bucket> m_ports;
+
+    /**
+     * \brief The end points, by local address and port.
+     */
+    std::unordered_map<LocalKey, Bucket, KeyHash> m_locals;
+
+    /**
+     * \brief The end points, by four-tuple.
+     */
+    std::unordered_map<TupleKey, Bucket, KeyHash> m_tuples;
 };
 
 } // namespace ns3
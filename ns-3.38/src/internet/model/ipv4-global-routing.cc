@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <vector>
 
@@ -64,7 +65,8 @@ Ipv4GlobalRouting::GetTypeId()
 
 Ipv4GlobalRouting::Ipv4GlobalRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_routeIndexValid(false)
 {
     NS_LOG_FUNCTION(this);
 
@@ -83,6 +85,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    m_routeIndexValid = false;
 }
 
 void
@@ -92,6 +95,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    m_routeIndexValid = false;
 }
 
 void
@@ -104,6 +108,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    m_routeIndexValid = false;
 }
 
 void
@@ -113,6 +118,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    m_routeIndexValid = false;
 }
 
 void
@@ -125,6 +131,46 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    m_routeIndexValid = false;
+}
+
+void
+Ipv4GlobalRouting::BuildRouteIndex()
+{
+    NS_LOG_FUNCTION(this);
+    m_hostRouteIndex.clear();
+    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    {
+        m_hostRouteIndex[(*i)->GetDest()].push_back(*i);
+    }
+    m_networkRouteIndex.Clear();
+    uint32_t position = 0;
+    for (NetworkRoutesCI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    {
+        m_networkRouteIndex.Insert((*j)->GetDestNetwork(),
+                                   (*j)->GetDestNetworkMask().GetPrefixLength(),
+                                   IndexedRoute(position++, *j));
+    }
+    m_ASexternalRouteIndex.Clear();
+    position = 0;
+    for (ASExternalRoutesCI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+    {
+        m_ASexternalRouteIndex.Insert((*k)->GetDestNetwork(),
+                                      (*k)->GetDestNetworkMask().GetPrefixLength(),
+                                      IndexedRoute(position++, *k));
+    }
+    m_routeIndexValid = true;
+}
+
+bool
+Ipv4GlobalRouting::IsOnInterface(const Ipv4RoutingTableEntry* route, Ptr<NetDevice> oif) const
+{
+    if (oif && oif != m_ipv4->GetNetDevice(route->GetInterface()))
+    {
+        NS_LOG_LOGIC("Not on requested interface, skipping");
+        return false;
+    }
+    return true;
 }
 
 Ptr<Ipv4Route>
@@ -137,66 +183,71 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
     RouteVec_t allRoutes;
 
+    if (!m_routeIndexValid)
+    {
+        BuildRouteIndex();
+    }
+
     NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    auto hosts = m_hostRouteIndex.find(dest);
+    if (hosts != m_hostRouteIndex.end())
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        for (Ipv4RoutingTableEntry* route : hosts->second)
         {
-            if (oif)
+            NS_ASSERT(route->IsHost());
+            if (IsOnInterface(route, oif))
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                allRoutes.push_back(route);
+                NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << route);
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
         }
     }
     if (allRoutes.empty()) // if no host route is found
     {
+        // Every matching network route is a candidate, whatever its prefix
+        // length, in the order of the route list.
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
-        {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
-            {
-                if (oif)
+        std::vector<IndexedRoute> matches;
+        m_networkRouteIndex.Lookup(
+            dest,
+            [this, oif, &matches](const std::vector<IndexedRoute>& routes, uint8_t /* length */) {
+                for (const IndexedRoute& route : routes)
                 {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
+                    if (IsOnInterface(route.second, oif))
                     {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
+                        matches.push_back(route);
                     }
                 }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
-            }
+                return false;
+            });
+        std::sort(matches.begin(), matches.end());
+        for (const IndexedRoute& route : matches)
+        {
+            allRoutes.push_back(route.second);
+            NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << route.second);
         }
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (ASExternalRoutesI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
-        {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
-            {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
+        // The first matching external route of the route list
+        const IndexedRoute* first = nullptr;
+        m_ASexternalRouteIndex.Lookup(
+            dest,
+            [this, oif, &first](const std::vector<IndexedRoute>& routes, uint8_t /* length */) {
+                for (const IndexedRoute& route : routes)
                 {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
+                    if ((first == nullptr || route.first < first->first) &&
+                        IsOnInterface(route.second, oif))
                     {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
+                        first = &route;
                     }
                 }
-                allRoutes.push_back(*k);
-                break;
-            }
+                return false;
+            });
+        if (first != nullptr)
+        {
+            NS_LOG_LOGIC("Found external route" << first->second);
+            allRoutes.push_back(first->second);
         }
     }
     if (!allRoutes.empty()) // if route(s) is found
@@ -299,6 +350,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
                 delete *i;
                 m_hostRoutes.erase(i);
+                m_routeIndexValid = false;
                 NS_LOG_LOGIC("Done removing host route "
                              << index << "; host route remaining size = " << m_hostRoutes.size());
                 return;
@@ -315,6 +367,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
             delete *j;
             m_networkRoutes.erase(j);
+            m_routeIndexValid = false;
             NS_LOG_LOGIC("Done removing network route "
                          << index << "; network route remaining size = " << m_networkRoutes.size());
             return;
@@ -330,6 +383,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
             delete *k;
             m_ASexternalRoutes.erase(k);
+            m_routeIndexValid = false;
             NS_LOG_LOGIC("Done removing network route "
                          << index << "; network route remaining size = " << m_networkRoutes.size());
             return;
@@ -365,6 +419,10 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_hostRouteIndex.clear();
+    m_networkRouteIndex.Clear();
+    m_ASexternalRouteIndex.Clear();
+    m_routeIndexValid = false;
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -533,9 +591,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp(uint32_t i)
     NS_LOG_FUNCTION(this << i);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -545,9 +601,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown(uint32_t i)
     NS_LOG_FUNCTION(this << i);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -557,9 +611,7 @@ Ipv4GlobalRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress add
     NS_LOG_FUNCTION(this << interface << address);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -569,9 +621,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
     NS_LOG_FUNCTION(this << interface << address);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -19,6 +19,8 @@
 #ifndef IPV4_GLOBAL_ROUTING_H
 #define IPV4_GLOBAL_ROUTING_H
 
+#include "ipv4-prefix-trie.h"
+
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -28,6 +30,9 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -273,10 +278,33 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     Ptr<Ipv4Route> LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
 
+    /**
+     * \brief Rebuild the lookup tables from the route lists.
+     */
+    void BuildRouteIndex();
+
+    /**
+     * \brief Whether a route leaves through the requested output interface.
+     * \param route the route
+     * \param oif output interface if any (put 0 otherwise)
+     * \return true if no output interface is requested, or if it is the one of the route
+     */
+    bool IsOnInterface(const Ipv4RoutingTableEntry* route, Ptr<NetDevice> oif) const;
+
     HostRoutes m_hostRoutes;             //!< Routes to hosts
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    /// A route, with its position in its route list
+    typedef std::pair<uint32_t, Ipv4RoutingTableEntry*> IndexedRoute;
+
+    /// Host routes by destination, in list order
+    std::unordered_map<Ipv4Address, std::vector<Ipv4RoutingTableEntry*>, Ipv4AddressHash>
+        m_hostRouteIndex;
+    Ipv4PrefixTrie<IndexedRoute> m_networkRouteIndex;    //!< Network routes by prefix
+    Ipv4PrefixTrie<IndexedRoute> m_ASexternalRouteIndex; //!< External routes by prefix
+    bool m_routeIndexValid; //!< Whether the lookup tables match the route lists
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
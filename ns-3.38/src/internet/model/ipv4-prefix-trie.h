@@ -0,0 +1,237 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of IPv4 prefixes.
+ *
+ * Each prefix holds the values inserted for it, in insertion order.
+ * A lookup only visits the nodes on the path of the destination address,
+ * so its cost depends on the prefix lengths, at most 33 nodes, and not
+ * on the number of prefixes in the trie.
+ *
+ * The trie has no removal: the routing protocols rebuild it from their
+ * route lists after these change.
+ *
+ * \tparam T \explicit The type of the values.
+ */
+template <typename T>
+class Ipv4PrefixTrie
+{
+  public:
+    Ipv4PrefixTrie()
+    {
+        Clear();
+    }
+
+    /** Remove all the prefixes. */
+    void Clear()
+    {
+        m_nodes.clear();
+        m_nodes.emplace_back(0, 0);
+        m_size = 0;
+    }
+
+    /**
+     * \returns The number of values in the trie.
+     */
+    uint32_t GetSize() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Add a value for a prefix.
+     * \param network The prefix address; bits beyond the prefix length are ignored.
+     * \param length The prefix length, from 0 to 32.
+     * \param value The value.
+     */
+    void Insert(Ipv4Address network, uint8_t length, const T& value)
+    {
+        NS_ASSERT(length <= 32);
+        uint32_t prefix = network.Get() & GetMask(length);
+        uint32_t current = 0;
+        while (m_nodes[current].length != length)
+        {
+            uint8_t bit = GetBit(prefix, m_nodes[current].length);
+            int32_t child = m_nodes[current].children[bit];
+            if (child < 0)
+            {
+                // AddNode may reallocate the nodes: index them after it.
+                int32_t leaf = AddNode(prefix, length);
+                m_nodes[current].children[bit] = leaf;
+                current = leaf;
+                break;
+            }
+            uint8_t common = GetCommonLength(prefix, length, m_nodes[child]);
+            if (common == m_nodes[child].length)
+            {
+                current = child;
+                continue;
+            }
+            // Split the edge to the child at the last bit shared with the prefix.
+            int32_t split = AddNode(prefix & GetMask(common), common);
+            m_nodes[split].children[GetBit(m_nodes[child].prefix, common)] = child;
+            m_nodes[current].children[bit] = split;
+            current = split;
+            if (common != length)
+            {
+                int32_t leaf = AddNode(prefix, length);
+                m_nodes[split].children[GetBit(prefix, common)] = leaf;
+                current = leaf;
+            }
+            break;
+        }
+        m_nodes[current].values.push_back(value);
+        m_size++;
+    }
+
+    /**
+     * Visit the prefixes matching an address, from the longest to the shortest.
+     *
+     * The visitor is called as <tt>bool visitor(const std::vector<T>& values,
+     * uint8_t length)</tt> for each matching prefix holding values, and stops
+     * the lookup by returning true.
+     *
+     * \param address The address.
+     * \param visitor The visitor.
+     * \returns Whether the visitor stopped the lookup.
+     */
+    template <typename Visitor>
+    bool Lookup(Ipv4Address address, Visitor visitor) const
+    {
+        uint32_t key = address.Get();
+        int32_t path[33];
+        uint32_t depth = 0;
+        int32_t current = 0;
+        while (current >= 0)
+        {
+            const Node& node = m_nodes[current];
+            if ((key ^ node.prefix) & GetMask(node.length))
+            {
+                break;
+            }
+            if (!node.values.empty())
+            {
+                path[depth++] = current;
+            }
+            if (node.length == 32)
+            {
+                break;
+            }
+            current = node.children[GetBit(key, node.length)];
+        }
+        while (depth > 0)
+        {
+            const Node& node = m_nodes[path[--depth]];
+            if (visitor(node.values, node.length))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    /** A prefix of the trie. */
+    struct Node
+    {
+        /**
+         * Constructor.
+         * \param prefix The prefix.
+         * \param length The prefix length.
+         */
+        Node(uint32_t prefix, uint8_t length)
+            : prefix(prefix),
+              length(length),
+              children{-1, -1}
+        {
+        }
+
+        uint32_t prefix;       //!< The prefix, with the bits beyond its length cleared.
+        uint8_t length;        //!< The prefix length.
+        int32_t children[2];   //!< The subtries on bit 0 and bit 1 past the prefix, or -1.
+        std::vector<T> values; //!< The values of the prefix.
+    };
+
+    /**
+     * \param length A prefix length.
+     * \returns The network mask of the prefix length.
+     */
+    static uint32_t GetMask(uint8_t length)
+    {
+        return length == 0 ? 0 : 0xffffffffU << (32 - length);
+    }
+
+    /**
+     * \param key An address.
+     * \param index The index of a bit, from the most significant one.
+     * \returns The bit.
+     */
+    static uint8_t GetBit(uint32_t key, uint8_t index)
+    {
+        return (key >> (31 - index)) & 1;
+    }
+
+    /**
+     * \param prefix A prefix.
+     * \param length The prefix length.
+     * \param node A node.
+     * \returns The length of the prefix shared by the prefix and the node.
+     */
+    static uint8_t GetCommonLength(uint32_t prefix, uint8_t length, const Node& node)
+    {
+        uint8_t common = 0;
+        uint8_t limit = std::min(length, node.length);
+        while (common < limit && GetBit(prefix, common) == GetBit(node.prefix, common))
+        {
+            common++;
+        }
+        return common;
+    }
+
+    /**
+     * Add a node without values nor children.
+     * \param prefix The prefix.
+     * \param length The prefix length.
+     * \returns The index of the node.
+     */
+    int32_t AddNode(uint32_t prefix, uint8_t length)
+    {
+        m_nodes.emplace_back(prefix, length);
+        return static_cast<int32_t>(m_nodes.size() - 1);
+    }
+
+    std::vector<Node> m_nodes; //!< The nodes, the root, of length 0, first.
+    uint32_t m_size;           //!< The number of values.
+};
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
@@ -58,7 +58,8 @@ Ipv4StaticRouting::GetTypeId()
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting()
-    : m_ipv4(nullptr)
+    : m_networkRouteIndexValid(false),
+      m_ipv4(nullptr)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -80,6 +81,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
     {
         Ipv4RoutingTableEntry* routePtr = new Ipv4RoutingTableEntry(route);
         m_networkRoutes.emplace_back(routePtr, metric);
+        m_networkRouteIndexValid = false;
     }
 }
 
@@ -98,6 +100,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
         Ipv4RoutingTableEntry* routePtr = new Ipv4RoutingTableEntry(route);
 
         m_networkRoutes.emplace_back(routePtr, metric);
+        m_networkRouteIndexValid = false;
     }
 }
 
@@ -153,6 +156,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Mask networkMask = Ipv4Mask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
     m_networkRoutes.emplace_back(route, 0);
+    m_networkRouteIndexValid = false;
 }
 
 uint32_t
@@ -244,8 +248,6 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
 {
     NS_LOG_FUNCTION(this << dest << " " << oif);
     Ptr<Ipv4Route> rtentry = nullptr;
-    uint16_t longest_mask = 0;
-    uint32_t shortest_metric = 0xffffffff;
     /* when sending on local multicast, there have to be interface specified */
     if (dest.IsLocalMulticast())
     {
@@ -261,55 +263,57 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
         return rtentry;
     }
 
-    for (NetworkRoutesI i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
+    if (!m_networkRouteIndexValid)
     {
-        Ipv4RoutingTableEntry* j = i->first;
-        uint32_t metric = i->second;
-        Ipv4Mask mask = (j)->GetDestNetworkMask();
-        uint16_t masklen = mask.GetPrefixLength();
-        Ipv4Address entry = (j)->GetDestNetwork();
-        NS_LOG_LOGIC("Searching for route to " << dest << ", checking against route to " << entry
-                                               << "/" << masklen);
-        if (mask.IsMatch(dest, entry))
+        m_networkRouteIndex.Clear();
+        for (NetworkRoutesCI i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
         {
-            NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
-                                                       << ", metric " << metric);
-            if (oif)
+            m_networkRouteIndex.Insert(i->first->GetDestNetwork(),
+                                       i->first->GetDestNetworkMask().GetPrefixLength(),
+                                       *i);
+        }
+        m_networkRouteIndexValid = true;
+    }
+
+    // The longest prefix wins.  Among the routes of that prefix, a host route
+    // is the first one of the table, and a network route the last one with
+    // the lowest metric.
+    const NetworkRoute* best = nullptr;
+    m_networkRouteIndex.Lookup(
+        dest,
+        [this, oif, &best](const std::vector<NetworkRoute>& routes, uint8_t masklen) {
+            for (const NetworkRoute& route : routes)
             {
-                if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
+                NS_LOG_LOGIC("Found global network route " << route.first << ", mask length "
+                                                           << uint16_t(masklen) << ", metric "
+                                                           << route.second);
+                if (oif && oif != m_ipv4->GetNetDevice(route.first->GetInterface()))
                 {
                     NS_LOG_LOGIC("Not on requested interface, skipping");
                     continue;
                 }
+                if (best != nullptr && route.second > best->second)
+                {
+                    NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
+                    continue;
+                }
+                best = &route;
+                if (masklen == 32)
+                {
+                    break;
+                }
             }
-            if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-                NS_LOG_LOGIC("Previous match longer, skipping");
-                continue;
-            }
-            if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-                shortest_metric = 0xffffffff;
-            }
-            longest_mask = masklen;
-            if (metric > shortest_metric)
-            {
-                NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
-                continue;
-            }
-            shortest_metric = metric;
-            Ipv4RoutingTableEntry* route = (j);
-            uint32_t interfaceIdx = route->GetInterface();
-            rtentry = Create<Ipv4Route>();
-            rtentry->SetDestination(route->GetDest());
-            rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
-            rtentry->SetGateway(route->GetGateway());
-            rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-            if (masklen == 32)
-            {
-                break;
-            }
-        }
+            return best != nullptr;
+        });
+    if (best)
+    {
+        Ipv4RoutingTableEntry* route = best->first;
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(route->GetDest());
+        rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
+        rtentry->SetGateway(route->GetGateway());
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
     }
     if (rtentry)
     {
@@ -459,6 +463,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
         {
             delete j->first;
             m_networkRoutes.erase(j);
+            m_networkRouteIndexValid = false;
             return;
         }
         tmp++;
@@ -593,6 +598,8 @@ Ipv4StaticRouting::DoDispose()
     {
         delete (j->first);
     }
+    m_networkRouteIndex.Clear();
+    m_networkRouteIndexValid = false;
     for (MulticastRoutesI i = m_multicastRoutes.begin(); i != m_multicastRoutes.end();
          i = m_multicastRoutes.erase(i))
     {
@@ -634,6 +641,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
         {
             delete it->first;
             it = m_networkRoutes.erase(it);
+            m_networkRouteIndexValid = false;
         }
         else
         {
@@ -679,6 +687,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
         {
             delete it->first;
             it = m_networkRoutes.erase(it);
+            m_networkRouteIndexValid = false;
         }
         else
         {
@@ -21,6 +21,8 @@
 #ifndef IPV4_STATIC_ROUTING_H
 #define IPV4_STATIC_ROUTING_H
 
+#include "ipv4-prefix-trie.h"
+
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -371,6 +373,9 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
     /// Iterator for container for the network routes
     typedef std::list<std::pair<Ipv4RoutingTableEntry*, uint32_t>>::iterator NetworkRoutesI;
 
+    /// A network route and its metric
+    typedef std::pair<Ipv4RoutingTableEntry*, uint32_t> NetworkRoute;
+
     /// Container for the multicast routes
     typedef std::list<Ipv4MulticastRoutingTableEntry*> MulticastRoutes;
 
@@ -410,6 +415,17 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief the network routes by prefix, rebuilt on lookup after the
+     * forwarding table changed.
+     */
+    Ipv4PrefixTrie<NetworkRoute> m_networkRouteIndex;
+
+    /**
+     * \brief whether m_networkRouteIndex matches the forwarding table.
+     */
+    bool m_networkRouteIndexValid;
+
     /**
      * \brief the forwarding table for multicast.
      */
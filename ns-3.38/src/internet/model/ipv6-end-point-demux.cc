@@ -23,11 +23,52 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("Ipv6EndPointDemux");
 
+namespace
+{
+
+/**
+ * \brief Remove an endpoint from its bucket in a table, and the bucket if it
+ * becomes empty.
+ * \param table the table
+ * \param key the key of the bucket
+ * \param endPoint the endpoint
+ */
+template <typename Table, typename Key>
+void
+RemoveFromBucket(Table& table, const Key& key, Ipv6EndPoint* endPoint)
+{
+    auto bucket = table.find(key);
+    NS_ASSERT(bucket != table.end());
+    bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), endPoint));
+    if (bucket->second.empty())
+    {
+        table.erase(bucket);
+    }
+}
+
+} // namespace
+
+std::size_t
+Ipv6EndPointDemux::KeyHash::operator()(const LocalKey& key) const
+{
+    return Ipv6AddressHash()(key.address) * 65599 + key.port;
+}
+
+std::size_t
+Ipv6EndPointDemux::KeyHash::operator()(const TupleKey& key) const
+{
+    std::size_t peer = Ipv6AddressHash()(key.peerAddress) * 65599 + key.peerPort;
+    return (*this)(key.local) * 0x9e3779b97f4a7c15ULL ^ peer;
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux()
     : m_ephemeral(49152),
       m_portFirst(49152),
@@ -51,24 +92,21 @@ bool
 Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
 {
     NS_LOG_FUNCTION(this << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        if ((*i)->GetLocalPort() == port)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_locals.find(LocalKey{addr, port});
+    if (bucket == m_locals.end())
+    {
+        return false;
+    }
+    for (Ipv6EndPoint* endPoint : bucket->second)
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        if (endPoint->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -87,7 +125,7 @@ Ipv6EndPointDemux::Allocate()
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(Ipv6Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -103,7 +141,7 @@ Ipv6EndPointDemux::Allocate(Ipv6Address address)
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -126,7 +164,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv6Address address,
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -139,19 +177,21 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_tuples.find(TupleKey{{localAddress, localPort}, peerAddress, peerPort});
+    if (bucket != m_tuples.end())
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (Ipv6EndPoint* endPoint : bucket->second)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if (endPoint->GetBoundNetDevice() == boundNetDevice || !endPoint->GetBoundNetDevice())
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Insert(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -162,17 +202,58 @@ void
 Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    EndPointsI i = std::find(m_endPoints.begin(), m_endPoints.end(), endPoint);
+    if (i != m_endPoints.end())
     {
-        if (*i == endPoint)
-        {
-            delete endPoint;
-            m_endPoints.erase(i);
-            break;
-        }
+        Unindex(endPoint);
+        RemoveFromBucket(m_ports, endPoint->GetLocalPort(), endPoint);
+        m_endPoints.erase(i);
+        delete endPoint;
     }
 }
 
+void
+Ipv6EndPointDemux::Insert(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    m_endPoints.push_back(endPoint);
+    m_ports[endPoint->GetLocalPort()].push_back(endPoint);
+    Index(endPoint);
+    endPoint->m_demux = this;
+}
+
+void
+Ipv6EndPointDemux::Index(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    LocalKey local{endPoint->GetLocalAddress(), endPoint->GetLocalPort()};
+    m_locals[local].push_back(endPoint);
+    m_tuples[TupleKey{local, endPoint->GetPeerAddress(), endPoint->GetPeerPort()}].push_back(
+        endPoint);
+}
+
+void
+Ipv6EndPointDemux::Unindex(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    LocalKey local{endPoint->GetLocalAddress(), endPoint->GetLocalPort()};
+    RemoveFromBucket(m_locals, local, endPoint);
+    RemoveFromBucket(m_tuples,
+                     TupleKey{local, endPoint->GetPeerAddress(), endPoint->GetPeerPort()},
+                     endPoint);
+}
+
+void
+Ipv6EndPointDemux::SetLocalPort(Ipv6EndPoint* endPoint, uint16_t port)
+{
+    NS_LOG_FUNCTION(this << endPoint << port);
+    Unindex(endPoint);
+    RemoveFromBucket(m_ports, endPoint->GetLocalPort(), endPoint);
+    endPoint->m_localPort = port;
+    m_ports[port].push_back(endPoint);
+    Index(endPoint);
+}
+
 /*
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
@@ -193,93 +274,104 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     EndPoints retval4; /* Exact match on all 4 */
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        Ipv6EndPoint* endP = *i;
 
-        NS_LOG_DEBUG("Looking at endpoint dport="
-                     << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
-                     << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
-
-        if (!endP->IsRxEnabled())
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP
-                                              << " because endpoint can not receive packets");
-            continue;
-        }
-
-        if (endP->GetLocalPort() != dport)
+    // A matching endpoint is bound to the destination address or to any
+    // address, and its peer address and port match exactly or are wildcards,
+    // so it is found in a few buckets of the four-tuple table.
+    std::vector<Ipv6Address> localAddresses{daddr};
+    if (daddr != Ipv6Address::GetAny())
+    {
+        localAddresses.push_back(Ipv6Address::GetAny());
+    }
+    std::vector<std::pair<Ipv6Address, uint16_t>> peers;
+    for (Ipv6Address peerAddress : {saddr, Ipv6Address::GetAny()})
+    {
+        for (uint16_t peerPort : {sport, uint16_t(0)})
         {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
-                                              << endP->GetLocalPort()
-                                              << " does not match packet dport " << dport);
-            continue;
+            if (std::find(peers.begin(), peers.end(), std::make_pair(peerAddress, peerPort)) ==
+                peers.end())
+            {
+                peers.emplace_back(peerAddress, peerPort);
+            }
         }
+    }
 
-        if (endP->GetBoundNetDevice())
+    for (Ipv6Address localAddress : localAddresses)
+    {
+        for (const auto& [peerAddress, peerPort] : peers)
         {
-            if (!incomingInterface)
+            auto bucket = m_tuples.find(TupleKey{{localAddress, dport}, peerAddress, peerPort});
+            if (bucket == m_tuples.end())
             {
                 continue;
             }
-            if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
+            for (Ipv6EndPoint* endP : bucket->second)
             {
-                NS_LOG_LOGIC("Skipping endpoint "
-                             << &endP << " because endpoint is bound to specific device and"
-                             << endP->GetBoundNetDevice() << " does not match packet device "
-                             << incomingInterface->GetDevice());
-                continue;
+                NS_LOG_DEBUG("Looking at endpoint dport="
+                             << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
+                             << " sport=" << endP->GetPeerPort()
+                             << " saddr=" << endP->GetPeerAddress());
+
+                if (!endP->IsRxEnabled())
+                {
+                    NS_LOG_LOGIC("Skipping endpoint "
+                                 << &endP << " because endpoint can not receive packets");
+                    continue;
+                }
+
+                if (endP->GetBoundNetDevice())
+                {
+                    if (!incomingInterface)
+                    {
+                        continue;
+                    }
+                    if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
+                    {
+                        NS_LOG_LOGIC("Skipping endpoint "
+                                     << &endP
+                                     << " because endpoint is bound to specific device and"
+                                     << endP->GetBoundNetDevice()
+                                     << " does not match packet device "
+                                     << incomingInterface->GetDevice());
+                        continue;
+                    }
+                }
+
+                bool localAddressMatchesWildCard =
+                    endP->GetLocalAddress() == Ipv6Address::GetAny();
+                bool localAddressMatchesExact = endP->GetLocalAddress() == daddr;
+                bool localAddressMatchesAllRouters =
+                    endP->GetLocalAddress() == Ipv6Address::GetAllRoutersMulticast();
+
+                bool remotePeerMatchesExact = endP->GetPeerPort() == sport;
+                bool remotePeerMatchesWildCard = endP->GetPeerPort() == 0;
+                bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
+                bool remoteAddressMatchesWildCard =
+                    endP->GetPeerAddress() == Ipv6Address::GetAny();
+
+                /* Now figure out which return list to add this one to */
+                if (localAddressMatchesWildCard && remotePeerMatchesWildCard &&
+                    remoteAddressMatchesWildCard)
+                { /* Only local port matches exactly */
+                    retval1.push_back(endP);
+                }
+                if ((localAddressMatchesExact || (localAddressMatchesAllRouters)) &&
+                    remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+                { /* Only local port and local address matches exactly */
+                    retval2.push_back(endP);
+                }
+                if (localAddressMatchesWildCard && remotePeerMatchesExact &&
+                    remoteAddressMatchesExact)
+                { /* All but local address */
+                    retval3.push_back(endP);
+                }
+                if (localAddressMatchesExact && remotePeerMatchesExact &&
+                    remoteAddressMatchesExact)
+                { /* All 4 match */
+                    retval4.push_back(endP);
+                }
             }
         }
-
-        /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-        NS_LOG_DEBUG("dest addr " << daddr);
-
-        bool localAddressMatchesWildCard = endP->GetLocalAddress() == Ipv6Address::GetAny();
-        bool localAddressMatchesExact = endP->GetLocalAddress() == daddr;
-        bool localAddressMatchesAllRouters =
-            endP->GetLocalAddress() == Ipv6Address::GetAllRoutersMulticast();
-
-        /* if no match here, keep looking */
-        if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-            continue;
-        }
-        bool remotePeerMatchesExact = endP->GetPeerPort() == sport;
-        bool remotePeerMatchesWildCard = endP->GetPeerPort() == 0;
-        bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
-        bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv6Address::GetAny();
-
-        /* If remote does not match either with exact or wildcard,i
-           skip this one */
-        if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-            continue;
-        }
-        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-            continue;
-        }
-
-        /* Now figure out which return list to add this one to */
-        if (localAddressMatchesWildCard && remotePeerMatchesWildCard &&
-            remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-            retval1.push_back(endP);
-        }
-        if ((localAddressMatchesExact || (localAddressMatchesAllRouters)) &&
-            remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-            retval2.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remotePeerMatchesExact && remoteAddressMatchesExact)
-        { /* All but local address */
-            retval3.push_back(endP);
-        }
-        if (localAddressMatchesExact && remotePeerMatchesExact && remoteAddressMatchesExact)
-        { /* All 4 match */
-            retval4.push_back(endP);
-        }
     }
 
     // Here we find the most exact match
@@ -312,16 +404,16 @@ Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src
 {
     uint32_t genericity = 3;
     Ipv6EndPoint* generic = nullptr;
+    auto bucket = m_ports.find(dport);
+    if (bucket == m_ports.end())
+    {
+        return nullptr;
+    }
 
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    for (auto i = bucket->second.begin(); i != bucket->second.end(); i++)
     {
         uint32_t tmp = 0;
 
-        if ((*i)->GetLocalPort() != dport)
-        {
-            continue;
-        }
-
         if ((*i)->GetLocalAddress() == dst && (*i)->GetPeerPort() == sport &&
             (*i)->GetPeerAddress() == src)
         {
@@ -26,6 +26,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -36,6 +38,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed in hash tables keyed on their local port, their
+ * local address and port, and their four-tuple, so that a lookup only visits
+ * the endpoints which can match.  The endpoints update the tables when their
+ * addresses or port change.
  */
 class Ipv6EndPointDemux
 {
@@ -161,6 +168,93 @@ class Ipv6EndPointDemux
     EndPoints GetEndPoints() const;
 
   private:
+    friend class Ipv6EndPoint;
+
+    /**
+     * \brief Key of the endpoints bound to a local address and port.
+     */
+    struct LocalKey
+    {
+        Ipv6Address address; //!< local address
+        uint16_t port;       //!< local port
+
+        /**
+         * \param other the key to compare with
+         * \return true if the keys are equal
+         */
+        bool operator==(const LocalKey& other) const
+        {
+            return address == other.address && port == other.port;
+        }
+    };
+
+    /**
+     * \brief Key of the endpoints with a given four-tuple.
+     */
+    struct TupleKey
+    {
+        LocalKey local;          //!< local address and port
+        Ipv6Address peerAddress; //!< peer address
+        uint16_t peerPort;       //!< peer port
+
+        /**
+         * \param other the key to compare with
+         * \return true if the keys are equal
+         */
+        bool operator==(const TupleKey& other) const
+        {
+            return local == other.local && peerAddress == other.peerAddress &&
+                   peerPort == other.peerPort;
+        }
+    };
+
+    /**
+     * \brief Hash function of the endpoint keys.
+     */
+    struct KeyHash
+    {
+        /**
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const LocalKey& key) const;
+        /**
+         * \param key the key
+         * \return the hash of the key
+         */
+        std::size_t operator()(const TupleKey& key) const;
+    };
+
+    /**
+     * \brief Endpoints sharing a key, in the order they were indexed.
+     */
+    typedef std::vector<Ipv6EndPoint*> Bucket;
+
+    /**
+     * \brief Add an endpoint to the list and to the tables.
+     * \param endPoint the endpoint
+     */
+    void Insert(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Add an endpoint to the tables keyed on its addresses.
+     * \param endPoint the endpoint
+     */
+    void Index(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Remove an endpoint from the tables keyed on its addresses.
+     * \param endPoint the endpoint
+     */
+    void Unindex(Ipv6EndPoint* endPoint);
+
+    /**
+     * \brief Change the local port of an endpoint, updating the tables.
+     * \param endPoint the endpoint
+     * \param port the new local port
+     */
+    void SetLocalPort(Ipv6EndPoint* endPoint, uint16_t port);
+
     /**
      * \brief Allocate a ephemeral port.
      * \return a port
@@ -186,6 +280,21 @@ class Ipv6EndPointDemux
      * \brief A list of IPv6 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The end points, by local port.
+     */
+    std::unordered_map<uint16_t, Bucket> m_ports;
+
+    /**
+     * \brief The end points, by local address and port.
+     */
+    std::unordered_map<LocalKey, Bucket, KeyHash> m_locals;
+
+    /**
+     * \brief The end points, by four-tuple.
+     */
+    std::unordered_map<TupleKey, Bucket, KeyHash> m_tuples;
 };
 
 } /* namespace ns3 */
@@ -33,6 +33,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \ingroup ipv6
@@ -194,6 +195,8 @@ class Ipv6EndPoint
     bool IsRxEnabled() const;
 
   private:
+    friend class Ipv6EndPointDemux;
+
     /**
      * \brief The local address.
      */
@@ -238,6 +241,11 @@ class Ipv6EndPoint
      * \brief true if the endpoint can receive packets.
      */
     bool m_rxEnabled;
+
+    /**
+     * \brief The demux indexing the endpoint by its addresses, if any.
+     */
+    Ipv6EndPointDemux* m_demux;
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 EndPointDemux Test: the most specific endpoint is found,
+ * including after its addresses change.
+ */
+class Ipv4EndPointDemuxTest : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxTest();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv4EndPointDemuxTest::Ipv4EndPointDemuxTest()
+    : TestCase("IPv4 EndPointDemux lookups")
+{
+}
+
+void
+Ipv4EndPointDemuxTest::DoRun()
+{
+    Ipv4Address local("10.0.0.1");
+    Ipv4Address peer("10.0.0.2");
+    Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface>();
+    interface->SetDevice(CreateObject<SimpleNetDevice>());
+    interface->AddAddress(Ipv4InterfaceAddress(local, Ipv4Mask("255.255.255.0")));
+
+    Ipv4EndPointDemux demux;
+    Ipv4EndPoint* listener = demux.Allocate(nullptr, 80);
+    Ipv4EndPoint* connection = demux.Allocate(nullptr, local, 80, peer, 1234);
+    Ipv4EndPoint* bound = demux.Allocate(nullptr, local, 81);
+    Ipv4EndPoint* subnet = demux.Allocate(nullptr, Ipv4Address("10.0.0.0"), 82);
+    NS_TEST_ASSERT_MSG_NE(listener, nullptr, "Allocation failed");
+    NS_TEST_ASSERT_MSG_NE(connection, nullptr, "Allocation failed");
+    NS_TEST_ASSERT_MSG_NE(bound, nullptr, "Allocation failed");
+    NS_TEST_ASSERT_MSG_NE(subnet, nullptr, "Allocation failed");
+
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, local, 80, peer, 1234),
+                          nullptr,
+                          "Duplicated four-tuple should be rejected");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, local, 81),
+                          nullptr,
+                          "Duplicated local address and port should be rejected");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(80), true, "Port 80 is in use");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(83), false, "Port 83 is not in use");
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupLocal(nullptr, local, 81), true, "Port 81 is bound");
+
+    Ipv4EndPointDemux::EndPoints found = demux.Lookup(local, 80, peer, 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), connection, "The connection should be preferred");
+    found = demux.Lookup(local, 80, Ipv4Address("10.0.0.3"), 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), listener, "The listener should match other peers");
+    found = demux.Lookup(Ipv4Address("10.0.0.255"), 82, peer, 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), subnet, "The subnet endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(demux.SimpleLookup(local, 80, peer, 1234),
+                          connection,
+                          "SimpleLookup should find the connection");
+
+    // The tables follow the changes of the endpoint addresses.
+    bound->SetPeer(peer, 5000);
+    found = demux.Lookup(local, 81, peer, 5000, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), bound, "The connected endpoint should match");
+    found = demux.Lookup(local, 81, peer, 5001, interface);
+    NS_TEST_EXPECT_MSG_EQ(found.size(), 0, "No endpoint should match another peer port");
+    bound->SetLocalAddress(Ipv4Address("10.0.0.4"));
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupLocal(nullptr, local, 81), false, "Port 81 is unbound");
+    found = demux.Lookup(Ipv4Address("10.0.0.4"), 81, peer, 5000, interface);
+    NS_TEST_EXPECT_MSG_EQ(found.size(), 1, "The endpoint should match its new address");
+
+    bound->SetRxEnabled(false);
+    found = demux.Lookup(Ipv4Address("10.0.0.4"), 81, peer, 5000, interface);
+    NS_TEST_EXPECT_MSG_EQ(found.size(), 0, "Endpoints with disabled Rx should be skipped");
+
+    demux.DeAllocate(connection);
+    found = demux.Lookup(local, 80, peer, 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), listener, "The listener should match after close");
+    demux.DeAllocate(listener);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(80), false, "Port 80 is no longer in use");
+    NS_TEST_EXPECT_MSG_EQ(demux.GetAllEndPoints().size(), 2, "Two endpoints should be left");
+
+    interface->Dispose();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv6 EndPointDemux Test: the most specific endpoint is found,
+ * including after its addresses change.
+ */
+class Ipv6EndPointDemuxTest : public TestCase
+{
+  public:
+    Ipv6EndPointDemuxTest();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv6EndPointDemuxTest::Ipv6EndPointDemuxTest()
+    : TestCase("IPv6 EndPointDemux lookups")
+{
+}
+
+void
+Ipv6EndPointDemuxTest::DoRun()
+{
+    Ipv6Address local("2001:db8::1");
+    Ipv6Address peer("2001:db8::2");
+    Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface>();
+    interface->SetDevice(CreateObject<SimpleNetDevice>());
+
+    Ipv6EndPointDemux demux;
+    Ipv6EndPoint* listener = demux.Allocate(nullptr, 80);
+    Ipv6EndPoint* connection = demux.Allocate(nullptr, local, 80, peer, 1234);
+    NS_TEST_ASSERT_MSG_NE(listener, nullptr, "Allocation failed");
+    NS_TEST_ASSERT_MSG_NE(connection, nullptr, "Allocation failed");
+    NS_TEST_EXPECT_MSG_EQ(demux.Allocate(nullptr, local, 80, peer, 1234),
+                          nullptr,
+                          "Duplicated four-tuple should be rejected");
+
+    Ipv6EndPointDemux::EndPoints found = demux.Lookup(local, 80, peer, 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), connection, "The connection should be preferred");
+    found = demux.Lookup(local, 80, Ipv6Address("2001:db8::3"), 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), listener, "The listener should match other peers");
+
+    // The tables follow the changes of the endpoint addresses and port.
+    connection->SetLocalPort(90);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(90), true, "Port 90 is in use");
+    found = demux.Lookup(local, 90, peer, 1234, interface);
+    NS_TEST_ASSERT_MSG_EQ(found.size(), 1, "One endpoint should match");
+    NS_TEST_EXPECT_MSG_EQ(found.front(), connection, "The endpoint should match its new port");
+    connection->SetPeer(Ipv6Address("2001:db8::3"), 1235);
+    found = demux.Lookup(local, 90, peer, 1234, interface);
+    NS_TEST_EXPECT_MSG_EQ(found.size(), 0, "No endpoint should match the old peer");
+    NS_TEST_EXPECT_MSG_EQ(demux.SimpleLookup(local, 90, Ipv6Address("2001:db8::3"), 1235),
+                          connection,
+                          "SimpleLookup should find the connection");
+
+    demux.DeAllocate(listener);
+    NS_TEST_EXPECT_MSG_EQ(demux.LookupPortLocal(80), false, "Port 80 is no longer in use");
+    found = demux.Lookup(local, 80, peer, 1234, interface);
+    NS_TEST_EXPECT_MSG_EQ(found.size(), 0, "No endpoint should match a closed port");
+
+    interface->Dispose();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    EndPointDemuxTestSuite()
+        : TestSuite("end-point-demux", UNIT)
+    {
+        AddTestCase(new Ipv4EndPointDemuxTest, TestCase::QUICK);
+        AddTestCase(new Ipv6EndPointDemuxTest, TestCase::QUICK);
+    }
+};
+
+static EndPointDemuxTestSuite
+    g_endPointDemuxTestSuite; //!< Static variable for test initialization
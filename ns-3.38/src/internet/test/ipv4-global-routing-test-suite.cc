@@ -41,6 +41,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <sstream>
 #include <vector>
 
 using namespace ns3;
@@ -1313,6 +1315,159 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting recomputation test: the routes computed with
+ * several threads, and incrementally after topology changes, are the same
+ * as the ones of a full single-threaded computation.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingRecomputeTestCase();
+
+  private:
+    void DoSetup() override;
+    void DoRun() override;
+    void DoTeardown() override;
+
+    /**
+     * \brief Get the routes of the nodes.
+     * \returns The sorted routes of each node.
+     */
+    std::vector<std::vector<std::string>> GetRoutes() const;
+
+    /**
+     * \brief Recompute the routes and check them against a full
+     * single-threaded computation.
+     * \param threads The number of threads.
+     * \param incremental Whether the computation is incremental.
+     * \param message The message of the test.
+     */
+    void CheckRecompute(uint32_t threads, bool incremental, std::string message);
+
+    NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase()
+    : TestCase("Global routing recomputation with threads and incremental SPF")
+{
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoSetup()
+{
+    // Six routers in a ring of point-to-point links with a chord, three of
+    // them on a LAN, and two hosts on point-to-point links.
+    m_nodes.Create(8);
+    SimpleNetDeviceHelper p2pHelper;
+    p2pHelper.SetNetDevicePointToPointMode(true);
+    std::vector<NetDeviceContainer> links;
+    uint32_t ends[8][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 0}, {1, 4}, {3, 6}};
+    for (auto& end : ends)
+    {
+        links.push_back(p2pHelper.Install(NodeContainer(m_nodes.Get(end[0]), m_nodes.Get(end[1]))));
+    }
+    links.push_back(p2pHelper.Install(NodeContainer(m_nodes.Get(5), m_nodes.Get(7))));
+    SimpleNetDeviceHelper lanHelper;
+    links.push_back(
+        lanHelper.Install(NodeContainer(m_nodes.Get(0), m_nodes.Get(2), m_nodes.Get(4))));
+
+    InternetStackHelper internet;
+    Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+    internet.SetRoutingHelper(ipv4RoutingHelper);
+    internet.Install(m_nodes);
+
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    for (auto& link : links)
+    {
+        ipv4.Assign(link);
+        ipv4.NewNetwork();
+    }
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoTeardown()
+{
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(false));
+    Simulator::Destroy();
+}
+
+std::vector<std::vector<std::string>>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes() const
+{
+    std::vector<std::vector<std::string>> routes;
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+    {
+        Ptr<Ipv4GlobalRouting> routing =
+            m_nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4GlobalRouting>();
+        std::vector<std::string> nodeRoutes;
+        for (uint32_t j = 0; j < routing->GetNRoutes(); j++)
+        {
+            std::ostringstream oss;
+            oss << *routing->GetRoute(j);
+            nodeRoutes.push_back(oss.str());
+        }
+        std::sort(nodeRoutes.begin(), nodeRoutes.end());
+        routes.push_back(nodeRoutes);
+    }
+    return routes;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::CheckRecompute(uint32_t threads,
+                                                   bool incremental,
+                                                   std::string message)
+{
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(threads));
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(incremental));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    std::vector<std::vector<std::string>> routes = GetRoutes();
+
+    // The full computation drops the trees kept for the incremental one:
+    // compute them again.
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(false));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    std::vector<std::vector<std::string>> expected = GetRoutes();
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(threads));
+    Config::SetGlobal("GlobalRoutingIncremental", BooleanValue(incremental));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+
+    for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(routes[i].size(), expected[i].size(), message << ", node " << i);
+        for (uint32_t j = 0; j < std::min(routes[i].size(), expected[i].size()); j++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(routes[i][j], expected[i][j], message << ", node " << i);
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun()
+{
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    NS_TEST_ASSERT_MSG_GT(GetRoutes()[0].size(), 10, "Error-- the router misses routes");
+
+    CheckRecompute(4, false, "Multi-threaded computation");
+    CheckRecompute(1, true, "Incremental computation");
+
+    // Each change gets checked against the trees of the previous topology.
+    Ptr<Ipv4> ipv4 = m_nodes.Get(1)->GetObject<Ipv4>();
+    ipv4->SetDown(3);
+    CheckRecompute(1, true, "Incremental computation after a link went down");
+    ipv4->SetUp(3);
+    CheckRecompute(4, true, "Incremental computation after a link went up");
+    m_nodes.Get(3)->GetObject<Ipv4>()->SetMetric(1, 10);
+    CheckRecompute(1, true, "Incremental computation after a metric change");
+    m_nodes.Get(6)->GetObject<Ipv4>()->SetDown(1);
+    CheckRecompute(1, true, "Incremental computation after a host went down");
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1335,6 +1490,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
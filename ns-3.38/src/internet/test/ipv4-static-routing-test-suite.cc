@@ -20,6 +20,8 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node-container.h"
 #include "ns3/node.h"
@@ -210,7 +212,127 @@ Ipv4StaticRoutingSlash32TestCase::DoRun()
 /**
  * \ingroup internet-test
  *
- * \brief IPv4 StaticRouting /32 TestSuite
+ * \brief IPv4 StaticRouting longest prefix match Test
+ */
+class Ipv4StaticRoutingLongestPrefixTestCase : public TestCase
+{
+  public:
+    Ipv4StaticRoutingLongestPrefixTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Look up the gateway to a destination.
+     * \param routing The routing protocol.
+     * \param dest The destination address.
+     * \returns The gateway of the route found, or 255.255.255.255 if none.
+     */
+    Ipv4Address Lookup(Ptr<Ipv4StaticRouting> routing, std::string dest);
+};
+
+Ipv4StaticRoutingLongestPrefixTestCase::Ipv4StaticRoutingLongestPrefixTestCase()
+    : TestCase("Static routing longest prefix match and metrics")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLongestPrefixTestCase::Lookup(Ptr<Ipv4StaticRouting> routing, std::string dest)
+{
+    Ipv4Header header;
+    header.SetDestination(Ipv4Address(dest.c_str()));
+    Socket::SocketErrno error;
+    Ptr<Ipv4Route> route = routing->RouteOutput(Create<Packet>(), header, nullptr, error);
+    return route ? route->GetGateway() : Ipv4Address::GetBroadcast();
+}
+
+void
+Ipv4StaticRoutingLongestPrefixTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+    device->SetAddress(Mac48Address::Allocate());
+    node->AddDevice(device);
+    InternetStackHelper internet;
+    internet.Install(node);
+
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    int32_t ifIndex = ipv4->AddInterface(device);
+    ipv4->AddAddress(ifIndex, Ipv4InterfaceAddress(Ipv4Address("10.1.0.1"), Ipv4Mask("/24")));
+    ipv4->SetUp(ifIndex);
+
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    Ptr<Ipv4StaticRouting> routing = ipv4RoutingHelper.GetStaticRouting(ipv4);
+    routing->SetDefaultRoute(Ipv4Address("10.1.0.10"), ifIndex);
+    routing->AddNetworkRouteTo(Ipv4Address("10.0.0.0"),
+                               Ipv4Mask("/8"),
+                               Ipv4Address("10.1.0.2"),
+                               ifIndex);
+    routing->AddNetworkRouteTo(Ipv4Address("10.2.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("10.1.0.3"),
+                               ifIndex,
+                               5);
+    routing->AddNetworkRouteTo(Ipv4Address("10.2.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("10.1.0.4"),
+                               ifIndex,
+                               5);
+    routing->AddNetworkRouteTo(Ipv4Address("10.2.0.0"),
+                               Ipv4Mask("/16"),
+                               Ipv4Address("10.1.0.5"),
+                               ifIndex,
+                               7);
+    routing->AddHostRouteTo(Ipv4Address("10.2.3.4"), Ipv4Address("10.1.0.6"), ifIndex, 3);
+    routing->AddHostRouteTo(Ipv4Address("10.2.3.4"), Ipv4Address("10.1.0.7"), ifIndex, 1);
+
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "192.168.0.1"),
+                          Ipv4Address("10.1.0.10"),
+                          "The default route should be used");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.3.0.1"),
+                          Ipv4Address("10.1.0.2"),
+                          "The /8 route should be used");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.1.0.2"),
+                          Ipv4Address::GetZero(),
+                          "The route to the interface network should be used");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.2.9.9"),
+                          Ipv4Address("10.1.0.4"),
+                          "The last /16 route with the lowest metric should be used");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.2.3.4"),
+                          Ipv4Address("10.1.0.6"),
+                          "The first host route should be used");
+
+    // Lookups follow the changes of the table.
+    for (uint32_t i = 0; i < routing->GetNRoutes(); i++)
+    {
+        if (routing->GetRoute(i).GetGateway() == Ipv4Address("10.1.0.4"))
+        {
+            routing->RemoveRoute(i);
+            break;
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.2.9.9"),
+                          Ipv4Address("10.1.0.3"),
+                          "The remaining /16 route with the lowest metric should be used");
+    routing->AddNetworkRouteTo(Ipv4Address("10.2.9.0"),
+                               Ipv4Mask("/24"),
+                               Ipv4Address("10.1.0.8"),
+                               ifIndex,
+                               9);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.2.9.9"),
+                          Ipv4Address("10.1.0.8"),
+                          "The new /24 route should be used");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(routing, "10.2.8.9"),
+                          Ipv4Address("10.1.0.3"),
+                          "The /16 route should still be used outside of the /24");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 StaticRouting TestSuite
  */
 class Ipv4StaticRoutingTestSuite : public TestSuite
 {
@@ -222,6 +344,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite()
     : TestSuite("ipv4-static-routing", UNIT)
 {
     AddTestCase(new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4StaticRoutingLongestPrefixTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite
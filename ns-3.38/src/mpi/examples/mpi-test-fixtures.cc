@@ -24,9 +24,12 @@
 #include "ns3/inet6-socket-address.h"
 #include "ns3/packet.h"
 #include "ns3/ptr.h"
+#include "ns3/shared-memory-transport.h"
 #include "ns3/simulator.h"
 
 #include <mpi.h>
+#include <numeric>
+#include <vector>
 
 namespace ns3
 {
@@ -41,6 +44,13 @@ SinkTracer::Init()
 {
     m_sinkCount = 0;
     m_line = 0;
+    if (SharedMemoryTransport::IsEnabled())
+    {
+        // The ranks are forked processes, MPI is not initialized
+        m_worldRank = SharedMemoryTransport::GetSystemId();
+        m_worldSize = SharedMemoryTransport::GetSize();
+        return;
+    }
     MPI_Comm_rank(MPI_COMM_WORLD, &m_worldRank);
     MPI_Comm_size(MPI_COMM_WORLD, &m_worldSize);
 }
@@ -59,7 +69,16 @@ SinkTracer::Verify(unsigned long expectedCount)
     unsigned long globalCount;
 
 #ifdef NS3_MPI
-    MPI_Reduce(&m_sinkCount, &globalCount, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (SharedMemoryTransport::IsEnabled())
+    {
+        std::vector<unsigned long> counts(m_worldSize);
+        SharedMemoryTransport::AllGather(&m_sinkCount, sizeof(m_sinkCount), counts.data());
+        globalCount = std::accumulate(counts.begin(), counts.end(), 0UL);
+    }
+    else
+    {
+        MPI_Reduce(&m_sinkCount, &globalCount, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    }
 #else
     globalCount = m_sinkCount;
 #endif
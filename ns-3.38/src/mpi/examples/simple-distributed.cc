@@ -69,6 +69,7 @@ main(int argc, char* argv[])
 {
     bool nix = true;
     bool nullmsg = false;
+    bool sharedMemory = false;
     bool tracing = false;
     bool testing = false;
     bool verbose = false;
@@ -77,6 +78,9 @@ main(int argc, char* argv[])
     CommandLine cmd(__FILE__);
     cmd.AddValue("nix", "Enable the use of nix-vector or global routing", nix);
     cmd.AddValue("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+    cmd.AddValue("sharedMemory",
+                 "Run the logical processors as local processes sharing memory, without MPI",
+                 sharedMemory);
     cmd.AddValue("tracing", "Enable pcap tracing", tracing);
     cmd.AddValue("verbose", "verbose output", verbose);
     cmd.AddValue("test", "Enable regression test output", testing);
@@ -94,8 +98,16 @@ main(int argc, char* argv[])
                           StringValue("ns3::DistributedSimulatorImpl"));
     }
 
-    // Enable parallel simulator with the command line arguments
-    MpiInterface::Enable(&argc, &argv);
+    // Enable parallel simulator with the command line arguments, or
+    // fork the second logical processor
+    if (sharedMemory)
+    {
+        MpiInterface::EnableSharedMemory(2);
+    }
+    else
+    {
+        MpiInterface::Enable(&argc, &argv);
+    }
 
     SinkTracer::Init();
 
@@ -0,0 +1,700 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::PartitionHelper.
+ */
+
+#include "partition-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <set>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PartitionHelper");
+
+namespace
+{
+
+/** Marks a vertex not yet matched or assigned. */
+const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+/** Coarsening stops when the graph has fewer vertices per partition. */
+const uint32_t COARSEST_VERTICES_PER_PARTITION = 20;
+/** Number of seeds tried to split the coarsest graph. */
+const uint32_t INITIAL_PARTITION_TRIES = 8;
+/** Maximum number of refinement passes per level. */
+const uint32_t MAX_REFINE_PASSES = 10;
+/** Cost of cutting the shortest link, relative to the longest one. */
+const uint64_t MAX_EDGE_WEIGHT = 1 << 16;
+
+/**
+ * Find the representative of a vertex, compressing the path.
+ * \param [in,out] parents The parent of each vertex.
+ * \param [in] v The vertex.
+ * \returns The representative.
+ */
+uint32_t
+FindRoot(std::vector<uint32_t>& parents, uint32_t v)
+{
+    while (parents[v] != v)
+    {
+        parents[v] = parents[parents[v]];
+        v = parents[v];
+    }
+    return v;
+}
+
+} // namespace
+
+PartitionHelper::PartitionHelper()
+    : m_partitions(1),
+      m_imbalance(1.03),
+      m_minLookahead(Time(0)),
+      m_maxPartWeight(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+PartitionHelper::SetPartitionCount(uint32_t partitions)
+{
+    NS_LOG_FUNCTION(this << partitions);
+    NS_ABORT_MSG_IF(partitions == 0, "At least one partition is required");
+    m_partitions = partitions;
+}
+
+void
+PartitionHelper::SetImbalance(double imbalance)
+{
+    NS_LOG_FUNCTION(this << imbalance);
+    NS_ABORT_MSG_IF(imbalance < 1, "The imbalance factor must be at least 1");
+    m_imbalance = imbalance;
+}
+
+void
+PartitionHelper::SetMinLookahead(Time lookahead)
+{
+    NS_LOG_FUNCTION(this << lookahead);
+    m_minLookahead = lookahead;
+}
+
+void
+PartitionHelper::AddNode(Ptr<Node> node)
+{
+    if (m_nodes.emplace(node->GetId(), m_nodeIds.size()).second)
+    {
+        m_nodeIds.push_back(node->GetId());
+        m_weights.push_back(1);
+    }
+}
+
+void
+PartitionHelper::Add(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this);
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        AddNode(*i);
+    }
+}
+
+void
+PartitionHelper::SetNodeWeight(Ptr<Node> node, uint32_t weight)
+{
+    NS_LOG_FUNCTION(this << node->GetId() << weight);
+    AddNode(node);
+    m_weights[m_nodes[node->GetId()]] = weight;
+}
+
+void
+PartitionHelper::AddLink(Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+    NS_LOG_FUNCTION(this << a->GetId() << b->GetId() << delay);
+    AddNode(a);
+    AddNode(b);
+    if (a != b)
+    {
+        m_links.push_back(Link{a->GetId(), b->GetId(), delay});
+    }
+}
+
+void
+PartitionHelper::AddChannels(NodeContainer nodes)
+{
+    NS_LOG_FUNCTION(this);
+    std::set<Ptr<Channel>> channels;
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        Ptr<Node> node = *i;
+        AddNode(node);
+        for (uint32_t j = 0; j < node->GetNDevices(); ++j)
+        {
+            Ptr<NetDevice> device = node->GetDevice(j);
+            Ptr<Channel> channel = device->GetChannel();
+            if (!channel || !channels.insert(channel).second)
+            {
+                continue;
+            }
+            if (device->IsPointToPoint() && channel->GetNDevices() == 2)
+            {
+                TimeValue delay;
+                if (!channel->GetAttributeFailSafe("Delay", delay))
+                {
+                    delay.Set(Time(0));
+                }
+                AddLink(channel->GetDevice(0)->GetNode(),
+                        channel->GetDevice(1)->GetNode(),
+                        delay.Get());
+                continue;
+            }
+            // Only point-to-point channels can be split between ranks.
+            Ptr<Node> first = channel->GetDevice(0)->GetNode();
+            for (std::size_t k = 1; k < channel->GetNDevices(); ++k)
+            {
+                AddLink(first, channel->GetDevice(k)->GetNode(), Time(0));
+            }
+        }
+    }
+}
+
+bool
+PartitionHelper::IsCuttable(Time delay) const
+{
+    return delay.IsStrictlyPositive() && delay >= m_minLookahead;
+}
+
+PartitionHelper::Graph
+PartitionHelper::BuildGraph(std::vector<uint64_t> weights,
+                            std::vector<std::tuple<uint32_t, uint32_t, uint64_t>>& edges)
+{
+    for (auto& edge : edges)
+    {
+        if (std::get<0>(edge) > std::get<1>(edge))
+        {
+            std::swap(std::get<0>(edge), std::get<1>(edge));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // Merge the parallel edges, and count the degree of each vertex.
+    Graph graph;
+    graph.weights = std::move(weights);
+    uint32_t n = graph.weights.size();
+    std::vector<uint32_t> degrees(n, 0);
+    std::size_t merged = 0;
+    for (std::size_t i = 0; i < edges.size(); ++i)
+    {
+        if (merged > 0 && std::get<0>(edges[merged - 1]) == std::get<0>(edges[i]) &&
+            std::get<1>(edges[merged - 1]) == std::get<1>(edges[i]))
+        {
+            std::get<2>(edges[merged - 1]) += std::get<2>(edges[i]);
+            continue;
+        }
+        edges[merged++] = edges[i];
+        degrees[std::get<0>(edges[i])]++;
+        degrees[std::get<1>(edges[i])]++;
+    }
+    edges.resize(merged);
+
+    graph.offsets.assign(n + 1, 0);
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        graph.offsets[v + 1] = graph.offsets[v] + degrees[v];
+    }
+    graph.neighbors.resize(graph.offsets[n]);
+    graph.edgeWeights.resize(graph.offsets[n]);
+    std::vector<uint32_t> next(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const auto& [u, v, weight] : edges)
+    {
+        graph.neighbors[next[u]] = v;
+        graph.edgeWeights[next[u]++] = weight;
+        graph.neighbors[next[v]] = u;
+        graph.edgeWeights[next[v]++] = weight;
+    }
+    return graph;
+}
+
+PartitionHelper::Graph
+PartitionHelper::Coarsen(const Graph& graph, uint64_t maxWeight, std::vector<uint32_t>& map)
+{
+    uint32_t n = graph.weights.size();
+
+    // Match the vertices of low degree first, since they have fewer choices.
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&graph](uint32_t a, uint32_t b) {
+        return graph.offsets[a + 1] - graph.offsets[a] < graph.offsets[b + 1] - graph.offsets[b];
+    });
+
+    std::vector<uint32_t> matches(n, NONE);
+    for (uint32_t v : order)
+    {
+        if (matches[v] != NONE)
+        {
+            continue;
+        }
+        uint32_t best = v;
+        uint64_t bestWeight = 0;
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e)
+        {
+            uint32_t u = graph.neighbors[e];
+            if (matches[u] != NONE || graph.weights[v] + graph.weights[u] > maxWeight)
+            {
+                continue;
+            }
+            if (graph.edgeWeights[e] > bestWeight ||
+                (graph.edgeWeights[e] == bestWeight && graph.weights[u] < graph.weights[best]))
+            {
+                best = u;
+                bestWeight = graph.edgeWeights[e];
+            }
+        }
+        matches[v] = best;
+        matches[best] = v;
+    }
+
+    map.assign(n, NONE);
+    std::vector<uint64_t> weights;
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        if (map[v] == NONE)
+        {
+            map[v] = weights.size();
+            map[matches[v]] = weights.size();
+            weights.push_back(graph.weights[v] + (matches[v] != v ? graph.weights[matches[v]] : 0));
+        }
+    }
+
+    std::vector<std::tuple<uint32_t, uint32_t, uint64_t>> edges;
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e)
+        {
+            uint32_t u = graph.neighbors[e];
+            if (v < u && map[v] != map[u])
+            {
+                edges.emplace_back(map[v], map[u], graph.edgeWeights[e]);
+            }
+        }
+    }
+    return BuildGraph(std::move(weights), edges);
+}
+
+std::vector<uint32_t>
+PartitionHelper::Grow(const Graph& graph, uint32_t seed) const
+{
+    uint32_t n = graph.weights.size();
+    std::vector<uint32_t> parts(n, NONE);
+    uint64_t remaining = std::accumulate(graph.weights.begin(), graph.weights.end(), uint64_t(0));
+
+    // The candidates, by weight of their edges to the partition being grown.
+    std::set<std::pair<uint64_t, uint32_t>> frontier;
+    std::vector<uint64_t> connections(n, 0);
+    std::vector<uint32_t> candidates;
+    uint32_t next = seed;
+    for (uint32_t p = 0; p + 1 < m_partitions; ++p)
+    {
+        // Spread the weight left over by the previous partitions.
+        uint64_t target = remaining / (m_partitions - p);
+        uint64_t weight = 0;
+        while (weight < target)
+        {
+            if (frontier.empty())
+            {
+                // Start from the next unassigned vertex, e.g. in another component.
+                uint32_t i = 0;
+                while (i < n && parts[next] != NONE)
+                {
+                    next = (next + 1) % n;
+                    ++i;
+                }
+                if (i == n)
+                {
+                    break;
+                }
+                frontier.emplace(0, next);
+                candidates.push_back(next);
+            }
+            uint32_t v = std::prev(frontier.end())->second;
+            frontier.erase(std::prev(frontier.end()));
+            parts[v] = p;
+            weight += graph.weights[v];
+            for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e)
+            {
+                uint32_t u = graph.neighbors[e];
+                if (parts[u] != NONE)
+                {
+                    continue;
+                }
+                if (!frontier.erase({connections[u], u}))
+                {
+                    candidates.push_back(u);
+                }
+                connections[u] += graph.edgeWeights[e];
+                frontier.emplace(connections[u], u);
+            }
+        }
+        remaining -= weight;
+        frontier.clear();
+        for (uint32_t u : candidates)
+        {
+            connections[u] = 0;
+        }
+        candidates.clear();
+    }
+    for (uint32_t& part : parts)
+    {
+        if (part == NONE)
+        {
+            part = m_partitions - 1;
+        }
+    }
+    return parts;
+}
+
+void
+PartitionHelper::Refine(const Graph& graph, std::vector<uint32_t>& parts) const
+{
+    uint32_t n = graph.weights.size();
+    std::vector<uint64_t> partWeights(m_partitions, 0);
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        partWeights[parts[v]] += graph.weights[v];
+    }
+
+    std::vector<uint64_t> connections(m_partitions, 0);
+    std::vector<uint32_t> touched;
+    for (uint32_t pass = 0; pass < MAX_REFINE_PASSES; ++pass)
+    {
+        uint32_t moves = 0;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            uint32_t own = parts[v];
+            uint64_t weight = graph.weights[v];
+            bool boundary = false;
+            for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e)
+            {
+                uint32_t p = parts[graph.neighbors[e]];
+                if (connections[p] == 0)
+                {
+                    touched.push_back(p);
+                }
+                connections[p] += graph.edgeWeights[e];
+                boundary |= p != own;
+            }
+            bool overweight = partWeights[own] > m_maxPartWeight;
+            if (boundary || overweight)
+            {
+                // Move to the adjacent partition with the best gain, if it has room.
+                uint32_t best = own;
+                int64_t bestGain = std::numeric_limits<int64_t>::min();
+                for (uint32_t p : touched)
+                {
+                    if (p == own || partWeights[p] + weight > m_maxPartWeight)
+                    {
+                        continue;
+                    }
+                    int64_t gain = int64_t(connections[p]) - int64_t(connections[own]);
+                    if (gain > bestGain || (gain == bestGain && partWeights[p] < partWeights[best]))
+                    {
+                        best = p;
+                        bestGain = gain;
+                    }
+                }
+                if (overweight && best == own)
+                {
+                    // Restore the balance, whatever the cost.
+                    for (uint32_t p = 0; p < m_partitions; ++p)
+                    {
+                        if (p != own && partWeights[p] + weight <= m_maxPartWeight &&
+                            (best == own || partWeights[p] < partWeights[best]))
+                        {
+                            best = p;
+                        }
+                    }
+                }
+                if (best != own &&
+                    (overweight || bestGain > 0 ||
+                     (bestGain == 0 && partWeights[best] + weight < partWeights[own])))
+                {
+                    parts[v] = best;
+                    partWeights[own] -= weight;
+                    partWeights[best] += weight;
+                    ++moves;
+                }
+            }
+            for (uint32_t p : touched)
+            {
+                connections[p] = 0;
+            }
+            touched.clear();
+        }
+        if (moves == 0)
+        {
+            break;
+        }
+    }
+}
+
+uint64_t
+PartitionHelper::GetCut(const Graph& graph, const std::vector<uint32_t>& parts)
+{
+    uint64_t cut = 0;
+    for (uint32_t v = 0; v < graph.weights.size(); ++v)
+    {
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e)
+        {
+            if (parts[v] != parts[graph.neighbors[e]])
+            {
+                cut += graph.edgeWeights[e];
+            }
+        }
+    }
+    return cut / 2;
+}
+
+void
+PartitionHelper::Compute()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t n = m_nodeIds.size();
+    m_partition.clear();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Merge the nodes joined by links which cannot be cut.
+    std::vector<uint32_t> parents(n);
+    std::iota(parents.begin(), parents.end(), 0);
+    int64_t maxDelay = 0;
+    for (const Link& link : m_links)
+    {
+        if (IsCuttable(link.delay))
+        {
+            maxDelay = std::max(maxDelay, link.delay.GetTimeStep());
+        }
+        else
+        {
+            parents[FindRoot(parents, m_nodes[link.a])] = FindRoot(parents, m_nodes[link.b]);
+        }
+    }
+    std::vector<uint32_t> groups(n, NONE);
+    std::vector<uint64_t> weights;
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        uint32_t root = FindRoot(parents, v);
+        if (groups[root] == NONE)
+        {
+            groups[root] = weights.size();
+            weights.push_back(0);
+        }
+        groups[v] = groups[root];
+        weights[groups[v]] += m_weights[v];
+    }
+    NS_ABORT_MSG_IF(weights.size() < m_partitions,
+                    "Only " << weights.size() << " groups of nodes for " << m_partitions
+                            << " partitions");
+
+    // Shorter links cost more to cut, since they shorten the time window.
+    std::vector<std::tuple<uint32_t, uint32_t, uint64_t>> edges;
+    for (const Link& link : m_links)
+    {
+        uint32_t a = groups[m_nodes[link.a]];
+        uint32_t b = groups[m_nodes[link.b]];
+        if (a != b)
+        {
+            int64_t delay = link.delay.GetTimeStep();
+            uint64_t weight = std::min<uint64_t>((maxDelay + delay - 1) / delay, MAX_EDGE_WEIGHT);
+            edges.emplace_back(a, b, weight);
+        }
+    }
+
+    uint64_t total = std::accumulate(weights.begin(), weights.end(), uint64_t(0));
+    uint64_t heaviest = *std::max_element(weights.begin(), weights.end());
+    auto limit = static_cast<uint64_t>(std::ceil(m_imbalance * total / m_partitions));
+    m_maxPartWeight = std::max(limit, heaviest);
+
+    // Coarsen the graph until it is small enough, or cannot shrink any more.
+    std::vector<Graph> graphs;
+    std::vector<std::vector<uint32_t>> maps;
+    graphs.push_back(BuildGraph(std::move(weights), edges));
+    uint32_t coarsest = COARSEST_VERTICES_PER_PARTITION * m_partitions;
+    uint64_t maxWeight = std::max<uint64_t>(3 * total / (2 * coarsest), 1);
+    while (graphs.back().weights.size() > coarsest)
+    {
+        std::vector<uint32_t> map;
+        Graph coarse = Coarsen(graphs.back(), maxWeight, map);
+        if (coarse.weights.size() > 0.95 * graphs.back().weights.size())
+        {
+            break;
+        }
+        graphs.push_back(std::move(coarse));
+        maps.push_back(std::move(map));
+    }
+    NS_LOG_LOGIC("Coarsened " << graphs.front().weights.size() << " vertices into "
+                              << graphs.back().weights.size() << " in " << maps.size()
+                              << " levels");
+
+    // Split the coarsest graph from several seeds, and keep the best split.
+    const Graph& graph = graphs.back();
+    uint32_t tries = std::min<uint32_t>(INITIAL_PARTITION_TRIES, graph.weights.size());
+    std::vector<uint32_t> parts;
+    uint64_t bestExcess = 0;
+    uint64_t bestCut = 0;
+    for (uint32_t i = 0; i < tries; ++i)
+    {
+        std::vector<uint32_t> candidate = Grow(graph, i * graph.weights.size() / tries);
+        Refine(graph, candidate);
+        std::vector<uint64_t> partWeights(m_partitions, 0);
+        for (uint32_t v = 0; v < candidate.size(); ++v)
+        {
+            partWeights[candidate[v]] += graph.weights[v];
+        }
+        uint64_t excess = 0;
+        for (uint64_t weight : partWeights)
+        {
+            excess += weight > m_maxPartWeight ? weight - m_maxPartWeight : 0;
+        }
+        uint64_t cut = GetCut(graph, candidate);
+        if (parts.empty() || excess < bestExcess || (excess == bestExcess && cut < bestCut))
+        {
+            parts = std::move(candidate);
+            bestExcess = excess;
+            bestCut = cut;
+        }
+    }
+
+    // Project the partition back to the finer graphs, refining it at each level.
+    for (std::size_t level = maps.size(); level > 0; --level)
+    {
+        const std::vector<uint32_t>& map = maps[level - 1];
+        std::vector<uint32_t> finer(map.size());
+        for (uint32_t v = 0; v < map.size(); ++v)
+        {
+            finer[v] = parts[map[v]];
+        }
+        Refine(graphs[level - 1], finer);
+        parts = std::move(finer);
+    }
+
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        m_partition[m_nodeIds[v]] = parts[groups[v]];
+    }
+    NS_LOG_INFO("Partitioned " << n << " nodes into " << m_partitions << " partitions, cutting "
+                               << GetEdgeCut() << " links, lookahead " << GetLookahead());
+}
+
+uint32_t
+PartitionHelper::GetPartition(Ptr<Node> node) const
+{
+    auto it = m_partition.find(node->GetId());
+    NS_ABORT_MSG_IF(it == m_partition.end(), "No partition for node " << node->GetId());
+    return it->second;
+}
+
+bool
+PartitionHelper::IsCut(const Link& link) const
+{
+    auto a = m_partition.find(link.a);
+    auto b = m_partition.find(link.b);
+    return a != m_partition.end() && b != m_partition.end() && a->second != b->second;
+}
+
+uint32_t
+PartitionHelper::GetEdgeCut() const
+{
+    uint32_t cut = 0;
+    for (const Link& link : m_links)
+    {
+        if (IsCut(link))
+        {
+            ++cut;
+        }
+    }
+    return cut;
+}
+
+Time
+PartitionHelper::GetLookahead() const
+{
+    Time lookahead = Time::Max();
+    for (const Link& link : m_links)
+    {
+        if (IsCut(link))
+        {
+            lookahead = std::min(lookahead, link.delay);
+        }
+    }
+    return lookahead;
+}
+
+void
+PartitionHelper::Assign() const
+{
+    NS_LOG_FUNCTION(this);
+    for (const auto& [id, part] : m_partition)
+    {
+        NS_ABORT_MSG_IF(id >= NodeList::GetNNodes(), "No node " << id << " in the simulation");
+        NodeList::GetNode(id)->SetAttribute("SystemId", UintegerValue(part));
+    }
+}
+
+void
+PartitionHelper::WritePartitionMap(const std::string& filename) const
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ofstream file(filename);
+    NS_ABORT_MSG_UNLESS(file.is_open(), "Cannot open partition map " << filename);
+    for (const auto& [id, part] : m_partition)
+    {
+        file << id << " " << part << "\n";
+    }
+}
+
+void
+PartitionHelper::ReadPartitionMap(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ifstream file(filename);
+    NS_ABORT_MSG_UNLESS(file.is_open(), "Cannot open partition map " << filename);
+    m_partition.clear();
+    uint32_t id;
+    uint32_t part;
+    while (file >> id >> part)
+    {
+        m_partition[id] = part;
+    }
+    NS_ABORT_MSG_UNLESS(file.eof(), "Malformed partition map " << filename);
+}
+
+} // namespace ns3
@@ -0,0 +1,237 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::PartitionHelper.
+ */
+
+#ifndef NS3_PARTITION_HELPER_H
+#define NS3_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Computes the system id of each node of a distributed simulation.
+ *
+ * The topology is described as a graph whose vertices are the nodes
+ * and whose edges are the links between them, with their delays.  The
+ * helper splits it into balanced partitions, one per rank, cutting as
+ * few links as it can and preferring the links with the longest
+ * delays, since the shortest delay of a cut link bounds the time
+ * window of the distributed simulator.  Links shorter than the minimum
+ * lookahead, links without delay and the links of channels other than
+ * point-to-point ones are never cut.
+ *
+ * The partitioning is multilevel: the graph is coarsened by merging
+ * the vertices joined by the heaviest edges, the coarsest graph is
+ * split by growing the partitions from seed vertices, and the
+ * partition is projected back level by level, moving the vertices on
+ * the boundaries between partitions to reduce the cut.  It is
+ * deterministic, so every rank computes the same partition from the
+ * same description.
+ *
+ * The system ids must be set before the point-to-point devices are
+ * installed, since the helper installing them decides which channels
+ * are remote.  The links are therefore either described with AddLink()
+ * before installing the devices, and the partition applied with
+ * Assign(), or collected from a complete topology with AddChannels()
+ * and saved with WritePartitionMap(), to be loaded with
+ * ReadPartitionMap() and applied on the next run:
+ *
+ * \code
+ *   PartitionHelper partition;
+ *   partition.SetPartitionCount(MpiInterface::GetSize());
+ *   partition.Add(nodes);
+ *   partition.AddLink(nodes.Get(0), nodes.Get(1), MicroSeconds(5));
+ *   ...
+ *   partition.Compute();
+ *   partition.Assign();
+ *   // install the devices and the applications
+ * \endcode
+ */
+class PartitionHelper
+{
+  public:
+    PartitionHelper();
+
+    /**
+     * Set the number of partitions, usually the number of ranks.
+     * \param [in] partitions The number of partitions.
+     */
+    void SetPartitionCount(uint32_t partitions);
+    /**
+     * Set the allowed imbalance: the weight of a partition may exceed
+     * the average by this factor.
+     * \param [in] imbalance The imbalance factor, at least 1.
+     */
+    void SetImbalance(double imbalance);
+    /**
+     * Set the minimum lookahead: links with a shorter delay are not cut.
+     * \param [in] lookahead The minimum lookahead.
+     */
+    void SetMinLookahead(Time lookahead);
+
+    /**
+     * Add nodes to the graph, with a weight of 1.
+     * \param [in] nodes The nodes.
+     */
+    void Add(NodeContainer nodes);
+    /**
+     * Set the weight of a node, e.g. its expected share of the events.
+     * \param [in] node The node, which is added to the graph.
+     * \param [in] weight The weight.
+     */
+    void SetNodeWeight(Ptr<Node> node, uint32_t weight);
+    /**
+     * Add a link between two nodes, which are added to the graph.
+     * \param [in] a The first node.
+     * \param [in] b The second node.
+     * \param [in] delay The delay of the link.
+     */
+    void AddLink(Ptr<Node> a, Ptr<Node> b, Time delay);
+    /**
+     * Add nodes to the graph, with the links of the channels their
+     * devices are attached to.  The delay of a point-to-point channel
+     * is its "Delay" attribute.
+     * \param [in] nodes The nodes.
+     */
+    void AddChannels(NodeContainer nodes);
+
+    /** Compute the partition of the nodes of the graph. */
+    void Compute();
+
+    /**
+     * \param [in] node The node.
+     * \returns The partition of the node.
+     */
+    uint32_t GetPartition(Ptr<Node> node) const;
+    /** \returns The number of links cut by the partition. */
+    uint32_t GetEdgeCut() const;
+    /** \returns The shortest delay of a cut link, or Time::Max() if none. */
+    Time GetLookahead() const;
+
+    /** Set the system id of the nodes to their partition. */
+    void Assign() const;
+    /**
+     * Write the partition to a file, one line per node, holding the node
+     * id and the partition.
+     * \param [in] filename The file name.
+     */
+    void WritePartitionMap(const std::string& filename) const;
+    /**
+     * Read the partition from a file written by WritePartitionMap().
+     * \param [in] filename The file name.
+     */
+    void ReadPartitionMap(const std::string& filename);
+
+  private:
+    /** A graph in compressed sparse row form. */
+    struct Graph
+    {
+        std::vector<uint64_t> weights;     //!< The vertex weights.
+        std::vector<uint32_t> offsets;     //!< The first edge of each vertex, and the end.
+        std::vector<uint32_t> neighbors;   //!< The vertex at the end of each edge.
+        std::vector<uint64_t> edgeWeights; //!< The edge weights.
+    };
+
+    /** A link between two nodes. */
+    struct Link
+    {
+        uint32_t a; //!< The id of the first node.
+        uint32_t b; //!< The id of the second node.
+        Time delay; //!< The delay.
+    };
+
+    /**
+     * Add a node to the graph.
+     * \param [in] node The node.
+     */
+    void AddNode(Ptr<Node> node);
+    /**
+     * \param [in] delay The delay of a link.
+     * \returns Whether the link may be cut.
+     */
+    bool IsCuttable(Time delay) const;
+    /**
+     * \param [in] link A link.
+     * \returns Whether the partition separates the nodes of the link.
+     */
+    bool IsCut(const Link& link) const;
+
+    /**
+     * Build a graph from a list of edges, merging the parallel edges.
+     * \param [in] weights The vertex weights.
+     * \param [in,out] edges The edges, as (vertex, vertex, weight).
+     * \returns The graph.
+     */
+    static Graph BuildGraph(std::vector<uint64_t> weights,
+                            std::vector<std::tuple<uint32_t, uint32_t, uint64_t>>& edges);
+    /**
+     * Coarsen a graph by merging the vertices of a heavy edge matching.
+     * \param [in] graph The graph.
+     * \param [in] maxWeight The maximum weight of a merged vertex.
+     * \param [out] map The vertex of the coarse graph of each vertex.
+     * \returns The coarse graph.
+     */
+    static Graph Coarsen(const Graph& graph, uint64_t maxWeight, std::vector<uint32_t>& map);
+    /**
+     * Split a graph by growing the partitions from a seed vertex.
+     * \param [in] graph The graph.
+     * \param [in] seed The first seed vertex.
+     * \returns The partition of each vertex.
+     */
+    std::vector<uint32_t> Grow(const Graph& graph, uint32_t seed) const;
+    /**
+     * Move the vertices on the boundaries to reduce the cut and restore
+     * the balance.
+     * \param [in] graph The graph.
+     * \param [in,out] parts The partition of each vertex.
+     */
+    void Refine(const Graph& graph, std::vector<uint32_t>& parts) const;
+    /**
+     * \param [in] graph The graph.
+     * \param [in] parts The partition of each vertex.
+     * \returns The total weight of the cut edges.
+     */
+    static uint64_t GetCut(const Graph& graph, const std::vector<uint32_t>& parts);
+
+    uint32_t m_partitions;                    //!< The number of partitions.
+    double m_imbalance;                       //!< The allowed imbalance.
+    Time m_minLookahead;                      //!< The minimum lookahead.
+    uint64_t m_maxPartWeight;                 //!< The maximum weight of a partition.
+    std::map<uint32_t, uint32_t> m_nodes;     //!< The vertex of each node id.
+    std::vector<uint32_t> m_nodeIds;          //!< The node id of each vertex.
+    std::vector<uint64_t> m_weights;          //!< The weight of each vertex.
+    std::vector<Link> m_links;                //!< The links.
+    std::map<uint32_t, uint32_t> m_partition; //!< The partition of each node id.
+};
+
+} // namespace ns3
+
+#endif /* NS3_PARTITION_HELPER_H */
@@ -255,7 +255,7 @@ DistributedSimulatorImpl::CalculateLookAhead()
         sendbuf = m_lookAhead.GetInteger();
     }
 
-    MPI_Allreduce(&sendbuf, &recvbuf, 1, MPI_LONG, MPI_MAX, MpiInterface::GetCommunicator());
+    recvbuf = GrantedTimeWindowMpiInterface::AllReduceMax(sendbuf);
 
     /* For nodes that did not compute a lookahead use max from ranks
      * that did compute a value.  An edge case occurs if all nodes have
@@ -377,7 +377,9 @@ DistributedSimulatorImpl::Run()
         if (nextTime > m_grantedTime || IsLocalFinished())
         {
             // Can't process next event, calculate a new LBTS
-            // First receive any pending messages
+            // First send the packets batched in this window
+            GrantedTimeWindowMpiInterface::FlushSendBuffers();
+            // Then receive any pending messages
             GrantedTimeWindowMpiInterface::ReceiveMessages();
             // reset next time
             nextTime = Next();
@@ -390,13 +392,7 @@ DistributedSimulatorImpl::Run()
                              IsLocalFinished(),
                              nextTime);
             m_pLBTS[m_myId] = lMsg;
-            MPI_Allgather(&lMsg,
-                          sizeof(LbtsMessage),
-                          MPI_BYTE,
-                          m_pLBTS,
-                          sizeof(LbtsMessage),
-                          MPI_BYTE,
-                          MpiInterface::GetCommunicator());
+            GrantedTimeWindowMpiInterface::AllGather(&lMsg, sizeof(LbtsMessage), m_pLBTS);
             Time smallestTime = m_pLBTS[0].GetSmallestTime();
             // The totRx and totTx counts insure there are no transient
             // messages;  If totRx != totTx, there are transients,
@@ -18,7 +18,7 @@
 /**
  * \file
  * \ingroup mpi
- * Implementation of classes ns3::SentBuffer and ns3::GrantedTimeWindowMpiInterface.
+ * Implementation of class ns3::GrantedTimeWindowMpiInterface.
  */
 
 // This object contains static methods that provide an easy interface
@@ -28,6 +28,7 @@
 
 #include "mpi-interface.h"
 #include "mpi-receiver.h"
+#include "shared-memory-transport.h"
 
 #include "ns3/log.h"
 #include "ns3/net-device.h"
@@ -37,10 +38,11 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
-#include <list>
 #include <mpi.h>
+#include <vector>
 
 namespace ns3
 {
@@ -49,47 +51,75 @@ NS_LOG_COMPONENT_DEFINE("GrantedTimeWindowMpiInterface");
 
 NS_OBJECT_ENSURE_REGISTERED(GrantedTimeWindowMpiInterface);
 
-SentBuffer::SentBuffer()
+namespace
 {
-    m_buffer = nullptr;
-    m_request = nullptr;
-}
 
-SentBuffer::~SentBuffer()
+/** Header of a packet record in an MPI message. */
+struct PacketRecordHeader
 {
-    delete[] m_buffer;
-}
+    uint64_t time; //!< The receive time.
+    uint32_t node; //!< The destination node.
+    uint32_t dev;  //!< The destination device.
+    uint32_t size; //!< The serialized packet size.
+    uint32_t pad;  //!< Padding to keep the packet 8-byte aligned.
+};
 
-uint8_t*
-SentBuffer::GetBuffer()
+/**
+ * Schedule the reception of a packet record.
+ * \param [in] record The record.
+ * \returns The record size.
+ */
+uint32_t
+ReceivePacketRecord(const uint8_t* record)
 {
-    return m_buffer;
-}
+    // Get the meta data first
+    auto header = reinterpret_cast<const PacketRecordHeader*>(record);
+    Time rxTime(header->time);
+    uint32_t dev = header->dev;
+
+    Ptr<Packet> p = Create<Packet>(record + sizeof(PacketRecordHeader), header->size, true);
+
+    // Find the correct node/device to schedule receive event
+    Ptr<Node> pNode = NodeList::GetNode(header->node);
+    Ptr<MpiReceiver> pMpiRec = nullptr;
+    uint32_t nDevices = pNode->GetNDevices();
+    for (uint32_t i = 0; i < nDevices; ++i)
+    {
+        Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
+        if (pThisDev->GetIfIndex() == dev)
+        {
+            pMpiRec = pThisDev->GetObject<MpiReceiver>();
+            break;
+        }
+    }
 
-void
-SentBuffer::SetBuffer(uint8_t* buffer)
-{
-    m_buffer = buffer;
-}
+    NS_ASSERT(pNode && pMpiRec);
 
-MPI_Request*
-SentBuffer::GetRequest()
-{
-    return &m_request;
+    // Schedule the rx event
+    Simulator::ScheduleWithContext(pNode->GetId(),
+                                   rxTime - Simulator::Now(),
+                                   &MpiReceiver::Receive,
+                                   pMpiRec,
+                                   p);
+
+    return sizeof(PacketRecordHeader) + header->size;
 }
 
+} // unnamed namespace
+
 uint32_t GrantedTimeWindowMpiInterface::g_sid = 0;
 uint32_t GrantedTimeWindowMpiInterface::g_size = 1;
 bool GrantedTimeWindowMpiInterface::g_enabled = false;
 bool GrantedTimeWindowMpiInterface::g_mpiInitCalled = false;
 uint32_t GrantedTimeWindowMpiInterface::g_rxCount = 0;
 uint32_t GrantedTimeWindowMpiInterface::g_txCount = 0;
-std::list<SentBuffer> GrantedTimeWindowMpiInterface::g_pendingTx;
+MpiSendBatcher GrantedTimeWindowMpiInterface::g_sendBatcher;
 
 MPI_Request* GrantedTimeWindowMpiInterface::g_requests;
 char** GrantedTimeWindowMpiInterface::g_pRxBuffers;
 MPI_Comm GrantedTimeWindowMpiInterface::g_communicator = MPI_COMM_WORLD;
 bool GrantedTimeWindowMpiInterface::g_freeCommunicator = false;
+bool GrantedTimeWindowMpiInterface::g_sharedMemory = false;
 ;
 
 TypeId
@@ -105,14 +135,17 @@ GrantedTimeWindowMpiInterface::Destroy()
 {
     NS_LOG_FUNCTION(this);
 
-    for (uint32_t i = 0; i < GetSize(); ++i)
+    if (!g_sharedMemory)
     {
-        delete[] g_pRxBuffers[i];
+        for (uint32_t i = 0; i < GetSize(); ++i)
+        {
+            delete[] g_pRxBuffers[i];
+        }
+        delete[] g_pRxBuffers;
+        delete[] g_requests;
     }
-    delete[] g_pRxBuffers;
-    delete[] g_requests;
 
-    g_pendingTx.clear();
+    g_sendBatcher.Cancel();
 }
 
 uint32_t
@@ -193,6 +226,7 @@ GrantedTimeWindowMpiInterface::Enable(MPI_Comm communicator)
     g_size = mpiSize;
 
     g_enabled = true;
+    g_sendBatcher.Initialize(g_communicator, g_size);
     // Post a non-blocking receive for all peers
     g_pRxBuffers = new char*[g_size];
     g_requests = new MPI_Request[g_size];
@@ -209,6 +243,21 @@ GrantedTimeWindowMpiInterface::Enable(MPI_Comm communicator)
     }
 }
 
+void
+GrantedTimeWindowMpiInterface::EnableSharedMemory(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+
+    NS_ASSERT(g_enabled == false);
+
+    SharedMemoryTransport::Enable(size);
+    g_sid = SharedMemoryTransport::GetSystemId();
+    g_size = SharedMemoryTransport::GetSize();
+    g_communicator = MPI_COMM_NULL;
+    g_sharedMemory = true;
+    g_enabled = true;
+}
+
 void
 GrantedTimeWindowMpiInterface::SendPacket(Ptr<Packet> p,
                                           const Time& rxTime,
@@ -217,34 +266,27 @@ GrantedTimeWindowMpiInterface::SendPacket(Ptr<Packet> p,
 {
     NS_LOG_FUNCTION(this << p << rxTime.GetTimeStep() << node << dev);
 
-    SentBuffer sendBuf;
-    g_pendingTx.push_back(sendBuf);
-    std::list<SentBuffer>::reverse_iterator i = g_pendingTx.rbegin(); // Points to the last element
-
-    uint32_t serializedSize = p->GetSerializedSize();
-    uint8_t* buffer = new uint8_t[serializedSize + 16];
-    i->SetBuffer(buffer);
-    // Add the time, dest node and dest device
-    uint64_t t = rxTime.GetInteger();
-    uint64_t* pTime = reinterpret_cast<uint64_t*>(buffer);
-    *pTime++ = t;
-    uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-    *pData++ = node;
-    *pData++ = dev;
-    // Serialize the packet
-    p->Serialize(reinterpret_cast<uint8_t*>(pData), serializedSize);
-
     // Find the system id for the destination node
     Ptr<Node> destNode = NodeList::GetNode(node);
     uint32_t nodeSysId = destNode->GetSystemId();
 
-    MPI_Isend(reinterpret_cast<void*>(i->GetBuffer()),
-              serializedSize + 16,
-              MPI_CHAR,
-              nodeSysId,
-              0,
-              g_communicator,
-              (i->GetRequest()));
+    // Append the time, dest node, dest device and packet to the message
+    uint32_t serializedSize = p->GetSerializedSize();
+    uint32_t recordSize = sizeof(PacketRecordHeader) + serializedSize;
+    uint8_t* buffer = g_sharedMemory ? SharedMemoryTransport::Reserve(nodeSysId, recordSize)
+                                     : g_sendBatcher.Reserve(nodeSysId, recordSize);
+    auto header = reinterpret_cast<PacketRecordHeader*>(buffer);
+    header->time = rxTime.GetInteger();
+    header->node = node;
+    header->dev = dev;
+    header->size = serializedSize;
+    header->pad = 0;
+    // Serialize the packet
+    p->Serialize(buffer + sizeof(PacketRecordHeader), serializedSize);
+    if (g_sharedMemory)
+    {
+        SharedMemoryTransport::Commit(nodeSysId);
+    }
     g_txCount++;
 }
 
@@ -253,6 +295,19 @@ GrantedTimeWindowMpiInterface::ReceiveMessages()
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    if (g_sharedMemory)
+    {
+        uint32_t rank;
+        uint32_t size;
+        while (const uint8_t* record = SharedMemoryTransport::Peek(rank, size))
+        {
+            g_rxCount++; // Count this receive
+            ReceivePacketRecord(record);
+            SharedMemoryTransport::Pop();
+        }
+        return;
+    }
+
     // Poll the non-block reads to see if data arrived
     while (true)
     {
@@ -267,44 +322,16 @@ GrantedTimeWindowMpiInterface::ReceiveMessages()
         }
         int count;
         MPI_Get_count(&status, MPI_CHAR, &count);
-        g_rxCount++; // Count this receive
-
-        // Get the meta data first
-        uint64_t* pTime = reinterpret_cast<uint64_t*>(g_pRxBuffers[index]);
-        uint64_t time = *pTime++;
-        uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-        uint32_t node = *pData++;
-        uint32_t dev = *pData++;
-
-        Time rxTime(time);
-
-        count -= sizeof(time) + sizeof(node) + sizeof(dev);
-
-        Ptr<Packet> p = Create<Packet>(reinterpret_cast<uint8_t*>(pData), count, true);
 
-        // Find the correct node/device to schedule receive event
-        Ptr<Node> pNode = NodeList::GetNode(node);
-        Ptr<MpiReceiver> pMpiRec = nullptr;
-        uint32_t nDevices = pNode->GetNDevices();
-        for (uint32_t i = 0; i < nDevices; ++i)
+        // Process each packet record of the message
+        uint8_t* buffer = reinterpret_cast<uint8_t*>(g_pRxBuffers[index]);
+        uint8_t* end = buffer + count;
+        while (buffer < end)
         {
-            Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
-            if (pThisDev->GetIfIndex() == dev)
-            {
-                pMpiRec = pThisDev->GetObject<MpiReceiver>();
-                break;
-            }
+            g_rxCount++; // Count this receive
+            buffer += MpiSendBatcher::GetRecordSize(ReceivePacketRecord(buffer));
         }
 
-        NS_ASSERT(pNode && pMpiRec);
-
-        // Schedule the rx event
-        Simulator::ScheduleWithContext(pNode->GetId(),
-                                       rxTime - Simulator::Now(),
-                                       &MpiReceiver::Receive,
-                                       pMpiRec,
-                                       p);
-
         // Re-queue the next read
         MPI_Irecv(g_pRxBuffers[index],
                   MAX_MPI_MSG_SIZE,
@@ -316,24 +343,49 @@ GrantedTimeWindowMpiInterface::ReceiveMessages()
     }
 }
 
+void
+GrantedTimeWindowMpiInterface::FlushSendBuffers()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    g_sendBatcher.FlushAll();
+}
+
 void
 GrantedTimeWindowMpiInterface::TestSendComplete()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    std::list<SentBuffer>::iterator i = g_pendingTx.begin();
-    while (i != g_pendingTx.end())
+    g_sendBatcher.TestSendComplete();
+}
+
+void
+GrantedTimeWindowMpiInterface::AllGather(const void* send, uint32_t size, void* recv)
+{
+    NS_LOG_FUNCTION(send << size << recv);
+
+    if (g_sharedMemory)
     {
-        MPI_Status status;
-        int flag = 0;
-        MPI_Test(i->GetRequest(), &flag, &status);
-        std::list<SentBuffer>::iterator current = i; // Save current for erasing
-        i++;                                         // Advance to next
-        if (flag)
-        { // This message is complete
-            g_pendingTx.erase(current);
-        }
+        SharedMemoryTransport::AllGather(send, size, recv);
+        return;
     }
+    MPI_Allgather(send, size, MPI_BYTE, recv, size, MPI_BYTE, g_communicator);
+}
+
+int64_t
+GrantedTimeWindowMpiInterface::AllReduceMax(int64_t value)
+{
+    NS_LOG_FUNCTION(value);
+
+    if (g_sharedMemory)
+    {
+        std::vector<int64_t> values(g_size);
+        SharedMemoryTransport::AllGather(&value, sizeof(value), values.data());
+        return *std::max_element(values.begin(), values.end());
+    }
+    int64_t result;
+    MPI_Allreduce(&value, &result, 1, MPI_INT64_T, MPI_MAX, g_communicator);
+    return result;
 }
 
 void
@@ -341,6 +393,12 @@ GrantedTimeWindowMpiInterface::Disable()
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    if (g_sharedMemory)
+    {
+        SharedMemoryTransport::Disable();
+        g_sharedMemory = false;
+    }
+
     if (g_freeCommunicator)
     {
         MPI_Comm_free(&g_communicator);
@@ -18,7 +18,7 @@
 /**
  * \file
  * \ingroup mpi
- * Declaration of classes ns3::SentBuffer and ns3::GrantedTimeWindowMpiInterface.
+ * Declaration of class ns3::GrantedTimeWindowMpiInterface.
  */
 
 // This object contains static methods that provide an easy interface
@@ -27,56 +27,18 @@
 #ifndef NS3_GRANTED_TIME_WINDOW_MPI_INTERFACE_H
 #define NS3_GRANTED_TIME_WINDOW_MPI_INTERFACE_H
 
+#include "mpi-send-batcher.h"
 #include "parallel-communication-interface.h"
 
 #include "ns3/buffer.h"
 #include "ns3/nstime.h"
 
-#include <list>
 #include <mpi.h>
 #include <stdint.h>
 
 namespace ns3
 {
 
-/**
- * maximum MPI message size for easy
- * buffer creation
- */
-const uint32_t MAX_MPI_MSG_SIZE = 2000;
-
-/**
- * \ingroup mpi
- *
- * \brief Tracks non-blocking sends
- *
- * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
- */
-class SentBuffer
-{
-  public:
-    SentBuffer();
-    ~SentBuffer();
-
-    /**
-     * \return pointer to sent buffer
-     */
-    uint8_t* GetBuffer();
-    /**
-     * \param buffer pointer to sent buffer
-     */
-    void SetBuffer(uint8_t* buffer);
-    /**
-     * \return MPI request
-     */
-    MPI_Request* GetRequest();
-
-  private:
-    uint8_t* m_buffer;     /**< The buffer. */
-    MPI_Request m_request; /**< The MPI request handle. */
-};
-
 class Packet;
 class DistributedSimulatorImpl;
 
@@ -88,6 +50,11 @@ class DistributedSimulatorImpl;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * The packets sent to a task during a time window are batched into a
+ * few MPI messages, which are sent when full or when the window ends.
+ * When the tasks are local processes sharing memory, each packet is
+ * written directly to the shared memory ring of its task instead.
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -105,6 +72,7 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
     bool IsEnabled() override;
     void Enable(int* pargc, char*** pargv) override;
     void Enable(MPI_Comm communicator) override;
+    void EnableSharedMemory(uint32_t size) override;
     void Disable() override;
     void SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev) override;
     MPI_Comm GetCommunicator() override;
@@ -122,6 +90,10 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
      * Check for received messages complete
      */
     static void ReceiveMessages();
+    /**
+     * Send the packets batched since the last call
+     */
+    static void FlushSendBuffers();
     /**
      * Check for completed sends
      */
@@ -134,6 +106,18 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
      * \return transmitted count in packets
      */
     static uint32_t GetTxCount();
+    /**
+     * Gather a block of bytes from every task
+     * \param send block of this task
+     * \param size block size, in bytes
+     * \param recv blocks of all the tasks, in system id order
+     */
+    static void AllGather(const void* send, uint32_t size, void* recv);
+    /**
+     * \param value value of this task
+     * \return maximum value over all the tasks
+     */
+    static int64_t AllReduceMax(int64_t value);
 
     /** System ID (rank) for this task. */
     static uint32_t g_sid;
@@ -161,14 +145,17 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
     /** Data buffers for non-blocking reads. */
     static char** g_pRxBuffers;
 
-    /** List of pending non-blocking sends. */
-    static std::list<SentBuffer> g_pendingTx;
+    /** Batches the packets into non-blocking sends. */
+    static MpiSendBatcher g_sendBatcher;
 
     /** MPI communicator being used for ns-3 tasks. */
     static MPI_Comm g_communicator;
 
     /** Did ns-3 create the communicator?  Have to free it. */
     static bool g_freeCommunicator;
+
+    /** Are the tasks local processes communicating through shared memory. */
+    static bool g_sharedMemory;
 };
 
 } // namespace ns3
@@ -135,6 +135,13 @@ MpiInterface::Enable(MPI_Comm communicator)
     g_parallelCommunicationInterface->Enable(communicator);
 }
 
+void
+MpiInterface::EnableSharedMemory(uint32_t size)
+{
+    SetParallelSimulatorImpl();
+    g_parallelCommunicationInterface->EnableSharedMemory(size);
+}
+
 void
 MpiInterface::SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
 {
@@ -125,6 +125,26 @@ class MpiInterface
      * \param communicator MPI Communicator that should be used by ns-3
      */
     static void Enable(MPI_Comm communicator);
+    /**
+     * \brief Setup the parallel communication interface between ranks
+     * running as processes forked on the local host.
+     *
+     * This method forks \pname{size} - 1 processes: each returns from
+     * it and runs the rest of the program as its rank, as it would under
+     * mpiexec.  The ranks communicate through shared memory instead of
+     * MPI, with a lower latency, so the program is run directly rather
+     * than with mpiexec, and MPI is not initialized.  GetCommunicator()
+     * returns MPI_COMM_NULL.
+     *
+     * Disable() must be invoked at the end of the program; rank 0
+     * waits there for the other ranks to exit.
+     *
+     * \note The `SimulatorImplementationType attribute in
+     * ns3::GlobalValues must be set before calling EnableSharedMemory()
+     *
+     * \param size number of ranks
+     */
+    static void EnableSharedMemory(uint32_t size);
     /**
      * \brief Clean up the ns-3 parallel communications interface.
      *
@@ -148,8 +168,9 @@ class MpiInterface
      * \brief Return the communicator used to run ns-3.
      *
      * The communicator returned will be MPI_COMM_WORLD if Enable (int*
-     * pargc, char*** pargv) is used to enable or the user specified
-     * communicator if Enable (MPI_Comm communicator) is used.
+     * pargc, char*** pargv) is used to enable, the user specified
+     * communicator if Enable (MPI_Comm communicator) is used, or
+     * MPI_COMM_NULL if EnableSharedMemory() is used.
      *
      * \return The MPI Communicator.
      */
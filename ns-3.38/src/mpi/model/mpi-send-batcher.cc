@@ -0,0 +1,182 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::MpiSendBatcher.
+ */
+
+#include "mpi-send-batcher.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MpiSendBatcher");
+
+MpiSendBatcher::MpiSendBatcher()
+    : m_communicator(MPI_COMM_WORLD)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MpiSendBatcher::~MpiSendBatcher()
+{
+    // This may run after MPI is finalized: release the buffers only.
+    for (const PendingSend& send : m_sends)
+    {
+        delete[] send.buffer;
+    }
+    for (const Message& message : m_messages)
+    {
+        delete[] message.buffer;
+    }
+    for (uint8_t* buffer : m_pool)
+    {
+        delete[] buffer;
+    }
+}
+
+void
+MpiSendBatcher::Initialize(MPI_Comm communicator, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_communicator = communicator;
+    m_messages.assign(size, Message{nullptr, 0});
+}
+
+uint32_t
+MpiSendBatcher::GetRecordSize(uint32_t size)
+{
+    return (size + 7) & ~7U;
+}
+
+uint8_t*
+MpiSendBatcher::GetBuffer()
+{
+    if (m_pool.empty())
+    {
+        return new uint8_t[MAX_MPI_MSG_SIZE];
+    }
+    uint8_t* buffer = m_pool.back();
+    m_pool.pop_back();
+    return buffer;
+}
+
+uint8_t*
+MpiSendBatcher::Reserve(uint32_t rank, uint32_t size)
+{
+    NS_LOG_FUNCTION(this << rank << size);
+    NS_ASSERT(rank < m_messages.size());
+    uint32_t recordSize = GetRecordSize(size);
+    NS_ABORT_MSG_IF(recordSize > MAX_MPI_MSG_SIZE,
+                    "Record of " << size << " bytes too large for an MPI message");
+    Message& message = m_messages[rank];
+    if (message.size + recordSize > MAX_MPI_MSG_SIZE)
+    {
+        Flush(rank);
+    }
+    if (message.buffer == nullptr)
+    {
+        message.buffer = GetBuffer();
+    }
+    uint8_t* record = message.buffer + message.size;
+    message.size += recordSize;
+    return record;
+}
+
+bool
+MpiSendBatcher::Flush(uint32_t rank)
+{
+    NS_LOG_FUNCTION(this << rank);
+    Message& message = m_messages[rank];
+    if (message.size == 0)
+    {
+        return false;
+    }
+    m_sends.push_back(PendingSend{message.buffer, MPI_REQUEST_NULL});
+    MPI_Isend(message.buffer,
+              message.size,
+              MPI_CHAR,
+              rank,
+              0,
+              m_communicator,
+              &m_sends.back().request);
+    message.buffer = nullptr;
+    message.size = 0;
+    return true;
+}
+
+void
+MpiSendBatcher::FlushAll()
+{
+    NS_LOG_FUNCTION(this);
+    for (uint32_t rank = 0; rank < m_messages.size(); ++rank)
+    {
+        Flush(rank);
+    }
+}
+
+void
+MpiSendBatcher::TestSendComplete()
+{
+    NS_LOG_FUNCTION(this);
+    auto done = m_sends.begin();
+    for (auto it = m_sends.begin(); it != m_sends.end(); ++it)
+    {
+        int flag = 0;
+        MPI_Test(&it->request, &flag, MPI_STATUS_IGNORE);
+        if (flag)
+        {
+            m_pool.push_back(it->buffer);
+        }
+        else
+        {
+            *done++ = *it;
+        }
+    }
+    m_sends.erase(done, m_sends.end());
+}
+
+void
+MpiSendBatcher::Cancel()
+{
+    NS_LOG_FUNCTION(this);
+    for (PendingSend& send : m_sends)
+    {
+        if (send.request != MPI_REQUEST_NULL)
+        {
+            MPI_Cancel(&send.request);
+            MPI_Request_free(&send.request);
+        }
+        m_pool.push_back(send.buffer);
+    }
+    m_sends.clear();
+    for (Message& message : m_messages)
+    {
+        if (message.buffer != nullptr)
+        {
+            m_pool.push_back(message.buffer);
+        }
+        message.buffer = nullptr;
+        message.size = 0;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,128 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::MpiSendBatcher.
+ */
+
+#ifndef NS3_MPI_SEND_BATCHER_H
+#define NS3_MPI_SEND_BATCHER_H
+
+#include <mpi.h>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Maximum MPI message size, which is also the size of the receive
+ * buffers.
+ */
+const uint32_t MAX_MPI_MSG_SIZE = 64 * 1024;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Aggregates the records sent to each rank into large MPI messages.
+ *
+ * Records, typically a packet and its metadata, are appended to the
+ * message being built for their destination rank.  The message is sent
+ * with a single non-blocking send when the next record would not fit in
+ * it, or when Flush() is called, e.g. at the end of a time window.  This
+ * replaces one MPI call and one buffer allocation per packet with one
+ * per message.
+ *
+ * The message buffers are pooled: the buffer of a completed send is
+ * reused for a later message.  Records are aligned on 8 bytes, so that
+ * their fields can be read in place.
+ */
+class MpiSendBatcher
+{
+  public:
+    MpiSendBatcher();
+    /** Release the buffers, without calling MPI. */
+    ~MpiSendBatcher();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    MpiSendBatcher(const MpiSendBatcher&) = delete;
+    MpiSendBatcher& operator=(const MpiSendBatcher&) = delete;
+
+    /**
+     * Set the communicator and the number of ranks.
+     * \param [in] communicator The communicator.
+     * \param [in] size The number of ranks.
+     */
+    void Initialize(MPI_Comm communicator, uint32_t size);
+
+    /**
+     * Get the space taken by a record in a message.
+     * \param [in] size The record size, in bytes.
+     * \returns The size rounded up to the record alignment.
+     */
+    static uint32_t GetRecordSize(uint32_t size);
+
+    /**
+     * Reserve a record in the message to a rank, sending the message
+     * first if the record does not fit in it.
+     * \param [in] rank The destination rank.
+     * \param [in] size The record size, in bytes, at most MAX_MPI_MSG_SIZE.
+     * \returns Where to write the record, before the next call to the batcher.
+     */
+    uint8_t* Reserve(uint32_t rank, uint32_t size);
+
+    /**
+     * Send the message to a rank, if it holds any record.
+     * \param [in] rank The destination rank.
+     * \returns Whether a message was sent.
+     */
+    bool Flush(uint32_t rank);
+    /** Send the messages to all the ranks. */
+    void FlushAll();
+
+    /** Recycle the buffers of the completed sends. */
+    void TestSendComplete();
+    /** Cancel the pending sends, and discard the messages being built. */
+    void Cancel();
+
+  private:
+    /** Get a buffer from the pool, or allocate one. */
+    uint8_t* GetBuffer();
+
+    /** A message being built. */
+    struct Message
+    {
+        uint8_t* buffer; //!< The buffer, or nullptr if none yet.
+        uint32_t size;   //!< The bytes used in the buffer.
+    };
+
+    /** A message being sent. */
+    struct PendingSend
+    {
+        uint8_t* buffer;     //!< The buffer.
+        MPI_Request request; //!< The non-blocking send request.
+    };
+
+    MPI_Comm m_communicator;          //!< The communicator.
+    std::vector<Message> m_messages;  //!< The message being built, per rank.
+    std::vector<PendingSend> m_sends; //!< The messages being sent.
+    std::vector<uint8_t*> m_pool;     //!< The free buffers.
+};
+
+} // namespace ns3
+
+#endif /* NS3_MPI_SEND_BATCHER_H */
@@ -21,7 +21,7 @@
 /**
  * \file
  * \ingroup mpi
- * Implementation of classes ns3::NullMessageSentBuffer and ns3::NullMessageMpiInterface.
+ * Implementation of class ns3::NullMessageMpiInterface.
  */
 
 #include "null-message-mpi-interface.h"
@@ -29,6 +29,7 @@
 #include "null-message-simulator-impl.h"
 #include "remote-channel-bundle-manager.h"
 #include "remote-channel-bundle.h"
+#include "shared-memory-transport.h"
 
 #include "ns3/log.h"
 #include "ns3/mpi-receiver.h"
@@ -40,7 +41,6 @@
 
 #include <iomanip>
 #include <iostream>
-#include <list>
 #include <mpi.h>
 
 namespace ns3
@@ -50,78 +50,71 @@ NS_LOG_COMPONENT_DEFINE("NullMessageMpiInterface");
 
 NS_OBJECT_ENSURE_REGISTERED(NullMessageMpiInterface);
 
-/**
- * \ingroup mpi
- *
- * \brief Non-blocking send buffers for Null Message implementation.
- *
- * One buffer is allocated for each non-blocking send.
- */
-class NullMessageSentBuffer
+namespace
 {
-  public:
-    NullMessageSentBuffer();
-    ~NullMessageSentBuffer();
-
-    /**
-     * \return pointer to sent buffer
-     */
-    uint8_t* GetBuffer();
-    /**
-     * \param buffer pointer to sent buffer
-     */
-    void SetBuffer(uint8_t* buffer);
-    /**
-     * \return MPI request
-     */
-    MPI_Request* GetRequest();
-
-  private:
-    /**
-     * Buffer for send.
-     */
-    uint8_t* m_buffer;
-
-    /**
-     * MPI request posted for the send.
-     */
-    MPI_Request m_request;
+
+/** Header of a packet or Null Message record in an MPI message. */
+struct NullMessageRecordHeader
+{
+    uint64_t time;      //!< The receive time, zero for a Null Message.
+    uint64_t guarantee; //!< The guarantee time of the sender.
+    uint32_t node;      //!< The destination node.
+    uint32_t dev;       //!< The destination device.
+    uint32_t size;      //!< The serialized packet size.
+    uint32_t pad;       //!< Padding to keep the packet 8-byte aligned.
 };
 
 /**
- * maximum MPI message size for easy
- * buffer creation
+ * Schedule the reception of a packet record, and update the guarantee
+ * time of the bundle for both packet and Null Message records.
+ * \param [in] record The record.
+ * \param [in] bundle The bundle from the sending task.
+ * \returns The record size.
  */
-const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
-
-NullMessageSentBuffer::NullMessageSentBuffer()
+uint32_t
+ReceiveRecord(const uint8_t* record, Ptr<RemoteChannelBundle> bundle)
 {
-    m_buffer = nullptr;
-    m_request = nullptr;
-}
+    // Get the meta data first
+    auto header = reinterpret_cast<const NullMessageRecordHeader*>(record);
+    Time rxTime(header->time);
+    uint32_t dev = header->dev;
 
-NullMessageSentBuffer::~NullMessageSentBuffer()
-{
-    delete[] m_buffer;
-}
+    // rxtime == 0 means this is a Null Message
+    if (rxTime > Time(0))
+    {
+        Ptr<Packet> p =
+            Create<Packet>(record + sizeof(NullMessageRecordHeader), header->size, true);
+
+        // Find the correct node/device to schedule receive event
+        Ptr<Node> pNode = NodeList::GetNode(header->node);
+        Ptr<MpiReceiver> pMpiRec = nullptr;
+        uint32_t nDevices = pNode->GetNDevices();
+        for (uint32_t i = 0; i < nDevices; ++i)
+        {
+            Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
+            if (pThisDev->GetIfIndex() == dev)
+            {
+                pMpiRec = pThisDev->GetObject<MpiReceiver>();
+                break;
+            }
+        }
+        NS_ASSERT(pNode && pMpiRec);
+
+        // Schedule the rx event
+        Simulator::ScheduleWithContext(pNode->GetId(),
+                                       rxTime - Simulator::Now(),
+                                       &MpiReceiver::Receive,
+                                       pMpiRec,
+                                       p);
+    }
 
-uint8_t*
-NullMessageSentBuffer::GetBuffer()
-{
-    return m_buffer;
-}
+    // Update guarantee time for both packet receives and Null Messages.
+    bundle->SetGuaranteeTime(Time(header->guarantee));
 
-void
-NullMessageSentBuffer::SetBuffer(uint8_t* buffer)
-{
-    m_buffer = buffer;
+    return sizeof(NullMessageRecordHeader) + header->size;
 }
 
-MPI_Request*
-NullMessageSentBuffer::GetRequest()
-{
-    return &m_request;
-}
+} // unnamed namespace
 
 uint32_t NullMessageMpiInterface::g_sid = 0;
 uint32_t NullMessageMpiInterface::g_size = 1;
@@ -129,10 +122,11 @@ uint32_t NullMessageMpiInterface::g_numNeighbors = 0;
 bool NullMessageMpiInterface::g_enabled = false;
 bool NullMessageMpiInterface::g_mpiInitCalled = false;
 
-std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
+MpiSendBatcher NullMessageMpiInterface::g_sendBatcher;
 
 MPI_Comm NullMessageMpiInterface::g_communicator = MPI_COMM_WORLD;
 bool NullMessageMpiInterface::g_freeCommunicator = false;
+bool NullMessageMpiInterface::g_sharedMemory = false;
 MPI_Request* NullMessageMpiInterface::g_requests;
 char** NullMessageMpiInterface::g_pRxBuffers;
 
@@ -223,10 +217,26 @@ NullMessageMpiInterface::Enable(MPI_Comm communicator)
     g_size = mpiSize;
 
     g_enabled = true;
+    g_sendBatcher.Initialize(g_communicator, g_size);
 
     MPI_Barrier(g_communicator);
 }
 
+void
+NullMessageMpiInterface::EnableSharedMemory(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+
+    NS_ASSERT(g_enabled == false);
+
+    SharedMemoryTransport::Enable(size);
+    g_sid = SharedMemoryTransport::GetSystemId();
+    g_size = SharedMemoryTransport::GetSize();
+    g_communicator = MPI_COMM_NULL;
+    g_sharedMemory = true;
+    g_enabled = true;
+}
+
 void
 NullMessageMpiInterface::InitializeSendReceiveBuffers()
 {
@@ -235,6 +245,12 @@ NullMessageMpiInterface::InitializeSendReceiveBuffers()
 
     g_numNeighbors = RemoteChannelBundleManager::Size();
 
+    if (g_sharedMemory)
+    {
+        // The shared memory rings need no receive buffers
+        return;
+    }
+
     // Post a non-blocking receive for all peers
     g_requests = new MPI_Request[g_numNeighbors];
     g_pRxBuffers = new char*[g_numNeighbors];
@@ -244,9 +260,9 @@ NullMessageMpiInterface::InitializeSendReceiveBuffers()
         Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(rank);
         if (bundle)
         {
-            g_pRxBuffers[index] = new char[NULL_MESSAGE_MAX_MPI_MSG_SIZE];
+            g_pRxBuffers[index] = new char[MAX_MPI_MSG_SIZE];
             MPI_Irecv(g_pRxBuffers[index],
-                      NULL_MESSAGE_MAX_MPI_MSG_SIZE,
+                      MAX_MPI_MSG_SIZE,
                       MPI_CHAR,
                       rank,
                       0,
@@ -268,39 +284,29 @@ NullMessageMpiInterface::SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t
     Ptr<Node> destNode = NodeList::GetNode(node);
     uint32_t nodeSysId = destNode->GetSystemId();
 
-    NullMessageSentBuffer sendBuf;
-    g_pendingTx.push_back(sendBuf);
-    std::list<NullMessageSentBuffer>::reverse_iterator iter =
-        g_pendingTx.rbegin(); // Points to the last element
-
+    // Append the time, guarantee, dest node, dest device and packet to
+    // the message, sent with the next Null Message
     uint32_t serializedSize = p->GetSerializedSize();
-    uint32_t bufferSize = serializedSize + (2 * sizeof(uint64_t)) + (2 * sizeof(uint32_t));
-    uint8_t* buffer = new uint8_t[bufferSize];
-    iter->SetBuffer(buffer);
-    // Add the time, dest node and dest device
-    uint64_t t = rxTime.GetInteger();
-    uint64_t* pTime = reinterpret_cast<uint64_t*>(buffer);
-    *pTime++ = t;
+    uint32_t recordSize = sizeof(NullMessageRecordHeader) + serializedSize;
+    uint8_t* buffer = g_sharedMemory ? SharedMemoryTransport::Reserve(nodeSysId, recordSize)
+                                     : g_sendBatcher.Reserve(nodeSysId, recordSize);
+    auto header = reinterpret_cast<NullMessageRecordHeader*>(buffer);
+    header->time = rxTime.GetInteger();
 
     Time guarantee_update =
         NullMessageSimulatorImpl::GetInstance()->CalculateGuaranteeTime(nodeSysId);
-    *pTime++ = guarantee_update.GetTimeStep();
+    header->guarantee = guarantee_update.GetTimeStep();
 
-    uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-    *pData++ = node;
-    *pData++ = dev;
+    header->node = node;
+    header->dev = dev;
+    header->size = serializedSize;
+    header->pad = 0;
     // Serialize the packet
-    p->Serialize(reinterpret_cast<uint8_t*>(pData), serializedSize);
-
-    MPI_Isend(reinterpret_cast<void*>(iter->GetBuffer()),
-              bufferSize,
-              MPI_CHAR,
-              nodeSysId,
-              0,
-              g_communicator,
-              (iter->GetRequest()));
-
-    NullMessageSimulatorImpl::GetInstance()->RescheduleNullMessageEvent(nodeSysId);
+    p->Serialize(buffer + sizeof(NullMessageRecordHeader), serializedSize);
+    if (g_sharedMemory)
+    {
+        SharedMemoryTransport::Commit(nodeSysId);
+    }
 }
 
 void
@@ -311,32 +317,27 @@ NullMessageMpiInterface::SendNullMessage(const Time& guarantee_update,
 
     NS_ASSERT(g_enabled);
 
-    NullMessageSentBuffer sendBuf;
-    g_pendingTx.push_back(sendBuf);
-    std::list<NullMessageSentBuffer>::reverse_iterator iter =
-        g_pendingTx.rbegin(); // Points to the last element
-
-    uint32_t bufferSize = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
-    uint8_t* buffer = new uint8_t[bufferSize];
-    iter->SetBuffer(buffer);
-    // Add the time, dest node and dest device
-    uint64_t* pTime = reinterpret_cast<uint64_t*>(buffer);
-    *pTime++ = 0;
-    *pTime++ = guarantee_update.GetInteger();
-    uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-    *pData++ = 0;
-    *pData++ = 0;
-
     // Find the system id for the destination MPI rank
     uint32_t nodeSysId = bundle->GetSystemId();
 
-    MPI_Isend(reinterpret_cast<void*>(iter->GetBuffer()),
-              bufferSize,
-              MPI_CHAR,
-              nodeSysId,
-              0,
-              g_communicator,
-              (iter->GetRequest()));
+    // Append the Null Message to the batched packets and send them all
+    uint32_t recordSize = sizeof(NullMessageRecordHeader);
+    uint8_t* buffer = g_sharedMemory ? SharedMemoryTransport::Reserve(nodeSysId, recordSize)
+                                     : g_sendBatcher.Reserve(nodeSysId, recordSize);
+    auto header = reinterpret_cast<NullMessageRecordHeader*>(buffer);
+    header->time = 0;
+    header->guarantee = guarantee_update.GetInteger();
+    header->node = 0;
+    header->dev = 0;
+    header->size = 0;
+    header->pad = 0;
+
+    if (g_sharedMemory)
+    {
+        SharedMemoryTransport::Commit(nodeSysId);
+        return;
+    }
+    g_sendBatcher.Flush(nodeSysId);
 }
 
 void
@@ -372,6 +373,24 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
         return;
     }
 
+    if (g_sharedMemory)
+    {
+        if (blocking)
+        {
+            SharedMemoryTransport::Wait();
+        }
+        uint32_t rank;
+        uint32_t size;
+        while (const uint8_t* record = SharedMemoryTransport::Peek(rank, size))
+        {
+            Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(rank);
+            NS_ASSERT(bundle);
+            ReceiveRecord(record, bundle);
+            SharedMemoryTransport::Pop();
+        }
+        return;
+    }
+
     do
     {
         int messageReceived = 0;
@@ -394,56 +413,20 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
             int count;
             MPI_Get_count(&status, MPI_CHAR, &count);
 
-            // Get the meta data first
-            uint64_t* pTime = reinterpret_cast<uint64_t*>(g_pRxBuffers[index]);
-            uint64_t time = *pTime++;
-            uint64_t guaranteeUpdate = *pTime++;
-
-            uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-            uint32_t node = *pData++;
-            uint32_t dev = *pData++;
-
-            Time rxTime(time);
-
-            // rxtime == 0 means this is a Null Message
-            if (rxTime > Time(0))
-            {
-                count -= sizeof(time) + sizeof(guaranteeUpdate) + sizeof(node) + sizeof(dev);
-
-                Ptr<Packet> p = Create<Packet>(reinterpret_cast<uint8_t*>(pData), count, true);
-
-                // Find the correct node/device to schedule receive event
-                Ptr<Node> pNode = NodeList::GetNode(node);
-                Ptr<MpiReceiver> pMpiRec = nullptr;
-                uint32_t nDevices = pNode->GetNDevices();
-                for (uint32_t i = 0; i < nDevices; ++i)
-                {
-                    Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
-                    if (pThisDev->GetIfIndex() == dev)
-                    {
-                        pMpiRec = pThisDev->GetObject<MpiReceiver>();
-                        break;
-                    }
-                }
-                NS_ASSERT(pNode && pMpiRec);
-
-                // Schedule the rx event
-                Simulator::ScheduleWithContext(pNode->GetId(),
-                                               rxTime - Simulator::Now(),
-                                               &MpiReceiver::Receive,
-                                               pMpiRec,
-                                               p);
-            }
-
-            // Update guarantee time for both packet receives and Null Messages.
             Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(status.MPI_SOURCE);
             NS_ASSERT(bundle);
 
-            bundle->SetGuaranteeTime(Time(guaranteeUpdate));
+            // Process each record of the message, in the order sent
+            uint8_t* buffer = reinterpret_cast<uint8_t*>(g_pRxBuffers[index]);
+            uint8_t* end = buffer + count;
+            while (buffer < end)
+            {
+                buffer += MpiSendBatcher::GetRecordSize(ReceiveRecord(buffer, bundle));
+            }
 
             // Re-queue the next read
             MPI_Irecv(g_pRxBuffers[index],
-                      NULL_MESSAGE_MAX_MPI_MSG_SIZE,
+                      MAX_MPI_MSG_SIZE,
                       MPI_CHAR,
                       status.MPI_SOURCE,
                       0,
@@ -458,6 +441,16 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
     } while (!stop);
 }
 
+void
+NullMessageMpiInterface::FlushSendBuffers()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    NS_ASSERT(g_enabled);
+
+    g_sendBatcher.FlushAll();
+}
+
 void
 NullMessageMpiInterface::TestSendComplete()
 {
@@ -465,19 +458,7 @@ NullMessageMpiInterface::TestSendComplete()
 
     NS_ASSERT(g_enabled);
 
-    std::list<NullMessageSentBuffer>::iterator iter = g_pendingTx.begin();
-    while (iter != g_pendingTx.end())
-    {
-        MPI_Status status;
-        int flag = 0;
-        MPI_Test(iter->GetRequest(), &flag, &status);
-        std::list<NullMessageSentBuffer>::iterator current = iter; // Save current for erasing
-        ++iter;                                                    // Advance to next
-        if (flag)
-        { // This message is complete
-            g_pendingTx.erase(current);
-        }
-    }
+    g_sendBatcher.TestSendComplete();
 }
 
 void
@@ -485,15 +466,15 @@ NullMessageMpiInterface::Disable()
 {
     NS_LOG_FUNCTION(this);
 
-    if (g_enabled)
+    if (g_enabled && g_sharedMemory)
     {
-        for (std::list<NullMessageSentBuffer>::iterator iter = g_pendingTx.begin();
-             iter != g_pendingTx.end();
-             ++iter)
-        {
-            MPI_Cancel(iter->GetRequest());
-            MPI_Request_free(iter->GetRequest());
-        }
+        SharedMemoryTransport::Disable();
+        g_sharedMemory = false;
+        g_enabled = false;
+    }
+    else if (g_enabled)
+    {
+        g_sendBatcher.Cancel();
 
         for (uint32_t i = 0; i < g_numNeighbors; ++i)
         {
@@ -508,8 +489,6 @@ NullMessageMpiInterface::Disable()
         delete[] g_pRxBuffers;
         delete[] g_requests;
 
-        g_pendingTx.clear();
-
         if (g_freeCommunicator)
         {
             MPI_Comm_free(&g_communicator);
@@ -20,25 +20,24 @@
 /**
  * \file
  * \ingroup mpi
- * Declaration of classes ns3::NullMessageSentBuffer and ns3::NullMessageMpiInterface.
+ * Declaration of class ns3::NullMessageMpiInterface.
  */
 
 #ifndef NS3_NULLMESSAGE_MPI_INTERFACE_H
 #define NS3_NULLMESSAGE_MPI_INTERFACE_H
 
+#include "mpi-send-batcher.h"
 #include "parallel-communication-interface.h"
 
 #include <ns3/buffer.h>
 #include <ns3/nstime.h>
 
-#include <list>
 #include <mpi.h>
 
 namespace ns3
 {
 
 class NullMessageSimulatorImpl;
-class NullMessageSentBuffer;
 class RemoteChannelBundle;
 class Packet;
 
@@ -47,6 +46,12 @@ class Packet;
  *
  * \brief Interface between ns-3 and MPI for the Null Message
  * distributed simulation implementation.
+ *
+ * The packets sent to a task are batched into a single MPI message,
+ * which is sent with the next Null Message to that task, or when this
+ * task blocks waiting for messages.  When the tasks are local processes
+ * sharing memory, each packet is written directly to the shared memory
+ * ring of its task instead.
  */
 class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -67,6 +72,7 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
     bool IsEnabled() override;
     void Enable(int* pargc, char*** pargv) override;
     void Enable(MPI_Comm communicator) override;
+    void EnableSharedMemory(uint32_t size) override;
     void Disable() override;
     void SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev) override;
     MPI_Comm GetCommunicator() override;
@@ -84,9 +90,9 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
     /**
      * \brief Send a Null Message to across the specified bundle.
      *
-     * Null Messages are sent when a packet has not been sent across
-     * this bundle in order to allow time advancement on the remote
-     * MPI task.
+     * Null Messages are sent periodically across each bundle in
+     * order to allow time advancement on the remote MPI task.  The
+     * packets batched for the remote MPI task are sent along.
      *
      * \param [in] guaranteeUpdate Lower bound time on the next
      * possible event from this MPI task to the remote MPI task across
@@ -94,10 +100,10 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
      *
      * \param [in] bundle The bundle of links between two ranks.
      *
-     * \internal The Null Message MPI buffer format uses the same packet
-     * metadata format as sending a normal packet with the time,
-     * destination node, and destination device set to zero.  Using the
-     * same packet metadata simplifies receive logic.
+     * \internal The Null Message record uses the same packet
+     * metadata format as a normal packet record with the time,
+     * destination node, destination device and size set to zero.  Using
+     * the same packet metadata simplifies receive logic.
      */
     static void SendNullMessage(const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
     /**
@@ -110,6 +116,10 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
      * has been received.
      */
     static void ReceiveMessagesBlocking();
+    /**
+     * Send the packets batched since the last Null Message to each task
+     */
+    static void FlushSendBuffers();
     /**
      * Check for completed sends
      */
@@ -158,14 +168,17 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
     /** Data buffers for non-blocking receives. */
     static char** g_pRxBuffers;
 
-    /** List of pending non-blocking sends. */
-    static std::list<NullMessageSentBuffer> g_pendingTx;
+    /** Batches the packets and Null Messages into non-blocking sends. */
+    static MpiSendBatcher g_sendBatcher;
 
     /** MPI communicator being used for ns-3 tasks. */
     static MPI_Comm g_communicator;
 
     /** Did we create the communicator?  Have to free it. */
     static bool g_freeCommunicator;
+
+    /** Are the tasks local processes communicating through shared memory. */
+    static bool g_sharedMemory;
 };
 
 } // namespace ns3
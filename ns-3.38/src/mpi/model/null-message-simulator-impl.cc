@@ -273,32 +273,6 @@ NullMessageSimulatorImpl::ScheduleNullMessageEvent(Ptr<RemoteChannelBundle> bund
                                            PeekPointer(bundle)));
 }
 
-void
-NullMessageSimulatorImpl::RescheduleNullMessageEvent(Ptr<RemoteChannelBundle> bundle)
-{
-    NS_LOG_FUNCTION(this << bundle);
-
-    Simulator::Cancel(bundle->GetEventId());
-
-    Time delay(m_schedulerTune * bundle->GetDelay().GetTimeStep());
-
-    bundle->SetEventId(Simulator::Schedule(delay,
-                                           &NullMessageSimulatorImpl::NullMessageEventHandler,
-                                           this,
-                                           PeekPointer(bundle)));
-}
-
-void
-NullMessageSimulatorImpl::RescheduleNullMessageEvent(uint32_t nodeSysId)
-{
-    NS_LOG_FUNCTION(this << nodeSysId);
-
-    Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(nodeSysId);
-    NS_ASSERT(bundle);
-
-    RescheduleNullMessageEvent(bundle);
-}
-
 void
 NullMessageSimulatorImpl::Run()
 {
@@ -325,6 +299,9 @@ NullMessageSimulatorImpl::Run()
             HandleArrivingMessagesBlocking();
         }
     }
+
+    // Send the packets batched since the last Null Messages
+    NullMessageMpiInterface::FlushSendBuffers();
 }
 
 void
@@ -345,6 +322,9 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking()
 {
     NS_LOG_FUNCTION(this);
 
+    // Send the batched packets first, the other tasks may be waiting for them
+    NullMessageMpiInterface::FlushSendBuffers();
+
     NullMessageMpiInterface::ReceiveMessagesBlocking();
 
     CalculateSafeTime();
@@ -144,22 +144,6 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      */
     void ScheduleNullMessageEvent(Ptr<RemoteChannelBundle> bundle);
 
-    /**
-     * \param bundle Bundle to reschedule Null Message event for
-     *
-     * Reschedule Null Message event for the specified
-     * RemoteChannelBundel.  Existing event will be canceled.
-     */
-    void RescheduleNullMessageEvent(Ptr<RemoteChannelBundle> bundle);
-
-    /**
-     * \param nodeSysId SystemID to reschedule null event for
-     *
-     * Reschedule Null Message event for the RemoteChannelBundel to the
-     * task nodeSysId.  Existing event will be canceled.
-     */
-    void RescheduleNullMessageEvent(uint32_t nodeSysId);
-
     /**
      * \param systemId SystemID to compute guarantee time for
      *
@@ -89,6 +89,10 @@ class ParallelCommunicationInterface
      * \copydoc MpiInterface::Enable(MPI_Comm communicator)
      */
     virtual void Enable(MPI_Comm communicator) = 0;
+    /**
+     * \copydoc MpiInterface::EnableSharedMemory
+     */
+    virtual void EnableSharedMemory(uint32_t size) = 0;
     /**
      * \copydoc MpiInterface::Disable
      */
@@ -0,0 +1,474 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::SharedMemoryTransport.
+ */
+
+#include "shared-memory-transport.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedMemoryTransport");
+
+namespace
+{
+
+const uint64_t RING_SIZE = 1 << 20;     //!< Size of each ring, a power of two.
+const uint32_t RECORD_HEADER_SIZE = 8;  //!< Size of the header of a record.
+const uint32_t WRAP = 0xffffffff;       //!< Record size marking the end of the ring.
+const uint32_t GATHER_SLOT_SIZE = 256;  //!< Size of the block of each rank in AllGather().
+const std::size_t CACHE_LINE_SIZE = 64; //!< Alignment of the shared structures.
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Atomics in shared memory must be lock-free");
+
+/** The positions in a ring, on separate cache lines. */
+struct RingHeader
+{
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head; //!< Bytes consumed by the reader.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail; //!< Bytes committed by the writer.
+};
+
+/** The barrier state. */
+struct BarrierState
+{
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> count; //!< Ranks arrived at the barrier.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> sense; //!< Flipped when all have arrived.
+};
+
+bool g_enabled = false;            //!< Whether the transport is enabled.
+uint32_t g_rank = 0;               //!< Rank of this process.
+uint32_t g_size = 1;               //!< Number of ranks.
+uint8_t* g_area = nullptr;         //!< The shared memory area.
+std::size_t g_areaSize = 0;        //!< Size of the shared memory area.
+BarrierState* g_barrier = nullptr; //!< The barrier, in the shared area.
+uint8_t* g_slots = nullptr;        //!< The AllGather() blocks, in the shared area.
+RingHeader* g_rings = nullptr;     //!< The ring positions, in the shared area.
+uint8_t* g_data = nullptr;         //!< The ring contents, in the shared area.
+uint32_t g_sense = 0;              //!< The barrier sense of this rank.
+std::vector<uint64_t> g_reserved;  //!< Ring tail after the reserved record, per destination.
+std::vector<pid_t> g_children;     //!< The forked ranks, in rank 0.
+bool g_peeked = false;             //!< Whether a record was returned by Peek().
+bool g_peekedQueue = false;        //!< Whether the record peeked is from the local queue.
+uint32_t g_peekedRank = 0;         //!< Source rank of the record peeked.
+uint32_t g_peekedSize = 0;         //!< Size of the record peeked.
+uint32_t g_nextRank = 0;           //!< Next source rank to read, to read them in turn.
+
+/** Records moved out of the rings while waiting, with their source rank. */
+std::deque<std::pair<uint32_t, std::vector<uint8_t>>> g_queue;
+
+/**
+ * Round a size up to the shared structures alignment.
+ * \param [in] size The size, in bytes.
+ * \returns The aligned size.
+ */
+std::size_t
+AlignCacheLine(std::size_t size)
+{
+    return (size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+}
+
+/**
+ * Get the space taken by a record in a ring.
+ * \param [in] size The record size, in bytes.
+ * \returns The record size, with its header and padding.
+ */
+uint64_t
+GetRecordSpace(uint32_t size)
+{
+    return RECORD_HEADER_SIZE + ((size + 7) & ~7U);
+}
+
+/**
+ * \param [in] from The source rank.
+ * \param [in] to The destination rank.
+ * \returns The positions of the ring.
+ */
+RingHeader&
+GetRing(uint32_t from, uint32_t to)
+{
+    return g_rings[from * g_size + to];
+}
+
+/**
+ * \param [in] from The source rank.
+ * \param [in] to The destination rank.
+ * \returns The contents of the ring.
+ */
+uint8_t*
+GetRingData(uint32_t from, uint32_t to)
+{
+    return g_data + (from * g_size + to) * RING_SIZE;
+}
+
+/**
+ * Get the next record in the ring from a rank, skipping the end of the
+ * ring if the record wrapped around.
+ * \param [in] from The source rank.
+ * \param [out] size The record size, in bytes.
+ * \returns The record, or nullptr if the ring is empty.
+ */
+const uint8_t*
+ReadRing(uint32_t from, uint32_t& size)
+{
+    RingHeader& ring = GetRing(from, g_rank);
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head == ring.tail.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    const uint8_t* data = GetRingData(from, g_rank);
+    uint64_t offset = head & (RING_SIZE - 1);
+    std::memcpy(&size, data + offset, sizeof(size));
+    if (size == WRAP)
+    {
+        // The record written with the marker follows at the start.
+        ring.head.store(head + RING_SIZE - offset, std::memory_order_release);
+        offset = 0;
+        std::memcpy(&size, data, sizeof(size));
+    }
+    return data + offset + RECORD_HEADER_SIZE;
+}
+
+/**
+ * Release the record returned by ReadRing().
+ * \param [in] from The source rank.
+ * \param [in] size The record size, in bytes.
+ */
+void
+ReleaseRing(uint32_t from, uint32_t size)
+{
+    RingHeader& ring = GetRing(from, g_rank);
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.head.store(head + GetRecordSpace(size), std::memory_order_release);
+}
+
+/**
+ * \returns Whether a record was received.
+ */
+bool
+HasRecord()
+{
+    if (!g_queue.empty())
+    {
+        return true;
+    }
+    for (uint32_t from = 0; from < g_size; ++from)
+    {
+        RingHeader& ring = GetRing(from, g_rank);
+        if (from != g_rank && ring.head.load(std::memory_order_relaxed) !=
+                                  ring.tail.load(std::memory_order_acquire))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // unnamed namespace
+
+void
+SharedMemoryTransport::Enable(uint32_t size)
+{
+    NS_LOG_FUNCTION(size);
+    NS_ASSERT(!g_enabled);
+    NS_ABORT_MSG_IF(size == 0, "At least one rank is required");
+
+    std::size_t barrierSize = AlignCacheLine(sizeof(BarrierState));
+    std::size_t slotsSize = AlignCacheLine(size * GATHER_SLOT_SIZE);
+    std::size_t ringsSize = AlignCacheLine(size * size * sizeof(RingHeader));
+    g_areaSize = barrierSize + slotsSize + ringsSize + size * size * RING_SIZE;
+
+    // Anonymous shared pages are inherited by the forked ranks; the
+    // ring contents are only backed by memory once written.
+    void* area = mmap(nullptr,
+                      g_areaSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1,
+                      0);
+    if (area == MAP_FAILED)
+    {
+        NS_FATAL_ERROR("Cannot map " << g_areaSize
+                                     << " bytes of shared memory: " << std::strerror(errno));
+    }
+    g_area = static_cast<uint8_t*>(area);
+    g_barrier = new (g_area) BarrierState();
+    g_slots = g_area + barrierSize;
+    g_rings = reinterpret_cast<RingHeader*>(g_slots + slotsSize);
+    for (uint32_t i = 0; i < size * size; ++i)
+    {
+        new (&g_rings[i]) RingHeader();
+    }
+    g_data = g_area + barrierSize + slotsSize + ringsSize;
+
+    g_size = size;
+    g_rank = 0;
+    g_sense = 0;
+    g_nextRank = 0;
+    g_reserved.assign(size, 0);
+
+    // Do not duplicate the buffered output in every rank
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    for (uint32_t rank = 1; rank < size; ++rank)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            NS_FATAL_ERROR("Cannot fork rank " << rank << ": " << std::strerror(errno));
+        }
+        if (pid == 0)
+        {
+            g_rank = rank;
+            g_children.clear();
+            break;
+        }
+        g_children.push_back(pid);
+    }
+
+    g_enabled = true;
+}
+
+void
+SharedMemoryTransport::Disable()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(g_enabled);
+
+    for (std::size_t i = 0; i < g_children.size(); ++i)
+    {
+        int status = 0;
+        waitpid(g_children[i], &status, 0);
+        NS_ABORT_MSG_IF(!WIFEXITED(status) || WEXITSTATUS(status) != 0,
+                        "Rank " << i + 1 << " failed");
+    }
+    g_children.clear();
+
+    munmap(g_area, g_areaSize);
+    g_area = nullptr;
+    g_queue.clear();
+    g_peeked = false;
+    g_enabled = false;
+}
+
+bool
+SharedMemoryTransport::IsEnabled()
+{
+    return g_enabled;
+}
+
+uint32_t
+SharedMemoryTransport::GetSystemId()
+{
+    return g_rank;
+}
+
+uint32_t
+SharedMemoryTransport::GetSize()
+{
+    return g_size;
+}
+
+uint8_t*
+SharedMemoryTransport::Reserve(uint32_t rank, uint32_t size)
+{
+    NS_LOG_FUNCTION(rank << size);
+    NS_ASSERT(g_enabled && rank < g_size && rank != g_rank);
+    uint64_t space = GetRecordSpace(size);
+    NS_ABORT_MSG_IF(space > RING_SIZE / 2,
+                    "Record of " << size << " bytes too large for a shared memory ring");
+
+    RingHeader& ring = GetRing(g_rank, rank);
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t offset = tail & (RING_SIZE - 1);
+    // A record is contiguous: skip the end of the ring if it does not fit
+    uint64_t skip = (offset + space > RING_SIZE) ? RING_SIZE - offset : 0;
+    while (tail + skip + space - ring.head.load(std::memory_order_acquire) > RING_SIZE)
+    {
+        Poll();
+        std::this_thread::yield();
+    }
+
+    uint8_t* data = GetRingData(g_rank, rank);
+    if (skip > 0)
+    {
+        std::memcpy(data + offset, &WRAP, sizeof(WRAP));
+        tail += skip;
+        offset = 0;
+    }
+    std::memcpy(data + offset, &size, sizeof(size));
+    g_reserved[rank] = tail + space;
+    return data + offset + RECORD_HEADER_SIZE;
+}
+
+void
+SharedMemoryTransport::Commit(uint32_t rank)
+{
+    NS_LOG_FUNCTION(rank);
+    GetRing(g_rank, rank).tail.store(g_reserved[rank], std::memory_order_release);
+}
+
+const uint8_t*
+SharedMemoryTransport::Peek(uint32_t& rank, uint32_t& size)
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(g_enabled);
+
+    if (!g_queue.empty())
+    {
+        rank = g_queue.front().first;
+        size = g_queue.front().second.size();
+        g_peeked = true;
+        g_peekedQueue = true;
+        return g_queue.front().second.data();
+    }
+    for (uint32_t i = 0; i < g_size; ++i)
+    {
+        uint32_t from = (g_nextRank + i) % g_size;
+        if (from == g_rank)
+        {
+            continue;
+        }
+        const uint8_t* record = ReadRing(from, size);
+        if (record != nullptr)
+        {
+            rank = from;
+            g_peeked = true;
+            g_peekedQueue = false;
+            g_peekedRank = from;
+            g_peekedSize = size;
+            return record;
+        }
+    }
+    return nullptr;
+}
+
+void
+SharedMemoryTransport::Pop()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(g_peeked);
+
+    if (g_peekedQueue)
+    {
+        g_queue.pop_front();
+    }
+    else
+    {
+        ReleaseRing(g_peekedRank, g_peekedSize);
+        g_nextRank = (g_peekedRank + 1) % g_size;
+    }
+    g_peeked = false;
+}
+
+void
+SharedMemoryTransport::Wait()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(g_enabled);
+
+    while (!HasRecord())
+    {
+        std::this_thread::yield();
+    }
+}
+
+void
+SharedMemoryTransport::Poll()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT_MSG(!g_peeked, "Cannot wait while a record is being read");
+
+    for (uint32_t from = 0; from < g_size; ++from)
+    {
+        if (from == g_rank)
+        {
+            continue;
+        }
+        uint32_t size;
+        while (const uint8_t* record = ReadRing(from, size))
+        {
+            g_queue.emplace_back(from, std::vector<uint8_t>(record, record + size));
+            ReleaseRing(from, size);
+        }
+    }
+}
+
+void
+SharedMemoryTransport::Barrier()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(g_enabled);
+
+    // Sense-reversing barrier: the last rank to arrive flips the sense
+    g_sense = 1 - g_sense;
+    if (g_barrier->count.fetch_add(1, std::memory_order_acq_rel) == g_size - 1)
+    {
+        g_barrier->count.store(0, std::memory_order_relaxed);
+        g_barrier->sense.store(g_sense, std::memory_order_release);
+        return;
+    }
+    while (g_barrier->sense.load(std::memory_order_acquire) != g_sense)
+    {
+        Poll();
+        std::this_thread::yield();
+    }
+}
+
+void
+SharedMemoryTransport::AllGather(const void* send, uint32_t size, void* recv)
+{
+    NS_LOG_FUNCTION(send << size << recv);
+    NS_ASSERT(size <= GATHER_SLOT_SIZE);
+
+    std::memcpy(g_slots + g_rank * GATHER_SLOT_SIZE, send, size);
+    Barrier();
+    for (uint32_t rank = 0; rank < g_size; ++rank)
+    {
+        std::memcpy(static_cast<uint8_t*>(recv) + rank * size,
+                    g_slots + rank * GATHER_SLOT_SIZE,
+                    size);
+    }
+    // Do not let a rank overwrite its block before all have read it
+    Barrier();
+}
+
+} // namespace ns3
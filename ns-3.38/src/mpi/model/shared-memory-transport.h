@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::SharedMemoryTransport.
+ */
+
+#ifndef NS3_SHARED_MEMORY_TRANSPORT_H
+#define NS3_SHARED_MEMORY_TRANSPORT_H
+
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Communication between ranks running as processes forked on
+ * the local host.
+ *
+ * Enable() maps a shared memory area, then forks the ranks other than
+ * rank 0: each process returns from Enable() and runs the rest of the
+ * program as its rank, as it would under mpiexec.
+ *
+ * Each ordered pair of ranks has a single-producer single-consumer
+ * ring buffer in the shared area.  A record is written in place in
+ * the ring of its destination, and is visible to the destination as
+ * soon as it is committed, without a system call or a copy through
+ * the kernel.  The collective operations are built on a barrier in
+ * the shared area.
+ *
+ * A rank waiting for room in a ring, for a record or at a barrier
+ * keeps draining its own incoming rings into a local queue, so that
+ * two ranks writing to each other never deadlock.
+ */
+class SharedMemoryTransport
+{
+  public:
+    /**
+     * Create the shared memory area and fork the ranks.
+     * \param [in] size The number of ranks.
+     */
+    static void Enable(uint32_t size);
+    /**
+     * Release the shared memory area.  Rank 0 waits for the other
+     * ranks to exit.
+     */
+    static void Disable();
+    /** \returns Whether the transport is enabled. */
+    static bool IsEnabled();
+    /** \returns The rank of this process. */
+    static uint32_t GetSystemId();
+    /** \returns The number of ranks. */
+    static uint32_t GetSize();
+
+    /**
+     * Reserve a record in the ring to a rank, waiting for room.
+     * \param [in] rank The destination rank.
+     * \param [in] size The record size, in bytes.
+     * \returns Where to write the record, before calling Commit().
+     */
+    static uint8_t* Reserve(uint32_t rank, uint32_t size);
+    /**
+     * Make the record reserved to a rank visible to it.
+     * \param [in] rank The destination rank.
+     */
+    static void Commit(uint32_t rank);
+
+    /**
+     * Get the next record received, in the order sent by each rank.
+     * \param [out] rank The source rank.
+     * \param [out] size The record size, in bytes.
+     * \returns The record, valid until Pop(), or nullptr if none.
+     */
+    static const uint8_t* Peek(uint32_t& rank, uint32_t& size);
+    /** Release the record returned by Peek(). */
+    static void Pop();
+    /** Wait until a record is received. */
+    static void Wait();
+
+    /** Wait until every rank reaches the barrier. */
+    static void Barrier();
+    /**
+     * Gather a block of bytes from every rank.
+     * \param [in] send The block of this rank.
+     * \param [in] size The block size, at most 256 bytes.
+     * \param [out] recv The blocks of all the ranks, in rank order.
+     */
+    static void AllGather(const void* send, uint32_t size, void* recv);
+
+  private:
+    /** Move the records received into the local queue. */
+    static void Poll();
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_TRANSPORT_H */
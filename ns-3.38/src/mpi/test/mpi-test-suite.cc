@@ -171,3 +171,15 @@ static MpiTestSuite g_mpiEmpty3NullMsg("mpi-example-empty-3-nullmsg",
                                        NS_TEST_SOURCEDIR,
                                        3,
                                        "-nullmsg");
+
+/* Tests using the shared memory communication, the example forking the ranks */
+static MpiTestSuite g_mpiSimple2Shm("mpi-example-simple-2-shm",
+                                    "simple-distributed",
+                                    NS_TEST_SOURCEDIR,
+                                    1,
+                                    "--sharedMemory");
+static MpiTestSuite g_mpiSimple2NullMsgShm("mpi-example-simple-2-nullmsg-shm",
+                                           "simple-distributed",
+                                           NS_TEST_SOURCEDIR,
+                                           1,
+                                           "--nullmsg --sharedMemory");
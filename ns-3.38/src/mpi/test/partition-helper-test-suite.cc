@@ -0,0 +1,290 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/partition-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Check that two cliques joined by a single link are split on that link.
+ */
+class PartitionHelperCliquesTestCase : public TestCase
+{
+  public:
+    PartitionHelperCliquesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PartitionHelperCliquesTestCase::PartitionHelperCliquesTestCase()
+    : TestCase("Two cliques joined by a bridge")
+{
+}
+
+void
+PartitionHelperCliquesTestCase::DoRun()
+{
+    NodeContainer left;
+    NodeContainer right;
+    left.Create(8);
+    right.Create(8);
+
+    PartitionHelper partition;
+    partition.SetPartitionCount(2);
+    for (NodeContainer* clique : {&left, &right})
+    {
+        for (uint32_t i = 0; i < clique->GetN(); ++i)
+        {
+            for (uint32_t j = i + 1; j < clique->GetN(); ++j)
+            {
+                partition.AddLink(clique->Get(i), clique->Get(j), MicroSeconds(1));
+            }
+        }
+    }
+    partition.AddLink(left.Get(3), right.Get(5), MicroSeconds(1));
+    partition.Compute();
+
+    NS_TEST_EXPECT_MSG_EQ(partition.GetEdgeCut(), 1, "Only the bridge should be cut");
+    NS_TEST_EXPECT_MSG_EQ(partition.GetLookahead(), MicroSeconds(1), "Wrong lookahead");
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(partition.GetPartition(left.Get(i)),
+                              partition.GetPartition(left.Get(0)),
+                              "The left clique should not be split");
+        NS_TEST_EXPECT_MSG_EQ(partition.GetPartition(right.Get(i)),
+                              partition.GetPartition(right.Get(0)),
+                              "The right clique should not be split");
+    }
+    NS_TEST_EXPECT_MSG_NE(partition.GetPartition(left.Get(0)),
+                          partition.GetPartition(right.Get(0)),
+                          "The cliques should be in different partitions");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Check that a grid is split into balanced partitions with a small cut.
+ */
+class PartitionHelperGridTestCase : public TestCase
+{
+  public:
+    PartitionHelperGridTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PartitionHelperGridTestCase::PartitionHelperGridTestCase()
+    : TestCase("Balanced partition of a grid")
+{
+}
+
+void
+PartitionHelperGridTestCase::DoRun()
+{
+    const uint32_t side = 32;
+    const uint32_t partitions = 4;
+    NodeContainer nodes;
+    nodes.Create(side * side);
+
+    PartitionHelper partition;
+    partition.SetPartitionCount(partitions);
+    partition.SetImbalance(1.05);
+    for (uint32_t i = 0; i < side; ++i)
+    {
+        for (uint32_t j = 0; j < side; ++j)
+        {
+            if (i + 1 < side)
+            {
+                partition.AddLink(nodes.Get(i * side + j),
+                                  nodes.Get((i + 1) * side + j),
+                                  MicroSeconds(1));
+            }
+            if (j + 1 < side)
+            {
+                partition.AddLink(nodes.Get(i * side + j),
+                                  nodes.Get(i * side + j + 1),
+                                  MicroSeconds(1));
+            }
+        }
+    }
+    partition.Compute();
+
+    std::vector<uint32_t> sizes(partitions, 0);
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        sizes[partition.GetPartition(nodes.Get(i))]++;
+    }
+    for (uint32_t size : sizes)
+    {
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(size, 269, "Partition too large");
+        NS_TEST_EXPECT_MSG_GT(size, 0, "Empty partition");
+    }
+    // Cutting the grid into quadrants cuts 64 links.
+    NS_TEST_EXPECT_MSG_LT_OR_EQ(partition.GetEdgeCut(), 96, "Cut too large");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Check that short links are kept within partitions.
+ */
+class PartitionHelperLookaheadTestCase : public TestCase
+{
+  public:
+    PartitionHelperLookaheadTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PartitionHelperLookaheadTestCase::PartitionHelperLookaheadTestCase()
+    : TestCase("Short links are not cut")
+{
+}
+
+void
+PartitionHelperLookaheadTestCase::DoRun()
+{
+    // A ring of four racks of four nodes: short links within a rack,
+    // long links between the racks.
+    const uint32_t racks = 4;
+    const uint32_t rackSize = 4;
+    NodeContainer nodes;
+    nodes.Create(racks * rackSize);
+
+    PartitionHelper partition;
+    partition.SetPartitionCount(racks);
+    for (uint32_t r = 0; r < racks; ++r)
+    {
+        for (uint32_t i = 0; i + 1 < rackSize; ++i)
+        {
+            partition.AddLink(nodes.Get(r * rackSize + i),
+                              nodes.Get(r * rackSize + i + 1),
+                              NanoSeconds(100));
+        }
+        partition.AddLink(nodes.Get(r * rackSize + rackSize - 1),
+                          nodes.Get(((r + 1) % racks) * rackSize),
+                          MicroSeconds(10));
+    }
+    partition.Compute();
+
+    NS_TEST_EXPECT_MSG_EQ(partition.GetEdgeCut(), racks, "Only the rack links should be cut");
+    NS_TEST_EXPECT_MSG_EQ(partition.GetLookahead(), MicroSeconds(10), "Wrong lookahead");
+
+    // With a minimum lookahead, the short links are never cut, even if
+    // the partition cannot be balanced.
+    PartitionHelper twoRacks;
+    twoRacks.SetPartitionCount(3);
+    twoRacks.SetMinLookahead(MicroSeconds(1));
+    for (uint32_t i = 0; i + 1 < 2 * rackSize; ++i)
+    {
+        twoRacks.AddLink(nodes.Get(i),
+                         nodes.Get(i + 1),
+                         i + 1 == rackSize ? MicroSeconds(10) : NanoSeconds(100));
+    }
+    twoRacks.Add(nodes.Get(2 * rackSize));
+    twoRacks.Compute();
+    NS_TEST_EXPECT_MSG_EQ(twoRacks.GetEdgeCut(), 1, "Only the rack link should be cut");
+    NS_TEST_EXPECT_MSG_EQ(twoRacks.GetLookahead(), MicroSeconds(10), "Wrong lookahead");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * Check that a partition map written to a file assigns the same system
+ * ids once read back.
+ */
+class PartitionHelperMapTestCase : public TestCase
+{
+  public:
+    PartitionHelperMapTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PartitionHelperMapTestCase::PartitionHelperMapTestCase()
+    : TestCase("Partition map file")
+{
+}
+
+void
+PartitionHelperMapTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(12);
+
+    PartitionHelper partition;
+    partition.SetPartitionCount(3);
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        partition.AddLink(nodes.Get(i), nodes.Get((i + 1) % nodes.GetN()), MicroSeconds(1));
+    }
+    partition.Compute();
+    std::string filename = CreateTempDirFilename("partition.map");
+    partition.WritePartitionMap(filename);
+
+    PartitionHelper loaded;
+    loaded.ReadPartitionMap(filename);
+    loaded.Assign();
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(nodes.Get(i)->GetSystemId(),
+                              partition.GetPartition(nodes.Get(i)),
+                              "Wrong system id for node " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(partition.GetEdgeCut(), 3, "The ring should be cut in three places");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ *
+ * PartitionHelper test suite.
+ */
+class PartitionHelperTestSuite : public TestSuite
+{
+  public:
+    PartitionHelperTestSuite();
+};
+
+PartitionHelperTestSuite::PartitionHelperTestSuite()
+    : TestSuite("partition-helper", UNIT)
+{
+    AddTestCase(new PartitionHelperCliquesTestCase, TestCase::QUICK);
+    AddTestCase(new PartitionHelperGridTestCase, TestCase::QUICK);
+    AddTestCase(new PartitionHelperLookaheadTestCase, TestCase::QUICK);
+    AddTestCase(new PartitionHelperMapTestCase, TestCase::QUICK);
+}
+
+static PartitionHelperTestSuite g_partitionHelperTestSuite; //!< Static variable for test
+                                                            //!< initialization
@@ -0,0 +1,736 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::LogicalProcess* MultithreadedSimulatorImpl::g_currentLp =
+    nullptr;
+
+namespace
+{
+
+/** Timestamp used for "no event". */
+const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max();
+
+/**
+ * Find the representative of a node in a union-find forest.
+ * \param [in,out] parent The forest, compressed on the way.
+ * \param [in] node The node.
+ * \returns The representative node.
+ */
+uint32_t
+FindRoot(std::vector<uint32_t>& parent, uint32_t node)
+{
+    while (parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("ThreadCount",
+                          "Number of threads running the logical processes, "
+                          "0 for one per hardware thread.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_threadCount),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MinLookahead",
+                          "Point-to-point channels with a smaller delay are not cut "
+                          "between logical processes.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_minLookahead),
+                          MakeTimeChecker());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+    : m_lps(1),
+      m_partitioned(false),
+      m_lookahead(NO_EVENT),
+      m_threadCount(0),
+      m_windowEnd(0),
+      m_windowCount(0),
+      m_stop(false),
+      m_generation(0),
+      m_busyWorkers(0),
+      m_shutdown(false),
+      m_nextActive(0)
+{
+    NS_LOG_FUNCTION(this);
+    LogicalProcess& global = m_lps[0];
+    global.id = 0;
+    global.currentTs = 0;
+    global.currentUid = 0;
+    global.currentContext = Simulator::NO_CONTEXT;
+    // uid 0 is "invalid" events, 1 is "now" events, 2 is "destroy" events
+    global.uid = EventId::UID::VALID;
+    global.eventCount = 0;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorkers();
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    StopWorkers();
+    for (auto& lp : m_lps)
+    {
+        for (const auto& remote : lp.outbox)
+        {
+            remote.impl->Unref();
+        }
+        lp.outbox.clear();
+        if (lp.events)
+        {
+            while (!lp.events->IsEmpty())
+            {
+                Scheduler::Event next = lp.events->RemoveNext();
+                next.impl->Unref();
+            }
+            lp.events = nullptr;
+        }
+    }
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    m_schedulerFactory = schedulerFactory;
+    for (auto& lp : m_lps)
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        if (lp.events)
+        {
+            while (!lp.events->IsEmpty())
+            {
+                scheduler->Insert(lp.events->RemoveNext());
+            }
+        }
+        lp.events = scheduler;
+    }
+}
+
+MultithreadedSimulatorImpl::LogicalProcess*
+MultithreadedSimulatorImpl::CurrentLp() const
+{
+    if (g_currentLp != nullptr)
+    {
+        return g_currentLp;
+    }
+    return const_cast<LogicalProcess*>(&m_lps[0]);
+}
+
+MultithreadedSimulatorImpl::LogicalProcess*
+MultithreadedSimulatorImpl::LpOf(uint32_t context) const
+{
+    uint32_t lp = (context < m_lpOfContext.size()) ? m_lpOfContext[context] : 0;
+    return const_cast<LogicalProcess*>(&m_lps[lp]);
+}
+
+MultithreadedSimulatorImpl::LogicalProcess*
+MultithreadedSimulatorImpl::OwnerLp(const EventId& id) const
+{
+    LogicalProcess* lp = LpOf(id.GetContext());
+    const LogicalProcess* current = CurrentLp();
+    NS_ABORT_MSG_IF(current->id != 0 && current != lp,
+                    "An event can only be accessed by its own logical process");
+    return lp;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert(LogicalProcess& lp,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = lp.uid;
+    lp.uid++;
+    lp.events->Insert(ev);
+    return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::Partition()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!m_partitioned);
+    m_partitioned = true;
+
+    // Merge the nodes of every channel which is not cut.
+    uint32_t nNodes = NodeList::GetNNodes();
+    std::vector<uint32_t> parent(nNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<std::pair<std::pair<uint32_t, uint32_t>, uint64_t>> cuts;
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d)
+        {
+            Ptr<Channel> channel = node->GetDevice(d)->GetChannel();
+            if (!channel)
+            {
+                continue;
+            }
+            if (DynamicCast<PointToPointChannel>(channel) && channel->GetNDevices() == 2)
+            {
+                TimeValue delay;
+                channel->GetAttribute("Delay", delay);
+                if (delay.Get().IsStrictlyPositive() && delay.Get() >= m_minLookahead)
+                {
+                    cuts.push_back({{channel->GetDevice(0)->GetNode()->GetId(),
+                                     channel->GetDevice(1)->GetNode()->GetId()},
+                                    static_cast<uint64_t>(delay.Get().GetTimeStep())});
+                    continue;
+                }
+            }
+            for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+            {
+                uint32_t other = channel->GetDevice(j)->GetNode()->GetId();
+                parent[FindRoot(parent, other)] = FindRoot(parent, i);
+            }
+        }
+    }
+
+    // Number the LPs in the order of their smallest node id.
+    std::vector<uint32_t> lpOfRoot(nNodes, 0);
+    m_lpOfContext.assign(nNodes, 0);
+    uint32_t nLps = 0;
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        uint32_t root = FindRoot(parent, i);
+        if (lpOfRoot[root] == 0)
+        {
+            lpOfRoot[root] = ++nLps;
+        }
+        m_lpOfContext[i] = lpOfRoot[root];
+    }
+
+    m_lookahead = NO_EVENT;
+    for (const auto& cut : cuts)
+    {
+        if (m_lpOfContext[cut.first.first] != m_lpOfContext[cut.first.second])
+        {
+            m_lookahead = std::min(m_lookahead, cut.second);
+        }
+    }
+
+    // Every LP starts where the global LP stands; uids keep increasing so
+    // that the events moved below keep unique keys.
+    m_lps.resize(nLps + 1);
+    for (uint32_t i = 1; i <= nLps; ++i)
+    {
+        LogicalProcess& lp = m_lps[i];
+        lp.id = i;
+        lp.events = m_schedulerFactory.Create<Scheduler>();
+        lp.currentTs = m_lps[0].currentTs;
+        lp.currentUid = 0;
+        lp.currentContext = Simulator::NO_CONTEXT;
+        lp.uid = m_lps[0].uid;
+        lp.eventCount = 0;
+    }
+
+    std::vector<Scheduler::Event> events;
+    while (!m_lps[0].events->IsEmpty())
+    {
+        events.push_back(m_lps[0].events->RemoveNext());
+    }
+    for (const auto& ev : events)
+    {
+        LpOf(ev.key.m_context)->events->Insert(ev);
+    }
+    NS_LOG_LOGIC(nLps << " logical processes, lookahead " << m_lookahead);
+}
+
+void
+MultithreadedSimulatorImpl::DeliverRemoteEvents()
+{
+    for (auto& lp : m_lps)
+    {
+        for (const auto& remote : lp.outbox)
+        {
+            Insert(m_lps[remote.lp], remote.ts, remote.context, remote.impl);
+        }
+        lp.outbox.clear();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent(LogicalProcess& lp)
+{
+    Scheduler::Event next = lp.events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= lp.currentTs);
+    lp.eventCount++;
+
+    NS_LOG_LOGIC("handle " << next.key.m_ts);
+    lp.currentTs = next.key.m_ts;
+    lp.currentContext = next.key.m_context;
+    lp.currentUid = next.key.m_uid;
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow(LogicalProcess& lp)
+{
+    g_currentLp = &lp;
+    while (!lp.events->IsEmpty() && lp.events->PeekNext().key.m_ts < m_windowEnd)
+    {
+        ProcessOneEvent(lp);
+    }
+    g_currentLp = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::DrainWindow()
+{
+    for (std::size_t i = m_nextActive++; i < m_active.size(); i = m_nextActive++)
+    {
+        ProcessWindow(*m_active[i]);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::WorkerLoop()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock{m_poolMutex};
+            m_startCv.wait(lock, [&] { return m_shutdown || m_generation != generation; });
+            if (m_shutdown)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+        DrainWindow();
+        {
+            std::unique_lock lock{m_poolMutex};
+            if (--m_busyWorkers == 0)
+            {
+                m_doneCv.notify_one();
+            }
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunWindow()
+{
+    NS_LOG_FUNCTION(this << m_active.size() << m_windowEnd);
+    m_windowCount++;
+    if (m_active.size() == 1 || m_workers.empty())
+    {
+        m_nextActive = 0;
+        DrainWindow();
+        return;
+    }
+    {
+        std::unique_lock lock{m_poolMutex};
+        m_nextActive = 0;
+        m_busyWorkers = m_workers.size();
+        m_generation++;
+    }
+    m_startCv.notify_all();
+    DrainWindow();
+    std::unique_lock lock{m_poolMutex};
+    m_doneCv.wait(lock, [&] { return m_busyWorkers == 0; });
+}
+
+void
+MultithreadedSimulatorImpl::StopWorkers()
+{
+    {
+        std::unique_lock lock{m_poolMutex};
+        m_shutdown = true;
+    }
+    m_startCv.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+    m_shutdown = false;
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(g_currentLp != nullptr, "Simulator::Run called from a simulation event");
+    if (!m_partitioned)
+    {
+        Partition();
+    }
+    uint32_t nLps = m_lps.size() - 1;
+    uint32_t nThreads = (m_threadCount == 0) ? std::thread::hardware_concurrency() : m_threadCount;
+    nThreads = std::max<uint32_t>(std::min(nThreads, nLps), 1);
+    while (m_workers.size() + 1 < nThreads)
+    {
+        m_workers.emplace_back(&MultithreadedSimulatorImpl::WorkerLoop, this);
+    }
+
+    LogicalProcess& global = m_lps[0];
+    m_stop = false;
+    while (!m_stop)
+    {
+        DeliverRemoteEvents();
+        uint64_t tGlobal =
+            global.events->IsEmpty() ? NO_EVENT : global.events->PeekNext().key.m_ts;
+        uint64_t tMin = NO_EVENT;
+        for (uint32_t i = 1; i <= nLps; ++i)
+        {
+            if (!m_lps[i].events->IsEmpty())
+            {
+                tMin = std::min(tMin, m_lps[i].events->PeekNext().key.m_ts);
+            }
+        }
+        if (tGlobal == NO_EVENT && tMin == NO_EVENT)
+        {
+            break;
+        }
+        if (tGlobal <= tMin)
+        {
+            // Every LP has caught up: the global event runs alone.
+            m_windowEnd = tGlobal;
+            ProcessOneEvent(global);
+            continue;
+        }
+
+        uint64_t windowEnd = (tMin > NO_EVENT - m_lookahead) ? NO_EVENT : tMin + m_lookahead;
+        m_windowEnd = std::min(windowEnd, tGlobal);
+        m_active.clear();
+        for (uint32_t i = 1; i <= nLps; ++i)
+        {
+            if (!m_lps[i].events->IsEmpty() && m_lps[i].events->PeekNext().key.m_ts < m_windowEnd)
+            {
+                m_active.push_back(&m_lps[i]);
+            }
+        }
+        RunWindow();
+    }
+    DeliverRemoteEvents();
+
+    // Now() on the main thread reports the furthest time reached.
+    for (uint32_t i = 1; i <= nLps; ++i)
+    {
+        global.currentTs = std::max(global.currentTs, m_lps[i].currentTs);
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (const auto& lp : m_lps)
+    {
+        if (!lp.events->IsEmpty() || !lp.outbox.empty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    LogicalProcess* lp = CurrentLp();
+    uint64_t ts = lp->currentTs + delay.GetTimeStep();
+    if (lp->id == 0)
+    {
+        Insert(*lp, ts, Simulator::NO_CONTEXT, MakeEvent(&Simulator::Stop));
+    }
+    else
+    {
+        // The global LP only runs between windows.
+        lp->outbox.push_back(
+            {0, Simulator::NO_CONTEXT, std::max(ts, m_windowEnd), MakeEvent(&Simulator::Stop)});
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+    LogicalProcess* lp = CurrentLp();
+    uint64_t ts = lp->currentTs + delay.GetTimeStep();
+    uint32_t uid = Insert(*lp, ts, lp->currentContext, event);
+    return EventId(event, ts, lp->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    LogicalProcess* lp = CurrentLp();
+    LogicalProcess* dst = LpOf(context);
+    uint64_t ts = lp->currentTs + delay.GetTimeStep();
+    if (lp->id == 0 || dst == lp)
+    {
+        // Global events run while every LP is idle.
+        Insert(*dst, ts, context, event);
+        return;
+    }
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "Event for context " << context << " at " << TimeStep(ts).As(Time::S)
+                                         << " inside the current window, which ends at "
+                                         << TimeStep(m_windowEnd).As(Time::S)
+                                         << ": the lookahead is too large");
+    lp->outbox.push_back({dst->id, context, ts, event});
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    EventId id(Ptr<EventImpl>(event, false), CurrentLp()->currentTs, 0xffffffff, 2);
+    std::unique_lock lock{m_destroyMutex};
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(CurrentLp()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    return TimeStep(id.GetTs() - CurrentLp()->currentTs);
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        std::unique_lock lock{m_destroyMutex};
+        for (DestroyEvents::iterator i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    // IsExpired() has checked that the event belongs to the calling LP.
+    LogicalProcess* lp = LpOf(id.GetContext());
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    lp->events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    // IsExpired() checks that the event belongs to the calling LP.
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        std::unique_lock lock{m_destroyMutex};
+        for (DestroyEvents::const_iterator i = m_destroyEvents.begin(); i != m_destroyEvents.end();
+             i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    const LogicalProcess* lp = OwnerLp(id);
+    return id.PeekEventImpl() == nullptr || id.GetTs() < lp->currentTs ||
+           (id.GetTs() == lp->currentTs && id.GetUid() <= lp->currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return CurrentLp()->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = 0;
+    for (const auto& lp : m_lps)
+    {
+        count += lp.eventCount;
+    }
+    return count;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetLogicalProcessCount() const
+{
+    return m_lps.size() - 1;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetLogicalProcess(uint32_t context) const
+{
+    return LpOf(context)->id;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead() const
+{
+    return (m_lookahead == NO_EVENT) ? Time::Max() : TimeStep(m_lookahead);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindowCount() const
+{
+    return m_windowCount;
+}
+
+} // namespace ns3
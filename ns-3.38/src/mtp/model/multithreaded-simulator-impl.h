@@ -0,0 +1,256 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \defgroup mtp Multithreaded Parallel Simulation
+ *
+ * Conservative parallel simulation on the threads of a single process.
+ */
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Conservative multithreaded simulator implementation.
+ *
+ * Nodes are grouped into logical processes (LPs) by the event context,
+ * which is the node id.  Every point-to-point channel whose delay is at
+ * least MinLookahead is cut; the nodes connected by any other channel are
+ * kept in the same LP.  The lookahead is the smallest delay of the cut
+ * channels that join two different LPs.  The partition is computed at the
+ * first call to Run(), from the nodes of the NodeList at that time.
+ *
+ * The simulation advances in windows.  With \c tMin the earliest event
+ * of all LPs, every LP with events before
+ * <tt>tMin + lookahead</tt> runs them on a pool of threads.  An event an
+ * LP schedules on a node of another LP cannot fall inside the window;
+ * it is buffered and delivered at the end of the window, LP by LP in
+ * LP order, so the event order of every LP, and thus the simulation
+ * outcome, does not depend on the thread interleaving.
+ *
+ * Events whose context is not the id of a node partitioned in an LP,
+ * such as the events scheduled from \c main() before Run() without a
+ * context, belong to the global LP.  They run alone, on the thread which
+ * called Run(), after every LP has caught up with their timestamp; at
+ * equal timestamps global events run before LP events.
+ *
+ * Limitations:
+ *  - the library must be built with NS3_MTP, which makes reference
+ *    counts atomic and packet buffers copy on write across threads;
+ *  - packet uids come from a process-wide counter and are thus not
+ *    reproducible from one run to the next;
+ *  - random variables must get their streams before Run(): streams
+ *    assigned at run time race on the global stream counter;
+ *  - Simulator::Stop() called from an LP takes effect at the end of the
+ *    current window;
+ *  - an event may only be removed by its own LP or by a global event.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Default constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get the number of logical processes, excluding the global one.
+     * \returns The number of LPs, zero before the first Run().
+     */
+    uint32_t GetLogicalProcessCount() const;
+    /**
+     * Get the logical process of a context.
+     * \param [in] context The context, usually a node id.
+     * \returns The LP index, from 1, or 0 for the global LP.
+     */
+    uint32_t GetLogicalProcess(uint32_t context) const;
+    /**
+     * Get the lookahead used to size the windows.
+     * \returns The lookahead, Time::Max() with less than two LPs.
+     */
+    Time GetLookahead() const;
+    /**
+     * Get the number of parallel windows run so far.
+     * \returns The number of windows.
+     */
+    uint64_t GetWindowCount() const;
+
+  private:
+    // Inherited from Object
+    void DoDispose() override;
+
+    /** An event scheduled on another LP, delivered at the end of the window. */
+    struct RemoteEvent
+    {
+        uint32_t lp;      //!< Destination LP.
+        uint32_t context; //!< Event context.
+        uint64_t ts;      //!< Absolute event timestamp.
+        EventImpl* impl;  //!< The event, with the scheduler reference.
+    };
+
+    /** The state of one logical process. */
+    struct LogicalProcess
+    {
+        uint32_t id;                     //!< Index in m_lps, 0 for the global LP.
+        Ptr<Scheduler> events;           //!< The event queue.
+        uint64_t currentTs;              //!< Timestamp of the current event.
+        uint32_t currentUid;             //!< Uid of the current event.
+        uint32_t currentContext;         //!< Context of the current event.
+        uint32_t uid;                    //!< Next event uid.
+        uint64_t eventCount;             //!< Number of events run.
+        std::vector<RemoteEvent> outbox; //!< Events for other LPs.
+    };
+
+    /**
+     * Get the LP of the calling thread.
+     * \returns The LP running on this thread, or the global LP.
+     */
+    LogicalProcess* CurrentLp() const;
+    /**
+     * Get the LP owning a context.
+     * \param [in] context The context.
+     * \returns The LP.
+     */
+    LogicalProcess* LpOf(uint32_t context) const;
+    /**
+     * Get the LP owning an event, checking that the calling thread may access it.
+     *
+     * The event and its LP state are only stable on the LP's own thread,
+     * or on the global LP, which runs alone.
+     * \param [in] id The event.
+     * \returns The LP.
+     */
+    LogicalProcess* OwnerLp(const EventId& id) const;
+    /**
+     * Insert an event in an LP, allocating its uid.
+     * \param [in,out] lp The LP.
+     * \param [in] ts The absolute timestamp.
+     * \param [in] context The context.
+     * \param [in] event The event.
+     * \returns The event uid.
+     */
+    uint32_t Insert(LogicalProcess& lp, uint64_t ts, uint32_t context, EventImpl* event);
+    /** Group the nodes into LPs and move their events. */
+    void Partition();
+    /** Move the events buffered in the outboxes to their LPs, in LP order. */
+    void DeliverRemoteEvents();
+    /**
+     * Run the next event of an LP.
+     * \param [in,out] lp The LP.
+     */
+    void ProcessOneEvent(LogicalProcess& lp);
+    /**
+     * Run the events of an LP before the end of the window.
+     * \param [in,out] lp The LP.
+     */
+    void ProcessWindow(LogicalProcess& lp);
+    /**
+     * Run a window on the LPs in m_active, on the thread pool.
+     */
+    void RunWindow();
+    /** Run the LPs of the window not yet claimed by another thread. */
+    void DrainWindow();
+    /** Body of the pool threads. */
+    void WorkerLoop();
+    /** Join the pool threads. */
+    void StopWorkers();
+
+    /** Container type for the pending destroy event list. */
+    typedef std::list<EventId> DestroyEvents;
+
+    /** The global LP in first position, then one per partition. */
+    std::vector<LogicalProcess> m_lps;
+    /** LP index of each context partitioned. */
+    std::vector<uint32_t> m_lpOfContext;
+    ObjectFactory m_schedulerFactory; //!< Factory of the LP schedulers.
+    bool m_partitioned;               //!< Whether Partition() ran.
+    uint64_t m_lookahead;             //!< Lookahead, in time steps.
+    Time m_minLookahead;              //!< Smallest channel delay cut between LPs.
+    uint32_t m_threadCount;           //!< Requested number of threads.
+    uint64_t m_windowEnd;             //!< End of the window being run.
+    uint64_t m_windowCount;           //!< Number of windows run.
+    std::atomic<bool> m_stop;         //!< Flag calling for the end of Run().
+
+    DestroyEvents m_destroyEvents;     //!< The destroy events.
+    mutable std::mutex m_destroyMutex; //!< Protects m_destroyEvents.
+
+    std::vector<std::thread> m_workers;    //!< The pool threads.
+    std::mutex m_poolMutex;                //!< Protects the pool state below.
+    std::condition_variable m_startCv;     //!< Signals a new window or shutdown.
+    std::condition_variable m_doneCv;      //!< Signals the end of a window.
+    uint64_t m_generation;                 //!< Window generation, to wake the pool.
+    uint32_t m_busyWorkers;                //!< Pool threads still in the window.
+    bool m_shutdown;                       //!< Whether the pool must exit.
+    std::vector<LogicalProcess*> m_active; //!< LPs with events in the window.
+    std::atomic<std::size_t> m_nextActive; //!< Next m_active entry to claim.
+
+    /** The LP running on the calling thread, if any. */
+    static thread_local LogicalProcess* g_currentLp;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,321 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/channel.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * Multithreaded simulator implementation test suite.
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests Multithreaded parallel simulation tests
+ */
+
+using namespace ns3;
+
+namespace
+{
+
+/** A packet reception: time step and size. */
+typedef std::pair<int64_t, uint32_t> Reception;
+
+/**
+ * \ingroup mtp-tests
+ * Ping-pong traffic over a chain of point-to-point links.
+ *
+ * Every node sends a burst to each neighbour; a received packet larger
+ * than the minimum size is sent back one byte shorter after a processing
+ * delay, so that events cross the links in both directions many times.
+ */
+class ChainTraffic
+{
+  public:
+    /**
+     * Build the chain.
+     * \param [in] delays The delay of each link, the chain has one more node.
+     */
+    ChainTraffic(const std::vector<Time>& delays)
+    {
+        m_nodes.Create(delays.size() + 1);
+        m_receptions.resize(m_nodes.GetN());
+        PointToPointHelper p2p;
+        p2p.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+        for (std::size_t i = 0; i < delays.size(); ++i)
+        {
+            p2p.SetChannelAttribute("Delay", TimeValue(delays[i]));
+            NetDeviceContainer devices = p2p.Install(m_nodes.Get(i), m_nodes.Get(i + 1));
+            for (uint32_t j = 0; j < 2; ++j)
+            {
+                devices.Get(j)->SetReceiveCallback(MakeCallback(&ChainTraffic::Receive, this));
+            }
+        }
+    }
+
+    /** Schedule the initial bursts. */
+    void Start()
+    {
+        for (uint32_t i = 0; i < m_nodes.GetN(); ++i)
+        {
+            Ptr<Node> node = m_nodes.Get(i);
+            for (uint32_t d = 0; d < node->GetNDevices(); ++d)
+            {
+                for (uint32_t k = 0; k < 4; ++k)
+                {
+                    Simulator::ScheduleWithContext(node->GetId(),
+                                                   MicroSeconds(100 * k + i),
+                                                   &ChainTraffic::Send,
+                                                   this,
+                                                   node->GetDevice(d),
+                                                   300 + 10 * i + k);
+                }
+            }
+        }
+    }
+
+    /**
+     * Get the receptions of every node.
+     * \returns The receptions, per node.
+     */
+    const std::vector<std::vector<Reception>>& GetReceptions() const
+    {
+        return m_receptions;
+    }
+
+    /**
+     * Get the nodes.
+     * \returns The nodes.
+     */
+    const NodeContainer& GetNodes() const
+    {
+        return m_nodes;
+    }
+
+  private:
+    /**
+     * Send a packet to the other end of a link.
+     * \param [in] device The sending device.
+     * \param [in] size The packet size.
+     */
+    void Send(Ptr<NetDevice> device, uint32_t size)
+    {
+        Ptr<NetDevice> peer = device->GetChannel()->GetDevice(0);
+        if (peer == device)
+        {
+            peer = device->GetChannel()->GetDevice(1);
+        }
+        device->Send(Create<Packet>(size), peer->GetAddress(), 0x0800);
+    }
+
+    /**
+     * Record a packet and send it back, shortened.
+     * \param [in] device The receiving device.
+     * \param [in] packet The packet.
+     * \returns true.
+     */
+    bool Receive(Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t, const Address&)
+    {
+        uint32_t node = device->GetNode()->GetId() - m_nodes.Get(0)->GetId();
+        m_receptions[node].emplace_back(Simulator::Now().GetTimeStep(), packet->GetSize());
+        if (packet->GetSize() > 250)
+        {
+            Simulator::Schedule(MicroSeconds(7),
+                                &ChainTraffic::Send,
+                                this,
+                                device,
+                                packet->GetSize() - 1);
+        }
+        return true;
+    }
+
+    NodeContainer m_nodes;                            //!< The chain.
+    std::vector<std::vector<Reception>> m_receptions; //!< Receptions, per node.
+};
+
+/**
+ * \ingroup mtp-tests
+ * Set the simulator implementation.
+ * \param [in] factory The implementation factory.
+ * \returns The implementation.
+ */
+Ptr<SimulatorImpl>
+UseImplementation(const ObjectFactory& factory)
+{
+    Simulator::Destroy();
+    Ptr<SimulatorImpl> impl = factory.Create<SimulatorImpl>();
+    Simulator::SetImplementation(impl);
+    return impl;
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup mtp-tests
+ * Check that the multithreaded implementation reproduces the events of
+ * the default implementation.
+ */
+class MtpEquivalenceTestCase : public TestCase
+{
+  public:
+    MtpEquivalenceTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * Run the chain traffic.
+     * \param [in] factory The simulator implementation factory.
+     * \returns The receptions, per node.
+     */
+    std::vector<std::vector<Reception>> RunChain(const ObjectFactory& factory);
+};
+
+MtpEquivalenceTestCase::MtpEquivalenceTestCase()
+    : TestCase("Multithreaded events match the default implementation")
+{
+}
+
+std::vector<std::vector<Reception>>
+MtpEquivalenceTestCase::RunChain(const ObjectFactory& factory)
+{
+    Ptr<SimulatorImpl> impl = UseImplementation(factory);
+    ChainTraffic traffic({MicroSeconds(50), MicroSeconds(20), MicroSeconds(35), MicroSeconds(20)});
+    traffic.Start();
+    Simulator::Stop(MilliSeconds(100));
+    Simulator::Run();
+
+    Ptr<MultithreadedSimulatorImpl> mtp = DynamicCast<MultithreadedSimulatorImpl>(impl);
+    if (mtp)
+    {
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetLogicalProcessCount(), 5, "one LP per node");
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetLookahead(), MicroSeconds(20), "smallest link delay");
+        NS_TEST_EXPECT_MSG_GT(mtp->GetWindowCount(), 1, "parallel windows");
+        NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), MilliSeconds(100), "stopped on time");
+    }
+    // Receptions at the same time on different links may be recorded in
+    // any order.
+    std::vector<std::vector<Reception>> receptions = traffic.GetReceptions();
+    for (auto& node : receptions)
+    {
+        std::sort(node.begin(), node.end());
+    }
+    Simulator::Destroy();
+    return receptions;
+}
+
+void
+MtpEquivalenceTestCase::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId("ns3::DefaultSimulatorImpl");
+    std::vector<std::vector<Reception>> expected = RunChain(factory);
+
+    factory.SetTypeId("ns3::MultithreadedSimulatorImpl");
+    factory.Set("ThreadCount", UintegerValue(3));
+    std::vector<std::vector<Reception>> first = RunChain(factory);
+    std::vector<std::vector<Reception>> second = RunChain(factory);
+
+    NS_TEST_ASSERT_MSG_EQ(first.size(), expected.size(), "node count");
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_GT(expected[i].size(), 0, "node " << i << " got traffic");
+        NS_TEST_EXPECT_MSG_EQ((first[i] == expected[i]), true, "node " << i << " receptions");
+        NS_TEST_EXPECT_MSG_EQ((second[i] == first[i]), true, "node " << i << " reproducible");
+    }
+}
+
+/**
+ * \ingroup mtp-tests
+ * Check the grouping of nodes into logical processes.
+ */
+class MtpPartitionTestCase : public TestCase
+{
+  public:
+    MtpPartitionTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+MtpPartitionTestCase::MtpPartitionTestCase()
+    : TestCase("Nodes joined by short links share a logical process")
+{
+}
+
+void
+MtpPartitionTestCase::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId("ns3::MultithreadedSimulatorImpl");
+    factory.Set("MinLookahead", TimeValue(MicroSeconds(10)));
+    Ptr<MultithreadedSimulatorImpl> impl =
+        DynamicCast<MultithreadedSimulatorImpl>(UseImplementation(factory));
+
+    // 0 -5us- 1 -30us- 2 -0s- 3 -10us- 4
+    ChainTraffic traffic({MicroSeconds(5), MicroSeconds(30), MicroSeconds(0), MicroSeconds(10)});
+    traffic.Start();
+    Simulator::Run();
+
+    const NodeContainer& nodes = traffic.GetNodes();
+    std::vector<uint32_t> lps;
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        lps.push_back(impl->GetLogicalProcess(nodes.Get(i)->GetId()));
+    }
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLogicalProcessCount(), 3, "three LPs");
+    NS_TEST_EXPECT_MSG_EQ(lps[0], 1, "LPs numbered by node id");
+    NS_TEST_EXPECT_MSG_EQ(lps[1], 1, "5us link below MinLookahead");
+    NS_TEST_EXPECT_MSG_EQ(lps[2], 2, "30us link cut");
+    NS_TEST_EXPECT_MSG_EQ(lps[3], 2, "zero delay link not cut");
+    NS_TEST_EXPECT_MSG_EQ(lps[4], 3, "10us link cut");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLogicalProcess(Simulator::NO_CONTEXT), 0, "global LP");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLookahead(), MicroSeconds(10), "smallest cut delay");
+    NS_TEST_EXPECT_MSG_EQ(impl->IsFinished(), true, "all events run");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mtp-tests
+ * Multithreaded simulator implementation test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite();
+};
+
+MtpTestSuite::MtpTestSuite()
+    : TestSuite("mtp", UNIT)
+{
+    AddTestCase(new MtpEquivalenceTestCase, TestCase::QUICK);
+    AddTestCase(new MtpPartitionTestCase, TestCase::QUICK);
+}
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
@@ -25,7 +25,9 @@
 #include <stdint.h>
 #include <vector>
 
-#define BUFFER_FREE_LIST 1
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3
 {
@@ -665,7 +667,11 @@ class Buffer
          * The reference count of an instance of this data structure.
          * Each buffer which references an instance holds a count.
          */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
         uint32_t m_count;
+#endif
         /**
          * the size of the m_data field below.
          */
@@ -767,9 +773,13 @@ class Buffer
     /**
      * location in a newly-allocated buffer where you should start
      * writing data. i.e., m_start should be initialized to this
-     * value.
+     * value.  Multithreaded builds keep one heuristic per thread.
      */
+#ifdef NS3_MTP
+    static thread_local uint32_t g_recommendedStart;
+#else
     static uint32_t g_recommendedStart;
+#endif
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -792,19 +802,15 @@ class Buffer
      */
     uint32_t m_end;
 
-#ifdef BUFFER_FREE_LIST
-    /// Container for buffer data
-    typedef std::vector<struct Buffer::Data*> FreeList;
-
-    /// Local static destructor structure
-    struct LocalStaticDestructor
-    {
-        ~LocalStaticDestructor();
-    };
-
-    static uint32_t g_maxSize;                            //!< Max observed data size
-    static FreeList* g_freeList;                          //!< Buffer data container
-    static LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+    /**
+     * largest size of the buffer data storage released so far. New
+     * storage is allocated at least this large so that it rarely needs
+     * to grow.  Multithreaded builds keep one per thread.
+     */
+#ifdef NS3_MTP
+    static thread_local uint32_t g_maxSize;
+#else
+    static uint32_t g_maxSize;
 #endif
 };
 
@@ -0,0 +1,209 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-allocator.h"
+
+#include "ns3/log.h"
+
+#include <atomic>
+#include <new>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketAllocator definitions.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PacketAllocator");
+
+namespace
+{
+
+/** Number of size classes, from PacketAllocator::MinBlockSize up. */
+constexpr std::size_t POOL_CLASSES = 12;
+
+static_assert(PacketAllocator::MinBlockSize << (POOL_CLASSES - 1) == PacketAllocator::MaxBlockSize,
+              "POOL_CLASSES does not match the block size range");
+
+/** A released block, linked into the free list of its size class. */
+struct PoolBlock
+{
+    PoolBlock* next; /**< Next free block of the same size class. */
+};
+
+/**
+ * Free lists of one thread.
+ *
+ * This is trivially destructible so it remains usable while other
+ * thread_local and static objects, such as packets held by static
+ * containers, are torn down; the blocks themselves are returned to the
+ * heap by PoolReleaser.
+ */
+struct PoolState
+{
+    PoolBlock* head[POOL_CLASSES]; /**< Free list per size class. */
+    uint32_t length[POOL_CLASSES]; /**< Free list lengths. */
+    PacketAllocator::Stats stats;  /**< Allocation statistics. */
+    bool closed;                   /**< Whether this thread is exiting. */
+};
+
+/** Free lists of the calling thread. */
+thread_local PoolState g_poolState;
+
+/** Returns the cached blocks of a thread to the heap when it exits. */
+struct PoolReleaser
+{
+    ~PoolReleaser()
+    {
+        for (std::size_t i = 0; i < POOL_CLASSES; ++i)
+        {
+            while (g_poolState.head[i] != nullptr)
+            {
+                PoolBlock* block = g_poolState.head[i];
+                g_poolState.head[i] = block->next;
+                ::operator delete(block);
+            }
+            g_poolState.length[i] = 0;
+        }
+        g_poolState.stats.cached = 0;
+        g_poolState.stats.cachedBytes = 0;
+        g_poolState.closed = true;
+    }
+};
+
+/** Registers the PoolReleaser of the calling thread on first use. */
+thread_local PoolReleaser g_poolReleaser;
+
+/** Whether released blocks are cached, read by every simulation thread. */
+std::atomic<bool> g_poolEnabled{true};
+
+/**
+ * Get the size class of a request.
+ * \param [in] size The requested size, at most PacketAllocator::MaxBlockSize.
+ * \returns The index of the size class.
+ */
+inline std::size_t
+GetClass(std::size_t size)
+{
+    std::size_t index = 0;
+    std::size_t block = PacketAllocator::MinBlockSize;
+    while (block < size)
+    {
+        block <<= 1;
+        ++index;
+    }
+    return index;
+}
+
+} // unnamed namespace
+
+std::size_t
+PacketAllocator::GetBlockSize(std::size_t size)
+{
+    if (size > MaxBlockSize)
+    {
+        return size;
+    }
+    return MinBlockSize << GetClass(size);
+}
+
+void*
+PacketAllocator::Allocate(std::size_t size)
+{
+    PoolState& pool = g_poolState;
+    pool.stats.allocations++;
+    if (size > MaxBlockSize)
+    {
+        pool.stats.heapAllocations++;
+        return ::operator new(size);
+    }
+    // Always round up to the size class, so the block can join the free
+    // list on release even if the pool was disabled when it was allocated.
+    std::size_t index = GetClass(size);
+    PoolBlock* block = g_poolEnabled.load(std::memory_order_relaxed) ? pool.head[index] : nullptr;
+    if (block != nullptr)
+    {
+        pool.head[index] = block->next;
+        pool.length[index]--;
+        pool.stats.cached--;
+        pool.stats.cachedBytes -= MinBlockSize << index;
+        pool.stats.poolHits++;
+        return block;
+    }
+    // Touch the releaser so the blocks of this thread are freed on exit.
+    static_cast<void>(&g_poolReleaser);
+    pool.stats.heapAllocations++;
+    return ::operator new(MinBlockSize << index);
+}
+
+void
+PacketAllocator::Deallocate(void* ptr, std::size_t size)
+{
+    PoolState& pool = g_poolState;
+    pool.stats.releases++;
+    std::size_t index = size > MaxBlockSize ? 0 : GetClass(size);
+    std::size_t blockSize = MinBlockSize << index;
+    if (!g_poolEnabled.load(std::memory_order_relaxed) || pool.closed || size > MaxBlockSize ||
+        (pool.length[index] + 1) * blockSize > MaxCachedBytes)
+    {
+        pool.stats.heapReleases++;
+        ::operator delete(ptr);
+        return;
+    }
+    // A thread may get its first blocks by releasing packets allocated
+    // elsewhere: touch the releaser here too.
+    static_cast<void>(&g_poolReleaser);
+    auto block = static_cast<PoolBlock*>(ptr);
+    block->next = pool.head[index];
+    pool.head[index] = block;
+    pool.length[index]++;
+    pool.stats.cached++;
+    pool.stats.cachedBytes += blockSize;
+}
+
+void
+PacketAllocator::SetEnabled(bool enabled)
+{
+    NS_LOG_FUNCTION(enabled);
+    g_poolEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool
+PacketAllocator::IsEnabled()
+{
+    return g_poolEnabled.load(std::memory_order_relaxed);
+}
+
+PacketAllocator::Stats
+PacketAllocator::GetStats()
+{
+    return g_poolState.stats;
+}
+
+void
+PacketAllocator::ResetStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    uint64_t cached = g_poolState.stats.cached;
+    uint64_t cachedBytes = g_poolState.stats.cachedBytes;
+    g_poolState.stats = Stats{};
+    g_poolState.stats.cached = cached;
+    g_poolState.stats.cachedBytes = cachedBytes;
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::PacketAllocator declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup packet
+ *
+ * \brief Size-class memory pool for packets and their buffers.
+ *
+ * Every packet sent through a simulation allocates a Packet, the
+ * Buffer::Data holding its bytes and, when tagged, PacketTagList and
+ * ByteTagList nodes; all of them are released again a few events later.
+ * To avoid a heap round trip for each of them, their memory is recycled
+ * through per-thread free lists, one per power-of-two size class from
+ * \c MinBlockSize up to \c MaxBlockSize bytes.  Larger blocks use the
+ * global heap.
+ *
+ * Requested sizes are always rounded up to their size class, so callers
+ * may use the whole block, as returned by GetBlockSize().  Since each
+ * thread owns its free lists, a block released by another thread than
+ * the one which allocated it simply joins the free list of the
+ * releasing thread.
+ *
+ * The pool can be disabled, for instance to track memory errors with
+ * valgrind: released blocks then go back to the global heap right away.
+ */
+class PacketAllocator
+{
+  public:
+    /** Allocation statistics of the pool. */
+    struct Stats
+    {
+        uint64_t allocations;     /**< Number of allocations. */
+        uint64_t poolHits;        /**< Allocations served from a free list. */
+        uint64_t heapAllocations; /**< Allocations served by the global heap. */
+        uint64_t releases;        /**< Number of releases. */
+        uint64_t heapReleases;    /**< Releases returned to the global heap. */
+        uint64_t cached;          /**< Blocks currently held in the free lists. */
+        uint64_t cachedBytes;     /**< Bytes currently held in the free lists. */
+    };
+
+    /** Smallest size class, in bytes. */
+    static constexpr std::size_t MinBlockSize = 32;
+    /** Largest size class, in bytes. */
+    static constexpr std::size_t MaxBlockSize = 65536;
+    /** Maximum number of bytes cached per size class and thread. */
+    static constexpr std::size_t MaxCachedBytes = 1024 * 1024;
+
+    /**
+     * Get the size of the block allocated for a request.
+     * \param [in] size The requested size, in bytes.
+     * \returns The usable size of the block, in bytes.
+     */
+    static std::size_t GetBlockSize(std::size_t size);
+    /**
+     * Allocate a block.
+     * \param [in] size The requested size, in bytes.
+     * \returns The block, of GetBlockSize(size) usable bytes.
+     */
+    static void* Allocate(std::size_t size);
+    /**
+     * Release a block.
+     * \param [in] ptr The block, as returned by Allocate().
+     * \param [in] size The size requested for the block, or its block size.
+     */
+    static void Deallocate(void* ptr, std::size_t size);
+
+    /**
+     * Enable or disable the pool.  Blocks cached while the pool was
+     * enabled stay valid and are reused when it is enabled again.
+     * \param [in] enabled Whether released blocks should be cached.
+     */
+    static void SetEnabled(bool enabled);
+    /**
+     * \returns Whether the pool is enabled.
+     */
+    static bool IsEnabled();
+    /**
+     * \returns The pool statistics of the calling thread.
+     */
+    static Stats GetStats();
+    /** Reset the pool statistics of the calling thread. */
+    static void ResetStats();
+};
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
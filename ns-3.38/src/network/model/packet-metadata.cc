@@ -38,7 +38,11 @@ bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
+#ifdef NS3_MTP
+std::atomic<uint16_t> PacketMetadata::m_chunkUid(0);
+#else
 uint16_t PacketMetadata::m_chunkUid = 0;
+#endif
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
 PacketMetadata::DataFreeList::~DataFreeList()
@@ -80,8 +84,7 @@ PacketMetadata::ReserveCopy(uint32_t size)
     struct PacketMetadata::Data* newData = PacketMetadata::Create(m_used + size);
     memcpy(newData->m_data, m_data->m_data, m_used);
     newData->m_dirtyEnd = m_used;
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         PacketMetadata::Recycle(m_data);
     }
@@ -104,8 +107,13 @@ PacketMetadata::Reserve(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
     NS_ASSERT(m_data != nullptr);
+#ifdef NS3_MTP
+    // Another thread may extend shared data concurrently: never write into it.
+    if (m_data->m_size >= m_used + size && m_data->m_count == 1)
+#else
     if (m_data->m_size >= m_used + size &&
         (m_head == 0xffff || m_data->m_count == 1 || m_data->m_dirtyEnd == m_used))
+#endif
     {
         /* enough room, not dirty. */
     }
@@ -384,8 +392,12 @@ PacketMetadata::AddSmall(const struct PacketMetadata::SmallItem* item)
     uint32_t typeUidSize = GetUleb128Size(item->typeUid);
     uint32_t sizeSize = GetUleb128Size(item->size);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2;
+#ifdef NS3_MTP
+    if (m_used + n > m_data->m_size || m_data->m_count != 1)
+#else
     if (m_used + n > m_data->m_size ||
         (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+#endif
     {
         ReserveCopy(n);
     }
@@ -421,8 +433,12 @@ PacketMetadata::AddBig(uint32_t next,
     uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
+#ifdef NS3_MTP
+    if (m_used + n > m_data->m_size || m_data->m_count != 1)
+#else
     if (m_used + n > m_data->m_size ||
         (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+#endif
     {
         ReserveCopy(n);
     }
@@ -567,6 +583,10 @@ struct PacketMetadata::Data*
 PacketMetadata::Create(uint32_t size)
 {
     NS_LOG_FUNCTION(size);
+#ifdef NS3_MTP
+    // The free list and its size heuristic are process-wide: bypass them.
+    return PacketMetadata::Allocate(size);
+#else
     NS_LOG_LOGIC("create size=" << size << ", max=" << m_maxSize);
     if (size > m_maxSize)
     {
@@ -587,12 +607,16 @@ PacketMetadata::Create(uint32_t size)
     }
     NS_LOG_LOGIC("create alloc size=" << m_maxSize);
     return PacketMetadata::Allocate(m_maxSize);
+#endif
 }
 
 void
 PacketMetadata::Recycle(struct PacketMetadata::Data* data)
 {
     NS_LOG_FUNCTION(data);
+#ifdef NS3_MTP
+    PacketMetadata::Deallocate(data);
+#else
     if (!m_enable)
     {
         PacketMetadata::Deallocate(data);
@@ -608,6 +632,7 @@ PacketMetadata::Recycle(struct PacketMetadata::Data* data)
     {
         m_freeList.push_back(data);
     }
+#endif
 }
 
 struct PacketMetadata::Data*
@@ -671,8 +696,7 @@ PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
     item.prev = 0xffff;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = m_chunkUid++;
     uint16_t written = AddSmall(&item);
     UpdateHead(written);
 }
@@ -739,8 +763,7 @@ PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
     item.prev = m_tail;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = m_chunkUid++;
     uint16_t written = AddSmall(&item);
     UpdateTail(written);
     NS_ASSERT(IsStateOk());
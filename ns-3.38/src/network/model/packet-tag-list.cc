@@ -24,6 +24,7 @@
 
 #include "packet-tag-list.h"
 
+#include "packet-allocator.h"
 #include "tag-buffer.h"
 #include "tag.h"
 
@@ -44,14 +45,33 @@ PacketTagList::CreateTagData(size_t dataSize)
                   "Requested TagData size " << dataSize << " exceeds maximum "
                                             << std::numeric_limits<decltype(TagData::size)>::max());
 
-    void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
+    void* p = PacketAllocator::Allocate(sizeof(TagData) + dataSize - 1);
+    // The matching DeleteTagData calls are in RemoveAll, RemoveWriter and ReleaseTagData
 
     TagData* tag = new (p) TagData;
     tag->size = dataSize;
     return tag;
 }
 
+void
+PacketTagList::DeleteTagData(TagData* data)
+{
+    std::size_t size = sizeof(TagData) + data->size - 1;
+    data->~TagData();
+    PacketAllocator::Deallocate(data, size);
+}
+
+void
+PacketTagList::ReleaseTagData(TagData* data)
+{
+    while (data != nullptr && --data->count == 0)
+    {
+        TagData* next = data->next;
+        DeleteTagData(data);
+        data = next;
+    }
+}
+
 bool
 PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
 {
@@ -150,7 +170,6 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     {
         NS_ASSERT(cur != nullptr);
         NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
         struct TagData* copy = CreateTagData(cur->size);
         copy->tid = cur->tid;
         copy->count = 1;
@@ -158,6 +177,7 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
         memcpy(copy->data, cur->data, copy->size);
         copy->next = cur->next; // merge into tail
         copy->next->count++;    // mark new merge
+        ReleaseTagData(cur);    // unmerge cur
         *prevNext = copy;       // point prior list at copy
         prevNext = &copy->next; // advance
         cur = copy->next;
@@ -195,19 +215,18 @@ PacketTagList::RemoveWriter(Tag& tag,
     if (preMerge)
     {
         // found tid before first merge, so delete cur
-        cur->~TagData();
-        std::free(cur);
+        DeleteTagData(cur);
     }
     else
     {
         // cur is always a merge at this point
-        // unmerge cur, since we linked around it already
-        cur->count--;
         if (cur->next != nullptr)
         {
             // there's a next, so make it a merge
             cur->next->count++;
         }
+        // unmerge cur, since we linked around it already
+        ReleaseTagData(cur);
     }
     return found;
 }
@@ -243,7 +262,6 @@ PacketTagList::ReplaceWriter(Tag& tag,
     {
         // cur is always a merge at this point
         // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
         struct TagData* copy = CreateTagData(tag.GetSerializedSize());
         copy->tid = tag.GetInstanceTypeId();
         copy->count = 1;
@@ -253,7 +271,8 @@ PacketTagList::ReplaceWriter(Tag& tag,
         {
             copy->next->count++; // mark new merge
         }
-        *prevNext = copy; // point prior list at copy
+        ReleaseTagData(cur); // unmerge cur
+        *prevNext = copy;    // point prior list at copy
     }
     return found;
 }
@@ -29,6 +29,10 @@
 #include <ostream>
 #include <stdint.h>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -142,7 +146,11 @@ class PacketTagList
     struct TagData
     {
         struct TagData* next; //!< Pointer to next in list
-        uint32_t count;       //!< Number of incoming links
+#ifdef NS3_MTP
+        std::atomic<uint32_t> count; //!< Number of incoming links
+#else
+        uint32_t count; //!< Number of incoming links
+#endif
         TypeId tid;           //!< Type of the tag serialized into #data
         uint32_t size;        //!< Size of the \c data buffer
         uint8_t data[1];      //!< Serialization buffer
@@ -253,6 +261,25 @@ class PacketTagList
      */
     static TagData* CreateTagData(size_t dataSize);
 
+    /**
+     * Destroy a TagData struct and release its memory.
+     *
+     * \param [in] data The TagData object, as returned by CreateTagData.
+     */
+    static void DeleteTagData(TagData* data);
+
+    /**
+     * Drop one incoming link to a TagData, destroying it, and in turn
+     * dropping its own link down the list, if that was the last one.
+     *
+     * Callers read the fields of \pname{data} before releasing it:
+     * in multithreaded builds another list sharing the node may drop
+     * its link at any time.
+     *
+     * \param [in] data The TagData to release.
+     */
+    static void ReleaseTagData(TagData* data);
+
     /**
      * Typedef of method function pointer for copy-on-write operations
      *
@@ -358,22 +385,19 @@ PacketTagList::RemoveAll()
     struct TagData* prev = nullptr;
     for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
-        cur->count--;
-        if (cur->count > 0)
+        if (--cur->count > 0)
         {
             break;
         }
         if (prev != nullptr)
         {
-            prev->~TagData();
-            std::free(prev);
+            DeleteTagData(prev);
         }
         prev = cur;
     }
     if (prev != nullptr)
     {
-        prev->~TagData();
-        std::free(prev);
+        DeleteTagData(prev);
     }
     m_next = nullptr;
 }
@@ -34,6 +34,7 @@
 #include "ns3/mac48-address.h"
 #include "ns3/ptr.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 namespace ns3
@@ -256,6 +257,18 @@ class Packet : public SimpleRefCount<Packet>
      * \return the copied object
      */
     Packet& operator=(const Packet& o);
+    /**
+     * \brief Allocate memory for a packet from the PacketAllocator pool
+     * \param size the size of the packet object
+     * \return the allocated memory
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * \brief Release the memory of a packet to the PacketAllocator pool
+     * \param ptr the memory to release
+     * \param size the size of the packet object
+     */
+    static void operator delete(void* ptr, std::size_t size);
     /**
      * \brief Create a packet with a zero-filled payload.
      *
@@ -797,7 +810,11 @@ class Packet : public SimpleRefCount<Packet>
     /* Please see comments above about nix-vector */
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+#ifdef NS3_MTP
+    static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+#else
     static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
@@ -16,9 +16,12 @@
  */
 
 #include "ns3/drop-tail-queue.h"
+#include "ns3/ring-buffer.h"
 #include "ns3/string.h"
 #include "ns3/test.h"
 
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -87,6 +90,69 @@ DropTailQueueTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(packet, nullptr, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer unit tests.
+ */
+class RingBufferTestCase : public TestCase
+{
+  public:
+    RingBufferTestCase();
+    void DoRun() override;
+};
+
+RingBufferTestCase::RingBufferTestCase()
+    : TestCase("Check the ring buffer container of the queues")
+{
+}
+
+void
+RingBufferTestCase::DoRun()
+{
+    RingBuffer<int> buffer;
+    std::vector<int> expected;
+
+    // Wrap around the slots many times, growing the buffer now and then.
+    int next = 0;
+    for (int round = 0; round < 100; ++round)
+    {
+        for (int i = 0; i < round % 40; ++i)
+        {
+            buffer.push_back(next);
+            expected.push_back(next++);
+        }
+        for (int i = 0; i < round % 17 && !buffer.empty(); ++i)
+        {
+            NS_TEST_ASSERT_MSG_EQ(buffer.front(), expected.front(), "Wrong FIFO order");
+            buffer.erase(buffer.begin());
+            expected.erase(expected.begin());
+        }
+        NS_TEST_ASSERT_MSG_EQ(buffer.size(), expected.size(), "Wrong size");
+    }
+
+    // Insert and erase in the middle of a wrapped buffer.
+    auto it = buffer.begin();
+    ++it;
+    ++it;
+    it = buffer.insert(it, -1);
+    NS_TEST_EXPECT_MSG_EQ(*it, -1, "Wrong inserted item");
+    expected.insert(expected.begin() + 2, -1);
+    it = buffer.erase(++buffer.begin());
+    expected.erase(expected.begin() + 1);
+    NS_TEST_EXPECT_MSG_EQ(*it, -1, "Wrong item after the erased one");
+    buffer.insert(buffer.end(), -2);
+    expected.push_back(-2);
+
+    std::vector<int> items(buffer.begin(), buffer.end());
+    NS_TEST_EXPECT_MSG_EQ((items == expected), true, "Wrong items");
+
+    buffer.clear();
+    NS_TEST_EXPECT_MSG_EQ(buffer.empty(), true, "The buffer should be empty");
+    NS_TEST_EXPECT_MSG_EQ((buffer.begin() == buffer.end()), true, "The buffer should be empty");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -100,6 +166,7 @@ class DropTailQueueTestSuite : public TestSuite
         : TestSuite("drop-tail-queue", UNIT)
     {
         AddTestCase(new DropTailQueueTestCase(), TestCase::QUICK);
+        AddTestCase(new RingBufferTestCase(), TestCase::QUICK);
     }
 };
 
@@ -25,6 +25,7 @@
  */
 
 #include "ns3/address.h"
+#include "ns3/boolean.h"
 #include "ns3/callback.h"
 #include "ns3/double.h"
 #include "ns3/error-model.h"
@@ -40,6 +41,8 @@
 #include "ns3/string.h"
 #include "ns3/test.h"
 
+#include <cmath>
+
 using namespace ns3;
 
 static void
@@ -288,6 +291,139 @@ BurstErrorModelSimple::DoRun()
     NS_TEST_ASSERT_MSG_EQ(m_drops, 260, "Wrong number of drops.");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RateErrorModel SkipAhead mode unit tests.
+ */
+class RateErrorModelSkipAhead : public TestCase
+{
+  public:
+    RateErrorModelSkipAhead();
+
+  private:
+    void DoRun() override;
+    /**
+     * Count the packets corrupted by a model.
+     * \param em The error model.
+     * \param packets The number of packets.
+     * \return The number of corrupted packets.
+     */
+    uint32_t CountCorrupted(Ptr<ErrorModel> em, uint32_t packets);
+};
+
+RateErrorModelSkipAhead::RateErrorModelSkipAhead()
+    : TestCase("RateErrorModel with geometric skip-ahead sampling")
+{
+}
+
+uint32_t
+RateErrorModelSkipAhead::CountCorrupted(Ptr<ErrorModel> em, uint32_t packets)
+{
+    Ptr<Packet> pkt = Create<Packet>(1000);
+    uint32_t corrupted = 0;
+    for (uint32_t i = 0; i < packets; i++)
+    {
+        corrupted += em->IsCorrupt(pkt);
+    }
+    return corrupted;
+}
+
+void
+RateErrorModelSkipAhead::DoRun()
+{
+    // Set some arbitrary deterministic values
+    RngSeedManager::SetSeed(3);
+    RngSeedManager::SetRun(5);
+
+    Ptr<RateErrorModel> em = CreateObject<RateErrorModel>();
+    em->SetAttribute("SkipAhead", BooleanValue(true));
+    em->AssignStreams(0);
+
+    // The rate of corrupted packets must match the per-packet draws of the
+    // default mode, within five standard deviations.
+    em->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
+    em->SetRate(0.01);
+    NS_TEST_EXPECT_MSG_EQ_TOL(CountCorrupted(em, 200000), 2000, 250, "Wrong packet errors");
+
+    em->SetUnit(RateErrorModel::ERROR_UNIT_BYTE);
+    em->SetRate(1e-4);
+    double per = 1 - std::pow(1 - 1e-4, 1000);
+    NS_TEST_EXPECT_MSG_EQ_TOL(CountCorrupted(em, 100000), 100000 * per, 500, "Wrong byte errors");
+
+    em->SetUnit(RateErrorModel::ERROR_UNIT_BIT);
+    em->SetRate(1e-5);
+    per = 1 - std::pow(1 - 1e-5, 8000);
+    NS_TEST_EXPECT_MSG_EQ_TOL(CountCorrupted(em, 100000), 100000 * per, 500, "Wrong bit errors");
+
+    em->SetRate(0);
+    NS_TEST_EXPECT_MSG_EQ(CountCorrupted(em, 1000), 0, "No packet should be corrupted");
+    em->SetRate(1);
+    NS_TEST_EXPECT_MSG_EQ(CountCorrupted(em, 1000), 1000, "All packets should be corrupted");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * GilbertElliottErrorModel unit tests.
+ */
+class GilbertElliottErrorModelSimple : public TestCase
+{
+  public:
+    GilbertElliottErrorModelSimple();
+
+  private:
+    void DoRun() override;
+};
+
+GilbertElliottErrorModelSimple::GilbertElliottErrorModelSimple()
+    : TestCase("GilbertElliottErrorModel burst statistics")
+{
+}
+
+void
+GilbertElliottErrorModelSimple::DoRun()
+{
+    // Set some arbitrary deterministic values
+    RngSeedManager::SetSeed(3);
+    RngSeedManager::SetRun(5);
+
+    Ptr<GilbertElliottErrorModel> em = CreateObject<GilbertElliottErrorModel>();
+    em->SetAttribute("GoodToBad", DoubleValue(0.01));
+    em->SetAttribute("BadToGood", DoubleValue(0.1));
+    em->AssignStreams(0);
+
+    // Every packet sent in the bad state is corrupted: a fraction
+    // 0.01 / (0.01 + 0.1) of the packets, in bursts of 10 packets on average.
+    Ptr<Packet> pkt = Create<Packet>(1000);
+    uint32_t packets = 200000;
+    uint32_t corrupted = 0;
+    uint32_t bursts = 0;
+    bool previous = false;
+    for (uint32_t i = 0; i < packets; i++)
+    {
+        bool bad = em->IsBad();
+        bool corrupt = em->IsCorrupt(pkt);
+        NS_TEST_ASSERT_MSG_EQ(corrupt, bad, "Corruption does not match the state");
+        corrupted += corrupt;
+        bursts += corrupt && !previous;
+        previous = corrupt;
+    }
+    NS_TEST_EXPECT_MSG_EQ_TOL(corrupted, packets / 11, 2700, "Wrong fraction of errors");
+    NS_TEST_EXPECT_MSG_EQ_TOL(double(corrupted) / bursts, 10, 1, "Wrong burst length");
+
+    // Without errors in the bad state, no packet is corrupted.
+    em->SetAttribute("BadErrorRate", DoubleValue(0));
+    em->Reset();
+    NS_TEST_EXPECT_MSG_EQ(em->IsBad(), false, "Reset() should restore the good state");
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(em->IsCorrupt(pkt), false, "No packet should be corrupted");
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -309,6 +445,8 @@ ErrorModelTestSuite::ErrorModelTestSuite()
 {
     AddTestCase(new ErrorModelSimple, TestCase::QUICK);
     AddTestCase(new BurstErrorModelSimple, TestCase::QUICK);
+    AddTestCase(new RateErrorModelSkipAhead, TestCase::QUICK);
+    AddTestCase(new GilbertElliottErrorModelSimple, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -16,10 +16,12 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/packet-allocator.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/packet.h"
 #include "ns3/test.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <ctime>
 #include <iomanip>
@@ -1260,6 +1262,87 @@ PacketTagListTest::DoRun()
 } // Timing
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet allocator unit tests.
+ */
+class PacketAllocatorTest : public TestCase
+{
+  public:
+    PacketAllocatorTest();
+
+  private:
+    void DoRun() override;
+    /**
+     * Create, tag, copy and release a few packets.
+     * \return Whether the packet contents were intact.
+     */
+    bool Churn();
+};
+
+PacketAllocatorTest::PacketAllocatorTest()
+    : TestCase("Packet allocator")
+{
+}
+
+bool
+PacketAllocatorTest::Churn()
+{
+    bool intact = true;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        uint8_t data[100];
+        for (uint32_t j = 0; j < sizeof(data); ++j)
+        {
+            data[j] = static_cast<uint8_t>(i + j);
+        }
+        Ptr<Packet> p = Create<Packet>(data, sizeof(data));
+        ATestTag<1> tag;
+        p->AddPacketTag(tag);
+        p->AddByteTag(tag);
+        ATestHeader<10> header;
+        p->AddHeader(header);
+        Ptr<Packet> copy = p->Copy();
+        copy->RemoveHeader(header);
+        uint8_t copied[sizeof(data)];
+        copy->CopyData(copied, sizeof(copied));
+        intact = intact && std::equal(data, data + sizeof(data), copied);
+    }
+    return intact;
+}
+
+void
+PacketAllocatorTest::DoRun()
+{
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetBlockSize(1), 32, "Wrong smallest block size");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetBlockSize(33), 64, "Wrong block size");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetBlockSize(65536), 65536, "Wrong largest block size");
+    NS_TEST_EXPECT_MSG_EQ(PacketAllocator::GetBlockSize(65537), 65537, "Wrong heap block size");
+
+    bool enabled = PacketAllocator::IsEnabled();
+    PacketAllocator::SetEnabled(true);
+    // Warm up the free lists, and the buffer sizing heuristic.
+    Churn();
+    Churn();
+    PacketAllocator::ResetStats();
+    NS_TEST_EXPECT_MSG_EQ(Churn(), true, "Packet corrupted");
+    auto stats = PacketAllocator::GetStats();
+    NS_TEST_EXPECT_MSG_GT(stats.allocations, 0, "No allocation through the pool");
+    NS_TEST_EXPECT_MSG_EQ(stats.poolHits, stats.allocations, "Allocations missed the pool");
+    NS_TEST_EXPECT_MSG_EQ(stats.releases, stats.allocations, "Allocations leaked");
+    NS_TEST_EXPECT_MSG_EQ(stats.heapReleases, 0, "Releases bypassed the pool");
+
+    PacketAllocator::SetEnabled(false);
+    PacketAllocator::ResetStats();
+    NS_TEST_EXPECT_MSG_EQ(Churn(), true, "Packet corrupted");
+    stats = PacketAllocator::GetStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.poolHits, 0, "Disabled pool used");
+    NS_TEST_EXPECT_MSG_EQ(stats.heapReleases, stats.releases, "Disabled pool cached blocks");
+    PacketAllocator::SetEnabled(enabled);
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1277,6 +1360,7 @@ PacketTestSuite::PacketTestSuite()
 {
     AddTestCase(new PacketTest, TestCase::QUICK);
     AddTestCase(new PacketTagListTest, TestCase::QUICK);
+    AddTestCase(new PacketAllocatorTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -16,14 +16,18 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/packet.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
 #include "ns3/test.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -1375,6 +1379,166 @@ DiffTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that a pcap file written from the background
+ * thread is identical to the same file written synchronously.
+ */
+class AsynchronousWriteTestCase : public TestCase
+{
+  public:
+    AsynchronousWriteTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Write a pcap file.
+     * \param filename the file name
+     * \param asynchronous whether to write the file from the background thread
+     */
+    void WriteFile(const std::string& filename, bool asynchronous);
+};
+
+AsynchronousWriteTestCase::AsynchronousWriteTestCase()
+    : TestCase("Check that asynchronous pcap files match synchronous ones")
+{
+}
+
+void
+AsynchronousWriteTestCase::WriteFile(const std::string& filename, bool asynchronous)
+{
+    PcapFile f;
+    f.Open(filename, std::ios::out, asynchronous);
+    NS_TEST_ASSERT_MSG_EQ(f.Fail(), false, "Open (" << filename << ") returns error");
+    f.Init(1, 64);
+
+    // Enough records to span several write blocks, some of them truncated
+    // to the snap length.
+    uint8_t data[200];
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        uint32_t size = (i * 7) % sizeof(data);
+        for (uint32_t j = 0; j < size; ++j)
+        {
+            data[j] = i + j;
+        }
+        if (i % 2)
+        {
+            f.Write(i / 1000, i % 1000, data, size);
+        }
+        else
+        {
+            f.Write(i / 1000, i % 1000, Create<Packet>(data, size));
+        }
+    }
+    f.Close();
+    NS_TEST_EXPECT_MSG_EQ(f.Fail(), false, "Writing " << filename << " failed");
+}
+
+void
+AsynchronousWriteTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("sync.pcap");
+    std::string filename2 = CreateTempDirFilename("async.pcap");
+    WriteFile(filename, false);
+    WriteFile(filename2, true);
+
+    uint32_t sec(0);
+    uint32_t usec(0);
+    uint32_t packets(0);
+    bool diff = PcapFile::Diff(filename, filename2, sec, usec, packets);
+    NS_TEST_EXPECT_MSG_EQ(diff, false, "Asynchronous file differs at " << sec << "." << usec);
+    NS_TEST_EXPECT_MSG_EQ(packets, 10000, "Wrong number of packets");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the PcapngFile writes well-formed blocks.
+ */
+class PcapngFileTestCase : public TestCase
+{
+  public:
+    PcapngFileTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+PcapngFileTestCase::PcapngFileTestCase()
+    : TestCase("Check that PcapngFile writes well-formed blocks")
+{
+}
+
+void
+PcapngFileTestCase::DoRun()
+{
+    std::string filename = CreateTempDirFilename("merged.pcapng");
+    {
+        Ptr<PcapngFile> f = PcapngFile::Get(filename);
+        NS_TEST_ASSERT_MSG_EQ(f->Fail(), false, "Cannot create " << filename);
+        NS_TEST_EXPECT_MSG_EQ(PcapngFile::Get(filename), f, "Files are not shared by name");
+        NS_TEST_EXPECT_MSG_EQ(f->AddInterface("eth0", 1, 8), 0, "Wrong interface id");
+        NS_TEST_EXPECT_MSG_EQ(f->AddInterface("", 1, 65535), 1, "Wrong interface id");
+
+        uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        f->Write(0, 1000000001, data, 10);
+        f->Write(1, 0x100000002, Create<Packet>(data, 5));
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+    auto get32 = [&bytes](std::size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, &bytes[offset], sizeof(value));
+        return value;
+    };
+
+    // Section header, interfaces "eth0" and unnamed, then two packets.
+    std::size_t sizes[] = {28, 40, 32, 40, 40};
+    uint32_t types[] = {0x0a0d0d0a, 1, 1, 6, 6};
+    std::size_t offsets[5];
+    std::size_t offset = 0;
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ((offset + sizes[i] <= bytes.size()), true, "File too short");
+        NS_TEST_EXPECT_MSG_EQ(get32(offset), types[i], "Wrong type of block " << i);
+        NS_TEST_EXPECT_MSG_EQ(get32(offset + 4), sizes[i], "Wrong size of block " << i);
+        NS_TEST_EXPECT_MSG_EQ(get32(offset + sizes[i] - 4),
+                              sizes[i],
+                              "Wrong trailing size of block " << i);
+        offsets[i] = offset;
+        offset += sizes[i];
+    }
+    NS_TEST_EXPECT_MSG_EQ(offset, bytes.size(), "Trailing bytes in the file");
+
+    NS_TEST_EXPECT_MSG_EQ(get32(8), 0x1a2b3c4d, "Wrong byte order magic");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[1] + 12), 8, "Wrong snap length");
+    NS_TEST_EXPECT_MSG_EQ(std::memcmp(&bytes[offsets[1] + 20], "eth0", 4),
+                          0,
+                          "Wrong interface name");
+
+    // The first packet is truncated to the snap length of its interface.
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[3] + 8), 0, "Wrong interface");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[3] + 12), 0, "Wrong timestamp");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[3] + 16), 1000000001, "Wrong timestamp");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[3] + 20), 8, "Wrong captured length");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[3] + 24), 10, "Wrong original length");
+    NS_TEST_EXPECT_MSG_EQ(bytes[offsets[3] + 35], 7, "Wrong packet data");
+
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[4] + 8), 1, "Wrong interface");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[4] + 12), 1, "Wrong timestamp");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[4] + 16), 2, "Wrong timestamp");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[4] + 20), 5, "Wrong captured length");
+    NS_TEST_EXPECT_MSG_EQ(get32(offsets[4] + 24), 5, "Wrong original length");
+    NS_TEST_EXPECT_MSG_EQ(bytes[offsets[4] + 32], 4, "Wrong packet data");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1398,6 +1562,8 @@ PcapFileTestSuite::PcapFileTestSuite()
     AddTestCase(new RecordHeaderTestCase, TestCase::QUICK);
     AddTestCase(new ReadFileTestCase, TestCase::QUICK);
     AddTestCase(new DiffTestCase, TestCase::QUICK);
+    AddTestCase(new AsynchronousWriteTestCase, TestCase::QUICK);
+    AddTestCase(new PcapngFileTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,270 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-file-writer.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AsyncFileWriter");
+
+/** A file shared by a writer and the background thread. */
+struct AsyncFileWriter::File
+{
+    std::ofstream stream; //!< The file stream.
+    std::size_t pending;  //!< Blocks queued for this file, guarded by the worker mutex.
+    bool failed;          //!< Whether a write failed, guarded by the worker mutex.
+};
+
+/**
+ * The background thread shared by all the writers.
+ *
+ * Blocks are queued under a mutex: the simulation thread takes it once
+ * per block, rather than once per record.
+ */
+class AsyncFileWriter::Worker
+{
+  public:
+    /**
+     * Get the worker, starting its thread on first use.
+     * \returns The worker, or \c nullptr while static objects are destroyed.
+     */
+    static Worker* Get();
+
+    /**
+     * Queue a block.
+     * \param [in] file The file to write the block to.
+     * \param [in] data The block.
+     * \param [in] size The size of the block, in bytes.
+     */
+    void Push(std::shared_ptr<File> file, std::unique_ptr<uint8_t[]> data, std::size_t size);
+    /**
+     * Wait until the queued blocks of a file are written.
+     * \param [in] file The file.
+     * \returns Whether all the blocks were written.
+     */
+    bool Wait(const std::shared_ptr<File>& file);
+
+  private:
+    Worker();
+    /** Write the remaining blocks and stop the thread. */
+    ~Worker();
+
+    /** A block waiting to be written. */
+    struct Block
+    {
+        std::shared_ptr<File> file;      //!< The file.
+        std::unique_ptr<uint8_t[]> data; //!< The data.
+        std::size_t size;                //!< The data size, in bytes.
+    };
+
+    /** Write the queued blocks until stopped. */
+    void Run();
+
+    std::mutex m_mutex;             //!< Guards the queue and the files.
+    std::condition_variable m_wake; //!< Signals a new block, or the stop.
+    std::condition_variable m_done; //!< Signals written blocks.
+    std::deque<Block> m_queue;      //!< The queued blocks.
+    bool m_stop;                    //!< Whether the thread should stop.
+    std::thread m_thread;           //!< The background thread.
+
+    /** Whether the worker was destroyed, at the end of the program. */
+    static bool m_destroyed;
+};
+
+bool AsyncFileWriter::Worker::m_destroyed = false;
+
+AsyncFileWriter::Worker*
+AsyncFileWriter::Worker::Get()
+{
+    if (m_destroyed)
+    {
+        return nullptr;
+    }
+    static Worker worker;
+    return &worker;
+}
+
+AsyncFileWriter::Worker::Worker()
+    : m_stop(false)
+{
+    m_thread = std::thread(&Worker::Run, this);
+}
+
+AsyncFileWriter::Worker::~Worker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_destroyed = true;
+}
+
+void
+AsyncFileWriter::Worker::Push(std::shared_ptr<File> file,
+                              std::unique_ptr<uint8_t[]> data,
+                              std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        file->pending++;
+        m_queue.push_back(Block{std::move(file), std::move(data), size});
+    }
+    m_wake.notify_one();
+}
+
+bool
+AsyncFileWriter::Worker::Wait(const std::shared_ptr<File>& file)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&file]() { return file->pending == 0; });
+    return !file->failed;
+}
+
+void
+AsyncFileWriter::Worker::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+        {
+            // Stopped, with every block written.
+            return;
+        }
+        Block block = std::move(m_queue.front());
+        m_queue.pop_front();
+        // Each file is written by this thread only, while it has blocks queued.
+        lock.unlock();
+        block.file->stream.write(reinterpret_cast<const char*>(block.data.get()), block.size);
+        bool failed = block.file->stream.fail();
+        block.data.reset();
+        lock.lock();
+        block.file->failed = block.file->failed || failed;
+        block.file->pending--;
+        m_done.notify_all();
+    }
+}
+
+AsyncFileWriter::AsyncFileWriter()
+    : m_failed(false),
+      m_used(0),
+      m_capacity(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+bool
+AsyncFileWriter::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    Close();
+    m_file = std::make_shared<File>();
+    m_file->pending = 0;
+    m_file->failed = false;
+    m_file->stream.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    m_failed = m_file->stream.fail();
+    if (m_failed)
+    {
+        m_file = nullptr;
+    }
+    return !m_failed;
+}
+
+void
+AsyncFileWriter::Close()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_file)
+    {
+        return;
+    }
+    Submit();
+    Worker* worker = Worker::Get();
+    if (worker != nullptr && !worker->Wait(m_file))
+    {
+        m_failed = true;
+    }
+    m_file->stream.close();
+    m_failed = m_failed || m_file->stream.fail();
+    m_file = nullptr;
+    m_block = nullptr;
+    m_used = 0;
+    m_capacity = 0;
+}
+
+bool
+AsyncFileWriter::IsOpen() const
+{
+    return bool(m_file);
+}
+
+bool
+AsyncFileWriter::Fail() const
+{
+    return m_failed;
+}
+
+void
+AsyncFileWriter::Flush(std::size_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    Submit();
+    if (!m_block || m_capacity < size)
+    {
+        m_capacity = std::max(size, BLOCK_SIZE);
+        m_block.reset(new uint8_t[m_capacity]);
+    }
+}
+
+void
+AsyncFileWriter::Submit()
+{
+    if (m_used > 0 && m_file)
+    {
+        Worker* worker = Worker::Get();
+        if (worker != nullptr)
+        {
+            worker->Push(m_file, std::move(m_block), m_used);
+        }
+        else
+        {
+            // The program is exiting: write on the calling thread.
+            m_file->stream.write(reinterpret_cast<const char*>(m_block.get()), m_used);
+            m_failed = m_failed || m_file->stream.fail();
+        }
+    }
+    m_used = 0;
+}
+
+} // namespace ns3
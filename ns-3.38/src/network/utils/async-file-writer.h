@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <cstring>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ *
+ * \brief A binary output file written from a background thread.
+ *
+ * Data is appended to an in-memory block on the calling thread; full
+ * blocks are handed over to a single background thread, shared by all
+ * the writers of the process, which writes them to their files.  This
+ * keeps file system calls, and their latency, off the simulation
+ * thread.
+ *
+ * A writer is used by one thread at a time.  Errors of the background
+ * thread are reported by Fail() once the file is closed.
+ */
+class AsyncFileWriter
+{
+  public:
+    /** Size of the blocks handed over to the background thread, in bytes. */
+    static constexpr std::size_t BLOCK_SIZE = 256 * 1024;
+
+    AsyncFileWriter();
+    /** Close the file, if still open. */
+    ~AsyncFileWriter();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * Create a file, truncating any existing file of the same name.
+     * \param [in] filename The file name.
+     * \returns Whether the file was created.
+     */
+    bool Open(const std::string& filename);
+    /**
+     * Write the buffered data and close the file.
+     *
+     * This waits for the background thread to write all the blocks of
+     * this file.
+     */
+    void Close();
+    /**
+     * \returns Whether the file is open.
+     */
+    bool IsOpen() const;
+    /**
+     * \returns Whether the file could not be created or, once closed, written.
+     */
+    bool Fail() const;
+
+    /**
+     * Reserve space at the end of the file.
+     * \param [in] size The number of bytes to reserve.
+     * \returns A pointer to \pname{size} bytes, to be filled in before
+     * the next call to the writer.
+     */
+    uint8_t* Reserve(std::size_t size)
+    {
+        if (m_used + size > m_capacity)
+        {
+            Flush(size);
+        }
+        uint8_t* data = m_block.get() + m_used;
+        m_used += size;
+        return data;
+    }
+
+    /**
+     * Append data to the file.
+     * \param [in] data The data.
+     * \param [in] size The data size, in bytes.
+     */
+    void Write(const void* data, std::size_t size)
+    {
+        if (size > 0)
+        {
+            std::memcpy(Reserve(size), data, size);
+        }
+    }
+
+  private:
+    /**
+     * Hand the current block over to the background thread, and get a
+     * new block.
+     * \param [in] size The space needed in the new block, in bytes.
+     */
+    void Flush(std::size_t size);
+    /** Hand the current block, if any, over to the background thread. */
+    void Submit();
+
+    /** A file shared with the background thread. */
+    struct File;
+    /** The background thread. */
+    class Worker;
+
+    std::shared_ptr<File> m_file;       //!< The file, if open.
+    bool m_failed;                      //!< Whether the file could not be created.
+    std::unique_ptr<uint8_t[]> m_block; //!< The block being filled.
+    std::size_t m_used;                 //!< Bytes used in the block.
+    std::size_t m_capacity;             //!< Size of the block.
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_FILE_WRITER_H */
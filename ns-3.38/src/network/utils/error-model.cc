@@ -70,13 +70,48 @@
 #include "ns3/pointer.h"
 #include "ns3/string.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace ns3
 {
 
 NS_LOG_COMPONENT_DEFINE("ErrorModel");
 
+namespace
+{
+
+/** Number of units drawn for an event that never happens. */
+const uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+/**
+ * Draw the number of units before the next error, when each unit is
+ * errored independently: the result follows a geometric distribution.
+ *
+ * \param ranvar a Uniform(0,1) random variable
+ * \param rate the error rate of each unit
+ * \returns the number of units before the next error, or NEVER if
+ * there is none
+ */
+uint64_t
+DrawGap(Ptr<RandomVariableStream> ranvar, double rate)
+{
+    if (rate <= 0)
+    {
+        return NEVER;
+    }
+    if (rate >= 1)
+    {
+        return 0;
+    }
+    // 1 - U lies in (0, 1], so that the logarithm is finite.
+    double gap = std::floor(std::log(1.0 - ranvar->GetValue()) / std::log1p(-rate));
+    return gap < static_cast<double>(NEVER) ? static_cast<uint64_t>(gap) : NEVER;
+}
+
+} // namespace
+
 NS_OBJECT_ENSURE_REGISTERED(ErrorModel);
 
 TypeId
@@ -176,11 +211,20 @@ RateErrorModel::GetTypeId()
                           "The decision variable attached to this error model.",
                           StringValue("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"),
                           MakePointerAccessor(&RateErrorModel::m_ranvar),
-                          MakePointerChecker<RandomVariableStream>());
+                          MakePointerChecker<RandomVariableStream>())
+            .AddAttribute("SkipAhead",
+                          "Whether to draw the number of units between errors, rather than "
+                          "a random number per packet.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RateErrorModel::m_skipAhead),
+                          MakeBooleanChecker());
     return tid;
 }
 
 RateErrorModel::RateErrorModel()
+    : m_gap(0),
+      m_gapRate(-1),
+      m_gapUnit(ERROR_UNIT_PACKET)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -241,6 +285,22 @@ RateErrorModel::DoCorrupt(Ptr<Packet> p)
     {
         return false;
     }
+    if (m_skipAhead)
+    {
+        switch (m_unit)
+        {
+        case ERROR_UNIT_PACKET:
+            return DoCorruptSkipAhead(1);
+        case ERROR_UNIT_BYTE:
+            return DoCorruptSkipAhead(p->GetSize());
+        case ERROR_UNIT_BIT:
+            return DoCorruptSkipAhead(8 * static_cast<uint64_t>(p->GetSize()));
+        default:
+            NS_ASSERT_MSG(false, "m_unit not supported yet");
+            break;
+        }
+        return false;
+    }
     switch (m_unit)
     {
     case ERROR_UNIT_PACKET:
@@ -281,11 +341,35 @@ RateErrorModel::DoCorruptBit(Ptr<Packet> p)
     return (m_ranvar->GetValue() < per);
 }
 
+bool
+RateErrorModel::DoCorruptSkipAhead(uint64_t units)
+{
+    NS_LOG_FUNCTION(this << units);
+    if (m_gapRate != m_rate || m_gapUnit != m_unit)
+    {
+        m_gap = DrawGap(m_ranvar, m_rate);
+        m_gapRate = m_rate;
+        m_gapUnit = m_unit;
+    }
+    if (m_gap >= units)
+    {
+        if (m_gap != NEVER)
+        {
+            m_gap -= units;
+        }
+        return false;
+    }
+    // Further errors in this packet do not matter: as errors are
+    // independent, the next gap can be drawn from the end of the packet.
+    m_gap = DrawGap(m_ranvar, m_rate);
+    return true;
+}
+
 void
 RateErrorModel::DoReset()
 {
     NS_LOG_FUNCTION(this);
-    /* re-initialize any state; no-op for now */
+    m_gapRate = -1;
 }
 
 //
@@ -419,6 +503,162 @@ BurstErrorModel::DoReset()
     m_currentBurstSz = 0;
 }
 
+//
+// GilbertElliottErrorModel
+//
+
+NS_OBJECT_ENSURE_REGISTERED(GilbertElliottErrorModel);
+
+TypeId
+GilbertElliottErrorModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::GilbertElliottErrorModel")
+            .SetParent<ErrorModel>()
+            .SetGroupName("Network")
+            .AddConstructor<GilbertElliottErrorModel>()
+            .AddAttribute("ErrorUnit",
+                          "The error unit",
+                          EnumValue(RateErrorModel::ERROR_UNIT_PACKET),
+                          MakeEnumAccessor(&GilbertElliottErrorModel::m_unit),
+                          MakeEnumChecker(RateErrorModel::ERROR_UNIT_BIT,
+                                          "ERROR_UNIT_BIT",
+                                          RateErrorModel::ERROR_UNIT_BYTE,
+                                          "ERROR_UNIT_BYTE",
+                                          RateErrorModel::ERROR_UNIT_PACKET,
+                                          "ERROR_UNIT_PACKET"))
+            .AddAttribute("GoodToBad",
+                          "The probability to move to the bad state after a unit in the "
+                          "good state.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&GilbertElliottErrorModel::m_goodToBad),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("BadToGood",
+                          "The probability to move to the good state after a unit in the "
+                          "bad state.",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&GilbertElliottErrorModel::m_badToGood),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("GoodErrorRate",
+                          "The error rate in the good state.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&GilbertElliottErrorModel::m_goodErrorRate),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("BadErrorRate",
+                          "The error rate in the bad state.",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&GilbertElliottErrorModel::m_badErrorRate),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("RanVar",
+                          "The decision variable attached to this error model.",
+                          StringValue("ns3::UniformRandomVariable[Min=0.0|Max=1.0]"),
+                          MakePointerAccessor(&GilbertElliottErrorModel::m_ranvar),
+                          MakePointerChecker<RandomVariableStream>());
+    return tid;
+}
+
+GilbertElliottErrorModel::GilbertElliottErrorModel()
+    : m_bad(false),
+      m_sojourn(0),
+      m_gap(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+GilbertElliottErrorModel::~GilbertElliottErrorModel()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+GilbertElliottErrorModel::IsBad() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_bad;
+}
+
+int64_t
+GilbertElliottErrorModel::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_ranvar->SetStream(stream);
+    return 1;
+}
+
+void
+GilbertElliottErrorModel::EnterState(bool bad)
+{
+    NS_LOG_FUNCTION(this << bad);
+    m_bad = bad;
+    // The state is left after a geometric number of units, at least one.
+    m_sojourn = DrawGap(m_ranvar, bad ? m_badToGood : m_goodToBad);
+    if (m_sojourn != NEVER)
+    {
+        m_sojourn++;
+    }
+    m_gap = DrawGap(m_ranvar, bad ? m_badErrorRate : m_goodErrorRate);
+}
+
+bool
+GilbertElliottErrorModel::DoCorrupt(Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+    if (!IsEnabled())
+    {
+        return false;
+    }
+    if (m_sojourn == 0)
+    {
+        EnterState(false);
+    }
+    uint64_t units = 1;
+    if (m_unit == RateErrorModel::ERROR_UNIT_BYTE)
+    {
+        units = p->GetSize();
+    }
+    else if (m_unit == RateErrorModel::ERROR_UNIT_BIT)
+    {
+        units = 8 * static_cast<uint64_t>(p->GetSize());
+    }
+
+    bool corrupt = false;
+    while (units > 0)
+    {
+        // Walk the packet up to its end or to the next state change.
+        uint64_t step = std::min(units, m_sojourn);
+        bool errored = m_gap < step;
+        if (!errored && m_gap != NEVER)
+        {
+            m_gap -= step;
+        }
+        if (m_sojourn != NEVER)
+        {
+            m_sojourn -= step;
+        }
+        units -= step;
+        corrupt = corrupt || errored;
+        if (m_sojourn == 0)
+        {
+            EnterState(!m_bad);
+        }
+        else if (errored)
+        {
+            // As in RateErrorModel, the next gap can be drawn from the end
+            // of the step, skipping the other errors of the step.
+            m_gap = DrawGap(m_ranvar, m_bad ? m_badErrorRate : m_goodErrorRate);
+        }
+    }
+    return corrupt;
+}
+
+void
+GilbertElliottErrorModel::DoReset()
+{
+    NS_LOG_FUNCTION(this);
+    m_bad = false;
+    m_sojourn = 0;
+}
+
 //
 // ListErrorModel
 //
@@ -110,8 +110,9 @@ class Packet;
  *   }
  * \endcode
  *
- * Four practical error models, a RateErrorModel, a BurstErrorModel,
- * a ListErrorModel, and a ReceiveListErrorModel, are currently implemented.
+ * Five practical error models, a RateErrorModel, a BurstErrorModel,
+ * a GilbertElliottErrorModel, a ListErrorModel, and a ReceiveListErrorModel,
+ * are currently implemented.
  */
 class ErrorModel : public Object
 {
@@ -175,8 +176,17 @@ class ErrorModel : public Object
  * unit (which may be per-bit, per-byte, and per-packet).
  * Users can optionally provide a RandomVariableStream object; the default
  * is to use a Uniform(0,1) distribution.
-
- * Reset() on this model will do nothing
+ *
+ * By default, one random number is drawn per packet.  When the SkipAhead
+ * attribute is true, the model instead draws the number of units (bits,
+ * bytes or packets) before the next error from a geometric distribution,
+ * and only counts units down until then: a random number is drawn per
+ * corrupted packet, which is much cheaper at low error rates.  Both modes
+ * corrupt each unit independently with the same probability, but they
+ * consume the random numbers differently.  The SkipAhead mode requires
+ * the random variable to be Uniform(0,1).
+ *
+ * Reset() on this model restarts the count down of the SkipAhead mode
  *
  * IsCorrupt() will not modify the packet data buffer
  */
@@ -255,12 +265,23 @@ class RateErrorModel : public ErrorModel
      * \returns true if the packet is corrupted
      */
     virtual bool DoCorruptBit(Ptr<Packet> p);
+    /**
+     * Corrupt a packet, counting the units down to the next error.
+     * \param units the number of units in the packet
+     * \returns true if the packet is corrupted
+     */
+    bool DoCorruptSkipAhead(uint64_t units);
     void DoReset() override;
 
     ErrorUnit m_unit; //!< Error rate unit
     double m_rate;    //!< Error rate
 
     Ptr<RandomVariableStream> m_ranvar; //!< rng stream
+
+    bool m_skipAhead;    //!< Draw the units between errors rather than per packet
+    uint64_t m_gap;      //!< Units left before the next error, in SkipAhead mode
+    double m_gapRate;    //!< Error rate m_gap was drawn for, negative if none
+    ErrorUnit m_gapUnit; //!< Error unit m_gap was drawn for
 };
 
 /**
@@ -352,6 +373,75 @@ class BurstErrorModel : public ErrorModel
     uint32_t m_currentBurstSz; //!< the current burst size
 };
 
+/**
+ * \brief Determine which packets are errored according to a two-state
+ * (Gilbert-Elliott) Markov chain, to model bursts of errors.
+ *
+ * The channel is either in the good or in the bad state, each with its own
+ * error rate.  After each unit (bit, byte or packet), the channel moves from
+ * the good to the bad state with probability GoodToBad, and from the bad
+ * to the good state with probability BadToGood, so that bursts last
+ * 1 / BadToGood units on average.
+ *
+ * Rather than drawing random numbers per unit, the model draws the number
+ * of units left in the current state and the number of units before the
+ * next error from geometric distributions, and counts units down until
+ * then.  A random number is thus drawn per state change or corrupted
+ * packet.  The random variable must be Uniform(0,1).
+ *
+ * Changes to the attributes take effect at the next state change or
+ * Reset().  Reset() puts the channel back in the good state.
+ *
+ * IsCorrupt() will not modify the packet data buffer
+ */
+class GilbertElliottErrorModel : public ErrorModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    GilbertElliottErrorModel();
+    ~GilbertElliottErrorModel() override;
+
+    /**
+     * \returns true if the channel is in the bad state
+     */
+    bool IsBad() const;
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    bool DoCorrupt(Ptr<Packet> p) override;
+    void DoReset() override;
+    /**
+     * Enter a state, drawing the units to spend in it and before its first error.
+     * \param bad true to enter the bad state
+     */
+    void EnterState(bool bad);
+
+    RateErrorModel::ErrorUnit m_unit;   //!< Error unit
+    double m_goodToBad;                 //!< Transition probability from the good state
+    double m_badToGood;                 //!< Transition probability from the bad state
+    double m_goodErrorRate;             //!< Error rate in the good state
+    double m_badErrorRate;              //!< Error rate in the bad state
+    Ptr<RandomVariableStream> m_ranvar; //!< rng stream
+
+    bool m_bad;         //!< Whether the channel is in the bad state
+    uint64_t m_sojourn; //!< Units left in the current state, zero before the first packet
+    uint64_t m_gap;     //!< Units left before the next error in the current state
+};
+
 /**
  * \brief Provide a list of Packet uids to corrupt
  *
@@ -21,6 +21,7 @@
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "ns3/log.h"
+#include "ns3/string.h"
 #include "ns3/uinteger.h"
 
 namespace ns3
@@ -48,11 +49,24 @@ PcapFileWrapper::GetTypeId()
                           "microseconds(default).",
                           BooleanValue(false),
                           MakeBooleanAccessor(&PcapFileWrapper::m_nanosecMode),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute("Asynchronous",
+                          "Whether files created for writing only are written from a "
+                          "background thread.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PcapFileWrapper::m_asynchronous),
+                          MakeBooleanChecker())
+            .AddAttribute("PcapngFile",
+                          "If not empty, files created for writing only are merged, as "
+                          "interfaces named after them, into the PCAPNG file of this name.",
+                          StringValue(""),
+                          MakeStringAccessor(&PcapFileWrapper::m_pcapngFilename),
+                          MakeStringChecker());
     return tid;
 }
 
 PcapFileWrapper::PcapFileWrapper()
+    : m_interface(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -67,6 +81,10 @@ bool
 PcapFileWrapper::Fail() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_pcapng)
+    {
+        return m_pcapng->Fail();
+    }
     return m_file.Fail();
 }
 
@@ -88,6 +106,7 @@ void
 PcapFileWrapper::Close()
 {
     NS_LOG_FUNCTION(this);
+    m_pcapng = nullptr;
     m_file.Close();
 }
 
@@ -95,7 +114,14 @@ void
 PcapFileWrapper::Open(const std::string& filename, std::ios::openmode mode)
 {
     NS_LOG_FUNCTION(this << filename << mode);
-    m_file.Open(filename, mode);
+    bool writeOnly = (mode & std::ios::out) && !(mode & std::ios::in);
+    if (writeOnly && !m_pcapngFilename.empty())
+    {
+        m_pcapng = PcapngFile::Get(m_pcapngFilename);
+        m_interfaceName = filename;
+        return;
+    }
+    m_file.Open(filename, mode, writeOnly && m_asynchronous);
 }
 
 void
@@ -107,6 +133,15 @@ PcapFileWrapper::Init(uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrect
     // a snaplen, we use the one provided.
     //
     NS_LOG_FUNCTION(this << dataLinkType << snapLen << tzCorrection);
+    if (m_pcapng)
+    {
+        if (snapLen == std::numeric_limits<uint32_t>::max())
+        {
+            snapLen = m_snapLen;
+        }
+        m_interface = m_pcapng->AddInterface(m_interfaceName, dataLinkType, snapLen);
+        return;
+    }
     if (snapLen != std::numeric_limits<uint32_t>::max())
     {
         m_file.Init(dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
@@ -121,6 +156,11 @@ void
 PcapFileWrapper::Write(Time t, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << t << p);
+    if (m_pcapng)
+    {
+        m_pcapng->Write(m_interface, t.GetNanoSeconds(), p);
+        return;
+    }
     if (m_file.IsNanoSecMode())
     {
         uint64_t current = t.GetNanoSeconds();
@@ -141,6 +181,11 @@ void
 PcapFileWrapper::Write(Time t, const Header& header, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << t << &header << p);
+    if (m_pcapng)
+    {
+        m_pcapng->Write(m_interface, t.GetNanoSeconds(), header, p);
+        return;
+    }
     if (m_file.IsNanoSecMode())
     {
         uint64_t current = t.GetNanoSeconds();
@@ -161,6 +206,11 @@ void
 PcapFileWrapper::Write(Time t, const uint8_t* buffer, uint32_t length)
 {
     NS_LOG_FUNCTION(this << t << &buffer << length);
+    if (m_pcapng)
+    {
+        m_pcapng->Write(m_interface, t.GetNanoSeconds(), buffer, length);
+        return;
+    }
     if (m_file.IsNanoSecMode())
     {
         uint64_t current = t.GetNanoSeconds();
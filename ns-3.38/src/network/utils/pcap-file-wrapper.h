@@ -19,6 +19,7 @@
 #define PCAP_FILE_WRAPPER_H
 
 #include "pcap-file.h"
+#include "pcapng-file.h"
 
 #include "ns3/nstime.h"
 #include "ns3/object.h"
@@ -37,6 +38,10 @@ namespace ns3
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * Files created for writing only can be written from a background thread
+ * (see the "Asynchronous" attribute), or merged into a single PCAPNG file
+ * holding one interface per wrapper (see the "PcapngFile" attribute).
  */
 class PcapFileWrapper : public Object
 {
@@ -222,9 +227,14 @@ class PcapFileWrapper : public Object
     uint32_t GetDataLinkType();
 
   private:
-    PcapFile m_file;    //!< Pcap file
-    uint32_t m_snapLen; //!< max length of saved packets
-    bool m_nanosecMode; //!< Timestamps in nanosecond mode
+    PcapFile m_file;              //!< Pcap file
+    uint32_t m_snapLen;           //!< max length of saved packets
+    bool m_nanosecMode;           //!< Timestamps in nanosecond mode
+    bool m_asynchronous;          //!< Write the pcap file from a background thread
+    std::string m_pcapngFilename; //!< Name of the PCAPNG file to write to, if any
+    Ptr<PcapngFile> m_pcapng;     //!< PCAPNG file written to, instead of m_file
+    std::string m_interfaceName;  //!< Name of the interface in the PCAPNG file
+    uint32_t m_interface;         //!< Id of the interface in the PCAPNG file
 };
 
 } // namespace ns3
@@ -71,7 +71,7 @@ bool
 PcapFile::Fail() const
 {
     NS_LOG_FUNCTION(this);
-    return m_file.fail();
+    return m_file.fail() || m_writer.Fail();
 }
 
 bool
@@ -92,6 +92,11 @@ void
 PcapFile::Close()
 {
     NS_LOG_FUNCTION(this);
+    if (m_writer.IsOpen())
+    {
+        m_writer.Close();
+        return;
+    }
     m_file.close();
 }
 
@@ -211,7 +216,10 @@ PcapFile::WriteFileHeader()
     // If we're initializing the file, we need to write the pcap file header
     // at the start of the file.
     //
-    m_file.seekp(0, std::ios::beg);
+    if (!m_writer.IsOpen())
+    {
+        m_file.seekp(0, std::ios::beg);
+    }
 
     //
     // We have the ability to write out the pcap file header in a foreign endian
@@ -239,13 +247,13 @@ PcapFile::WriteFileHeader()
     // Watch out for memory alignment differences between machines, so write
     // them all individually.
     //
-    m_file.write((const char*)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-    m_file.write((const char*)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-    m_file.write((const char*)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-    m_file.write((const char*)&headerOut->m_zone, sizeof(headerOut->m_zone));
-    m_file.write((const char*)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-    m_file.write((const char*)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-    m_file.write((const char*)&headerOut->m_type, sizeof(headerOut->m_type));
+    Output(&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
+    Output(&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
+    Output(&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
+    Output(&headerOut->m_zone, sizeof(headerOut->m_zone));
+    Output(&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
+    Output(&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
+    Output(&headerOut->m_type, sizeof(headerOut->m_type));
 }
 
 void
@@ -328,11 +336,21 @@ PcapFile::ReadAndVerifyFileHeader()
 }
 
 void
-PcapFile::Open(const std::string& filename, std::ios::openmode mode)
+PcapFile::Open(const std::string& filename, std::ios::openmode mode, bool asynchronous)
 {
-    NS_LOG_FUNCTION(this << filename << mode);
+    NS_LOG_FUNCTION(this << filename << mode << asynchronous);
     NS_ASSERT((mode & std::ios::app) == 0);
     NS_ASSERT(!m_file.fail());
+    if (asynchronous)
+    {
+        NS_ASSERT_MSG((mode & std::ios::in) == 0, "Asynchronous pcap files are write-only");
+        m_filename = filename;
+        if (!m_writer.Open(filename))
+        {
+            m_file.setstate(std::ios::failbit);
+        }
+        return;
+    }
     //
     // All pcap files are binary files, so we just do this automatically.
     //
@@ -432,20 +450,33 @@ PcapFile::WritePacketHeader(uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     // Watch out for memory alignment differences between machines, so write
     // them all individually.
     //
-    m_file.write((const char*)&header.m_tsSec, sizeof(header.m_tsSec));
-    m_file.write((const char*)&header.m_tsUsec, sizeof(header.m_tsUsec));
-    m_file.write((const char*)&header.m_inclLen, sizeof(header.m_inclLen));
-    m_file.write((const char*)&header.m_origLen, sizeof(header.m_origLen));
+    Output(&header.m_tsSec, sizeof(header.m_tsSec));
+    Output(&header.m_tsUsec, sizeof(header.m_tsUsec));
+    Output(&header.m_inclLen, sizeof(header.m_inclLen));
+    Output(&header.m_origLen, sizeof(header.m_origLen));
     NS_BUILD_DEBUG(m_file.flush());
     return inclLen;
 }
 
+void
+PcapFile::Output(const void* data, std::size_t size)
+{
+    if (m_writer.IsOpen())
+    {
+        m_writer.Write(data, size);
+    }
+    else
+    {
+        m_file.write(static_cast<const char*>(data), size);
+    }
+}
+
 void
 PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, const uint8_t* const data, uint32_t totalLen)
 {
     NS_LOG_FUNCTION(this << tsSec << tsUsec << &data << totalLen);
     uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, totalLen);
-    m_file.write((const char*)data, inclLen);
+    Output(data, inclLen);
     NS_BUILD_DEBUG(m_file.flush());
 }
 
@@ -454,6 +485,12 @@ PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
     NS_LOG_FUNCTION(this << tsSec << tsUsec << p);
     uint32_t inclLen = WritePacketHeader(tsSec, tsUsec, p->GetSize());
+    if (m_writer.IsOpen())
+    {
+        // Only the captured bytes are copied, straight into the write block.
+        p->CopyData(m_writer.Reserve(inclLen), inclLen);
+        return;
+    }
     p->CopyData(&m_file, inclLen);
     NS_BUILD_DEBUG(m_file.flush());
 }
@@ -470,8 +507,14 @@ PcapFile::Write(uint32_t tsSec, uint32_t tsUsec, const Header& header, Ptr<const
     headerBuffer.AddAtStart(headerSize);
     header.Serialize(headerBuffer.Begin());
     uint32_t toCopy = std::min(headerSize, inclLen);
-    headerBuffer.CopyData(&m_file, toCopy);
     inclLen -= toCopy;
+    if (m_writer.IsOpen())
+    {
+        headerBuffer.CopyData(m_writer.Reserve(toCopy), toCopy);
+        p->CopyData(m_writer.Reserve(inclLen), inclLen);
+        return;
+    }
+    headerBuffer.CopyData(&m_file, toCopy);
     p->CopyData(&m_file, inclLen);
 }
 
@@ -20,6 +20,8 @@
 #ifndef PCAP_FILE_H
 #define PCAP_FILE_H
 
+#include "async-file-writer.h"
+
 #include "ns3/ptr.h"
 
 #include <fstream>
@@ -75,11 +77,17 @@ class PcapFile
      * selected as a binary file (fstream::binary is automatically ored with the mode
      * field).
      *
+     * A file opened for writing only can be written asynchronously: records
+     * are then buffered in large blocks, which an AsyncFileWriter writes
+     * from a background thread.
+     *
      * \param filename String containing the name of the file.
      *
      * \param mode the access mode for the file.
+     *
+     * \param asynchronous Whether to write the file from a background thread.
      */
-    void Open(const std::string& filename, std::ios::openmode mode);
+    void Open(const std::string& filename, std::ios::openmode mode, bool asynchronous = false);
 
     /**
      * Close the underlying file.
@@ -373,8 +381,16 @@ class PcapFile
      */
     void ReadAndVerifyFileHeader();
 
+    /**
+     * \brief Write data to the file
+     * \param data the data
+     * \param size the data size
+     */
+    void Output(const void* data, std::size_t size);
+
     std::string m_filename;      //!< file name
     std::fstream m_file;         //!< file stream
+    AsyncFileWriter m_writer;    //!< background writer, for asynchronous files
     PcapFileHeader m_fileHeader; //!< file header
     bool m_swapMode;             //!< swap mode
     bool m_nanosecMode;          //!< nanosecond timestamp mode
@@ -0,0 +1,248 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcapng-file.h"
+
+#include "ns3/abort.h"
+#include "ns3/buffer.h"
+#include "ns3/header.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PcapngFile");
+
+namespace
+{
+
+const uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a; //!< Section header block type
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 1;   //!< Interface description block type
+const uint32_t ENHANCED_PACKET_BLOCK = 6;         //!< Enhanced packet block type
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;     //!< Byte order magic number
+const uint16_t VERSION_MAJOR = 1;                 //!< Major version of the file format
+const uint16_t VERSION_MINOR = 0;                 //!< Minor version of the file format
+const uint16_t OPTION_END = 0;                    //!< End of options option code
+const uint16_t OPTION_IF_NAME = 2;                //!< Interface name option code
+const uint16_t OPTION_IF_TSRESOL = 9;             //!< Timestamp resolution option code
+const uint8_t TSRESOL_NANOSECONDS = 9;            //!< Nanosecond timestamp resolution
+const uint32_t PACKET_BLOCK_OVERHEAD = 32;        //!< Enhanced packet block size without data
+
+/**
+ * Round a size up to the 32-bit alignment of the blocks.
+ * \param [in] size The size, in bytes.
+ * \returns The padded size.
+ */
+uint32_t
+Pad(uint32_t size)
+{
+    return (size + 3) & ~3U;
+}
+
+/**
+ * Append a value to a block.
+ * \tparam T \deduced The value type.
+ * \param [in,out] p The write position.
+ * \param [in] value The value.
+ */
+template <typename T>
+void
+Put(uint8_t*& p, T value)
+{
+    std::memcpy(p, &value, sizeof(value));
+    p += sizeof(value);
+}
+
+/** Guards the registry of open files. */
+std::mutex g_filesMutex;
+
+/**
+ * Get the registry of open files.
+ * \returns The open files, by name.
+ */
+std::map<std::string, PcapngFile*>&
+GetFiles()
+{
+    static std::map<std::string, PcapngFile*> files;
+    return files;
+}
+
+} // unnamed namespace
+
+Ptr<PcapngFile>
+PcapngFile::Get(const std::string& filename)
+{
+    NS_LOG_FUNCTION(filename);
+    std::lock_guard<std::mutex> lock(g_filesMutex);
+    auto& files = GetFiles();
+    auto it = files.find(filename);
+    if (it != files.end())
+    {
+        return Ptr<PcapngFile>(it->second);
+    }
+    Ptr<PcapngFile> file = Ptr<PcapngFile>(new PcapngFile(filename), false);
+    files[filename] = PeekPointer(file);
+    return file;
+}
+
+PcapngFile::PcapngFile(const std::string& filename)
+    : m_filename(filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    if (!m_writer.Open(filename))
+    {
+        return;
+    }
+    uint8_t* p = m_writer.Reserve(28);
+    Put<uint32_t>(p, SECTION_HEADER_BLOCK);
+    Put<uint32_t>(p, 28);
+    Put<uint32_t>(p, BYTE_ORDER_MAGIC);
+    Put<uint16_t>(p, VERSION_MAJOR);
+    Put<uint16_t>(p, VERSION_MINOR);
+    // The length of the section is not known in advance.
+    Put<int64_t>(p, -1);
+    Put<uint32_t>(p, 28);
+}
+
+PcapngFile::~PcapngFile()
+{
+    NS_LOG_FUNCTION(this);
+    {
+        std::lock_guard<std::mutex> lock(g_filesMutex);
+        auto& files = GetFiles();
+        auto it = files.find(m_filename);
+        if (it != files.end() && it->second == this)
+        {
+            files.erase(it);
+        }
+    }
+    m_writer.Close();
+    NS_ABORT_MSG_IF(m_writer.Fail(), "Unable to write " << m_filename);
+}
+
+bool
+PcapngFile::Fail() const
+{
+    return m_writer.Fail();
+}
+
+uint32_t
+PcapngFile::AddInterface(const std::string& name, uint32_t dataLinkType, uint32_t snapLen)
+{
+    NS_LOG_FUNCTION(this << name << dataLinkType << snapLen);
+#ifdef NS3_MTP
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    uint32_t nameLen = name.size();
+    uint32_t size = 16 + (nameLen > 0 ? 4 + Pad(nameLen) : 0) + 8 + 4 + 4;
+    uint8_t* p = m_writer.Reserve(size);
+    Put<uint32_t>(p, INTERFACE_DESCRIPTION_BLOCK);
+    Put<uint32_t>(p, size);
+    Put<uint16_t>(p, dataLinkType);
+    Put<uint16_t>(p, 0);
+    Put<uint32_t>(p, snapLen);
+    if (nameLen > 0)
+    {
+        Put<uint16_t>(p, OPTION_IF_NAME);
+        Put<uint16_t>(p, nameLen);
+        std::memcpy(p, name.data(), nameLen);
+        std::memset(p + nameLen, 0, Pad(nameLen) - nameLen);
+        p += Pad(nameLen);
+    }
+    Put<uint16_t>(p, OPTION_IF_TSRESOL);
+    Put<uint16_t>(p, 1);
+    Put<uint32_t>(p, TSRESOL_NANOSECONDS);
+    Put<uint16_t>(p, OPTION_END);
+    Put<uint16_t>(p, 0);
+    Put<uint32_t>(p, size);
+
+    m_snapLen.push_back(snapLen);
+    return m_snapLen.size() - 1;
+}
+
+uint8_t*
+PcapngFile::WritePacketBlock(uint32_t interface,
+                             uint64_t ns,
+                             uint32_t totalLen,
+                             uint32_t& inclLen)
+{
+    NS_ASSERT_MSG(interface < m_snapLen.size(), "Unknown interface " << interface);
+    inclLen = std::min(totalLen, m_snapLen[interface]);
+    uint32_t size = PACKET_BLOCK_OVERHEAD + Pad(inclLen);
+    uint8_t* p = m_writer.Reserve(size);
+    Put<uint32_t>(p, ENHANCED_PACKET_BLOCK);
+    Put<uint32_t>(p, size);
+    Put<uint32_t>(p, interface);
+    Put<uint32_t>(p, ns >> 32);
+    Put<uint32_t>(p, ns & 0xffffffff);
+    Put<uint32_t>(p, inclLen);
+    Put<uint32_t>(p, totalLen);
+    uint8_t* data = p;
+    p += inclLen;
+    std::memset(p, 0, Pad(inclLen) - inclLen);
+    p += Pad(inclLen) - inclLen;
+    Put<uint32_t>(p, size);
+    return data;
+}
+
+void
+PcapngFile::Write(uint32_t interface, uint64_t ns, const uint8_t* data, uint32_t totalLen)
+{
+    NS_LOG_FUNCTION(this << interface << ns << &data << totalLen);
+#ifdef NS3_MTP
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    uint32_t inclLen;
+    uint8_t* p = WritePacketBlock(interface, ns, totalLen, inclLen);
+    std::memcpy(p, data, inclLen);
+}
+
+void
+PcapngFile::Write(uint32_t interface, uint64_t ns, Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << interface << ns << p);
+#ifdef NS3_MTP
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    uint32_t inclLen;
+    uint8_t* data = WritePacketBlock(interface, ns, p->GetSize(), inclLen);
+    p->CopyData(data, inclLen);
+}
+
+void
+PcapngFile::Write(uint32_t interface, uint64_t ns, const Header& header, Ptr<const Packet> p)
+{
+    NS_LOG_FUNCTION(this << interface << ns << &header << p);
+    uint32_t headerSize = header.GetSerializedSize();
+    Buffer headerBuffer;
+    headerBuffer.AddAtStart(headerSize);
+    header.Serialize(headerBuffer.Begin());
+#ifdef NS3_MTP
+    std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    uint32_t inclLen;
+    uint8_t* data = WritePacketBlock(interface, ns, headerSize + p->GetSize(), inclLen);
+    uint32_t toCopy = std::min(headerSize, inclLen);
+    headerBuffer.CopyData(data, toCopy);
+    p->CopyData(data + toCopy, inclLen - toCopy);
+}
+
+} // namespace ns3
@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include "async-file-writer.h"
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef NS3_MTP
+#include <mutex>
+#endif
+
+namespace ns3
+{
+
+class Header;
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief A PCAPNG file merging the packets captured on many interfaces.
+ *
+ * Tracing every device of a large topology to its own pcap file creates
+ * thousands of files.  A PcapngFile instead holds one interface
+ * description block per traced device, and one enhanced packet block
+ * per captured packet, in a single file written from a background
+ * thread by an AsyncFileWriter.  Timestamps have a nanosecond
+ * resolution.
+ *
+ * The files are shared by name: every PcapngFile::Get() call with the
+ * same name returns the same file, which is closed when the last
+ * reference is released.  The file is written in the byte order of the
+ * host, as recorded in its section header block.
+ */
+class PcapngFile : public SimpleRefCount<PcapngFile>
+{
+  public:
+    /**
+     * Get a file, creating it on first use.
+     * \param [in] filename The file name.
+     * \returns The file.
+     */
+    static Ptr<PcapngFile> Get(const std::string& filename);
+
+    /** Close the file. */
+    ~PcapngFile();
+
+    /**
+     * \returns Whether the file could not be created or written.
+     */
+    bool Fail() const;
+
+    /**
+     * Add an interface to the file.
+     * \param [in] name The interface name.
+     * \param [in] dataLinkType The data link type, as defined by the pcap library.
+     * \param [in] snapLen The maximum number of bytes captured per packet.
+     * \returns The interface id.
+     */
+    uint32_t AddInterface(const std::string& name, uint32_t dataLinkType, uint32_t snapLen);
+
+    /**
+     * Write a packet captured on an interface.
+     * \param [in] interface The interface id.
+     * \param [in] ns The capture time, in nanoseconds.
+     * \param [in] data The packet data.
+     * \param [in] totalLen The packet size.
+     */
+    void Write(uint32_t interface, uint64_t ns, const uint8_t* data, uint32_t totalLen);
+    /**
+     * Write a packet captured on an interface.
+     * \param [in] interface The interface id.
+     * \param [in] ns The capture time, in nanoseconds.
+     * \param [in] p The packet.
+     */
+    void Write(uint32_t interface, uint64_t ns, Ptr<const Packet> p);
+    /**
+     * Write a packet captured on an interface, with a header prepended.
+     * \param [in] interface The interface id.
+     * \param [in] ns The capture time, in nanoseconds.
+     * \param [in] header The header to prepend to the packet.
+     * \param [in] p The packet.
+     */
+    void Write(uint32_t interface, uint64_t ns, const Header& header, Ptr<const Packet> p);
+
+  private:
+    /**
+     * Create a file.
+     * \param [in] filename The file name.
+     */
+    PcapngFile(const std::string& filename);
+
+    /**
+     * Reserve an enhanced packet block and fill in everything but the
+     * packet data.
+     * \param [in] interface The interface id.
+     * \param [in] ns The capture time, in nanoseconds.
+     * \param [in] totalLen The packet size.
+     * \param [out] inclLen The number of bytes to capture.
+     * \returns Where to copy the captured bytes.
+     */
+    uint8_t* WritePacketBlock(uint32_t interface,
+                              uint64_t ns,
+                              uint32_t totalLen,
+                              uint32_t& inclLen);
+
+    std::string m_filename;          //!< The file name.
+    AsyncFileWriter m_writer;        //!< The file writer.
+    std::vector<uint32_t> m_snapLen; //!< Snap length of each interface.
+#ifdef NS3_MTP
+    std::mutex m_mutex; //!< Serializes the simulation threads writing to the file.
+#endif
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
@@ -19,8 +19,7 @@
 #define QUEUE_FWD_H
 
 #include "ns3/ptr.h"
-
-#include <list>
+#include "ns3/ring-buffer.h"
 
 /**
  * \file
@@ -33,7 +32,7 @@ namespace ns3
 
 // Forward declaration of template class Queue specifying
 // the default value for the template template parameter Container
-template <typename Item, typename Container = std::list<Ptr<Item>>>
+template <typename Item, typename Container = RingBuffer<Ptr<Item>>>
 class Queue;
 
 } // namespace ns3
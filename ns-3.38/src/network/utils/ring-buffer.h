@@ -0,0 +1,389 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup queue
+ * ns3::RingBuffer declaration and template implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ *
+ * \brief A growable ring buffer, the default container of the Queue class.
+ *
+ * Items are stored contiguously in a circular array whose capacity is a
+ * power of two and doubles when the buffer is full, so that appending at
+ * the end and removing from the front, as a FIFO queue does, never
+ * allocate memory once the buffer has reached its working size.
+ * Insertions and removals elsewhere move the items that follow them.
+ *
+ * Unlike std::list, any insertion or removal invalidates the iterators.
+ * The slot of a removed item is reset to a default-constructed value, so
+ * that the buffer does not keep items such as Ptr alive.
+ *
+ * \tparam T \explicit The type of the items.
+ */
+template <typename T>
+class RingBuffer
+{
+  private:
+    /**
+     * An iterator over the items of a RingBuffer.
+     * \tparam Const Whether the items are read-only.
+     */
+    template <bool Const>
+    class IteratorImpl
+    {
+      public:
+        /// Iterator category.
+        using iterator_category = std::bidirectional_iterator_tag;
+        /// Type of the items.
+        using value_type = T;
+        /// Distance between iterators.
+        using difference_type = std::ptrdiff_t;
+        /// Pointer to an item.
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        /// Reference to an item.
+        using reference = std::conditional_t<Const, const T&, T&>;
+        /// Type of the buffer.
+        using Buffer = std::conditional_t<Const, const RingBuffer, RingBuffer>;
+
+        IteratorImpl()
+            : m_buffer(nullptr),
+              m_index(0)
+        {
+        }
+
+        /**
+         * Constructor.
+         * \param buffer the buffer
+         * \param index the position of the item, from the front of the buffer
+         */
+        IteratorImpl(Buffer* buffer, std::size_t index)
+            : m_buffer(buffer),
+              m_index(index)
+        {
+        }
+
+        /**
+         * Convert an iterator into a const iterator.
+         * \param other the iterator
+         */
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        IteratorImpl(const IteratorImpl<false>& other)
+            : m_buffer(other.m_buffer),
+              m_index(other.m_index)
+        {
+        }
+
+        /** \return the item */
+        reference operator*() const
+        {
+            return m_buffer->Slot(m_index);
+        }
+
+        /** \return a pointer to the item */
+        pointer operator->() const
+        {
+            return &m_buffer->Slot(m_index);
+        }
+
+        /** \return this iterator, moved to the next item */
+        IteratorImpl& operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+
+        /** \return a copy of this iterator, before moving it to the next item */
+        IteratorImpl operator++(int)
+        {
+            IteratorImpl copy = *this;
+            ++m_index;
+            return copy;
+        }
+
+        /** \return this iterator, moved to the previous item */
+        IteratorImpl& operator--()
+        {
+            --m_index;
+            return *this;
+        }
+
+        /** \return a copy of this iterator, before moving it to the previous item */
+        IteratorImpl operator--(int)
+        {
+            IteratorImpl copy = *this;
+            --m_index;
+            return copy;
+        }
+
+        /**
+         * \param other another iterator
+         * \return true if both iterators point to the same position
+         */
+        bool operator==(const IteratorImpl& other) const
+        {
+            return m_index == other.m_index;
+        }
+
+        /**
+         * \param other another iterator
+         * \return true if the iterators point to different positions
+         */
+        bool operator!=(const IteratorImpl& other) const
+        {
+            return m_index != other.m_index;
+        }
+
+      private:
+        friend class RingBuffer;
+        friend class IteratorImpl<true>;
+
+        Buffer* m_buffer;    //!< the buffer
+        std::size_t m_index; //!< position of the item, from the front of the buffer
+    };
+
+  public:
+    /// Type of the items.
+    using value_type = T;
+    /// Iterator.
+    using iterator = IteratorImpl<false>;
+    /// Const iterator.
+    using const_iterator = IteratorImpl<true>;
+
+    RingBuffer()
+        : m_head(0),
+          m_size(0)
+    {
+    }
+
+    /** \return an iterator to the first item */
+    iterator begin()
+    {
+        return iterator(this, 0);
+    }
+
+    /** \return an iterator past the last item */
+    iterator end()
+    {
+        return iterator(this, m_size);
+    }
+
+    /** \return a const iterator to the first item */
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    /** \return a const iterator past the last item */
+    const_iterator end() const
+    {
+        return const_iterator(this, m_size);
+    }
+
+    /** \return the number of items */
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /** \return true if the buffer holds no item */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /** \return the first item */
+    T& front()
+    {
+        return Slot(0);
+    }
+
+    /** \return the first item */
+    const T& front() const
+    {
+        return Slot(0);
+    }
+
+    /** \return the last item */
+    T& back()
+    {
+        return Slot(m_size - 1);
+    }
+
+    /** \return the last item */
+    const T& back() const
+    {
+        return Slot(m_size - 1);
+    }
+
+    /**
+     * Append an item.
+     * \param value the item
+     */
+    void push_back(const T& value)
+    {
+        if (m_size == m_slots.size())
+        {
+            Grow();
+        }
+        Slot(m_size) = value;
+        ++m_size;
+    }
+
+    /**
+     * Prepend an item.
+     * \param value the item
+     */
+    void push_front(const T& value)
+    {
+        if (m_size == m_slots.size())
+        {
+            Grow();
+        }
+        m_head = (m_head - 1) & (m_slots.size() - 1);
+        ++m_size;
+        Slot(0) = value;
+    }
+
+    /** Remove the first item. */
+    void pop_front()
+    {
+        Slot(0) = T();
+        m_head = (m_head + 1) & (m_slots.size() - 1);
+        --m_size;
+    }
+
+    /** Remove the last item. */
+    void pop_back()
+    {
+        Slot(m_size - 1) = T();
+        --m_size;
+    }
+
+    /**
+     * Insert an item.
+     * \param pos the position before which the item is inserted
+     * \param value the item
+     * \return an iterator to the inserted item
+     */
+    iterator insert(const_iterator pos, const T& value)
+    {
+        std::size_t index = pos.m_index;
+        if (index == m_size)
+        {
+            push_back(value);
+        }
+        else if (index == 0)
+        {
+            push_front(value);
+        }
+        else
+        {
+            push_back(value);
+            for (std::size_t i = m_size - 1; i > index; --i)
+            {
+                std::swap(Slot(i), Slot(i - 1));
+            }
+        }
+        return iterator(this, index);
+    }
+
+    /**
+     * Remove an item.
+     * \param pos the position of the item
+     * \return an iterator to the item that followed the removed one
+     */
+    iterator erase(const_iterator pos)
+    {
+        std::size_t index = pos.m_index;
+        if (index == 0)
+        {
+            pop_front();
+        }
+        else
+        {
+            for (std::size_t i = index; i + 1 < m_size; ++i)
+            {
+                Slot(i) = std::move(Slot(i + 1));
+            }
+            pop_back();
+        }
+        return iterator(this, index);
+    }
+
+    /** Remove all the items, keeping the capacity. */
+    void clear()
+    {
+        while (m_size > 0)
+        {
+            pop_back();
+        }
+        m_head = 0;
+    }
+
+  private:
+    /**
+     * \param index the position of an item, from the front of the buffer
+     * \return the slot of the item
+     */
+    T& Slot(std::size_t index)
+    {
+        return m_slots[(m_head + index) & (m_slots.size() - 1)];
+    }
+
+    /**
+     * \param index the position of an item, from the front of the buffer
+     * \return the slot of the item
+     */
+    const T& Slot(std::size_t index) const
+    {
+        return m_slots[(m_head + index) & (m_slots.size() - 1)];
+    }
+
+    /** Double the capacity, moving the items to the front of the new slots. */
+    void Grow()
+    {
+        std::vector<T> slots(m_slots.empty() ? 16 : 2 * m_slots.size());
+        for (std::size_t i = 0; i < m_size; ++i)
+        {
+            slots[i] = std::move(Slot(i));
+        }
+        m_slots.swap(slots);
+        m_head = 0;
+    }
+
+    std::vector<T> m_slots; //!< the slots, whose number is zero or a power of two
+    std::size_t m_head;     //!< slot of the first item
+    std::size_t m_size;     //!< number of items
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
@@ -22,11 +22,13 @@
 // Sample usage:  ./ns3 run 'bench-packets --n=10000'
 
 #include "ns3/command-line.h"
+#include "ns3/packet-allocator.h"
 #include "ns3/packet-metadata.h"
 #include "ns3/packet.h"
 #include "ns3/system-wall-clock-ms.h"
 
 #include <algorithm>
+#include <deque>
 #include <iostream>
 #include <limits>
 #include <sstream>
@@ -350,6 +352,42 @@ benchByteTags(uint32_t n)
     }
 }
 
+static void
+benchChurn(uint32_t n)
+{
+    BenchHeader<25> ipv4;
+    BenchHeader<20> tcp;
+    BenchTag<16> tag;
+
+    // Keep a window of packets in flight, as a transport protocol would,
+    // so that packets are released in a different order than created.
+    const std::size_t window = 64;
+    std::deque<Ptr<Packet>> inFlight;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> data = Create<Packet>(1000 + (i % 7) * 64);
+        data->AddHeader(tcp);
+        data->AddPacketTag(tag);
+        inFlight.push_back(data->Copy());
+        data->AddHeader(ipv4);
+
+        Ptr<Packet> ack = Create<Packet>();
+        ack->AddHeader(tcp);
+        ack->AddHeader(ipv4);
+        ack->RemoveHeader(ipv4);
+
+        if (i % 16 == 0)
+        {
+            Ptr<Packet> retransmission = inFlight.front()->Copy();
+            retransmission->AddHeader(ipv4);
+        }
+        if (inFlight.size() > window)
+        {
+            inFlight.pop_front();
+        }
+    }
+}
+
 static uint64_t
 runBenchOneIteration(void (*bench)(uint32_t), uint32_t n)
 {
@@ -382,6 +420,8 @@ main(int argc, char* argv[])
     uint32_t n = 0;
     uint32_t minIterations = 1;
     bool enablePrinting = false;
+    bool noPool = false;
+    bool comparePool = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark Packet class");
@@ -390,8 +430,14 @@ main(int argc, char* argv[])
                  "number of subiterations to minimize iteration time over",
                  minIterations);
     cmd.AddValue("enable-printing", "enable packet printing", enablePrinting);
+    cmd.AddValue("nopool", "disable the packet allocation pool", noPool);
+    cmd.AddValue("cmppool",
+                 "run the packet churn benchmark without and with the pool",
+                 comparePool);
     cmd.Parse(argc, argv);
 
+    PacketAllocator::SetEnabled(!noPool);
+
     if (n == 0)
     {
         std::cerr << "Error-- number of packets must be specified "
@@ -408,5 +454,21 @@ main(int argc, char* argv[])
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
 
+    if (comparePool)
+    {
+        PacketAllocator::SetEnabled(false);
+        runBench(&benchChurn, n, minIterations, "Packet churn, no packet pool");
+        PacketAllocator::SetEnabled(true);
+    }
+    PacketAllocator::ResetStats();
+    runBench(&benchChurn,
+             n,
+             minIterations,
+             PacketAllocator::IsEnabled() ? "Packet churn" : "Packet churn, no packet pool");
+    auto stats = PacketAllocator::GetStats();
+    std::cout << "Packet pool: allocations " << stats.allocations << ", pool hits "
+              << stats.poolHits << ", heap allocations " << stats.heapAllocations
+              << ", cached bytes " << stats.cachedBytes << std::endl;
+
     return 0;
 }
@@ -282,6 +282,7 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     {
         m_scheduler += " (default)";
     }
+    m_scheduler += EventImpl::IsPoolEnabled() ? ", event pool" : ", no event pool";
 
     Bench bench(pop, total);
     bench.SetRandomStream(eventStream);
@@ -387,6 +388,45 @@ BenchSuite::Log() const
 
 } // BenchSuite::Log()
 
+/**
+ * Run the benchmark suite for a single scheduler type,
+ * optionally with and without the EventImpl allocation pool.
+ *
+ * \param [in] factory Factory pre-configured to create the desired Scheduler.
+ * \param [in] pop The event population size.
+ * \param [in] total The total number of events to execute.
+ * \param [in] runs The number of replications.
+ * \param [in] eventStream The random stream of event delays.
+ * \param [in] calRev For the CalendarScheduler, whether the Reverse attribute was set.
+ * \param [in] comparePool Whether to run without the pool first.
+ */
+void
+RunSuite(ObjectFactory& factory,
+         uint64_t pop,
+         uint64_t total,
+         uint64_t runs,
+         Ptr<RandomVariableStream> eventStream,
+         bool calRev,
+         bool comparePool)
+{
+    bool enabled = EventImpl::IsPoolEnabled();
+    if (comparePool)
+    {
+        EventImpl::SetPoolEnabled(false);
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        EventImpl::SetPoolEnabled(true);
+    }
+
+    EventImpl::ResetPoolStats();
+    BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    auto stats = EventImpl::GetPoolStats();
+    LOG("EventImpl pool: allocations " << stats.allocations << ", pool hits " << stats.poolHits
+                                       << ", heap allocations " << stats.heapAllocations
+                                       << ", cached blocks " << stats.cached);
+    LOG("");
+    EventImpl::SetPoolEnabled(enabled);
+}
+
 /**
  *  Create a RandomVariableStream to generate next event delays.
  *
@@ -457,6 +497,7 @@ main(int argc, char* argv[])
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -466,6 +507,8 @@ main(int argc, char* argv[])
     uint64_t runs = 1;
     std::string filename = "";
     bool calRev = false;
+    bool noPool = false;
+    bool comparePool = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
@@ -482,6 +525,7 @@ main(int argc, char* argv[])
     cmd.AddValue("cal", "use CalendarSheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -491,8 +535,12 @@ main(int argc, char* argv[])
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
+    cmd.AddValue("nopool", "disable the EventImpl allocation pool", noPool);
+    cmd.AddValue("cmppool", "run each scheduler without and with the EventImpl pool", comparePool);
     cmd.Parse(argc, argv);
 
+    EventImpl::SetPoolEnabled(!noPool);
+
     g_me = cmd.GetName() + ": ";
     g_fwidth += 6; // 5 extra chars in '2.000002e+07 ': . e+0 _
 
@@ -505,10 +553,10 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
@@ -520,17 +568,22 @@ main(int argc, char* argv[])
     {
         factory.SetTypeId("ns3::CalendarScheduler");
         factory.Set("Reverse", BooleanValue(calRev));
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
         if (allSched)
         {
             factory.Set("Reverse", BooleanValue(!calRev));
-            BenchSuite(factory, pop, total, runs, eventStream, !calRev).Log();
+            RunSuite(factory, pop, total, runs, eventStream, !calRev, comparePool);
         }
     }
     if (schedHeap)
     {
         factory.SetTypeId("ns3::HeapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
+    }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
     }
     if (schedList)
     {
@@ -541,17 +594,17 @@ main(int argc, char* argv[])
             LOG("Running List scheduler with 1/10 total events");
             listTotal /= 10;
         }
-        BenchSuite(factory, pop, listTotal, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, listTotal, runs, eventStream, calRev, comparePool);
     }
     if (schedMap)
     {
         factory.SetTypeId("ns3::MapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
     }
     if (schedPQ)
     {
         factory.SetTypeId("ns3::PriorityQueueScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunSuite(factory, pop, total, runs, eventStream, calRev, comparePool);
     }
 
     return 0;
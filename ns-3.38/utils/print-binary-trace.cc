@@ -0,0 +1,49 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/binary-trace.h"
+
+#include <fstream>
+#include <iostream>
+
+/**
+ * \file
+ * \ingroup logging
+ * Render a binary trace file written by ns3::BinaryTrace as text.
+ */
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace file>" << std::endl;
+        return 1;
+    }
+    std::ifstream is(argv[1], std::ios::in | std::ios::binary);
+    if (!is.is_open())
+    {
+        std::cerr << argv[0] << ": cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    if (!BinaryTrace::Decode(is, std::cout))
+    {
+        std::cerr << argv[0] << ": " << argv[1] << " is not a complete binary trace" << std::endl;
+        return 1;
+    }
+    return 0;
+}